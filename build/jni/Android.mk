@@ -33,6 +33,7 @@ LOCAL_SRC_FILES :=../../ouzel/animators/Animator.cpp \
     ../../ouzel/core/android/WindowAndroid.cpp \
     ../../ouzel/core/Application.cpp \
     ../../ouzel/core/Cache.cpp \
+    ../../ouzel/core/JobSystem.cpp \
     ../../ouzel/core/Engine.cpp \
     ../../ouzel/core/UpdateCallback.cpp \
     ../../ouzel/core/Window.cpp \
@@ -56,6 +57,7 @@ LOCAL_SRC_FILES :=../../ouzel/animators/Animator.cpp \
     ../../ouzel/graphics/opengl/ShaderOGL.cpp \
     ../../ouzel/graphics/opengl/TextureOGL.cpp \
     ../../ouzel/graphics/opengl/VertexBufferOGL.cpp \
+    ../../ouzel/graphics/opengl/StreamBufferOGL.cpp \
     ../../ouzel/graphics/BlendState.cpp \
     ../../ouzel/graphics/Image.cpp \
     ../../ouzel/graphics/IndexBuffer.cpp \
@@ -64,6 +66,8 @@ LOCAL_SRC_FILES :=../../ouzel/animators/Animator.cpp \
     ../../ouzel/graphics/RenderTarget.cpp \
     ../../ouzel/graphics/Shader.cpp \
     ../../ouzel/graphics/Texture.cpp \
+    ../../ouzel/graphics/TextureCompression.cpp \
+    ../../ouzel/graphics/TextureAtlas.cpp \
     ../../ouzel/graphics/Vertex.cpp \
     ../../ouzel/graphics/VertexBuffer.cpp \
     ../../ouzel/gui/BMFont.cpp \
@@ -112,6 +116,7 @@ LOCAL_SRC_FILES :=../../ouzel/animators/Animator.cpp \
     ../../ouzel/scene/Sprite.cpp \
     ../../ouzel/scene/SpriteFrame.cpp \
     ../../ouzel/scene/TextDrawable.cpp \
+    ../../ouzel/scene/TransformHierarchy.cpp \
     ../../ouzel/utils/Log.cpp \
     ../../ouzel/utils/OBF.cpp \
     ../../ouzel/utils/Utils.cpp
@@ -1,6 +1,7 @@
 // Copyright (C) 2016 Elviss Strazdins
 // This file is part of the Ouzel engine.
 
+#include <algorithm>
 #include <rapidjson/rapidjson.h>
 #include <rapidjson/filereadstream.h>
 #include <rapidjson/document.h>
@@ -9,16 +10,35 @@
 #include "Application.h"
 #include "graphics/Renderer.h"
 #include "graphics/Texture.h"
+#include "graphics/Image.h"
 #include "graphics/Shader.h"
 #include "scene/ParticleDefinition.h"
 #include "scene/SpriteFrame.h"
 #include "files/FileSystem.h"
 #include "utils/Utils.h"
+#include "utils/Log.h"
 
 namespace ouzel
 {
+    // seconds between the scans for unused resources while the memory usage stays over the budget without changing
+    static const float EVICTION_RETRY_INTERVAL = 1.0f;
+
     Cache::Cache()
     {
+        updateCallback.callback = std::bind(&Cache::updateTextureLoads, this, std::placeholders::_1);
+        textureAtlas.setEvictionCallback(std::bind(&Cache::evictTextureAtlasPage, this, std::placeholders::_1));
+        evictionCallback.callback = std::bind(&Cache::evictUnusedResources, this, std::placeholders::_1);
+
+        setMemoryBudget(sharedEngine->getSettings().resourceMemoryBudget);
+    }
+
+    Cache::~Cache()
+    {
+        // the tasks reference the loads, so they must finish before the loads are destroyed
+        for (const std::unique_ptr<TextureLoad>& textureLoad : textureLoads)
+        {
+            sharedEngine->getJobSystem()->wait(textureLoad->group);
+        }
     }
 
     void Cache::preloadTexture(const std::string& filename, bool dynamic, bool mipmaps)
@@ -31,6 +51,11 @@ namespace ouzel
             texture->initFromFile(filename, dynamic, mipmaps);
 
             textures[filename] = texture;
+            textureUses[filename] = ++useCounter;
+        }
+        else
+        {
+            useTexture(filename);
         }
     }
 
@@ -42,6 +67,7 @@ namespace ouzel
 
         if (i != textures.end())
         {
+            useTexture(filename);
             return i->second;
         }
         else
@@ -50,19 +76,342 @@ namespace ouzel
             result->initFromFile(filename, dynamic, mipmaps);
 
             textures[filename] = result;
+            textureUses[filename] = ++useCounter;
         }
 
         return result;
     }
 
+    graphics::TexturePtr Cache::loadTextureAsync(const std::string& filename,
+                                                 const std::function<void(const graphics::TexturePtr&, bool)>& callback,
+                                                 bool dynamic, bool mipmaps,
+                                                 const graphics::TexturePtr& placeholder)
+    {
+        std::unordered_map<std::string, graphics::TexturePtr>::const_iterator i = textures.find(filename);
+
+        if (i != textures.end())
+        {
+            useTexture(filename);
+
+            for (const std::unique_ptr<TextureLoad>& textureLoad : textureLoads)
+            {
+                if (textureLoad->texture == i->second)
+                {
+                    if (callback) textureLoad->callbacks.push_back(callback);
+                    return i->second;
+                }
+            }
+
+            if (callback) callback(i->second, true);
+            return i->second;
+        }
+
+        graphics::TexturePtr texture = sharedEngine->getRenderer()->createTexture();
+        texture->setPlaceholder(placeholder ? placeholder : getTexture(graphics::TEXTURE_WHITE_PIXEL));
+
+        textures[filename] = texture;
+        textureUses[filename] = ++useCounter;
+
+        std::unique_ptr<TextureLoad> textureLoad(new TextureLoad());
+        textureLoad->filename = filename;
+        textureLoad->texture = texture;
+        textureLoad->dynamic = dynamic;
+        textureLoad->mipmaps = mipmaps;
+        textureLoad->success = false;
+        if (callback) textureLoad->callbacks.push_back(callback);
+
+        TextureLoad* load = textureLoad.get();
+        textureLoads.push_back(std::move(textureLoad));
+
+        sharedEngine->getJobSystem()->run(load->group, [load]() {
+            load->success = load->texture->decodeFile(load->filename, load->mipmaps);
+        });
+
+        sharedEngine->scheduleUpdate(&updateCallback);
+
+        return texture;
+    }
+
+    void Cache::updateTextureLoads(float)
+    {
+        std::vector<std::unique_ptr<TextureLoad>> finishedLoads;
+
+        for (auto i = textureLoads.begin(); i != textureLoads.end();)
+        {
+            if ((*i)->group.isFinished())
+            {
+                sharedEngine->getJobSystem()->wait((*i)->group);
+                finishedLoads.push_back(std::move(*i));
+                i = textureLoads.erase(i);
+            }
+            else
+            {
+                ++i;
+            }
+        }
+
+        if (textureLoads.empty())
+        {
+            sharedEngine->unscheduleUpdate(&updateCallback);
+        }
+
+        // callbacks may start new loads, so they are called after textureLoads has been updated
+        for (const std::unique_ptr<TextureLoad>& textureLoad : finishedLoads)
+        {
+            bool success = textureLoad->success && textureLoad->texture->applyDecodedData(textureLoad->dynamic);
+
+            if (!success)
+            {
+                Log(Log::Level::ERR) << "Failed to load texture " << textureLoad->filename;
+            }
+
+            for (const std::function<void(const graphics::TexturePtr&, bool)>& callback : textureLoad->callbacks)
+            {
+                callback(textureLoad->texture, success);
+            }
+        }
+    }
+
     void Cache::setTexture(const std::string& filename, const graphics::TexturePtr& texture)
     {
         textures[filename] = texture;
+        // the texture can't be loaded again if it is released
+        textureUses.erase(filename);
     }
 
     void Cache::releaseTextures()
     {
         textures.clear();
+        textureUses.clear();
+    }
+
+    void Cache::enableTextureAtlas(const Size2& pageSize, uint32_t maxPages, const Size2& maxImageSize)
+    {
+        textureAtlas.init(pageSize, maxPages, maxImageSize);
+        textureAtlasEnabled = true;
+    }
+
+    void Cache::releaseTextureAtlas()
+    {
+        // sprite frames that were already loaded keep their pages alive
+        textureAtlas.clear();
+    }
+
+    graphics::TexturePtr Cache::getTextureRegion(const std::string& filename, bool mipmaps, Rectangle& region) const
+    {
+        graphics::TexturePtr texture;
+
+        // images that already have their own texture are not packed a second time
+        if (textureAtlasEnabled && textures.find(filename) == textures.end())
+        {
+            if (textureAtlas.getImage(filename, texture, region))
+            {
+                return texture;
+            }
+
+            graphics::Image image;
+            if (!image.initFromFile(filename))
+            {
+                return nullptr;
+            }
+
+            if (textureAtlas.addImage(filename, image, texture, region))
+            {
+                return texture;
+            }
+
+            // the image is already decoded, so it isn't loaded again if it can't be packed
+            if (image.getPixelFormat() == graphics::PixelFormat::RGBA8_UNORM)
+            {
+                texture = sharedEngine->getRenderer()->createTexture();
+
+                if (!texture->initFromBuffer(image.getData(), image.getSize(), false, mipmaps))
+                {
+                    return nullptr;
+                }
+
+                textures[filename] = texture;
+                textureUses[filename] = ++useCounter;
+            }
+        }
+
+        if (!texture)
+        {
+            texture = getTexture(filename, false, mipmaps);
+        }
+
+        if (texture)
+        {
+            region = Rectangle(0.0f, 0.0f, texture->getSize().v[0], texture->getSize().v[1]);
+        }
+
+        return texture;
+    }
+
+    void Cache::evictTextureAtlasPage(const graphics::TexturePtr& texture)
+    {
+        // frames on the evicted page are packed again the next time they are requested
+        for (auto i = spriteFrames.begin(); i != spriteFrames.end();)
+        {
+            if (!i->second.empty() && i->second.front().getTexture() == texture)
+            {
+                spriteFrameUses.erase(i->first);
+                i = spriteFrames.erase(i);
+            }
+            else
+            {
+                ++i;
+            }
+        }
+    }
+
+    void Cache::setMemoryBudget(uint64_t newMemoryBudget)
+    {
+        memoryBudget = newMemoryBudget;
+        failedEvictionMemory = 0;
+
+        if (memoryBudget)
+        {
+            sharedEngine->scheduleUpdate(&evictionCallback);
+        }
+        else
+        {
+            sharedEngine->unscheduleUpdate(&evictionCallback);
+        }
+    }
+
+    void Cache::useTexture(const std::string& filename) const
+    {
+        auto i = textureUses.find(filename);
+
+        if (i != textureUses.end())
+        {
+            i->second = ++useCounter;
+        }
+    }
+
+    void Cache::useSpriteFrames(const std::string& filename) const
+    {
+        auto i = spriteFrameUses.find(filename);
+
+        if (i != spriteFrameUses.end())
+        {
+            i->second = ++useCounter;
+        }
+    }
+
+    void Cache::evictUnusedResources(float delta)
+    {
+        graphics::Renderer* renderer = sharedEngine->getRenderer();
+        uint64_t resourceMemory = renderer->getResourceMemory();
+
+        if (resourceMemory <= memoryBudget)
+        {
+            return;
+        }
+
+        // the last scan couldn't get under the budget, loading or releasing resources changes the memory usage,
+        // but entries also become evictable when their last reference outside of the cache is released, so retry after a while
+        if (resourceMemory == failedEvictionMemory)
+        {
+            evictionRetryTime -= delta;
+
+            if (evictionRetryTime > 0.0f)
+            {
+                return;
+            }
+        }
+
+        // a texture is not used outside of the cache if its use count equals the references held by the cache
+        std::unordered_map<const graphics::Texture*, long> cacheReferences;
+
+        for (const auto& texture : textures)
+        {
+            ++cacheReferences[texture.second.get()];
+        }
+
+        for (const auto& frames : spriteFrames)
+        {
+            for (const scene::SpriteFrame& frame : frames.second)
+            {
+                ++cacheReferences[frame.getTexture().get()];
+            }
+        }
+
+        auto isUnused = [&cacheReferences](const graphics::TexturePtr& texture) {
+            return !texture || texture.use_count() == cacheReferences[texture.get()];
+        };
+
+        struct Candidate
+        {
+            uint64_t lastUse;
+            std::string filename;
+            bool spriteFrames;
+        };
+
+        std::vector<Candidate> candidates;
+        candidates.reserve(textureUses.size() + spriteFrameUses.size());
+
+        for (const auto& use : textureUses)
+        {
+            candidates.push_back({ use.second, use.first, false });
+        }
+
+        for (const auto& use : spriteFrameUses)
+        {
+            candidates.push_back({ use.second, use.first, true });
+        }
+
+        std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+            return a.lastUse < b.lastUse;
+        });
+
+        for (const Candidate& candidate : candidates)
+        {
+            if (candidate.spriteFrames)
+            {
+                auto i = spriteFrames.find(candidate.filename);
+
+                if (!std::all_of(i->second.begin(), i->second.end(), [&isUnused](const scene::SpriteFrame& frame) {
+                    return isUnused(frame.getTexture());
+                }))
+                {
+                    continue;
+                }
+
+                for (const scene::SpriteFrame& frame : i->second)
+                {
+                    --cacheReferences[frame.getTexture().get()];
+                }
+
+                spriteFrames.erase(i);
+                spriteFrameUses.erase(candidate.filename);
+            }
+            else
+            {
+                auto i = textures.find(candidate.filename);
+
+                // textures of cached sprite frames are released with the frames, otherwise they would be loaded twice
+                if (i->second.use_count() > 1)
+                {
+                    continue;
+                }
+
+                textures.erase(i);
+                textureUses.erase(candidate.filename);
+            }
+
+            ++evictionCount;
+
+            // the memory is freed when the last reference to a texture is released
+            if (renderer->getResourceMemory() <= memoryBudget)
+            {
+                return;
+            }
+        }
+
+        failedEvictionMemory = renderer->getResourceMemory();
+        evictionRetryTime = EVICTION_RETRY_INTERVAL;
     }
 
     graphics::ShaderPtr Cache::getShader(const std::string& shaderName) const
@@ -115,20 +464,20 @@ namespace ouzel
         }
         else
         {
-            graphics::TexturePtr texture = sharedEngine->getCache()->getTexture(filename, false, mipmaps);
+            Rectangle rectangle;
+            graphics::TexturePtr texture = getTextureRegion(filename, mipmaps, rectangle);
 
             if (!texture)
             {
                 return;
             }
 
-            Rectangle rectangle(0, 0, texture->getSize().v[0], texture->getSize().v[1]);
-
-            scene::SpriteFrame frame(texture, rectangle, false, texture->getSize(), Vector2(), Vector2(0.5f, 0.5f));
+            scene::SpriteFrame frame(texture, rectangle, false, rectangle.size, Vector2(), Vector2(0.5f, 0.5f));
             frames.push_back(frame);
         }
 
         spriteFrames[filename] = frames;
+        spriteFrameUses[filename] = ++useCounter;
     }
 
     const std::vector<scene::SpriteFrame>& Cache::getSpriteFrames(const std::string& filename, bool mipmaps) const
@@ -147,18 +496,22 @@ namespace ouzel
             }
             else
             {
-                graphics::TexturePtr texture = sharedEngine->getCache()->getTexture(filename, false, mipmaps);
+                Rectangle rectangle;
+                graphics::TexturePtr texture = getTextureRegion(filename, mipmaps, rectangle);
 
                 if (texture)
                 {
-                    Rectangle rectangle(0.0f, 0.0f, texture->getSize().v[0], texture->getSize().v[1]);
-
-                    scene::SpriteFrame frame = scene::SpriteFrame(texture, rectangle, false, texture->getSize(), Vector2(), Vector2(0.5f, 0.5f));
+                    scene::SpriteFrame frame = scene::SpriteFrame(texture, rectangle, false, rectangle.size, Vector2(), Vector2(0.5f, 0.5f));
                     frames.push_back(frame);
                 }
             }
 
             spriteFrames[filename] = frames;
+            spriteFrameUses[filename] = ++useCounter;
+        }
+        else
+        {
+            useSpriteFrames(filename);
         }
 
         return spriteFrames[filename];
@@ -167,11 +520,13 @@ namespace ouzel
     void Cache::setSpriteFrames(const std::string& filename, const std::vector<scene::SpriteFrame>& frames)
     {
         spriteFrames[filename] = frames;
+        spriteFrameUses.erase(filename);
     }
 
     void Cache::releaseSpriteFrames()
     {
         spriteFrames.clear();
+        spriteFrameUses.clear();
     }
 
     void Cache::preloadParticleDefinition(const std::string& filename)
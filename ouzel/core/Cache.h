@@ -6,11 +6,17 @@
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <memory>
+#include <functional>
 #include "utils/Types.h"
 #include "utils/Noncopyable.h"
+#include "core/JobSystem.h"
+#include "core/UpdateCallback.h"
 #include "scene/SpriteFrame.h"
 #include "scene/ParticleDefinition.h"
 #include "gui/BMFont.h"
+#include "graphics/TextureAtlas.h"
+#include "math/Rectangle.h"
 
 namespace ouzel
 {
@@ -18,12 +24,27 @@ namespace ouzel
     {
     public:
         Cache();
+        ~Cache();
 
         void preloadTexture(const std::string& filename, bool dynamic = false, bool mipmaps = true);
+        // released textures are loaded again the next time they are requested
         graphics::TexturePtr getTexture(const std::string& filename, bool dynamic = false, bool mipmaps = true) const;
+        // returns immediately, the file is decoded on the job system and the texture is drawn with the placeholder
+        // (white pixel if none is given) until then, the callback is called on the update thread when loading finishes
+        graphics::TexturePtr loadTextureAsync(const std::string& filename,
+                                              const std::function<void(const graphics::TexturePtr&, bool)>& callback = nullptr,
+                                              bool dynamic = false, bool mipmaps = true,
+                                              const graphics::TexturePtr& placeholder = nullptr);
         void setTexture(const std::string& filename, const graphics::TexturePtr& texture);
         void releaseTextures();
 
+        // small images loaded as sprite frames are packed into shared atlas pages, so sprites using them can be batched
+        void enableTextureAtlas(const Size2& pageSize = Size2(2048.0f, 2048.0f), uint32_t maxPages = 4,
+                                const Size2& maxImageSize = Size2(256.0f, 256.0f));
+        void releaseTextureAtlas();
+        // returns the atlas page and the image's rectangle in it if the image was packed, otherwise the image's own texture
+        graphics::TexturePtr getTextureRegion(const std::string& filename, bool mipmaps, Rectangle& region) const;
+
         graphics::ShaderPtr getShader(const std::string& shaderName) const;
         void setShader(const std::string& shaderName, const graphics::ShaderPtr& shader);
 
@@ -41,7 +62,49 @@ namespace ouzel
         void preloadBMFont(const std::string& filename);
         const BMFont& getBMFont(const std::string& filename) const;
 
+        // when the renderer's resource memory exceeds the budget, the least recently used textures and sprite frames
+        // that were loaded from files and are not referenced outside of the cache are released, 0 disables it
+        void setMemoryBudget(uint64_t newMemoryBudget);
+        uint64_t getMemoryBudget() const { return memoryBudget; }
+        uint32_t getEvictionCount() const { return evictionCount; }
+
     protected:
+        void updateTextureLoads(float);
+        void evictUnusedResources(float);
+        // only entries that are tracked (loaded from files) are updated
+        void useTexture(const std::string& filename) const;
+        void useSpriteFrames(const std::string& filename) const;
+        void evictTextureAtlasPage(const graphics::TexturePtr& texture);
+
+        struct TextureLoad
+        {
+            std::string filename;
+            graphics::TexturePtr texture;
+            bool dynamic;
+            bool mipmaps;
+            // written by the task, read after the group has finished
+            bool success;
+            JobSystem::TaskGroup group;
+            std::vector<std::function<void(const graphics::TexturePtr&, bool)>> callbacks;
+        };
+
+        std::vector<std::unique_ptr<TextureLoad>> textureLoads;
+        UpdateCallback updateCallback;
+
+        UpdateCallback evictionCallback;
+        uint64_t memoryBudget = 0;
+        uint32_t evictionCount = 0;
+        uint64_t failedEvictionMemory = 0;
+        float evictionRetryTime = 0.0f;
+
+        // last use of the entries that can be loaded again from their files, other entries are never evicted
+        mutable uint64_t useCounter = 0;
+        mutable std::unordered_map<std::string, uint64_t> textureUses;
+        mutable std::unordered_map<std::string, uint64_t> spriteFrameUses;
+
+        bool textureAtlasEnabled = false;
+        mutable graphics::TextureAtlas textureAtlas;
+
         mutable std::unordered_map<std::string, graphics::TexturePtr> textures;
         mutable std::unordered_map<std::string, graphics::ShaderPtr> shaders;
         mutable std::unordered_map<std::string, scene::ParticleDefinition> particleDefinitions;
@@ -46,7 +46,7 @@
         #define OUZEL_64BITS 1
     #elif defined(__i386__)
         #define OUZEL_32BITS 1
-    #elif defined(__ARM_NEON__)
+    #elif defined(__ARM_NEON__) || defined(__ARM_NEON)
         #if defined(__arm64__)
             #define OUZEL_SUPPORTS_NEON64 1
             #define OUZEL_64BITS 1
@@ -68,7 +68,7 @@
         #define OUZEL_64BITS 1
     #elif defined(__i386__)
         #define OUZEL_32BITS 1
-    #elif defined(__ARM_NEON__)
+    #elif defined(__ARM_NEON__) || defined(__ARM_NEON)
         #if defined(__arm64__) || defined(__aarch64__)
             #define OUZEL_SUPPORTS_NEON64 1
             #define OUZEL_64BITS 1
@@ -90,11 +90,11 @@
         #define OUZEL_64BITS 1
     #elif defined(__i386__)
         #define OUZEL_32BITS 1
-    #elif defined(__ARM_NEON__)
+    #elif defined(__ARM_NEON__) || defined(__ARM_NEON)
         #if defined(__arm64__) || defined(__aarch64__)
             #define OUZEL_SUPPORTS_NEON64 1
             #define OUZEL_64BITS 1
-        #else defined(__arm__)
+        #elif defined(__arm__)
             #define OUZEL_SUPPORTS_NEON 1
             #define OUZEL_32BITS 1
         #endif
@@ -116,11 +116,11 @@
         #define OUZEL_64BITS 1
     #elif defined(__i386__)
         #define OUZEL_32BITS 1
-    #elif defined(__ARM_NEON__)
+    #elif defined(__ARM_NEON__) || defined(__ARM_NEON)
         #if defined(__arm64__) || defined(__aarch64__)
             #define OUZEL_SUPPORTS_NEON64 1
             #define OUZEL_64BITS 1
-        #else defined(__arm__)
+        #elif defined(__arm__)
             #define OUZEL_SUPPORTS_NEON 1
             #define OUZEL_32BITS 1
         #endif
@@ -132,6 +132,14 @@
     #define OUZEL_SUPPORTS_OPENAL 1
 #endif
 
-#if defined(__SSE__)
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
     #define OUZEL_SUPPORTS_SSE 1
 #endif
+
+// OUZEL_DISABLE_SIMD builds the scalar reference implementation of the math classes
+#if defined(OUZEL_DISABLE_SIMD)
+    #undef OUZEL_SUPPORTS_SSE
+    #undef OUZEL_SUPPORTS_NEON
+    #undef OUZEL_SUPPORTS_NEON64
+    #undef OUZEL_SUPPORTS_NEON_CHECK
+#endif
@@ -5,6 +5,7 @@
 #include "Engine.h"
 #include "CompileConfig.h"
 #include "Cache.h"
+#include "JobSystem.h"
 #include "Window.h"
 #include "localization/Localization.h"
 #include "utils/Log.h"
@@ -200,6 +201,21 @@ namespace ouzel
         window.reset(new Window(settings.size, settings.resizable, settings.fullscreen, settings.title));
 #endif
 
+        jobSystem.reset(new JobSystem());
+
+#if OUZEL_MULTITHREADED
+        // the main thread and the update thread are already busy
+        uint32_t cpuCount = std::thread::hardware_concurrency();
+        uint32_t workerCount = (cpuCount > 2) ? cpuCount - 2 : 1;
+#else
+        uint32_t workerCount = 0;
+#endif
+
+        if (!jobSystem->init(workerCount))
+        {
+            return false;
+        }
+
         eventDispatcher.reset(new EventDispatcher());
         cache.reset(new Cache());
         sceneManager.reset(new scene::SceneManager());
@@ -23,7 +23,8 @@ namespace ouzel
     class Window;
     class EventDispatcher;
     class Cache;
-    
+    class JobSystem;
+
     class Engine: public Noncopyable
     {
     public:
@@ -38,6 +39,7 @@ namespace ouzel
 
         EventDispatcher* getEventDispatcher() const { return eventDispatcher.get(); }
         Cache* getCache() const { return cache.get(); }
+        JobSystem* getJobSystem() const { return jobSystem.get(); }
         Window* getWindow() const { return window.get(); }
         graphics::Renderer* getRenderer() const { return renderer.get(); }
         audio::Audio* getAudio() const { return audio.get(); }
@@ -66,6 +68,8 @@ namespace ouzel
 
         Settings settings;
 
+        // declared first, so that it is destroyed after all the modules that may use it
+        std::unique_ptr<JobSystem> jobSystem;
         std::unique_ptr<EventDispatcher> eventDispatcher;
         std::unique_ptr<Window> window;
         std::unique_ptr<Localization> localization;
@@ -0,0 +1,308 @@
+// Copyright (C) 2016 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#include <algorithm>
+#include "JobSystem.h"
+
+namespace ouzel
+{
+    JobSystem::JobSystem():
+        nextWorker(0), queuedTaskCount(0), running(false)
+    {
+    }
+
+    JobSystem::~JobSystem()
+    {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            running = false;
+        }
+
+        sleepCondition.notify_all();
+
+        for (const std::unique_ptr<Worker>& worker : workers)
+        {
+            if (worker->thread.joinable()) worker->thread.join();
+        }
+    }
+
+    bool JobSystem::init(uint32_t newWorkerCount)
+    {
+        running = true;
+
+        workers.reserve(newWorkerCount);
+
+        for (uint32_t i = 0; i < newWorkerCount; ++i)
+        {
+            std::unique_ptr<Worker> worker(new Worker());
+            worker->index = i;
+            worker->executedTasks = 0;
+            worker->stolenTasks = 0;
+            worker->sleepCount = 0;
+
+            workers.push_back(std::move(worker));
+        }
+
+        // tasks can only be submitted after init returns, so the ids are set before any task looks them up
+        for (const std::unique_ptr<Worker>& worker : workers)
+        {
+            worker->thread = std::thread(&JobSystem::work, this, worker.get());
+            worker->id = worker->thread.get_id();
+        }
+
+        return true;
+    }
+
+    std::vector<JobSystem::WorkerStats> JobSystem::getWorkerStats() const
+    {
+        std::vector<WorkerStats> result;
+        result.reserve(workers.size());
+
+        for (const std::unique_ptr<Worker>& worker : workers)
+        {
+            result.push_back({ worker->executedTasks, worker->stolenTasks, worker->sleepCount });
+        }
+
+        return result;
+    }
+
+    void JobSystem::run(TaskGroup& group, const std::function<void()>& function)
+    {
+        ++group.pendingTaskCount;
+
+        push({ function, &group, nullptr, nullptr });
+    }
+
+    void JobSystem::run(TaskGroup& group, void (*function)(void*), void* data)
+    {
+        ++group.pendingTaskCount;
+
+        push({ nullptr, &group, function, data });
+    }
+
+    void JobSystem::then(TaskGroup& group, TaskGroup& continuationGroup, const std::function<void()>& function)
+    {
+        ++continuationGroup.pendingTaskCount;
+
+        {
+            std::lock_guard<std::mutex> lock(group.mutex);
+
+            if (group.pendingTaskCount > 0)
+            {
+                group.continuations.push_back({ function, &continuationGroup });
+                return;
+            }
+        }
+
+        push({ function, &continuationGroup, nullptr, nullptr });
+    }
+
+    void JobSystem::wait(TaskGroup& group)
+    {
+        Worker* worker = getCurrentWorker();
+        Task task;
+
+        while (group.pendingTaskCount > 0)
+        {
+            if (pop(worker, task))
+            {
+                execute(worker, task);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            sleepCondition.wait(lock, [this, &group]() {
+                return group.pendingTaskCount == 0 || queuedTaskCount > 0;
+            });
+        }
+
+        // the thread that finished the last task may still hold the group's mutex
+        std::lock_guard<std::mutex> lock(group.mutex);
+    }
+
+    void JobSystem::parallelFor(uint32_t begin, uint32_t end, uint32_t grainSize,
+                                const std::function<void(uint32_t, uint32_t)>& function)
+    {
+        if (grainSize == 0) grainSize = 1;
+
+        TaskGroup group;
+
+        for (uint32_t first = begin; first < end;)
+        {
+            uint32_t last = first + std::min(grainSize, end - first);
+
+            run(group, [&function, first, last]() {
+                function(first, last);
+            });
+
+            first = last;
+        }
+
+        wait(group);
+    }
+
+    void JobSystem::work(Worker* worker)
+    {
+        Task task;
+
+        for (;;)
+        {
+            if (pop(worker, task))
+            {
+                execute(worker, task);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(sleepMutex);
+
+            if (!running) break;
+
+            if (queuedTaskCount == 0)
+            {
+                ++worker->sleepCount;
+                sleepCondition.wait(lock, [this]() {
+                    return !running || queuedTaskCount > 0;
+                });
+            }
+        }
+    }
+
+    JobSystem::Worker* JobSystem::getCurrentWorker() const
+    {
+        std::thread::id id = std::this_thread::get_id();
+
+        for (const std::unique_ptr<Worker>& worker : workers)
+        {
+            if (worker->id == id) return worker.get();
+        }
+
+        return nullptr;
+    }
+
+    void JobSystem::push(Task task)
+    {
+        if (workers.empty())
+        {
+            execute(nullptr, task);
+            return;
+        }
+
+        // workers push to their own queue, other threads spread the tasks between the workers
+        Worker* worker = getCurrentWorker();
+        if (!worker) worker = workers[nextWorker++ % workers.size()].get();
+
+        // count the task before it can be popped, otherwise a thief could decrement the counter below zero,
+        // threads that see the count before the task is in the queue just retry
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            ++queuedTaskCount;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(worker->mutex);
+
+            if (worker->taskCount == worker->tasks.size())
+            {
+                // unwrap the queue into the larger buffer
+                std::vector<Task> tasks(std::max(worker->tasks.size() * 2, static_cast<size_t>(16)));
+
+                for (size_t i = 0; i < worker->taskCount; ++i)
+                {
+                    tasks[i] = std::move(worker->tasks[(worker->firstTask + i) % worker->tasks.size()]);
+                }
+
+                worker->tasks.swap(tasks);
+                worker->firstTask = 0;
+            }
+
+            worker->tasks[(worker->firstTask + worker->taskCount) % worker->tasks.size()] = std::move(task);
+            ++worker->taskCount;
+        }
+
+        sleepCondition.notify_one();
+    }
+
+    bool JobSystem::pop(Worker* worker, Task& task)
+    {
+        if (worker)
+        {
+            // own tasks are taken from the back, they are most likely still in the cache
+            std::lock_guard<std::mutex> lock(worker->mutex);
+
+            if (worker->taskCount > 0)
+            {
+                --worker->taskCount;
+                task = std::move(worker->tasks[(worker->firstTask + worker->taskCount) % worker->tasks.size()]);
+                --queuedTaskCount;
+                return true;
+            }
+        }
+
+        uint32_t start = worker ? worker->index + 1 : nextWorker.load();
+
+        for (uint32_t i = 0; i < workers.size(); ++i)
+        {
+            Worker* victim = workers[(start + i) % workers.size()].get();
+
+            if (victim == worker) continue;
+
+            // steal the oldest task, it usually represents the largest piece of work
+            std::lock_guard<std::mutex> lock(victim->mutex);
+
+            if (victim->taskCount > 0)
+            {
+                task = std::move(victim->tasks[victim->firstTask]);
+                victim->firstTask = (victim->firstTask + 1) % victim->tasks.size();
+                --victim->taskCount;
+                --queuedTaskCount;
+
+                if (worker) ++worker->stolenTasks;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void JobSystem::execute(Worker* worker, Task& task)
+    {
+        if (task.function)
+        {
+            task.function();
+        }
+        else
+        {
+            task.callback(task.data);
+        }
+
+        if (worker) ++worker->executedTasks;
+
+        finish(*task.group);
+    }
+
+    void JobSystem::finish(TaskGroup& group)
+    {
+        std::vector<TaskGroup::Continuation> continuations;
+
+        {
+            std::lock_guard<std::mutex> lock(group.mutex);
+
+            if (--group.pendingTaskCount > 0) return;
+
+            continuations.swap(group.continuations);
+        }
+
+        // the group may be destroyed from here on
+
+        for (TaskGroup::Continuation& continuation : continuations)
+        {
+            push({ std::move(continuation.function), continuation.group, nullptr, nullptr });
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+        }
+
+        sleepCondition.notify_all();
+    }
+}
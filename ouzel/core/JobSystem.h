@@ -0,0 +1,112 @@
+// Copyright (C) 2016 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include "utils/Noncopyable.h"
+
+namespace ouzel
+{
+    class JobSystem: public Noncopyable
+    {
+    public:
+        // tracks a set of tasks, must outlive all of them (wait for it before destroying it)
+        class TaskGroup: public Noncopyable
+        {
+            friend JobSystem;
+        public:
+            TaskGroup(): pendingTaskCount(0) {}
+
+            bool isFinished() const { return pendingTaskCount == 0; }
+
+        protected:
+            struct Continuation
+            {
+                std::function<void()> function;
+                TaskGroup* group;
+            };
+
+            std::atomic<uint32_t> pendingTaskCount;
+            std::mutex mutex;
+            std::vector<Continuation> continuations;
+        };
+
+        struct WorkerStats
+        {
+            uint64_t executedTasks;
+            uint64_t stolenTasks;
+            uint64_t sleepCount;
+        };
+
+        JobSystem();
+        ~JobSystem();
+
+        // 0 worker threads runs every task on the thread that submits it
+        bool init(uint32_t newWorkerCount);
+
+        uint32_t getWorkerCount() const { return static_cast<uint32_t>(workers.size()); }
+        std::vector<WorkerStats> getWorkerStats() const;
+
+        void run(TaskGroup& group, const std::function<void()>& function);
+        // doesn't allocate, for tasks that are submitted every frame
+        void run(TaskGroup& group, void (*function)(void*), void* data);
+        // runs the function as a task of continuationGroup after all tasks of group have finished
+        void then(TaskGroup& group, TaskGroup& continuationGroup, const std::function<void()>& function);
+        // executes other tasks while waiting, so it can be called from inside a task
+        void wait(TaskGroup& group);
+
+        // splits [begin, end) into ranges of at most grainSize elements and blocks until all of them are processed
+        void parallelFor(uint32_t begin, uint32_t end, uint32_t grainSize,
+                         const std::function<void(uint32_t, uint32_t)>& function);
+
+    protected:
+        struct Task
+        {
+            std::function<void()> function;
+            TaskGroup* group;
+            // used when function is empty
+            void (*callback)(void*);
+            void* data;
+        };
+
+        struct Worker
+        {
+            std::thread thread;
+            std::thread::id id;
+            uint32_t index;
+            std::mutex mutex;
+            // ring buffer of queued tasks, it only grows, so that queueing tasks every frame doesn't allocate
+            std::vector<Task> tasks;
+            size_t firstTask = 0;
+            size_t taskCount = 0;
+
+            std::atomic<uint64_t> executedTasks;
+            std::atomic<uint64_t> stolenTasks;
+            std::atomic<uint64_t> sleepCount;
+        };
+
+        void work(Worker* worker);
+        Worker* getCurrentWorker() const;
+        void push(Task task);
+        bool pop(Worker* worker, Task& task);
+        void execute(Worker* worker, Task& task);
+        void finish(TaskGroup& group);
+
+        std::vector<std::unique_ptr<Worker>> workers;
+        std::atomic<uint32_t> nextWorker;
+        std::atomic<uint32_t> queuedTaskCount;
+        std::atomic<bool> running;
+
+        // workers sleep here when there is nothing to steal, waiting threads are woken up when a group finishes
+        std::mutex sleepMutex;
+        std::condition_variable sleepCondition;
+    };
+}
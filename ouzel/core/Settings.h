@@ -24,5 +24,6 @@ namespace ouzel
         bool verticalSync = true;
         graphics::PixelFormat backBufferFormat = graphics::PixelFormat::DEFAULT;
         uint32_t depthBits = 0;
+        uint64_t resourceMemoryBudget = 0; // bytes of GPU resources above which unused cached textures are released, 0 for no limit
     };
 }
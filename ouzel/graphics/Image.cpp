@@ -1,7 +1,10 @@
 // Copyright (C) 2016 Elviss Strazdins
 // This file is part of the Ouzel engine.
 
+#include <algorithm>
+#include <cstring>
 #include "Image.h"
+#include "TextureCompression.h"
 #include "utils/Log.h"
 #include "core/Application.h"
 #include "files/FileSystem.h"
@@ -14,6 +17,38 @@ namespace ouzel
 {
     namespace graphics
     {
+        static const uint8_t KTX_IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+        static const uint32_t KTX_HEADER_SIZE = 64;
+        static const uint32_t KTX_ENDIANNESS = 0x04030201;
+        static const uint32_t KTX_ENDIANNESS_SWAPPED = 0x01020304;
+
+        static const uint8_t DDS_MAGIC[4] = { 'D', 'D', 'S', ' ' };
+        static const uint32_t DDS_HEADER_SIZE = 124;
+        static const uint32_t DDS_HEADER_DX10_SIZE = 20;
+        static const uint32_t DDSD_MIPMAPCOUNT = 0x20000;
+        static const uint32_t DDPF_FOURCC = 0x4;
+        static const uint32_t DDPF_RGB = 0x40;
+        static const uint32_t DDSCAPS2_CUBEMAP = 0x200;
+        static const uint32_t DDSCAPS2_VOLUME = 0x200000;
+
+        static inline uint32_t fourCC(char a, char b, char c, char d)
+        {
+            return static_cast<uint32_t>(a) | (static_cast<uint32_t>(b) << 8) | (static_cast<uint32_t>(c) << 16) | (static_cast<uint32_t>(d) << 24);
+        }
+
+        static inline uint32_t readUInt32(const uint8_t* src, bool swap)
+        {
+            uint32_t result;
+            memcpy(&result, src, sizeof(result));
+
+            if (swap)
+            {
+                result = ((result & 0xFF) << 24) | ((result & 0xFF00) << 8) | ((result >> 8) & 0xFF00) | (result >> 24);
+            }
+
+            return result;
+        }
+
         Image::Image()
         {
         }
@@ -33,6 +68,18 @@ namespace ouzel
 
         bool Image::initFromBuffer(const std::vector<uint8_t>& newData)
         {
+            if (newData.size() >= sizeof(KTX_IDENTIFIER) &&
+                std::equal(std::begin(KTX_IDENTIFIER), std::end(KTX_IDENTIFIER), newData.begin()))
+            {
+                return initFromKTX(newData);
+            }
+
+            if (newData.size() >= sizeof(DDS_MAGIC) &&
+                std::equal(std::begin(DDS_MAGIC), std::end(DDS_MAGIC), newData.begin()))
+            {
+                return initFromDDS(newData);
+            }
+
             int width;
             int height;
             int comp;
@@ -51,6 +98,244 @@ namespace ouzel
 
             size.v[0] = static_cast<float>(width);
             size.v[1] = static_cast<float>(height);
+            pixelFormat = PixelFormat::RGBA8_UNORM;
+            levelCount = 1;
+
+            return true;
+        }
+
+        bool Image::initFromKTX(const std::vector<uint8_t>& newData)
+        {
+            if (newData.size() < KTX_HEADER_SIZE)
+            {
+                Log(Log::Level::ERR) << "Failed to open texture file " << filename << ", reason: KTX header is too short";
+                return false;
+            }
+
+            uint32_t header[13];
+            const uint8_t* headerData = newData.data() + sizeof(KTX_IDENTIFIER);
+            bool swap = readUInt32(headerData, false) == KTX_ENDIANNESS_SWAPPED;
+
+            for (uint32_t i = 0; i < 13; ++i)
+            {
+                header[i] = readUInt32(headerData + i * sizeof(uint32_t), swap);
+            }
+
+            uint32_t glType = header[1];
+            uint32_t glInternalFormat = header[4];
+            uint32_t width = header[6];
+            uint32_t height = header[7];
+            uint32_t depth = header[8];
+            uint32_t arrayElementCount = header[9];
+            uint32_t faceCount = header[10];
+            uint32_t mipLevelCount = header[11];
+            uint32_t keyValueDataSize = header[12];
+
+            if (header[0] != KTX_ENDIANNESS ||
+                width == 0 || height == 0 || depth > 1 ||
+                arrayElementCount > 0 || faceCount != 1)
+            {
+                Log(Log::Level::ERR) << "Failed to open texture file " << filename << ", reason: only 2D KTX textures are supported";
+                return false;
+            }
+
+            bool supported = true;
+
+            switch (glInternalFormat)
+            {
+                case 0x83F0: // GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+                case 0x83F1: // GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+                    pixelFormat = PixelFormat::BC1_UNORM;
+                    break;
+                case 0x83F3: // GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+                    pixelFormat = PixelFormat::BC3_UNORM;
+                    break;
+                case 0x8E8C: // GL_COMPRESSED_RGBA_BPTC_UNORM
+                    pixelFormat = PixelFormat::BC7_UNORM;
+                    break;
+                case 0x9274: // GL_COMPRESSED_RGB8_ETC2
+                    pixelFormat = PixelFormat::ETC2_RGB8_UNORM;
+                    break;
+                case 0x9278: // GL_COMPRESSED_RGBA8_ETC2_EAC
+                    pixelFormat = PixelFormat::ETC2_RGBA8_UNORM;
+                    break;
+                case 0x1908: // GL_RGBA
+                case 0x8058: // GL_RGBA8
+                    pixelFormat = PixelFormat::RGBA8_UNORM;
+                    supported = (glType == 0x1401); // GL_UNSIGNED_BYTE
+                    break;
+                default:
+                    supported = false;
+                    break;
+            }
+
+            if (!supported)
+            {
+                Log(Log::Level::ERR) << "Failed to open texture file " << filename << ", reason: unsupported KTX pixel format " << glInternalFormat;
+                return false;
+            }
+
+            // the sizes of the levels are calculated by shifting, so a longer chain than the image allows can't be trusted
+            if (mipLevelCount > getMaxLevelCount(width, height))
+            {
+                Log(Log::Level::ERR) << "Failed to open texture file " << filename << ", reason: invalid KTX mip level count " << mipLevelCount;
+                return false;
+            }
+
+            size.v[0] = static_cast<float>(width);
+            size.v[1] = static_cast<float>(height);
+            levelCount = std::max(mipLevelCount, 1U);
+            data.clear();
+
+            // every level is prefixed with its size and padded to 4 bytes
+            size_t offset = KTX_HEADER_SIZE + keyValueDataSize;
+
+            for (uint32_t level = 0; level < levelCount; ++level)
+            {
+                uint32_t levelSize = getPixelFormatSize(pixelFormat, std::max(width >> level, 1U), std::max(height >> level, 1U));
+
+                if (offset + sizeof(uint32_t) > newData.size() ||
+                    readUInt32(newData.data() + offset, swap) < levelSize ||
+                    offset + sizeof(uint32_t) + levelSize > newData.size())
+                {
+                    Log(Log::Level::ERR) << "Failed to open texture file " << filename << ", reason: KTX level " << level << " is too short";
+                    return false;
+                }
+
+                uint32_t imageSize = readUInt32(newData.data() + offset, swap);
+                offset += sizeof(uint32_t);
+
+                data.insert(data.end(), newData.begin() + static_cast<std::vector<uint8_t>::difference_type>(offset),
+                            newData.begin() + static_cast<std::vector<uint8_t>::difference_type>(offset + levelSize));
+
+                offset += (imageSize + 3) & ~3U;
+            }
+
+            return true;
+        }
+
+        bool Image::initFromDDS(const std::vector<uint8_t>& newData)
+        {
+            if (newData.size() < sizeof(DDS_MAGIC) + DDS_HEADER_SIZE)
+            {
+                Log(Log::Level::ERR) << "Failed to open texture file " << filename << ", reason: DDS header is too short";
+                return false;
+            }
+
+            uint32_t header[DDS_HEADER_SIZE / sizeof(uint32_t)];
+
+            for (uint32_t i = 0; i < DDS_HEADER_SIZE / sizeof(uint32_t); ++i)
+            {
+                header[i] = readUInt32(newData.data() + sizeof(DDS_MAGIC) + i * sizeof(uint32_t), false);
+            }
+
+            uint32_t flags = header[1];
+            uint32_t height = header[2];
+            uint32_t width = header[3];
+            uint32_t mipMapCount = header[6];
+            uint32_t pixelFormatFlags = header[19];
+            uint32_t pixelFormatFourCC = header[20];
+            uint32_t caps2 = header[27];
+
+            if (header[0] != DDS_HEADER_SIZE || width == 0 || height == 0 ||
+                (caps2 & (DDSCAPS2_CUBEMAP | DDSCAPS2_VOLUME)))
+            {
+                Log(Log::Level::ERR) << "Failed to open texture file " << filename << ", reason: only 2D DDS textures are supported";
+                return false;
+            }
+
+            size_t offset = sizeof(DDS_MAGIC) + DDS_HEADER_SIZE;
+            bool supported = true;
+
+            if ((pixelFormatFlags & DDPF_FOURCC) && pixelFormatFourCC == fourCC('D', 'X', '1', '0'))
+            {
+                if (newData.size() < offset + DDS_HEADER_DX10_SIZE)
+                {
+                    Log(Log::Level::ERR) << "Failed to open texture file " << filename << ", reason: DDS header is too short";
+                    return false;
+                }
+
+                uint32_t dxgiFormat = readUInt32(newData.data() + offset, false);
+                uint32_t arraySize = readUInt32(newData.data() + offset + 12, false);
+                offset += DDS_HEADER_DX10_SIZE;
+
+                switch (dxgiFormat)
+                {
+                    case 28: // DXGI_FORMAT_R8G8B8A8_UNORM
+                    case 29: // DXGI_FORMAT_R8G8B8A8_UNORM_SRGB
+                        pixelFormat = PixelFormat::RGBA8_UNORM;
+                        break;
+                    case 71: // DXGI_FORMAT_BC1_UNORM
+                    case 72: // DXGI_FORMAT_BC1_UNORM_SRGB
+                        pixelFormat = PixelFormat::BC1_UNORM;
+                        break;
+                    case 77: // DXGI_FORMAT_BC3_UNORM
+                    case 78: // DXGI_FORMAT_BC3_UNORM_SRGB
+                        pixelFormat = PixelFormat::BC3_UNORM;
+                        break;
+                    case 98: // DXGI_FORMAT_BC7_UNORM
+                    case 99: // DXGI_FORMAT_BC7_UNORM_SRGB
+                        pixelFormat = PixelFormat::BC7_UNORM;
+                        break;
+                    default:
+                        supported = false;
+                        break;
+                }
+
+                if (arraySize > 1)
+                {
+                    Log(Log::Level::ERR) << "Failed to open texture file " << filename << ", reason: DDS texture arrays are not supported";
+                    return false;
+                }
+            }
+            else if (pixelFormatFlags & DDPF_FOURCC)
+            {
+                if (pixelFormatFourCC == fourCC('D', 'X', 'T', '1')) pixelFormat = PixelFormat::BC1_UNORM;
+                else if (pixelFormatFourCC == fourCC('D', 'X', 'T', '5')) pixelFormat = PixelFormat::BC3_UNORM;
+                else supported = false;
+            }
+            else if ((pixelFormatFlags & DDPF_RGB) && header[21] == 32 &&
+                     header[22] == 0x000000FF && header[23] == 0x0000FF00 && header[24] == 0x00FF0000)
+            {
+                pixelFormat = PixelFormat::RGBA8_UNORM;
+            }
+            else
+            {
+                supported = false;
+            }
+
+            if (!supported)
+            {
+                Log(Log::Level::ERR) << "Failed to open texture file " << filename << ", reason: unsupported DDS pixel format";
+                return false;
+            }
+
+            if ((flags & DDSD_MIPMAPCOUNT) && mipMapCount > getMaxLevelCount(width, height))
+            {
+                Log(Log::Level::ERR) << "Failed to open texture file " << filename << ", reason: invalid DDS mip map count " << mipMapCount;
+                return false;
+            }
+
+            size.v[0] = static_cast<float>(width);
+            size.v[1] = static_cast<float>(height);
+            levelCount = (flags & DDSD_MIPMAPCOUNT) ? std::max(mipMapCount, 1U) : 1;
+
+            // levels are stored one after another without padding
+            size_t dataSize = 0;
+
+            for (uint32_t level = 0; level < levelCount; ++level)
+            {
+                dataSize += getPixelFormatSize(pixelFormat, std::max(width >> level, 1U), std::max(height >> level, 1U));
+            }
+
+            if (offset + dataSize > newData.size())
+            {
+                Log(Log::Level::ERR) << "Failed to open texture file " << filename << ", reason: DDS data is too short";
+                return false;
+            }
+
+            data.assign(newData.begin() + static_cast<std::vector<uint8_t>::difference_type>(offset),
+                        newData.begin() + static_cast<std::vector<uint8_t>::difference_type>(offset + dataSize));
 
             return true;
         }
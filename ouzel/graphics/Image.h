@@ -7,6 +7,7 @@
 #include <vector>
 #include <cstdint>
 #include "utils/Noncopyable.h"
+#include "graphics/PixelFormat.h"
 #include "math/Size2.h"
 
 namespace ouzel
@@ -21,12 +22,21 @@ namespace ouzel
             const Size2& getSize() const { return size; }
             const std::vector<uint8_t>& getData() const { return data; }
 
+            // KTX and DDS containers keep their pixel format and mip levels, the levels are stored one after another in data
+            PixelFormat getPixelFormat() const { return pixelFormat; }
+            uint32_t getLevelCount() const { return levelCount; }
+
             virtual bool initFromFile(const std::string& newFilename);
             virtual bool initFromBuffer(const std::vector<uint8_t>& newData);
 
         protected:
+            bool initFromKTX(const std::vector<uint8_t>& newData);
+            bool initFromDDS(const std::vector<uint8_t>& newData);
+
             std::string filename;
             Size2 size;
+            PixelFormat pixelFormat = PixelFormat::RGBA8_UNORM;
+            uint32_t levelCount = 1;
 
             std::vector<uint8_t> data;
         };
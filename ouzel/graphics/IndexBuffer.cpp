@@ -9,18 +9,26 @@ namespace ouzel
 {
     namespace graphics
     {
-        IndexBuffer::IndexBuffer()
+        IndexBuffer::IndexBuffer():
+            memorySize(0), pendingData(nullptr), recycledData(nullptr)
         {
         }
 
         IndexBuffer::~IndexBuffer()
         {
+            setMemorySize(0);
+
+            delete pendingData.load();
+            delete recycledData.load();
         }
 
         void IndexBuffer::free()
         {
-            data.clear();
-            uploadData.data.clear();
+            setMemorySize(0);
+
+            // uploadData belongs to the render thread, so its data is released by committing an empty buffer
+            getStagingData().data.clear();
+            commitData(INDEX_BUFFER_DIRTY);
         }
 
         bool IndexBuffer::init(bool newDynamic)
@@ -41,14 +49,20 @@ namespace ouzel
             indexSize = newIndexSize;
             dynamic = newDynamic;
 
+            Data& staging = getStagingData();
+
             if (newIndices && indexSize && indexCount)
             {
-                data.assign(static_cast<const uint8_t*>(newIndices),
-                            static_cast<const uint8_t*>(newIndices) + indexSize * indexCount);
+                staging.data.assign(static_cast<const uint8_t*>(newIndices),
+                                    static_cast<const uint8_t*>(newIndices) + indexSize * indexCount);
+            }
+            else
+            {
+                // recycled staging data may still hold old contents
+                staging.data.clear();
             }
 
-            dirty = INDEX_BUFFER_DIRTY | INDEX_SIZE_DIRTY;
-            sharedEngine->getRenderer()->scheduleUpdate(shared_from_this());
+            commitData(INDEX_BUFFER_DIRTY | INDEX_SIZE_DIRTY);
 
             return true;
         }
@@ -62,11 +76,36 @@ namespace ouzel
 
             indexCount = newIndexCount;
 
-            data.assign(static_cast<const uint8_t*>(newIndices),
-                        static_cast<const uint8_t*>(newIndices) + indexSize * indexCount);
+            getStagingData().data.assign(static_cast<const uint8_t*>(newIndices),
+                                         static_cast<const uint8_t*>(newIndices) + indexSize * indexCount);
 
-            dirty |= INDEX_BUFFER_DIRTY;
-            sharedEngine->getRenderer()->scheduleUpdate(shared_from_this());
+            commitData(INDEX_BUFFER_DIRTY);
+
+            return true;
+        }
+
+        void* IndexBuffer::mapData(uint32_t newIndexCount)
+        {
+            if (!dynamic)
+            {
+                return nullptr;
+            }
+
+            indexCount = newIndexCount;
+            Data& staging = getStagingData();
+            staging.data.resize(indexSize * indexCount);
+
+            return staging.data.data();
+        }
+
+        bool IndexBuffer::unmapData()
+        {
+            if (!dynamic)
+            {
+                return false;
+            }
+
+            commitData(INDEX_BUFFER_DIRTY);
 
             return true;
         }
@@ -75,20 +114,86 @@ namespace ouzel
         {
             indexSize = newIndexSize;
 
-            dirty |= INDEX_SIZE_DIRTY;
-            sharedEngine->getRenderer()->scheduleUpdate(shared_from_this());
+            commitData(INDEX_SIZE_DIRTY);
 
             return true;
         }
 
+        void IndexBuffer::commitData(uint8_t newDirty)
+        {
+            getStagingData();
+
+            stagingData->indexSize = indexSize;
+            stagingData->dynamic = dynamic;
+            stagingData->dirty = newDirty;
+
+            std::unique_ptr<Data> previousData(pendingData.exchange(nullptr));
+
+            if (previousData)
+            {
+                if ((previousData->dirty & INDEX_BUFFER_DIRTY) && !(newDirty & INDEX_BUFFER_DIRTY))
+                {
+                    stagingData->data.swap(previousData->data);
+                }
+
+                stagingData->dirty |= previousData->dirty;
+            }
+
+            pendingData = stagingData.release();
+
+            // only one spare buffer is kept, so a dynamic buffer holds its data at most twice
+            if (previousData)
+            {
+                delete recycledData.exchange(previousData.release());
+            }
+
+            sharedEngine->getRenderer()->scheduleUpdate(shared_from_this());
+        }
+
+        IndexBuffer::Data& IndexBuffer::getStagingData()
+        {
+            if (!stagingData)
+            {
+                stagingData.reset(recycledData.exchange(nullptr));
+
+                if (!stagingData)
+                {
+                    stagingData.reset(new Data());
+                }
+            }
+
+            return *stagingData;
+        }
+
+        void IndexBuffer::setMemorySize(uint64_t newMemorySize)
+        {
+            uint64_t oldMemorySize = memorySize.exchange(newMemorySize);
+
+            if (newMemorySize != oldMemorySize)
+            {
+                sharedEngine->getRenderer()->indexBufferMemory += newMemorySize - oldMemorySize;
+            }
+        }
+
         void IndexBuffer::update()
         {
-            uploadData.indexSize = indexSize;
-            uploadData.dynamic = dynamic;
-            uploadData.dirty = dirty;
-            uploadData.data = std::move(data);
+            std::unique_ptr<Data> newData(pendingData.exchange(nullptr));
 
-            dirty = 0;
+            if (newData)
+            {
+                uploadData.indexSize = newData->indexSize;
+                uploadData.dynamic = newData->dynamic;
+                uploadData.dirty = newData->dirty;
+
+                // the data of a commit without INDEX_BUFFER_DIRTY is whatever the recycled buffer held
+                if (uploadData.dirty & INDEX_BUFFER_DIRTY)
+                {
+                    uploadData.data.swap(newData->data);
+                    setMemorySize(uploadData.data.size());
+                }
+
+                delete recycledData.exchange(newData.release());
+            }
         }
     } // namespace graphics
 } // namespace ouzel
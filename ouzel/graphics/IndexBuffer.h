@@ -4,6 +4,8 @@
 #pragma once
 
 #include <vector>
+#include <memory>
+#include <atomic>
 #include "utils/Noncopyable.h"
 #include "graphics/Resource.h"
 
@@ -29,6 +31,10 @@ namespace ouzel
             uint32_t getIndexSize() const { return indexSize; }
 
             virtual bool setData(const void* newIndices, uint32_t newIndexCount);
+            // returns memory for newIndexCount indices that unmapData hands to the renderer without copying,
+            // its previous contents are undefined, so all the indices have to be written
+            void* mapData(uint32_t newIndexCount);
+            bool unmapData();
 
         protected:
             IndexBuffer();
@@ -51,14 +57,21 @@ namespace ouzel
             Data uploadData;
 
         private:
+            void setMemorySize(uint64_t newMemorySize);
+            void commitData(uint8_t newDirty);
+            Data& getStagingData();
+
+            std::atomic<uint64_t> memorySize;
+
             uint32_t indexCount = 0;
             uint32_t indexSize = 0;
 
-            std::vector<uint8_t> data;
-
             bool dynamic = true;
 
-            uint8_t dirty = 0;
+            // handed to the renderer the same way as the data of vertex buffers
+            std::unique_ptr<Data> stagingData;
+            std::atomic<Data*> pendingData;
+            std::atomic<Data*> recycledData;
         };
     } // namespace graphics
 } // namespace ouzel
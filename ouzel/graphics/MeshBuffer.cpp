@@ -21,6 +21,7 @@ namespace ouzel
         {
             indexBuffer.reset();
             vertexBuffer.reset();
+            instanceBuffer.reset();
         }
 
         bool MeshBuffer::init(const IndexBufferPtr& newIndexBuffer,
@@ -51,10 +52,19 @@ namespace ouzel
             sharedEngine->getRenderer()->scheduleUpdate(shared_from_this());
         }
 
+        void MeshBuffer::setInstanceBuffer(const VertexBufferPtr& newInstanceBuffer)
+        {
+            instanceBuffer = newInstanceBuffer;
+
+            dirty = true;
+            sharedEngine->getRenderer()->scheduleUpdate(shared_from_this());
+        }
+
         void MeshBuffer::update()
         {
             uploadData.indexBuffer = indexBuffer;
             uploadData.vertexBuffer = vertexBuffer;
+            uploadData.instanceBuffer = instanceBuffer;
             uploadData.dirty = dirty;
 
             dirty = false;
@@ -25,9 +25,12 @@ namespace ouzel
 
             void setIndexBuffer(const IndexBufferPtr& newIndexBuffer);
             void setVertexBuffer(const VertexBufferPtr& newVertexBuffer);
+            // vertex buffer with per-instance attributes, used only by instanced draw commands
+            void setInstanceBuffer(const VertexBufferPtr& newInstanceBuffer);
 
             const IndexBufferPtr& getIndexBuffer() const { return indexBuffer; }
             const VertexBufferPtr& getVertexBuffer() const { return vertexBuffer; }
+            const VertexBufferPtr& getInstanceBuffer() const { return instanceBuffer; }
 
         protected:
             MeshBuffer();
@@ -37,6 +40,7 @@ namespace ouzel
             {
                 IndexBufferPtr indexBuffer;
                 VertexBufferPtr vertexBuffer;
+                VertexBufferPtr instanceBuffer;
                 bool dirty = false;
             };
 
@@ -45,6 +49,7 @@ namespace ouzel
         private:
             IndexBufferPtr indexBuffer;
             VertexBufferPtr vertexBuffer;
+            VertexBufferPtr instanceBuffer;
 
             bool dirty = false;
         };
@@ -43,7 +43,12 @@ namespace ouzel
             RGBA32_UINT,
             RGBA32_SINT,
             RGBA32_FLOAT,
-            R5G5B5A1_UNORM
+            R5G5B5A1_UNORM,
+            BC1_UNORM,
+            BC3_UNORM,
+            BC7_UNORM,
+            ETC2_RGB8_UNORM,
+            ETC2_RGBA8_UNORM
         };
     } // namespace graphics
 } // namespace ouzel
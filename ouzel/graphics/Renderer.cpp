@@ -1,6 +1,8 @@
 // Copyright (C) 2016 Elviss Strazdins
 // This file is part of the Ouzel engine.
 
+#include <algorithm>
+#include <cstdio>
 #include "Renderer.h"
 #include "core/Engine.h"
 #include "Texture.h"
@@ -14,13 +16,15 @@
 #include "events/EventDispatcher.h"
 #include "core/Window.h"
 #include "utils/Log.h"
+#include "stb_image_write.h"
 
 namespace ouzel
 {
     namespace graphics
     {
         Renderer::Renderer(Driver aDriver):
-            driver(aDriver), clearColor(Color::BLACK), clear(true),
+            driver(aDriver), clearColor(Color::BLACK),
+            textureMemory(0), vertexBufferMemory(0), indexBufferMemory(0), clear(true),
             activeDrawQueueFinished(false), refillDrawQueue(true),
             projectionTransform(Matrix4::IDENTITY),
             renderTargetProjectionTransform(Matrix4::IDENTITY)
@@ -29,11 +33,36 @@ namespace ouzel
 
         Renderer::~Renderer()
         {
+            // the encoding tasks own their pixels, but the files have to be complete when the engine exits
+            sharedEngine->getJobSystem()->wait(screenshotGroup);
         }
 
         void Renderer::free()
         {
             activeDrawQueue.clear();
+            activeShaderConstants.clear();
+            activeShaderConstantData.clear();
+            pendingDrawList.clear();
+
+            for (std::vector<BatchBuffer>& ringBuffers : batchBuffers)
+            {
+                ringBuffers.clear();
+            }
+
+            batchRingIndex = 0;
+            batchBufferCount = 0;
+            sortBucket = 0;
+
+            for (InstanceBuffer& instanceBuffer : instanceBuffers)
+            {
+                instanceBuffer = InstanceBuffer();
+            }
+
+            quadIndexBuffer.reset();
+            quadVertexBuffer.reset();
+            instancedShader.reset();
+            instancingSupported = false;
+
             ready = false;
         }
 
@@ -63,33 +92,51 @@ namespace ouzel
 
             if (activeDrawQueueFinished)
             {
-                drawQueue = std::move(activeDrawQueue);
-                activeDrawQueue.reserve(drawQueue.size());
+                // swap instead of move so that both queues keep their capacity between frames
+                drawQueue.swap(activeDrawQueue);
+                activeDrawQueue.clear();
+                shaderConstants.swap(activeShaderConstants);
+                activeShaderConstants.clear();
+                shaderConstantData.swap(activeShaderConstantData);
+                activeShaderConstantData.clear();
                 drawCallCount = static_cast<uint32_t>(drawQueue.size());
-
-                std::set<ResourcePtr> resources;
+                stateChangeCount = activeStateChangeCount;
+                stateChangesAvoided = activeStateChangesAvoided;
 
                 {
                     std::lock_guard<std::mutex> lock(updateMutex);
-                    resources = std::move(updateSet);
-                    updateSet.clear();
+                    activeUpdateQueue.swap(updateQueue);
+                }
 
-                    for (const ResourcePtr& resource : resources)
-                    {
-                        // prepare data for upload
-                        resource->update();
-                    }
+                std::sort(activeUpdateQueue.begin(), activeUpdateQueue.end());
+                activeUpdateQueue.erase(std::unique(activeUpdateQueue.begin(), activeUpdateQueue.end()), activeUpdateQueue.end());
+
+                // the lock is only held while the queues are swapped, resources hand over their data in update() on their own
+                for (const ResourcePtr& resource : activeUpdateQueue)
+                {
+                    // prepare data for upload
+                    resource->update();
                 }
 
-                for (const ResourcePtr& resource : resources)
+                bool uploaded = true;
+
+                for (const ResourcePtr& resource : activeUpdateQueue)
                 {
                     // upload data to GPU
                     if (!resource->upload())
                     {
-                        return false;
+                        uploaded = false;
+                        break;
                     }
                 }
 
+                activeUpdateQueue.clear();
+
+                if (!uploaded)
+                {
+                    return false;
+                }
+
                 activeDrawQueueFinished = false;
                 refillDrawQueue = true;
             }
@@ -133,7 +180,208 @@ namespace ouzel
                                       bool scissorTestEnabled,
                                       const Rectangle& scissorTest)
         {
+            return pendingDrawList.addDrawCommand(textures,
+                                                  shader,
+                                                  pixelShaderConstants,
+                                                  vertexShaderConstants,
+                                                  blendState,
+                                                  meshBuffer,
+                                                  indexCount,
+                                                  drawMode,
+                                                  startIndex,
+                                                  renderTarget,
+                                                  viewport,
+                                                  wireframe,
+                                                  scissorTestEnabled,
+                                                  scissorTest);
+        }
+
+        bool Renderer::addDrawCommand(std::initializer_list<TexturePtr> textures,
+                                      const ShaderPtr& shader,
+                                      std::initializer_list<ShaderConstant> pixelShaderConstants,
+                                      std::initializer_list<ShaderConstant> vertexShaderConstants,
+                                      const BlendStatePtr& blendState,
+                                      const MeshBufferPtr& meshBuffer,
+                                      uint32_t indexCount,
+                                      DrawMode drawMode,
+                                      uint32_t startIndex,
+                                      const RenderTargetPtr& renderTarget,
+                                      const Rectangle& viewport,
+                                      bool wireframe,
+                                      bool scissorTestEnabled,
+                                      const Rectangle& scissorTest)
+        {
+            return pendingDrawList.addDrawCommand(textures,
+                                                  shader,
+                                                  pixelShaderConstants,
+                                                  vertexShaderConstants,
+                                                  blendState,
+                                                  meshBuffer,
+                                                  indexCount,
+                                                  drawMode,
+                                                  startIndex,
+                                                  renderTarget,
+                                                  viewport,
+                                                  wireframe,
+                                                  scissorTestEnabled,
+                                                  scissorTest);
+        }
+
+        bool Renderer::addBatchedDrawCommand(const TexturePtr& texture,
+                                             const ShaderPtr& shader,
+                                             const BlendStatePtr& blendState,
+                                             const Matrix4& viewProjection,
+                                             const Matrix4& transform,
+                                             const Color& color,
+                                             const VertexPCT* vertices,
+                                             uint32_t vertexCount,
+                                             const uint16_t* indices,
+                                             uint32_t indexCount,
+                                             const RenderTargetPtr& renderTarget,
+                                             const Rectangle& viewport,
+                                             bool scissorTestEnabled,
+                                             const Rectangle& scissorTest)
+        {
+            return pendingDrawList.addBatchedDrawCommand(texture,
+                                                         shader,
+                                                         blendState,
+                                                         viewProjection,
+                                                         transform,
+                                                         color,
+                                                         vertices,
+                                                         vertexCount,
+                                                         indices,
+                                                         indexCount,
+                                                         renderTarget,
+                                                         viewport,
+                                                         scissorTestEnabled,
+                                                         scissorTest);
+        }
+
+        bool Renderer::addInstancedDrawCommand(const TexturePtr& texture,
+                                               const BlendStatePtr& blendState,
+                                               const Matrix4& viewProjection,
+                                               const Color& color,
+                                               const VertexInstance* instances,
+                                               uint32_t instanceCount,
+                                               const RenderTargetPtr& renderTarget,
+                                               const Rectangle& viewport,
+                                               bool scissorTestEnabled,
+                                               const Rectangle& scissorTest)
+        {
+            return pendingDrawList.addInstancedDrawCommand(texture,
+                                                           blendState,
+                                                           viewProjection,
+                                                           color,
+                                                           instances,
+                                                           instanceCount,
+                                                           renderTarget,
+                                                           viewport,
+                                                           scissorTestEnabled,
+                                                           scissorTest);
+        }
 
+        void Renderer::nextSortBucket()
+        {
+            pendingDrawList.nextSortBucket();
+        }
+
+        bool Renderer::DrawList::addDrawCommand(const std::vector<TexturePtr>& textures,
+                                                const ShaderPtr& shader,
+                                                const std::vector<std::vector<float>>& pixelShaderConstants,
+                                                const std::vector<std::vector<float>>& vertexShaderConstants,
+                                                const BlendStatePtr& blendState,
+                                                const MeshBufferPtr& meshBuffer,
+                                                uint32_t indexCount,
+                                                DrawMode drawMode,
+                                                uint32_t startIndex,
+                                                const RenderTargetPtr& renderTarget,
+                                                const Rectangle& viewport,
+                                                bool wireframe,
+                                                bool scissorTestEnabled,
+                                                const Rectangle& scissorTest)
+        {
+            std::vector<ShaderConstant> pixelShaderConstantPointers;
+            pixelShaderConstantPointers.reserve(pixelShaderConstants.size());
+
+            for (const std::vector<float>& pixelShaderConstant : pixelShaderConstants)
+            {
+                pixelShaderConstantPointers.push_back(ShaderConstant(pixelShaderConstant.data(), static_cast<uint32_t>(pixelShaderConstant.size())));
+            }
+
+            std::vector<ShaderConstant> vertexShaderConstantPointers;
+            vertexShaderConstantPointers.reserve(vertexShaderConstants.size());
+
+            for (const std::vector<float>& vertexShaderConstant : vertexShaderConstants)
+            {
+                vertexShaderConstantPointers.push_back(ShaderConstant(vertexShaderConstant.data(), static_cast<uint32_t>(vertexShaderConstant.size())));
+            }
+
+            return pushDrawCommand(textures.data(), static_cast<uint32_t>(textures.size()),
+                                   shader,
+                                   pixelShaderConstantPointers.data(), static_cast<uint32_t>(pixelShaderConstantPointers.size()),
+                                   vertexShaderConstantPointers.data(), static_cast<uint32_t>(vertexShaderConstantPointers.size()),
+                                   blendState,
+                                   meshBuffer,
+                                   indexCount,
+                                   drawMode,
+                                   startIndex,
+                                   renderTarget,
+                                   viewport,
+                                   wireframe,
+                                   scissorTestEnabled,
+                                   scissorTest);
+        }
+
+        bool Renderer::DrawList::addDrawCommand(std::initializer_list<TexturePtr> textures,
+                                                const ShaderPtr& shader,
+                                                std::initializer_list<ShaderConstant> pixelShaderConstants,
+                                                std::initializer_list<ShaderConstant> vertexShaderConstants,
+                                                const BlendStatePtr& blendState,
+                                                const MeshBufferPtr& meshBuffer,
+                                                uint32_t indexCount,
+                                                DrawMode drawMode,
+                                                uint32_t startIndex,
+                                                const RenderTargetPtr& renderTarget,
+                                                const Rectangle& viewport,
+                                                bool wireframe,
+                                                bool scissorTestEnabled,
+                                                const Rectangle& scissorTest)
+        {
+            return pushDrawCommand(textures.begin(), static_cast<uint32_t>(textures.size()),
+                                   shader,
+                                   pixelShaderConstants.begin(), static_cast<uint32_t>(pixelShaderConstants.size()),
+                                   vertexShaderConstants.begin(), static_cast<uint32_t>(vertexShaderConstants.size()),
+                                   blendState,
+                                   meshBuffer,
+                                   indexCount,
+                                   drawMode,
+                                   startIndex,
+                                   renderTarget,
+                                   viewport,
+                                   wireframe,
+                                   scissorTestEnabled,
+                                   scissorTest);
+        }
+
+        bool Renderer::DrawList::pushDrawCommand(const TexturePtr* textures,
+                                                 uint32_t textureCount,
+                                                 const ShaderPtr& shader,
+                                                 const ShaderConstant* pixelShaderConstants,
+                                                 uint32_t pixelShaderConstantCount,
+                                                 const ShaderConstant* vertexShaderConstants,
+                                                 uint32_t vertexShaderConstantCount,
+                                                 const BlendStatePtr& blendState,
+                                                 const MeshBufferPtr& meshBuffer,
+                                                 uint32_t indexCount,
+                                                 DrawMode drawMode,
+                                                 uint32_t startIndex,
+                                                 const RenderTargetPtr& renderTarget,
+                                                 const Rectangle& viewport,
+                                                 bool wireframe,
+                                                 bool scissorTestEnabled,
+                                                 const Rectangle& scissorTest)
+        {
             if (!shader)
             {
                 Log(Log::Level::ERR) << "No shader passed to render queue";
@@ -141,38 +389,594 @@ namespace ouzel
             }
 
             if (!meshBuffer || !meshBuffer->getIndexBuffer() || !meshBuffer->getVertexBuffer() ||
-                shader->getVertexAttributes() != meshBuffer->getVertexBuffer()->getVertexAttributes())
+                (shader->getVertexAttributes() & ~VERTEX_INSTANCE_ATTRIBUTES) != meshBuffer->getVertexBuffer()->getVertexAttributes())
             {
                 Log(Log::Level::ERR) << "Invalid mesh buffer passed to render queue";
                 return false;
             }
 
-            activeDrawQueue.push_back({
-                textures,
-                shader,
-                pixelShaderConstants,
-                vertexShaderConstants,
-                blendState,
-                meshBuffer,
-                (indexCount > 0) ? indexCount : meshBuffer->getIndexBuffer()->getIndexCount() - startIndex,
-                drawMode,
-                startIndex,
-                renderTarget,
-                viewport,
-                wireframe,
-                scissorTestEnabled,
-                scissorTest
-            });
+            recordDrawCommand(textures, textureCount,
+                              shader,
+                              pixelShaderConstants, pixelShaderConstantCount,
+                              vertexShaderConstants, vertexShaderConstantCount,
+                              blendState,
+                              meshBuffer,
+                              (indexCount > 0) ? indexCount : meshBuffer->getIndexBuffer()->getIndexCount() - startIndex,
+                              drawMode,
+                              startIndex,
+                              renderTarget,
+                              viewport,
+                              wireframe,
+                              scissorTestEnabled,
+                              scissorTest);
 
             return true;
         }
 
+        Renderer::DrawCommand& Renderer::DrawList::recordDrawCommand(const TexturePtr* textures,
+                                                                     uint32_t textureCount,
+                                                                     const ShaderPtr& shader,
+                                                                     const ShaderConstant* pixelShaderConstants,
+                                                                     uint32_t pixelShaderConstantCount,
+                                                                     const ShaderConstant* vertexShaderConstants,
+                                                                     uint32_t vertexShaderConstantCount,
+                                                                     const BlendStatePtr& blendState,
+                                                                     const MeshBufferPtr& meshBuffer,
+                                                                     uint32_t indexCount,
+                                                                     DrawMode drawMode,
+                                                                     uint32_t startIndex,
+                                                                     const RenderTargetPtr& renderTarget,
+                                                                     const Rectangle& viewport,
+                                                                     bool wireframe,
+                                                                     bool scissorTestEnabled,
+                                                                     const Rectangle& scissorTest)
+        {
+            drawCommands.push_back(DrawCommand());
+            DrawCommand& drawCommand = drawCommands.back();
+
+            for (uint32_t layer = 0; layer < Texture::LAYERS && layer < textureCount; ++layer)
+            {
+                drawCommand.textures[layer] = textures[layer];
+            }
+
+            drawCommand.shader = shader;
+
+            drawCommand.pixelShaderConstantIndex = static_cast<uint32_t>(shaderConstants.size());
+            drawCommand.pixelShaderConstantCount = pixelShaderConstantCount;
+
+            for (uint32_t i = 0; i < pixelShaderConstantCount; ++i)
+            {
+                addShaderConstant(pixelShaderConstants[i].data, pixelShaderConstants[i].size);
+            }
+
+            drawCommand.vertexShaderConstantIndex = static_cast<uint32_t>(shaderConstants.size());
+            drawCommand.vertexShaderConstantCount = vertexShaderConstantCount;
+
+            for (uint32_t i = 0; i < vertexShaderConstantCount; ++i)
+            {
+                addShaderConstant(vertexShaderConstants[i].data, vertexShaderConstants[i].size);
+            }
+
+            drawCommand.blendState = blendState;
+            drawCommand.meshBuffer = meshBuffer;
+            drawCommand.indexCount = indexCount;
+            drawCommand.drawMode = drawMode;
+            drawCommand.startIndex = startIndex;
+            drawCommand.renderTarget = renderTarget;
+            drawCommand.viewport = viewport;
+            drawCommand.wireframe = wireframe;
+            drawCommand.scissorTestEnabled = scissorTestEnabled;
+            drawCommand.scissorTest = scissorTest;
+            drawCommand.sortBucket = sortBucket;
+            // sort keys depend on the mesh buffer, they are calculated when the list is added to the renderer
+            drawCommand.sortKey = 0;
+            drawCommand.instanceCount = 0;
+            drawCommand.startInstance = 0;
+
+            batchRanges.push_back({ 0, 0, 0, 0 });
+
+            return drawCommand;
+        }
+
+        void Renderer::DrawList::addShaderConstant(const float* data, uint32_t size)
+        {
+            shaderConstants.push_back({ static_cast<uint32_t>(shaderConstantData.size()), size });
+            shaderConstantData.insert(shaderConstantData.end(), data, data + size);
+        }
+
+        bool Renderer::DrawList::canMerge(const DrawCommand& drawCommand,
+                                          const TexturePtr& texture,
+                                          const ShaderPtr& shader,
+                                          const BlendStatePtr& blendState,
+                                          const Matrix4& viewProjection,
+                                          const RenderTargetPtr& renderTarget,
+                                          const Rectangle& viewport,
+                                          bool scissorTestEnabled,
+                                          const Rectangle& scissorTest) const
+        {
+            if (drawCommand.textures[0] != texture ||
+                drawCommand.shader != shader ||
+                drawCommand.blendState != blendState ||
+                drawCommand.renderTarget != renderTarget ||
+                drawCommand.viewport != viewport ||
+                drawCommand.scissorTestEnabled != scissorTestEnabled ||
+                (scissorTestEnabled && drawCommand.scissorTest != scissorTest) ||
+                // buckets only limit how far the renderer may reorder commands, they don't matter when it doesn't sort
+                (sharedEngine->getRenderer()->getSortDrawCommands() && drawCommand.sortBucket != sortBucket))
+            {
+                return false;
+            }
+
+            const ShaderConstantRange& range = shaderConstants[drawCommand.vertexShaderConstantIndex];
+
+            return std::equal(viewProjection.m, viewProjection.m + 16, shaderConstantData.begin() + range.offset);
+        }
+
+        static inline uint8_t multiplyColorComponent(uint8_t a, uint8_t b)
+        {
+            return static_cast<uint8_t>((static_cast<uint32_t>(a) * static_cast<uint32_t>(b) + 127) / 255);
+        }
+
+        bool Renderer::DrawList::addBatchedDrawCommand(const TexturePtr& texture,
+                                                       const ShaderPtr& shader,
+                                                       const BlendStatePtr& blendState,
+                                                       const Matrix4& viewProjection,
+                                                       const Matrix4& transform,
+                                                       const Color& color,
+                                                       const VertexPCT* vertices,
+                                                       uint32_t vertexCount,
+                                                       const uint16_t* indices,
+                                                       uint32_t indexCount,
+                                                       const RenderTargetPtr& renderTarget,
+                                                       const Rectangle& viewport,
+                                                       bool scissorTestEnabled,
+                                                       const Rectangle& scissorTest)
+        {
+            if (!shader || shader->getVertexAttributes() != VertexPCT::ATTRIBUTES)
+            {
+                Log(Log::Level::ERR) << "Invalid shader passed to batched render queue";
+                return false;
+            }
+
+            if (vertexCount > BATCH_MAX_VERTICES)
+            {
+                Log(Log::Level::ERR) << "Too many vertices passed to batched render queue";
+                return false;
+            }
+
+            if (vertexCount == 0 || indexCount == 0)
+            {
+                return true;
+            }
+
+            DrawCommand* drawCommand = nullptr;
+            BatchRange* batchRange = nullptr;
+
+            // extend the previous batch if it uses the same state and still fits in one page
+            if (!drawCommands.empty() &&
+                batchRanges.back().vertexCount > 0 &&
+                batchRanges.back().vertexCount + vertexCount <= BATCH_MAX_VERTICES &&
+                canMerge(drawCommands.back(), texture, shader, blendState, viewProjection,
+                         renderTarget, viewport, scissorTestEnabled, scissorTest))
+            {
+                drawCommand = &drawCommands.back();
+                batchRange = &batchRanges.back();
+            }
+            else
+            {
+                // vertex colors already include the draw color
+                static const float colorVector[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+
+                ShaderConstant pixelShaderConstant(colorVector);
+                ShaderConstant vertexShaderConstant(viewProjection.m);
+
+                drawCommand = &recordDrawCommand(&texture, 1,
+                                                 shader,
+                                                 &pixelShaderConstant, 1,
+                                                 &vertexShaderConstant, 1,
+                                                 blendState,
+                                                 nullptr,
+                                                 0,
+                                                 DrawMode::TRIANGLE_LIST,
+                                                 0,
+                                                 renderTarget,
+                                                 viewport,
+                                                 false,
+                                                 scissorTestEnabled,
+                                                 scissorTest);
+
+                batchRange = &batchRanges.back();
+                batchRange->vertexOffset = static_cast<uint32_t>(batchVertices.size());
+                batchRange->indexOffset = static_cast<uint32_t>(batchIndices.size());
+            }
+
+            uint16_t baseVertex = static_cast<uint16_t>(batchRange->vertexCount);
+
+            size_t firstVertex = batchVertices.size();
+
+            for (uint32_t i = 0; i < vertexCount; ++i)
+            {
+                VertexPCT vertex = vertices[i];
+
+                for (uint32_t c = 0; c < 4; ++c)
+                {
+                    vertex.color.v[c] = multiplyColorComponent(vertex.color.v[c], color.v[c]);
+                }
+
+                batchVertices.push_back(vertex);
+            }
+
+            // pre-transform vertices on CPU, so that all batched commands can share one view projection matrix
+            if (vertexCount)
+            {
+                Vector3* positions = &batchVertices[firstVertex].position;
+                transform.transformPoints(positions, positions, vertexCount, sizeof(VertexPCT), sizeof(VertexPCT));
+            }
+
+            for (uint32_t i = 0; i < indexCount; ++i)
+            {
+                batchIndices.push_back(static_cast<uint16_t>(baseVertex + indices[i]));
+            }
+
+            batchRange->vertexCount += vertexCount;
+            drawCommand->indexCount += indexCount;
+
+            return true;
+        }
+
+        bool Renderer::DrawList::addInstancedDrawCommand(const TexturePtr& texture,
+                                                         const BlendStatePtr& blendState,
+                                                         const Matrix4& viewProjection,
+                                                         const Color& color,
+                                                         const VertexInstance* newInstances,
+                                                         uint32_t instanceCount,
+                                                         const RenderTargetPtr& renderTarget,
+                                                         const Rectangle& viewport,
+                                                         bool scissorTestEnabled,
+                                                         const Rectangle& scissorTest)
+        {
+            Renderer* renderer = sharedEngine->getRenderer();
+
+            if (!renderer->instancingSupported || !renderer->instancedShader)
+            {
+                return false;
+            }
+
+            if (instanceCount == 0)
+            {
+                return true;
+            }
+
+            DrawCommand* drawCommand = nullptr;
+
+            if (!drawCommands.empty() &&
+                drawCommands.back().instanceCount > 0 &&
+                canMerge(drawCommands.back(), texture, renderer->instancedShader, blendState, viewProjection,
+                         renderTarget, viewport, scissorTestEnabled, scissorTest))
+            {
+                drawCommand = &drawCommands.back();
+            }
+            else
+            {
+                // instance colors already include the draw color
+                static const float colorVector[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+
+                ShaderConstant pixelShaderConstant(colorVector);
+                ShaderConstant vertexShaderConstant(viewProjection.m);
+
+                drawCommand = &recordDrawCommand(&texture, 1,
+                                                 renderer->instancedShader,
+                                                 &pixelShaderConstant, 1,
+                                                 &vertexShaderConstant, 1,
+                                                 blendState,
+                                                 nullptr,
+                                                 6,
+                                                 DrawMode::TRIANGLE_LIST,
+                                                 0,
+                                                 renderTarget,
+                                                 viewport,
+                                                 false,
+                                                 scissorTestEnabled,
+                                                 scissorTest);
+
+                batchRanges.back().instanceOffset = static_cast<uint32_t>(instances.size());
+            }
+
+            for (uint32_t i = 0; i < instanceCount; ++i)
+            {
+                VertexInstance instance = newInstances[i];
+
+                for (uint32_t c = 0; c < 4; ++c)
+                {
+                    instance.color.v[c] = multiplyColorComponent(instance.color.v[c], color.v[c]);
+                }
+
+                instances.push_back(instance);
+            }
+
+            drawCommand->instanceCount += instanceCount;
+
+            return true;
+        }
+
+        Renderer::InstanceBuffer& Renderer::getInstanceBuffer()
+        {
+            if (!quadIndexBuffer)
+            {
+                static const uint16_t quadIndices[] = { 0, 1, 2, 1, 3, 2 };
+
+                static const VertexPCT quadVertices[] = {
+                    VertexPCT(Vector3(-0.5f, -0.5f, 0.0f), Color::WHITE, Vector2(0.0f, 1.0f)),
+                    VertexPCT(Vector3(0.5f, -0.5f, 0.0f), Color::WHITE, Vector2(1.0f, 1.0f)),
+                    VertexPCT(Vector3(-0.5f, 0.5f, 0.0f), Color::WHITE, Vector2(0.0f, 0.0f)),
+                    VertexPCT(Vector3(0.5f, 0.5f, 0.0f), Color::WHITE, Vector2(1.0f, 0.0f))
+                };
+
+                quadIndexBuffer = createIndexBuffer();
+                quadIndexBuffer->initFromBuffer(quadIndices, sizeof(uint16_t), 6, false);
+
+                quadVertexBuffer = createVertexBuffer();
+                quadVertexBuffer->initFromBuffer(quadVertices, VertexPCT::ATTRIBUTES, 4, false);
+            }
+
+            InstanceBuffer& instanceBuffer = instanceBuffers[batchRingIndex];
+
+            if (!instanceBuffer.meshBuffer)
+            {
+                instanceBuffer.vertexBuffer = createVertexBuffer();
+                instanceBuffer.vertexBuffer->initFromBuffer(nullptr, VertexInstance::ATTRIBUTES, 0, true);
+
+                instanceBuffer.meshBuffer = createMeshBuffer();
+                instanceBuffer.meshBuffer->init(quadIndexBuffer, quadVertexBuffer);
+                instanceBuffer.meshBuffer->setInstanceBuffer(instanceBuffer.vertexBuffer);
+            }
+
+            return instanceBuffer;
+        }
+
+        Renderer::BatchBuffer& Renderer::getBatchBuffer(uint32_t vertexCount)
+        {
+            std::vector<BatchBuffer>& ringBuffers = batchBuffers[batchRingIndex];
+
+            if (batchBufferCount == 0 ||
+                ringBuffers[batchBufferCount - 1].vertices.size() + vertexCount > BATCH_MAX_VERTICES)
+            {
+                if (batchBufferCount == ringBuffers.size())
+                {
+                    BatchBuffer batchBuffer;
+
+                    batchBuffer.indexBuffer = createIndexBuffer();
+                    batchBuffer.indexBuffer->initFromBuffer(nullptr, sizeof(uint16_t), 0, true);
+
+                    batchBuffer.vertexBuffer = createVertexBuffer();
+                    batchBuffer.vertexBuffer->initFromBuffer(nullptr, VertexPCT::ATTRIBUTES, 0, true);
+
+                    batchBuffer.meshBuffer = createMeshBuffer();
+                    batchBuffer.meshBuffer->init(batchBuffer.indexBuffer, batchBuffer.vertexBuffer);
+
+                    ringBuffers.push_back(std::move(batchBuffer));
+                }
+
+                ++batchBufferCount;
+            }
+
+            return ringBuffers[batchBufferCount - 1];
+        }
+
+        static inline uint64_t pointerBits(const void* pointer, uint32_t bits)
+        {
+            // allocations are at least 16-byte aligned, so the lowest bits carry no information
+            return (static_cast<uint64_t>(reinterpret_cast<uintptr_t>(pointer)) >> 4) & ((1ULL << bits) - 1);
+        }
+
+        uint64_t Renderer::calculateSortKey(const DrawCommand& drawCommand)
+        {
+            // most expensive state changes in the most significant bits:
+            // render target (8 bits), shader (12 bits), blend state (8 bits), texture (20 bits), mesh buffer (16 bits)
+            return (pointerBits(drawCommand.renderTarget.get(), 8) << 56) |
+                (pointerBits(drawCommand.shader.get(), 12) << 44) |
+                (pointerBits(drawCommand.blendState.get(), 8) << 36) |
+                (pointerBits(drawCommand.textures[0].get(), 20) << 16) |
+                pointerBits(drawCommand.meshBuffer.get(), 16);
+        }
+
+        uint32_t Renderer::countStateChanges(const std::vector<DrawCommand>& drawCommands)
+        {
+            uint32_t result = 0;
+            const DrawCommand* previous = nullptr;
+
+            for (const DrawCommand& drawCommand : drawCommands)
+            {
+                if (!previous || previous->renderTarget != drawCommand.renderTarget) ++result;
+                if (!previous || previous->shader != drawCommand.shader) ++result;
+                if (!previous || previous->blendState != drawCommand.blendState) ++result;
+                if (!previous || previous->meshBuffer != drawCommand.meshBuffer) ++result;
+
+                for (uint32_t layer = 0; layer < Texture::LAYERS; ++layer)
+                {
+                    if (!previous || previous->textures[layer] != drawCommand.textures[layer]) ++result;
+                }
+
+                previous = &drawCommand;
+            }
+
+            return result;
+        }
+
+        void Renderer::sortActiveDrawQueue()
+        {
+            uint32_t unsortedStateChangeCount = countStateChanges(activeDrawQueue);
+
+            for (auto begin = activeDrawQueue.begin(); begin != activeDrawQueue.end();)
+            {
+                auto end = begin + 1;
+
+                while (end != activeDrawQueue.end() && end->sortBucket == begin->sortBucket)
+                {
+                    ++end;
+                }
+
+                if (end - begin > 1)
+                {
+                    std::stable_sort(begin, end, [](const DrawCommand& a, const DrawCommand& b) {
+                        return a.sortKey < b.sortKey;
+                    });
+                }
+
+                begin = end;
+            }
+
+            activeStateChangeCount = countStateChanges(activeDrawQueue);
+            activeStateChangesAvoided = (unsortedStateChangeCount > activeStateChangeCount) ? unsortedStateChangeCount - activeStateChangeCount : 0;
+        }
+
         void Renderer::flushDrawCommands()
         {
+            submitPendingDrawList();
+
+            if (sortDrawCommands)
+            {
+                sortActiveDrawQueue();
+            }
+            else
+            {
+                activeStateChangeCount = countStateChanges(activeDrawQueue);
+                activeStateChangesAvoided = 0;
+            }
+
+            std::vector<BatchBuffer>& ringBuffers = batchBuffers[batchRingIndex];
+
+            for (uint32_t i = 0; i < batchBufferCount; ++i)
+            {
+                BatchBuffer& batchBuffer = ringBuffers[i];
+
+                batchBuffer.indexBuffer->setData(batchBuffer.indices.data(), static_cast<uint32_t>(batchBuffer.indices.size()));
+                batchBuffer.vertexBuffer->setData(batchBuffer.vertices.data(), static_cast<uint32_t>(batchBuffer.vertices.size()));
+
+                // keep the capacity for the next time this page is used
+                batchBuffer.indices.clear();
+                batchBuffer.vertices.clear();
+            }
+
+            InstanceBuffer& instanceBuffer = instanceBuffers[batchRingIndex];
+
+            if (instanceBuffer.vertexBuffer)
+            {
+                instanceBuffer.vertexBuffer->setData(instanceBuffer.instances.data(), static_cast<uint32_t>(instanceBuffer.instances.size()));
+                instanceBuffer.instances.clear();
+            }
+
+            batchBufferCount = 0;
+            batchRingIndex = (batchRingIndex + 1) % BATCH_RING_SIZE;
+            sortBucket = 0;
+
             refillDrawQueue = false;
             activeDrawQueueFinished = true;
         }
 
+        void Renderer::addDrawList(const DrawList& drawList)
+        {
+            // keep the order of commands added directly to the renderer and the draw lists
+            submitPendingDrawList();
+            appendDrawList(drawList);
+        }
+
+        void Renderer::submitPendingDrawList()
+        {
+            if (!pendingDrawList.empty())
+            {
+                appendDrawList(pendingDrawList);
+            }
+
+            pendingDrawList.clear();
+        }
+
+        void Renderer::appendDrawList(const DrawList& drawList)
+        {
+            uint32_t shaderConstantStart = static_cast<uint32_t>(activeShaderConstants.size());
+            uint32_t shaderConstantDataStart = static_cast<uint32_t>(activeShaderConstantData.size());
+            uint32_t sortBucketStart = sortBucket + 1;
+
+            for (const ShaderConstantRange& range : drawList.shaderConstants)
+            {
+                activeShaderConstants.push_back({ range.offset + shaderConstantDataStart, range.size });
+            }
+
+            activeShaderConstantData.insert(activeShaderConstantData.end(),
+                                            drawList.shaderConstantData.begin(),
+                                            drawList.shaderConstantData.end());
+
+            for (size_t i = 0; i < drawList.drawCommands.size(); ++i)
+            {
+                activeDrawQueue.push_back(drawList.drawCommands[i]);
+                DrawCommand& drawCommand = activeDrawQueue.back();
+
+                drawCommand.pixelShaderConstantIndex += shaderConstantStart;
+                drawCommand.vertexShaderConstantIndex += shaderConstantStart;
+                drawCommand.sortBucket += sortBucketStart;
+
+                for (TexturePtr& texture : drawCommand.textures)
+                {
+                    // textures that are still loading are drawn with their placeholders
+                    if (texture && texture->getPlaceholder())
+                    {
+                        texture = texture->getPlaceholder();
+                    }
+                }
+
+                const BatchRange& batchRange = drawList.batchRanges[i];
+
+                if (batchRange.vertexCount)
+                {
+                    BatchBuffer& batchBuffer = getBatchBuffer(batchRange.vertexCount);
+
+                    uint16_t baseVertex = static_cast<uint16_t>(batchBuffer.vertices.size());
+
+                    drawCommand.meshBuffer = batchBuffer.meshBuffer;
+                    drawCommand.startIndex = static_cast<uint32_t>(batchBuffer.indices.size());
+
+                    batchBuffer.vertices.insert(batchBuffer.vertices.end(),
+                                                drawList.batchVertices.begin() + batchRange.vertexOffset,
+                                                drawList.batchVertices.begin() + batchRange.vertexOffset + batchRange.vertexCount);
+
+                    for (uint32_t index = 0; index < drawCommand.indexCount; ++index)
+                    {
+                        batchBuffer.indices.push_back(static_cast<uint16_t>(baseVertex + drawList.batchIndices[batchRange.indexOffset + index]));
+                    }
+                }
+                else if (drawCommand.instanceCount)
+                {
+                    InstanceBuffer& instanceBuffer = getInstanceBuffer();
+
+                    drawCommand.meshBuffer = instanceBuffer.meshBuffer;
+                    drawCommand.startInstance = static_cast<uint32_t>(instanceBuffer.instances.size());
+
+                    instanceBuffer.instances.insert(instanceBuffer.instances.end(),
+                                                    drawList.instances.begin() + batchRange.instanceOffset,
+                                                    drawList.instances.begin() + batchRange.instanceOffset + drawCommand.instanceCount);
+                }
+
+                if (sortDrawCommands)
+                {
+                    drawCommand.sortKey = calculateSortKey(drawCommand);
+                }
+            }
+
+            sortBucket = sortBucketStart + drawList.sortBucket;
+        }
+
+        void Renderer::DrawList::clear()
+        {
+            drawCommands.clear();
+            batchRanges.clear();
+            shaderConstants.clear();
+            shaderConstantData.clear();
+            batchVertices.clear();
+            batchIndices.clear();
+            instances.clear();
+            sortBucket = 0;
+        }
+
         bool Renderer::saveScreenshot(const std::string& filename)
         {
             std::lock_guard<std::mutex> lock(screenshotMutex);
@@ -182,11 +986,91 @@ namespace ouzel
             return true;
         }
 
+        void Renderer::startFrameCapture(const std::string& filenamePrefix, uint32_t frameCount)
+        {
+            std::lock_guard<std::mutex> lock(screenshotMutex);
+
+            frameCapturePrefix = filenamePrefix;
+            frameCaptureCount = frameCount;
+            frameCaptureIndex = 0;
+        }
+
+        void Renderer::stopFrameCapture()
+        {
+            std::lock_guard<std::mutex> lock(screenshotMutex);
+
+            frameCaptureCount = 0;
+        }
+
+        bool Renderer::isCapturingFrames() const
+        {
+            std::lock_guard<std::mutex> lock(screenshotMutex);
+
+            return frameCaptureIndex < frameCaptureCount;
+        }
+
+        std::vector<std::string> Renderer::getScreenshotFilenames()
+        {
+            std::vector<std::string> filenames;
+
+            std::lock_guard<std::mutex> lock(screenshotMutex);
+
+            while (!screenshotQueue.empty())
+            {
+                filenames.push_back(screenshotQueue.front());
+                screenshotQueue.pop();
+            }
+
+            if (frameCaptureIndex < frameCaptureCount)
+            {
+                char index[16];
+                snprintf(index, sizeof(index), "%06u", frameCaptureIndex++);
+                filenames.push_back(frameCapturePrefix + index + ".png");
+            }
+
+            return filenames;
+        }
+
+        void Renderer::saveScreenshotData(const std::vector<std::string>& filenames, uint32_t width, uint32_t height, std::vector<uint8_t> data)
+        {
+            std::shared_ptr<std::vector<uint8_t>> pixels = std::make_shared<std::vector<uint8_t>>(std::move(data));
+
+            for (const std::string& filename : filenames)
+            {
+                sharedEngine->getJobSystem()->run(screenshotGroup, [filename, width, height, pixels]() {
+                    if (!stbi_write_png(filename.c_str(), static_cast<int>(width), static_cast<int>(height), 4,
+                                        pixels->data(), static_cast<int>(width * 4)))
+                    {
+                        Log(Log::Level::ERR) << "Failed to save screenshot to " << filename;
+                    }
+                });
+            }
+        }
+
         void Renderer::scheduleUpdate(const ResourcePtr& resource)
         {
             std::lock_guard<std::mutex> lock(updateMutex);
 
-            updateSet.insert(resource);
+            updateQueue.push_back(resource);
+        }
+
+        bool Renderer::isTextureFormatSupported(PixelFormat pixelFormat) const
+        {
+            switch (pixelFormat)
+            {
+                case PixelFormat::RGBA8_UNORM:
+                    return true;
+                case PixelFormat::BC1_UNORM:
+                case PixelFormat::BC3_UNORM:
+                    return bcTexturesSupported;
+                case PixelFormat::BC7_UNORM:
+                    return bc7TexturesSupported;
+                case PixelFormat::ETC2_RGB8_UNORM:
+                case PixelFormat::ETC2_RGBA8_UNORM:
+                    return etc2TexturesSupported;
+                default:
+                    return false;
+            }
         }
     } // namespace graphics
 } // namespace ouzel
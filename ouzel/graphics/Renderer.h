@@ -6,6 +6,7 @@
 #include <cstdint>
 #include <vector>
 #include <string>
+#include <initializer_list>
 #include <queue>
 #include <set>
 #include <memory>
@@ -13,6 +14,7 @@
 #include <atomic>
 #include "utils/Types.h"
 #include "utils/Noncopyable.h"
+#include "core/JobSystem.h"
 #include "math/Rectangle.h"
 #include "math/Matrix4.h"
 #include "math/Size2.h"
@@ -20,6 +22,7 @@
 #include "math/AABB2.h"
 #include "graphics/Vertex.h"
 #include "graphics/Shader.h"
+#include "graphics/Texture.h"
 #include "graphics/BlendState.h"
 #include "graphics/PixelFormat.h"
 #include "graphics/TextureFilter.h"
@@ -33,6 +36,7 @@ namespace ouzel
     {
         const std::string SHADER_TEXTURE = "shaderTexture";
         const std::string SHADER_COLOR = "shaderColor";
+        const std::string SHADER_TEXTURE_INSTANCED = "shaderTextureInstanced";
 
         const std::string BLEND_NO_BLEND = "blendNoBlend";
         const std::string BLEND_ADD = "blendAdd";
@@ -42,11 +46,16 @@ namespace ouzel
         const std::string TEXTURE_WHITE_PIXEL = "textureWhitePixel";
 
         class MeshBuffer;
+        class VertexBuffer;
+        class IndexBuffer;
 
         class Renderer: public Noncopyable
         {
             friend Engine;
             friend Window;
+            friend Texture;
+            friend VertexBuffer;
+            friend IndexBuffer;
         public:
             enum class Driver
             {
@@ -66,6 +75,25 @@ namespace ouzel
                 TRIANGLE_STRIP
             };
 
+            struct ShaderConstant
+            {
+                ShaderConstant(const float* aData, uint32_t aSize):
+                    data(aData), size(aSize)
+                {
+                }
+
+                template<size_t N>
+                ShaderConstant(const float (&aData)[N]):
+                    data(aData), size(N)
+                {
+                }
+
+                const float* data;
+                uint32_t size;
+            };
+
+            class DrawList;
+
             virtual ~Renderer();
             virtual void free();
 
@@ -109,8 +137,52 @@ namespace ouzel
                                 bool wireframe = false,
                                 bool scissorTestEnabled = false,
                                 const Rectangle& scissorTest = Rectangle());
+            bool addDrawCommand(std::initializer_list<TexturePtr> textures,
+                                const ShaderPtr& shader,
+                                std::initializer_list<ShaderConstant> pixelShaderConstants,
+                                std::initializer_list<ShaderConstant> vertexShaderConstants,
+                                const BlendStatePtr& blendState,
+                                const MeshBufferPtr& meshBuffer,
+                                uint32_t indexCount = 0,
+                                DrawMode drawMode = DrawMode::TRIANGLE_LIST,
+                                uint32_t startIndex = 0,
+                                const RenderTargetPtr& renderTarget = nullptr,
+                                const Rectangle& viewport = Rectangle(0.0f, 0.0f, 1.0f, 1.0f),
+                                bool wireframe = false,
+                                bool scissorTestEnabled = false,
+                                const Rectangle& scissorTest = Rectangle());
+            bool addBatchedDrawCommand(const TexturePtr& texture,
+                                       const ShaderPtr& shader,
+                                       const BlendStatePtr& blendState,
+                                       const Matrix4& viewProjection,
+                                       const Matrix4& transform,
+                                       const Color& color,
+                                       const VertexPCT* vertices,
+                                       uint32_t vertexCount,
+                                       const uint16_t* indices,
+                                       uint32_t indexCount,
+                                       const RenderTargetPtr& renderTarget = nullptr,
+                                       const Rectangle& viewport = Rectangle(0.0f, 0.0f, 1.0f, 1.0f),
+                                       bool scissorTestEnabled = false,
+                                       const Rectangle& scissorTest = Rectangle());
+            // draws textured quads with one instanced draw call, returns false if instancing is not available
+            bool addInstancedDrawCommand(const TexturePtr& texture,
+                                         const BlendStatePtr& blendState,
+                                         const Matrix4& viewProjection,
+                                         const Color& color,
+                                         const VertexInstance* instances,
+                                         uint32_t instanceCount,
+                                         const RenderTargetPtr& renderTarget = nullptr,
+                                         const Rectangle& viewport = Rectangle(0.0f, 0.0f, 1.0f, 1.0f),
+                                         bool scissorTestEnabled = false,
+                                         const Rectangle& scissorTest = Rectangle());
             void flushDrawCommands();
 
+            // append the commands of a draw list to the frame, draw lists can be filled on other threads and submitted more than once
+            void addDrawList(const DrawList& drawList);
+            // the list the add*DrawCommand functions record into, it must only be used on the thread that draws the scene
+            DrawList& getDrawList() { return pendingDrawList; }
+
             Vector2 convertScreenToNormalizedLocation(const Vector2& position)
             {
                 return Vector2(position.v[0] / size.v[0],
@@ -123,10 +195,29 @@ namespace ouzel
                                (1.0f - position.v[1]) * size.v[1]);
             }
 
+            // the frame is read back without waiting for the GPU and encoded on the job system, so the file is written a few frames later
             virtual bool saveScreenshot(const std::string& filename);
+            // saves the next frameCount frames to filenamePrefix000000.png, filenamePrefix000001.png and so on
+            void startFrameCapture(const std::string& filenamePrefix, uint32_t frameCount);
+            void stopFrameCapture();
+            bool isCapturingFrames() const;
 
             virtual uint32_t getDrawCallCount() const { return drawCallCount; }
 
+            // reorder draw commands inside a sort bucket to minimize state changes, commands from different buckets keep their order
+            void setSortDrawCommands(bool newSortDrawCommands) { sortDrawCommands = newSortDrawCommands; }
+            bool getSortDrawCommands() const { return sortDrawCommands; }
+            void nextSortBucket();
+
+            uint32_t getStateChangeCount() const { return stateChangeCount; }
+            uint32_t getStateChangesAvoided() const { return stateChangesAvoided; }
+
+            // bytes of texture levels and buffer data uploaded for the resources that are alive, an estimate of the used GPU memory
+            uint64_t getTextureMemory() const { return textureMemory; }
+            uint64_t getVertexBufferMemory() const { return vertexBufferMemory; }
+            uint64_t getIndexBufferMemory() const { return indexBufferMemory; }
+            uint64_t getResourceMemory() const { return textureMemory + vertexBufferMemory + indexBufferMemory; }
+
             uint16_t getAPIMajorVersion() const { return apiMajorVersion; }
             uint16_t getAPIMinorVersion() const { return apiMinorVersion; }
 
@@ -141,6 +232,9 @@ namespace ouzel
             void scheduleUpdate(const ResourcePtr& resource);
 
             bool isNPOTTexturesSupported() const { return npotTexturesSupported; }
+            bool isInstancingSupported() const { return instancingSupported; }
+            // compressed formats that the renderer can't sample are decompressed by the texture when possible
+            bool isTextureFormatSupported(PixelFormat pixelFormat) const;
 
             const Matrix4& getProjectionTransform(bool renderTarget) const
             {
@@ -156,6 +250,7 @@ namespace ouzel
                               bool newVerticalSync,
                               uint32_t newDepthBits);
 
+
             Driver driver;
             Window* window;
             Size2 size;
@@ -169,18 +264,35 @@ namespace ouzel
 
             Color clearColor;
             uint32_t drawCallCount = 0;
+            uint32_t stateChangeCount = 0;
+            uint32_t stateChangesAvoided = 0;
 
             uint16_t apiMajorVersion = 0;
             uint16_t apiMinorVersion = 0;
 
+            // updated by the resources, declared before the queues so that resources released with them can still update them
+            std::atomic<uint64_t> textureMemory;
+            std::atomic<uint64_t> vertexBufferMemory;
+            std::atomic<uint64_t> indexBufferMemory;
+
             std::atomic<bool> clear;
 
+            // location of a single shader constant in the frame's shaderConstantData
+            struct ShaderConstantRange
+            {
+                uint32_t offset;
+                uint32_t size;
+            };
+
             struct DrawCommand
             {
-                std::vector<TexturePtr> textures;
+                TexturePtr textures[Texture::LAYERS];
                 ShaderPtr shader;
-                std::vector<std::vector<float>> pixelShaderConstants;
-                std::vector<std::vector<float>> vertexShaderConstants;
+                // ranges in shaderConstants
+                uint32_t pixelShaderConstantIndex;
+                uint32_t pixelShaderConstantCount;
+                uint32_t vertexShaderConstantIndex;
+                uint32_t vertexShaderConstantCount;
                 BlendStatePtr blendState;
                 MeshBufferPtr meshBuffer;
                 uint32_t indexCount;
@@ -191,23 +303,231 @@ namespace ouzel
                 bool wireframe;
                 bool scissorTestEnabled;
                 Rectangle scissorTest;
+                uint32_t sortBucket;
+                uint64_t sortKey;
+                // number of instances in the mesh buffer's instance buffer, 0 for non-instanced draw commands
+                uint32_t instanceCount;
+                uint32_t startInstance;
             };
 
+            // location of pre-transformed vertices or instances of a draw command in a DrawList
+            struct BatchRange
+            {
+                uint32_t vertexOffset;
+                uint32_t vertexCount;
+                uint32_t indexOffset;
+                uint32_t instanceOffset;
+            };
+
+        public:
+            class DrawList
+            {
+                friend Renderer;
+            public:
+                bool empty() const { return drawCommands.empty(); }
+                uint32_t getDrawCommandCount() const { return static_cast<uint32_t>(drawCommands.size()); }
+                void clear();
+
+                bool addDrawCommand(const std::vector<TexturePtr>& textures,
+                                    const ShaderPtr& shader,
+                                    const std::vector<std::vector<float>>& pixelShaderConstants,
+                                    const std::vector<std::vector<float>>& vertexShaderConstants,
+                                    const BlendStatePtr& blendState,
+                                    const MeshBufferPtr& meshBuffer,
+                                    uint32_t indexCount = 0,
+                                    DrawMode drawMode = DrawMode::TRIANGLE_LIST,
+                                    uint32_t startIndex = 0,
+                                    const RenderTargetPtr& renderTarget = nullptr,
+                                    const Rectangle& viewport = Rectangle(0.0f, 0.0f, 1.0f, 1.0f),
+                                    bool wireframe = false,
+                                    bool scissorTestEnabled = false,
+                                    const Rectangle& scissorTest = Rectangle());
+                bool addDrawCommand(std::initializer_list<TexturePtr> textures,
+                                    const ShaderPtr& shader,
+                                    std::initializer_list<ShaderConstant> pixelShaderConstants,
+                                    std::initializer_list<ShaderConstant> vertexShaderConstants,
+                                    const BlendStatePtr& blendState,
+                                    const MeshBufferPtr& meshBuffer,
+                                    uint32_t indexCount = 0,
+                                    DrawMode drawMode = DrawMode::TRIANGLE_LIST,
+                                    uint32_t startIndex = 0,
+                                    const RenderTargetPtr& renderTarget = nullptr,
+                                    const Rectangle& viewport = Rectangle(0.0f, 0.0f, 1.0f, 1.0f),
+                                    bool wireframe = false,
+                                    bool scissorTestEnabled = false,
+                                    const Rectangle& scissorTest = Rectangle());
+                bool addBatchedDrawCommand(const TexturePtr& texture,
+                                           const ShaderPtr& shader,
+                                           const BlendStatePtr& blendState,
+                                           const Matrix4& viewProjection,
+                                           const Matrix4& transform,
+                                           const Color& color,
+                                           const VertexPCT* vertices,
+                                           uint32_t vertexCount,
+                                           const uint16_t* indices,
+                                           uint32_t indexCount,
+                                           const RenderTargetPtr& renderTarget = nullptr,
+                                           const Rectangle& viewport = Rectangle(0.0f, 0.0f, 1.0f, 1.0f),
+                                           bool scissorTestEnabled = false,
+                                           const Rectangle& scissorTest = Rectangle());
+                bool addInstancedDrawCommand(const TexturePtr& texture,
+                                             const BlendStatePtr& blendState,
+                                             const Matrix4& viewProjection,
+                                             const Color& color,
+                                             const VertexInstance* instances,
+                                             uint32_t instanceCount,
+                                             const RenderTargetPtr& renderTarget = nullptr,
+                                             const Rectangle& viewport = Rectangle(0.0f, 0.0f, 1.0f, 1.0f),
+                                             bool scissorTestEnabled = false,
+                                             const Rectangle& scissorTest = Rectangle());
+
+                void nextSortBucket() { ++sortBucket; }
+
+            protected:
+                bool pushDrawCommand(const TexturePtr* textures,
+                                     uint32_t textureCount,
+                                     const ShaderPtr& shader,
+                                     const ShaderConstant* pixelShaderConstants,
+                                     uint32_t pixelShaderConstantCount,
+                                     const ShaderConstant* vertexShaderConstants,
+                                     uint32_t vertexShaderConstantCount,
+                                     const BlendStatePtr& blendState,
+                                     const MeshBufferPtr& meshBuffer,
+                                     uint32_t indexCount,
+                                     DrawMode drawMode,
+                                     uint32_t startIndex,
+                                     const RenderTargetPtr& renderTarget,
+                                     const Rectangle& viewport,
+                                     bool wireframe,
+                                     bool scissorTestEnabled,
+                                     const Rectangle& scissorTest);
+                // adds a draw command without validating the mesh buffer, batched and instanced commands get theirs in addDrawList
+                DrawCommand& recordDrawCommand(const TexturePtr* textures,
+                                               uint32_t textureCount,
+                                               const ShaderPtr& shader,
+                                               const ShaderConstant* pixelShaderConstants,
+                                               uint32_t pixelShaderConstantCount,
+                                               const ShaderConstant* vertexShaderConstants,
+                                               uint32_t vertexShaderConstantCount,
+                                               const BlendStatePtr& blendState,
+                                               const MeshBufferPtr& meshBuffer,
+                                               uint32_t indexCount,
+                                               DrawMode drawMode,
+                                               uint32_t startIndex,
+                                               const RenderTargetPtr& renderTarget,
+                                               const Rectangle& viewport,
+                                               bool wireframe,
+                                               bool scissorTestEnabled,
+                                               const Rectangle& scissorTest);
+                void addShaderConstant(const float* data, uint32_t size);
+                bool canMerge(const DrawCommand& drawCommand,
+                              const TexturePtr& texture,
+                              const ShaderPtr& shader,
+                              const BlendStatePtr& blendState,
+                              const Matrix4& viewProjection,
+                              const RenderTargetPtr& renderTarget,
+                              const Rectangle& viewport,
+                              bool scissorTestEnabled,
+                              const Rectangle& scissorTest) const;
+
+                std::vector<DrawCommand> drawCommands;
+                std::vector<BatchRange> batchRanges;
+                std::vector<ShaderConstantRange> shaderConstants;
+                std::vector<float> shaderConstantData;
+                std::vector<VertexPCT> batchVertices;
+                std::vector<uint16_t> batchIndices;
+                std::vector<VertexInstance> instances;
+                uint32_t sortBucket = 0;
+            };
+
+        protected:
+
+            static uint64_t calculateSortKey(const DrawCommand& drawCommand);
+            static uint32_t countStateChanges(const std::vector<DrawCommand>& drawCommands);
+            void sortActiveDrawQueue();
+            void submitPendingDrawList();
+            void appendDrawList(const DrawList& drawList);
+
+            bool sortDrawCommands = false;
+            uint32_t sortBucket = 0;
+            uint32_t activeStateChangeCount = 0;
+            uint32_t activeStateChangesAvoided = 0;
+
             std::atomic<bool> activeDrawQueueFinished;
             std::atomic<bool> refillDrawQueue;
 
             bool verticalSync = true;
             bool ready = false;
             bool npotTexturesSupported = true;
+            bool instancingSupported = false;
+            bool bcTexturesSupported = false; // BC1 and BC3
+            bool bc7TexturesSupported = false;
+            bool etc2TexturesSupported = false;
 
             std::vector<DrawCommand> activeDrawQueue;
             std::vector<DrawCommand> drawQueue;
 
-            std::set<ResourcePtr> updateSet;
+            // per-frame linear storage of shader constants, swapped together with the draw queues
+            std::vector<ShaderConstantRange> activeShaderConstants;
+            std::vector<ShaderConstantRange> shaderConstants;
+            std::vector<float> activeShaderConstantData;
+            std::vector<float> shaderConstantData;
+
+            // streaming buffers for batched draw commands, one page holds up to 65536 vertices (16-bit indices)
+            static const uint32_t BATCH_MAX_VERTICES = 65536;
+            // buffers are cycled between frames so that a page is not overwritten while the GPU may still read it
+            static const uint32_t BATCH_RING_SIZE = 3;
+
+            struct BatchBuffer
+            {
+                MeshBufferPtr meshBuffer;
+                IndexBufferPtr indexBuffer;
+                VertexBufferPtr vertexBuffer;
+                std::vector<VertexPCT> vertices;
+                std::vector<uint16_t> indices;
+            };
+
+            BatchBuffer& getBatchBuffer(uint32_t vertexCount);
+
+            std::vector<BatchBuffer> batchBuffers[BATCH_RING_SIZE];
+            uint32_t batchRingIndex = 0;
+            uint32_t batchBufferCount = 0;
+
+            // instanced quads share one unit quad, instances are streamed through the same ring as the batches
+            struct InstanceBuffer
+            {
+                MeshBufferPtr meshBuffer;
+                VertexBufferPtr vertexBuffer;
+                std::vector<VertexInstance> instances;
+            };
+
+            InstanceBuffer& getInstanceBuffer();
+
+            ShaderPtr instancedShader;
+            IndexBufferPtr quadIndexBuffer;
+            VertexBufferPtr quadVertexBuffer;
+            InstanceBuffer instanceBuffers[BATCH_RING_SIZE];
+
+            // commands added directly to the renderer, submitted before the next draw list and when the frame is flushed
+            DrawList pendingDrawList;
+
+            // resources can be scheduled more than once per frame, duplicates are removed on the render thread
+            std::vector<ResourcePtr> updateQueue;
             std::mutex updateMutex;
+            // both queues keep their capacity, so scheduling an update doesn't allocate
+            std::vector<ResourcePtr> activeUpdateQueue;
+
+            // returns the files the frame that has just been drawn has to be saved to
+            std::vector<std::string> getScreenshotFilenames();
+            // takes top-down RGBA8 pixels and writes them to PNG files on the job system
+            void saveScreenshotData(const std::vector<std::string>& filenames, uint32_t width, uint32_t height, std::vector<uint8_t> data);
 
             std::queue<std::string> screenshotQueue;
-            std::mutex screenshotMutex;
+            std::string frameCapturePrefix;
+            uint32_t frameCaptureCount = 0;
+            uint32_t frameCaptureIndex = 0;
+            mutable std::mutex screenshotMutex;
+            JobSystem::TaskGroup screenshotGroup;
 
             Matrix4 projectionTransform;
             Matrix4 renderTargetProjectionTransform;
@@ -2,36 +2,78 @@
 // This file is part of the Ouzel engine.
 
 #include <algorithm>
+#include <cstring>
 #include "Texture.h"
 #include "Renderer.h"
 #include "Image.h"
+#include "TextureCompression.h"
 #include "core/Engine.h"
+#include "core/Application.h"
+#include "core/JobSystem.h"
+#include "files/FileSystem.h"
 #include "utils/Utils.h"
 #include "math/MathUtils.h"
+#include "utils/Log.h"
 
 namespace ouzel
 {
     namespace graphics
     {
-        Texture::Texture()
+        // minimum number of destination pixels per downsampling task, smaller mip levels are downsampled on the calling thread
+        static const uint32_t MIN_DOWNSAMPLE_TASK_PIXELS = 16384;
+
+        // overlapping dirty rectangles are merged, all of them are merged into their bounds when there are more
+        static const size_t MAX_DIRTY_REGIONS = 16;
+
+        // cooked textures start with the magic, version, pixel format, width, height and level count, followed by
+        // the width, height, pitch and offset from the start of the file of every level,
+        // all values are 32 bit integers in the byte order of the platforms the engine runs on (little endian)
+        static const uint8_t COOKED_TEXTURE_MAGIC[4] = { 'O', 'T', 'E', 'X' };
+        static const uint32_t COOKED_TEXTURE_VERSION = 1;
+        static const uint32_t COOKED_TEXTURE_HEADER_SIZE = 24;
+        static const uint32_t COOKED_TEXTURE_LEVEL_SIZE = 16;
+        static const uint32_t COOKED_TEXTURE_ALIGNMENT = 16;
+
+        static inline uint32_t readUInt32(const uint8_t* src)
+        {
+            uint32_t result;
+            memcpy(&result, src, sizeof(result));
+            return result;
+        }
+
+        static inline void writeUInt32(uint8_t* dst, uint32_t value)
+        {
+            memcpy(dst, &value, sizeof(value));
+        }
+
+        Texture::Texture():
+            memorySize(0)
         {
         }
 
         Texture::~Texture()
         {
+            setMemorySize(0);
         }
 
         void Texture::free()
         {
+            setMemorySize(0);
+
             levels.clear();
+            data.clear();
+            dirtyRegions.clear();
             uploadData.levels.clear();
+            uploadData.data.clear();
         }
 
         bool Texture::init(const Size2& newSize, bool newDynamic, bool newMipmaps, bool newRenderTarget)
         {
             free();
+            placeholder.reset();
 
             size = newSize;
+            pixelFormat = PixelFormat::RGBA8_UNORM;
             dynamic = newDynamic;
             mipmaps = newMipmaps;
             renderTarget = newRenderTarget;
@@ -50,18 +92,53 @@ namespace ouzel
 
             filename = newFilename;
 
-            Image image;
-            if (!image.initFromFile(filename))
+            std::vector<uint8_t> fileData;
+            if (!sharedApplication->getFileSystem()->readFile(filename, fileData))
             {
                 return false;
             }
 
-            return initFromBuffer(image.getData(), image.getSize(), newDynamic, newMipmaps);
+            if (isCookedTexture(fileData))
+            {
+                if (!calculateCookedLevels(fileData, newMipmaps, size, pixelFormat, levels, data))
+                {
+                    return false;
+                }
+            }
+            else
+            {
+                Image image;
+                if (!image.initFromBuffer(fileData))
+                {
+                    return false;
+                }
+
+                size = image.getSize();
+
+                if (!calculateImageLevels(image, newMipmaps && shouldGenerateMipMaps(size), pixelFormat, levels, data))
+                {
+                    return false;
+                }
+            }
+
+            placeholder.reset();
+
+            dynamic = newDynamic;
+            mipmaps = newMipmaps;
+            renderTarget = false;
+            mipMapsGenerated = levels.size() > 1;
+
+            dirty = true;
+
+            sharedEngine->getRenderer()->scheduleUpdate(shared_from_this());
+
+            return true;
         }
 
         bool Texture::initFromBuffer(const std::vector<uint8_t>& newData, const Size2& newSize, bool newDynamic, bool newMipmaps)
         {
             free();
+            placeholder.reset();
 
             dynamic = newDynamic;
             mipmaps = newMipmaps;
@@ -103,180 +180,744 @@ namespace ouzel
             return true;
         }
 
-        static void imageRgba8Downsample2x2(uint32_t width, uint32_t height, uint32_t pitch, const uint8_t* src, uint8_t* dst)
+        // lookup tables that replace the powf calls of the gamma correct downsampling, the results are identical
+        struct GammaTables
         {
-            const uint32_t dstwidth  = width / 2;
-            const uint32_t dstheight = height / 2;
+            // linear values go up to 255^2.2, which is below 2^18
+            static const uint32_t BUCKET_SHIFT = 16;
+            static const uint32_t BUCKET_COUNT = 0x48800000 >> BUCKET_SHIFT;
 
-            if (dstwidth == 0 ||  dstheight == 0)
+            GammaTables()
             {
-                return;
-            }
-
-            for (uint32_t y = 0, ystep = pitch * 2; y < dstheight; ++y, src += ystep)
-            {
-                const uint8_t* rgba = src;
-                for (uint32_t x = 0; x < dstwidth; ++x, rgba += 8, dst += 4)
+                for (uint32_t i = 0; i < 256; ++i)
                 {
-                    float pixels = 0.0f;
+                    toLinear[i] = powf(static_cast<float>(i), 2.2f);
+                }
 
-                    float r = 0, g = 0, b = 0, a = 0;
+                // fromLinear[v] is the smallest float that converts back to at least v, found by a binary search over
+                // the bit patterns of the positive floats (they are ordered the same way as the values)
+                fromLinear[0] = 0.0f;
 
-                    if (rgba[3] > 0)
-                    {
-                        r += powf(rgba[0], 2.2f);
-                        g += powf(rgba[1], 2.2f);
-                        b += powf(rgba[2], 2.2f);
-                        pixels += 1.0f;
-                    }
-                    a = rgba[3];
+                for (uint32_t v = 1; v < 256; ++v)
+                {
+                    uint32_t low = 0;
+                    uint32_t high = 0x7F800000; // infinity
 
-                    if (rgba[7] > 0)
+                    while (low < high)
                     {
-                        r += powf(rgba[4], 2.2f);
-                        g += powf(rgba[5], 2.2f);
-                        b += powf(rgba[6], 2.2f);
-                        pixels += 1.0f;
-                    }
-                    a += rgba[7];
+                        uint32_t middle = low + (high - low) / 2;
+                        float value;
+                        memcpy(&value, &middle, sizeof(value));
 
-                    if (rgba[pitch+3])
-                    {
-                        r += powf(rgba[pitch+0], 2.2f);
-                        g += powf(rgba[pitch+1], 2.2f);
-                        b += powf(rgba[pitch+2], 2.2f);
-                        pixels += 1.0f;
+                        if (powf(value, 1.0f / 2.2f) >= static_cast<float>(v))
+                        {
+                            high = middle;
+                        }
+                        else
+                        {
+                            low = middle + 1;
+                        }
                     }
-                    a += rgba[pitch+3];
 
-                    if (rgba[pitch+7] > 0)
-                    {
-                        r += powf(rgba[pitch+4], 2.2f);
-                        g += powf(rgba[pitch+5], 2.2f);
-                        b += powf(rgba[pitch+6], 2.2f);
-                        pixels += 1.0f;
-                    }
-                    a += rgba[pitch+7];
+                    memcpy(&fromLinear[v], &low, sizeof(float));
+                }
+
+                // a bucket covers 1/128 of an octave and the thresholds are at least 2.2 * log2(256 / 255) octaves apart,
+                // so every bucket contains at most one threshold
+                uint32_t result = 0;
+
+                for (uint32_t bucket = 0; bucket < BUCKET_COUNT; ++bucket)
+                {
+                    uint32_t bits = bucket << BUCKET_SHIFT;
+                    float value;
+                    memcpy(&value, &bits, sizeof(value));
+
+                    while (result < 255 && value >= fromLinear[result + 1]) ++result;
+
+                    buckets[bucket] = static_cast<uint8_t>(result);
+                }
+            }
+
+            // same as truncating powf(value, 1.0f / 2.2f) to uint8_t
+            uint8_t linearToGamma(float value) const
+            {
+                uint32_t bits;
+                memcpy(&bits, &value, sizeof(bits));
+
+                uint32_t result = buckets[bits >> BUCKET_SHIFT];
+                if (result < 255 && value >= fromLinear[result + 1]) ++result;
+
+                return static_cast<uint8_t>(result);
+            }
+
+            float toLinear[256];
+            float fromLinear[256];
+            uint8_t buckets[BUCKET_COUNT];
+        };
 
-                    if (pixels > 0.0f)
+        static const GammaTables& getGammaTables()
+        {
+            static const GammaTables gammaTables;
+            return gammaTables;
+        }
+
+        // src0 and src1 are the two source rows and step the offset to the second pixel of the 2x2 block (0 if the image is 1 pixel wide)
+        static void imageRgba8DownsampleRow(const uint8_t* src0, const uint8_t* src1, uint32_t step, uint32_t dstWidth, uint8_t* dst)
+        {
+            const GammaTables& tables = getGammaTables();
+
+            for (uint32_t x = 0; x < dstWidth; ++x, src0 += 8, src1 += 8, dst += 4)
+            {
+                const uint8_t* pixels[4] = { src0, src0 + step, src1, src1 + step };
+
+                float count = 0.0f;
+                float r = 0.0f, g = 0.0f, b = 0.0f;
+                uint32_t a = 0;
+
+                for (const uint8_t* pixel : pixels)
+                {
+                    if (pixel[3] > 0)
                     {
-                        r /= pixels;
-                        g /= pixels;
-                        b /= pixels;
+                        r += tables.toLinear[pixel[0]];
+                        g += tables.toLinear[pixel[1]];
+                        b += tables.toLinear[pixel[2]];
+                        count += 1.0f;
                     }
-                    else
+                    a += pixel[3];
+                }
+
+                if (count > 0.0f)
+                {
+                    r /= count;
+                    g /= count;
+                    b /= count;
+                }
+
+                dst[0] = tables.linearToGamma(r);
+                dst[1] = tables.linearToGamma(g);
+                dst[2] = tables.linearToGamma(b);
+                dst[3] = static_cast<uint8_t>(a / 4);
+            }
+        }
+
+        // writes rows [firstRow, lastRow) of the next mip level, a dimension of 1 pixel stays 1 pixel and its pixels are used twice
+        static void imageRgba8Downsample2x2(uint32_t width, uint32_t height, uint32_t pitch, const uint8_t* src,
+                                            uint32_t dstWidth, uint32_t dstPitch, uint32_t firstRow, uint32_t lastRow, uint8_t* dst)
+        {
+            uint32_t step = (width >= 2) ? 4 : 0;
+
+            for (uint32_t y = firstRow; y < lastRow; ++y)
+            {
+                const uint8_t* src0 = src + ((height >= 2) ? y * 2 : y) * pitch;
+                const uint8_t* src1 = (height >= 2) ? src0 + pitch : src0;
+
+                imageRgba8DownsampleRow(src0, src1, step, dstWidth, dst + y * dstPitch);
+            }
+        }
+
+        bool Texture::setRegion(const Rectangle& newRegion, const std::vector<uint8_t>& newData)
+        {
+            if (!dynamic || pixelFormat != PixelFormat::RGBA8_UNORM || levels.empty())
+            {
+                return false;
+            }
+
+            if (newRegion.position.x() < 0.0f || newRegion.position.y() < 0.0f ||
+                newRegion.size.v[0] <= 0.0f || newRegion.size.v[1] <= 0.0f ||
+                newRegion.position.x() + newRegion.size.v[0] > size.v[0] ||
+                newRegion.position.y() + newRegion.size.v[1] > size.v[1])
+            {
+                return false;
+            }
+
+            Region region = {
+                0,
+                static_cast<uint32_t>(newRegion.position.x()),
+                static_cast<uint32_t>(newRegion.position.y()),
+                static_cast<uint32_t>(newRegion.size.v[0]),
+                static_cast<uint32_t>(newRegion.size.v[1]),
+                0
+            };
+
+            if (newData.size() < region.width * region.height * 4)
+            {
+                return false;
+            }
+
+            uint32_t rowSize = region.width * 4;
+
+            for (uint32_t row = 0; row < region.height; ++row)
+            {
+                memcpy(data.data() + levels[0].offset + (region.y + row) * levels[0].pitch + region.x * 4,
+                       newData.data() + row * rowSize, rowSize);
+            }
+
+            // only the pixels of the smaller levels that cover the rectangle are downsampled again
+            uint32_t left = region.x;
+            uint32_t top = region.y;
+            uint32_t right = region.x + region.width;
+            uint32_t bottom = region.y + region.height;
+
+            for (size_t level = 1; level < levels.size(); ++level)
+            {
+                const Level& srcLevel = levels[level - 1];
+                const Level& dstLevel = levels[level];
+
+                uint32_t width = static_cast<uint32_t>(srcLevel.size.v[0]);
+                uint32_t height = static_cast<uint32_t>(srcLevel.size.v[1]);
+                uint32_t dstWidth = static_cast<uint32_t>(dstLevel.size.v[0]);
+                uint32_t dstHeight = static_cast<uint32_t>(dstLevel.size.v[1]);
+
+                left /= 2;
+                top /= 2;
+                right = std::min((right + 1) / 2, dstWidth);
+                bottom = std::min((bottom + 1) / 2, dstHeight);
+
+                if (left >= right || top >= bottom)
+                {
+                    break;
+                }
+
+                const uint8_t* src = data.data() + srcLevel.offset + ((width >= 2) ? left * 8 : 0);
+                uint8_t* dst = data.data() + dstLevel.offset + left * 4;
+
+                imageRgba8Downsample2x2(width, height, srcLevel.pitch, src, right - left, dstLevel.pitch, top, bottom, dst);
+            }
+
+            auto mergeRegion = [](Region& target, const Region& other) {
+                uint32_t mergedRight = std::max(target.x + target.width, other.x + other.width);
+                uint32_t mergedBottom = std::max(target.y + target.height, other.y + other.height);
+
+                target.x = std::min(target.x, other.x);
+                target.y = std::min(target.y, other.y);
+                target.width = mergedRight - target.x;
+                target.height = mergedBottom - target.y;
+            };
+
+            bool merged = false;
+
+            for (Region& dirtyRegion : dirtyRegions)
+            {
+                if (region.x <= dirtyRegion.x + dirtyRegion.width && dirtyRegion.x <= region.x + region.width &&
+                    region.y <= dirtyRegion.y + dirtyRegion.height && dirtyRegion.y <= region.y + region.height)
+                {
+                    mergeRegion(dirtyRegion, region);
+                    merged = true;
+                    break;
+                }
+            }
+
+            if (!merged)
+            {
+                dirtyRegions.push_back(region);
+
+                if (dirtyRegions.size() > MAX_DIRTY_REGIONS)
+                {
+                    for (size_t i = 1; i < dirtyRegions.size(); ++i)
                     {
-                        r = g = b = 0;
+                        mergeRegion(dirtyRegions[0], dirtyRegions[i]);
                     }
 
-                    a *= 0.25f;
-                    r = powf(r, 1.0f / 2.2f);
-                    g = powf(g, 1.0f / 2.2f);
-                    b = powf(b, 1.0f / 2.2f);
-                    dst[0] = (uint8_t)r;
-                    dst[1] = (uint8_t)g;
-                    dst[2] = (uint8_t)b;
-                    dst[3] = (uint8_t)a;
+                    dirtyRegions.resize(1);
                 }
             }
+
+            sharedEngine->getRenderer()->scheduleUpdate(shared_from_this());
+
+            return true;
         }
 
         bool Texture::calculateData(const std::vector<uint8_t>& newData, const Size2& newSize)
         {
-            levels.clear();
             size = newSize;
+            pixelFormat = PixelFormat::RGBA8_UNORM;
+
+            calculateLevels(newData, newSize, mipmaps && shouldGenerateMipMaps(newSize), levels, data);
 
+            mipMapsGenerated = levels.size() > 1;
+
+            return true;
+        }
+
+        bool Texture::shouldGenerateMipMaps(const Size2& newSize)
+        {
             uint32_t newWidth = static_cast<uint32_t>(newSize.v[0]);
             uint32_t newHeight = static_cast<uint32_t>(newSize.v[1]);
 
+            return sharedEngine->getRenderer()->isNPOTTexturesSupported() || (isPOT(newWidth) && isPOT(newHeight));
+        }
+
+        void Texture::calculateLevels(const std::vector<uint8_t>& newData, const Size2& newSize, bool generateMipMaps,
+                                      std::vector<Level>& newLevels, std::vector<uint8_t>& newLevelData)
+        {
+            newLevels.clear();
+
+            uint32_t newWidth = static_cast<uint32_t>(newSize.v[0]);
+            uint32_t newHeight = static_cast<uint32_t>(newSize.v[1]);
+
+            // lay out the whole mip chain first, so all levels share a single allocation
             uint32_t pitch = newWidth * 4;
-            levels.push_back({ newSize, pitch, newData });
+            uint32_t baseSize = pitch * newHeight;
+            uint32_t offset = baseSize;
+            newLevels.push_back({ newSize, pitch, 0 });
+
+            if (generateMipMaps)
+            {
+                while (newWidth >= 2 || newHeight >= 2)
+                {
+                    newWidth = (newWidth >= 2) ? newWidth / 2 : 1;
+                    newHeight = (newHeight >= 2) ? newHeight / 2 : 1;
+                    pitch = newWidth * 4;
+
+                    Size2 mipMapSize = Size2(static_cast<float>(newWidth), static_cast<float>(newHeight));
+                    newLevels.push_back({ mipMapSize, pitch, offset });
 
-            mipMapsGenerated = mipmaps && (sharedEngine->getRenderer()->isNPOTTexturesSupported() || (isPOT(newWidth) && isPOT(newHeight)));
+                    offset += pitch * newHeight;
+                }
+            }
 
-            if (mipMapsGenerated)
+            newLevelData.resize(offset);
+            std::copy(newData.begin(),
+                      newData.begin() + static_cast<std::vector<uint8_t>::difference_type>(baseSize),
+                      newLevelData.begin());
+
+            // the texture cooker runs without an engine, so it downsamples on the calling thread
+            JobSystem* jobSystem = sharedEngine ? sharedEngine->getJobSystem() : nullptr;
+
+            // every level is written to its own part of the buffer, so the rows of a level can be downsampled in parallel
+            for (size_t level = 1; level < newLevels.size(); ++level)
             {
-                uint32_t bufferSize = newWidth * newHeight * 4;
+                const Level& srcLevel = newLevels[level - 1];
+                const Level& dstLevel = newLevels[level];
+
+                uint32_t width = static_cast<uint32_t>(srcLevel.size.v[0]);
+                uint32_t height = static_cast<uint32_t>(srcLevel.size.v[1]);
+                uint32_t dstWidth = static_cast<uint32_t>(dstLevel.size.v[0]);
+                uint32_t dstHeight = static_cast<uint32_t>(dstLevel.size.v[1]);
+                uint32_t srcPitch = srcLevel.pitch;
+                uint32_t dstPitch = dstLevel.pitch;
+
+                const uint8_t* src = newLevelData.data() + srcLevel.offset;
+                uint8_t* dst = newLevelData.data() + dstLevel.offset;
+
+                uint32_t rowsPerTask = std::max(MIN_DOWNSAMPLE_TASK_PIXELS / dstWidth, 1U);
 
-                if (newWidth == 1)
+                if (jobSystem && jobSystem->getWorkerCount() > 0 && dstHeight > rowsPerTask)
                 {
-                    bufferSize *= 2;
+                    jobSystem->parallelFor(0, dstHeight, rowsPerTask, [=](uint32_t firstRow, uint32_t lastRow) {
+                        imageRgba8Downsample2x2(width, height, srcPitch, src, dstWidth, dstPitch, firstRow, lastRow, dst);
+                    });
                 }
-                if (newHeight == 1)
+                else
                 {
-                    bufferSize *= 2;
+                    imageRgba8Downsample2x2(width, height, srcPitch, src, dstWidth, dstPitch, 0, dstHeight, dst);
                 }
+            }
+        }
 
-                std::vector<uint8_t> mipMapData(bufferSize);
-                std::copy(newData.begin(),
-                          newData.begin() + static_cast<std::vector<uint8_t>::difference_type>(newWidth * newHeight * 4),
-                          mipMapData.begin());
+        bool Texture::calculateImageLevels(const Image& image, bool generateMipMaps, PixelFormat& newPixelFormat,
+                                           std::vector<Level>& newLevels, std::vector<uint8_t>& newLevelData)
+        {
+            PixelFormat imagePixelFormat = image.getPixelFormat();
+            const Size2& imageSize = image.getSize();
 
-                while (newWidth >= 2 && newHeight >= 2)
-                {
-                    imageRgba8Downsample2x2(newWidth, newHeight, pitch, mipMapData.data(), mipMapData.data());
+            if (imagePixelFormat == PixelFormat::RGBA8_UNORM)
+            {
+                newPixelFormat = PixelFormat::RGBA8_UNORM;
+                calculateLevels(image.getData(), imageSize, generateMipMaps, newLevels, newLevelData);
+                return true;
+            }
 
-                    newWidth >>= 1;
-                    newHeight >>= 1;
+            uint32_t width = static_cast<uint32_t>(imageSize.v[0]);
+            uint32_t height = static_cast<uint32_t>(imageSize.v[1]);
 
-                    Size2 mipMapSize = Size2(static_cast<float>(newWidth), static_cast<float>(newHeight));
-                    pitch = newWidth * 4;
+            if (sharedEngine->getRenderer()->isTextureFormatSupported(imagePixelFormat))
+            {
+                // compressed data can't be downsampled, so only the levels stored in the image are used
+                newPixelFormat = imagePixelFormat;
+                copyImageLevels(image, generateMipMaps ? image.getLevelCount() : 1, newLevels, newLevelData);
+
+                return true;
+            }
+
+            std::vector<uint8_t> decompressedData;
+
+            if (!decompressImage(imagePixelFormat, width, height, image.getData().data(), decompressedData))
+            {
+                Log(Log::Level::ERR) << "Texture pixel format is not supported by the renderer";
+                return false;
+            }
+
+            newPixelFormat = PixelFormat::RGBA8_UNORM;
+            calculateLevels(decompressedData, imageSize, generateMipMaps, newLevels, newLevelData);
+
+            return true;
+        }
+
+        void Texture::copyImageLevels(const Image& image, uint32_t levelCount,
+                                      std::vector<Level>& newLevels, std::vector<uint8_t>& newLevelData)
+        {
+            PixelFormat imagePixelFormat = image.getPixelFormat();
+            uint32_t width = static_cast<uint32_t>(image.getSize().v[0]);
+            uint32_t height = static_cast<uint32_t>(image.getSize().v[1]);
+            uint32_t offset = 0;
+
+            newLevels.clear();
+
+            for (uint32_t level = 0; level < levelCount; ++level)
+            {
+                uint32_t levelWidth = std::max(width >> level, 1U);
+                uint32_t levelHeight = std::max(height >> level, 1U);
+
+                newLevels.push_back({ Size2(static_cast<float>(levelWidth), static_cast<float>(levelHeight)),
+                                      getPixelFormatPitch(imagePixelFormat, levelWidth), offset });
+
+                offset += getPixelFormatSize(imagePixelFormat, levelWidth, levelHeight);
+            }
+
+            newLevelData.assign(image.getData().begin(),
+                                image.getData().begin() + static_cast<std::vector<uint8_t>::difference_type>(offset));
+        }
+
+        bool Texture::isCookedTexture(const std::vector<uint8_t>& fileData)
+        {
+            return fileData.size() >= sizeof(COOKED_TEXTURE_MAGIC) &&
+                   std::equal(std::begin(COOKED_TEXTURE_MAGIC), std::end(COOKED_TEXTURE_MAGIC), fileData.begin());
+        }
+
+        bool Texture::calculateCookedLevels(std::vector<uint8_t>& fileData, bool newMipmaps, Size2& newSize, PixelFormat& newPixelFormat,
+                                            std::vector<Level>& newLevels, std::vector<uint8_t>& newLevelData)
+        {
+            if (fileData.size() < COOKED_TEXTURE_HEADER_SIZE ||
+                readUInt32(fileData.data() + 4) != COOKED_TEXTURE_VERSION)
+            {
+                Log(Log::Level::ERR) << "Unsupported cooked texture version";
+                return false;
+            }
+
+            PixelFormat filePixelFormat = static_cast<PixelFormat>(readUInt32(fileData.data() + 8));
+            uint32_t width = readUInt32(fileData.data() + 12);
+            uint32_t height = readUInt32(fileData.data() + 16);
+            uint32_t levelCount = readUInt32(fileData.data() + 20);
+
+            // level sizes are calculated by shifting, which is only defined for the levels of the mip chain
+            if (getPixelFormatSize(filePixelFormat, 1, 1) == 0 || width == 0 || height == 0 || levelCount == 0 ||
+                levelCount > getMaxLevelCount(width, height) ||
+                levelCount > (fileData.size() - COOKED_TEXTURE_HEADER_SIZE) / COOKED_TEXTURE_LEVEL_SIZE)
+            {
+                Log(Log::Level::ERR) << "Invalid cooked texture header";
+                return false;
+            }
 
-                    levels.push_back({ mipMapSize, pitch, mipMapData });
+            newLevels.clear();
+
+            for (uint32_t level = 0; level < levelCount; ++level)
+            {
+                const uint8_t* levelHeader = fileData.data() + COOKED_TEXTURE_HEADER_SIZE + level * COOKED_TEXTURE_LEVEL_SIZE;
+                uint32_t levelWidth = readUInt32(levelHeader);
+                uint32_t levelHeight = readUInt32(levelHeader + 4);
+                uint32_t pitch = readUInt32(levelHeader + 8);
+                uint32_t offset = readUInt32(levelHeader + 12);
+
+                if (levelWidth != std::max(width >> level, 1U) ||
+                    levelHeight != std::max(height >> level, 1U) ||
+                    pitch != getPixelFormatPitch(filePixelFormat, levelWidth) ||
+                    offset > fileData.size() ||
+                    getPixelFormatSize(filePixelFormat, levelWidth, levelHeight) > fileData.size() - offset)
+                {
+                    Log(Log::Level::ERR) << "Invalid cooked texture level data";
+                    return false;
                 }
 
-                if (newWidth > newHeight)
+                newLevels.push_back({ Size2(static_cast<float>(levelWidth), static_cast<float>(levelHeight)), pitch, offset });
+            }
+
+            newSize = Size2(static_cast<float>(width), static_cast<float>(height));
+            bool generateMipMaps = newMipmaps && shouldGenerateMipMaps(newSize);
+
+            if (sharedEngine->getRenderer()->isTextureFormatSupported(filePixelFormat))
+            {
+                // the levels point into the file data, so it becomes the level buffer without copying or decoding
+                if (!generateMipMaps)
                 {
-                    for (; newWidth >= 2;)
-                    {
-                        std::copy(mipMapData.begin(),
-                                  mipMapData.begin() + static_cast<std::vector<uint8_t>::difference_type>(newWidth * 4),
-                                  mipMapData.begin() + static_cast<std::vector<uint8_t>::difference_type>(newWidth * 4));
+                    newLevels.resize(1);
+                }
+
+                newPixelFormat = filePixelFormat;
+                newLevelData = std::move(fileData);
 
-                        imageRgba8Downsample2x2(newWidth, 2, pitch, mipMapData.data(), mipMapData.data());
+                return true;
+            }
 
-                        newWidth >>= 1;
+            std::vector<uint8_t> decompressedData;
 
-                        Size2 mipMapSize = Size2(static_cast<float>(newWidth), static_cast<float>(newHeight));
-                        pitch = newWidth * 4;
+            if (!decompressImage(filePixelFormat, width, height, fileData.data() + newLevels[0].offset, decompressedData))
+            {
+                Log(Log::Level::ERR) << "Texture pixel format is not supported by the renderer";
+                return false;
+            }
 
-                        levels.push_back({ mipMapSize, pitch, mipMapData });
-                    }
+            newPixelFormat = PixelFormat::RGBA8_UNORM;
+            calculateLevels(decompressedData, newSize, generateMipMaps, newLevels, newLevelData);
+
+            return true;
+        }
+
+        bool Texture::cook(const Image& image, PixelFormat newPixelFormat, bool newMipmaps, std::vector<uint8_t>& result)
+        {
+            PixelFormat imagePixelFormat = image.getPixelFormat();
+            const Size2& imageSize = image.getSize();
+            uint32_t width = static_cast<uint32_t>(imageSize.v[0]);
+            uint32_t height = static_cast<uint32_t>(imageSize.v[1]);
+
+            std::vector<Level> newLevels;
+            std::vector<uint8_t> newLevelData;
+
+            if (imagePixelFormat == newPixelFormat && imagePixelFormat != PixelFormat::RGBA8_UNORM)
+            {
+                // already compressed images are stored as they are
+                copyImageLevels(image, newMipmaps ? image.getLevelCount() : 1, newLevels, newLevelData);
+            }
+            else
+            {
+                if (newPixelFormat != PixelFormat::RGBA8_UNORM &&
+                    newPixelFormat != PixelFormat::BC1_UNORM &&
+                    newPixelFormat != PixelFormat::BC3_UNORM)
+                {
+                    Log(Log::Level::ERR) << "Texture cooker can't encode the pixel format";
+                    return false;
                 }
-                else
+
+                std::vector<uint8_t> decompressedData;
+
+                if (imagePixelFormat != PixelFormat::RGBA8_UNORM &&
+                    !decompressImage(imagePixelFormat, width, height, image.getData().data(), decompressedData))
                 {
-                    for (; newHeight >= 2;)
-                    {
-                        uint32_t* src = reinterpret_cast<uint32_t*>(mipMapData.data());
-                        for (int32_t i = static_cast<int32_t>(newHeight) - 1; i >= 0; --i)
-                        {
-                            src[i * 2] = src[i];
-                            src[i * 2 + 1] = src[i];
-                        }
+                    Log(Log::Level::ERR) << "Texture cooker can't decode the pixel format";
+                    return false;
+                }
 
-                        imageRgba8Downsample2x2(2, newHeight, 8, mipMapData.data(), mipMapData.data());
+                calculateLevels(imagePixelFormat == PixelFormat::RGBA8_UNORM ? image.getData() : decompressedData,
+                                imageSize, newMipmaps, newLevels, newLevelData);
 
-                        newHeight >>= 1;
+                if (newPixelFormat != PixelFormat::RGBA8_UNORM)
+                {
+                    std::vector<uint8_t> compressedData;
+                    std::vector<uint8_t> levelData;
+                    uint32_t offset = 0;
 
-                        Size2 mipMapSize = Size2(static_cast<float>(newWidth), static_cast<float>(newHeight));
-                        levels.push_back({ mipMapSize, pitch, mipMapData });
+                    for (Level& level : newLevels)
+                    {
+                        uint32_t levelWidth = static_cast<uint32_t>(level.size.v[0]);
+                        uint32_t levelHeight = static_cast<uint32_t>(level.size.v[1]);
+
+                        compressImage(newPixelFormat, levelWidth, levelHeight, newLevelData.data() + level.offset, levelData);
+                        compressedData.insert(compressedData.end(), levelData.begin(), levelData.end());
+
+                        level.pitch = getPixelFormatPitch(newPixelFormat, levelWidth);
+                        level.offset = offset;
+                        offset += static_cast<uint32_t>(levelData.size());
                     }
+
+                    newLevelData = std::move(compressedData);
                 }
             }
 
+            // every level starts at an aligned offset, so the file can be uploaded straight from memory
+            uint32_t levelCount = static_cast<uint32_t>(newLevels.size());
+            uint32_t headerSize = COOKED_TEXTURE_HEADER_SIZE + levelCount * COOKED_TEXTURE_LEVEL_SIZE;
+            uint32_t fileOffset = (headerSize + COOKED_TEXTURE_ALIGNMENT - 1) & ~(COOKED_TEXTURE_ALIGNMENT - 1);
+            std::vector<uint32_t> levelOffsets;
+
+            for (const Level& level : newLevels)
+            {
+                levelOffsets.push_back(fileOffset);
+
+                uint32_t levelSize = getPixelFormatSize(newPixelFormat,
+                                                        static_cast<uint32_t>(level.size.v[0]),
+                                                        static_cast<uint32_t>(level.size.v[1]));
+                fileOffset = (fileOffset + levelSize + COOKED_TEXTURE_ALIGNMENT - 1) & ~(COOKED_TEXTURE_ALIGNMENT - 1);
+            }
+
+            result.assign(fileOffset, 0);
+
+            std::copy(std::begin(COOKED_TEXTURE_MAGIC), std::end(COOKED_TEXTURE_MAGIC), result.begin());
+            writeUInt32(result.data() + 4, COOKED_TEXTURE_VERSION);
+            writeUInt32(result.data() + 8, static_cast<uint32_t>(newPixelFormat));
+            writeUInt32(result.data() + 12, width);
+            writeUInt32(result.data() + 16, height);
+            writeUInt32(result.data() + 20, levelCount);
+
+            for (uint32_t level = 0; level < levelCount; ++level)
+            {
+                const Level& currentLevel = newLevels[level];
+                uint32_t levelWidth = static_cast<uint32_t>(currentLevel.size.v[0]);
+                uint32_t levelHeight = static_cast<uint32_t>(currentLevel.size.v[1]);
+                uint8_t* levelHeader = result.data() + COOKED_TEXTURE_HEADER_SIZE + level * COOKED_TEXTURE_LEVEL_SIZE;
+
+                writeUInt32(levelHeader, levelWidth);
+                writeUInt32(levelHeader + 4, levelHeight);
+                writeUInt32(levelHeader + 8, currentLevel.pitch);
+                writeUInt32(levelHeader + 12, levelOffsets[level]);
+
+                memcpy(result.data() + levelOffsets[level], newLevelData.data() + currentLevel.offset,
+                       getPixelFormatSize(newPixelFormat, levelWidth, levelHeight));
+            }
+
             return true;
         }
 
+        bool Texture::decodeFile(const std::string& newFilename, bool newMipmaps)
+        {
+            decodedLevels.clear();
+            decodedData.clear();
+            decodedFilename = newFilename;
+
+            decodedMipMaps = newMipmaps;
+
+            std::vector<uint8_t> fileData;
+            if (!sharedApplication->getFileSystem()->readFile(newFilename, fileData))
+            {
+                return false;
+            }
+
+            if (isCookedTexture(fileData))
+            {
+                return calculateCookedLevels(fileData, newMipmaps, decodedSize, decodedPixelFormat, decodedLevels, decodedData);
+            }
+
+            Image image;
+            if (!image.initFromBuffer(fileData))
+            {
+                return false;
+            }
+
+            decodedSize = image.getSize();
+
+            return calculateImageLevels(image, newMipmaps && shouldGenerateMipMaps(decodedSize),
+                                        decodedPixelFormat, decodedLevels, decodedData);
+        }
+
+        bool Texture::applyDecodedData(bool newDynamic)
+        {
+            if (decodedLevels.empty())
+            {
+                return false;
+            }
+
+            free();
+
+            filename = decodedFilename;
+            size = decodedSize;
+            pixelFormat = decodedPixelFormat;
+            dynamic = newDynamic;
+            mipmaps = decodedMipMaps;
+            renderTarget = false;
+            levels = std::move(decodedLevels);
+            data = std::move(decodedData);
+            decodedLevels.clear();
+            decodedData.clear();
+            mipMapsGenerated = levels.size() > 1;
+
+            dirty = true;
+
+            placeholder.reset();
+
+            sharedEngine->getRenderer()->scheduleUpdate(shared_from_this());
+
+            return true;
+        }
+
+        void Texture::setMemorySize(uint64_t newMemorySize)
+        {
+            uint64_t oldMemorySize = memorySize.exchange(newMemorySize);
+
+            // unsigned arithmetic wraps around, so the difference can be added when the texture shrinks too
+            if (newMemorySize != oldMemorySize)
+            {
+                sharedEngine->getRenderer()->textureMemory += newMemorySize - oldMemorySize;
+            }
+        }
+
         void Texture::update()
         {
             uploadData.size = size;
+            uploadData.pixelFormat = pixelFormat;
             uploadData.dynamic = dynamic;
             uploadData.mipmaps = mipMapsGenerated;
             uploadData.dirty = dirty;
 
             uploadData.renderTarget = renderTarget;
-            uploadData.levels = std::move(levels);
+            uploadData.regions.clear();
+            uploadData.regionData.clear();
+
+            if (dirty)
+            {
+                // dynamic textures keep their levels, so that setRegion can update them
+                if (dynamic)
+                {
+                    uploadData.levels = levels;
+                    uploadData.data = data;
+                }
+                else
+                {
+                    uploadData.levels = std::move(levels);
+                    uploadData.data = std::move(data);
+                }
+
+                // textures without data (render targets) are allocated by the renderer with 4 bytes per pixel
+                setMemorySize(uploadData.data.empty() ?
+                              static_cast<uint64_t>(size.v[0]) * static_cast<uint64_t>(size.v[1]) * 4 :
+                              uploadData.data.size());
+            }
+            else
+            {
+                // only the pixels inside the dirty rectangles are copied for the upload
+                for (const Region& dirtyRegion : dirtyRegions)
+                {
+                    uint32_t left = dirtyRegion.x;
+                    uint32_t top = dirtyRegion.y;
+                    uint32_t right = dirtyRegion.x + dirtyRegion.width;
+                    uint32_t bottom = dirtyRegion.y + dirtyRegion.height;
+
+                    for (size_t level = 0; level < levels.size(); ++level)
+                    {
+                        const Level& textureLevel = levels[level];
+
+                        if (level > 0)
+                        {
+                            left /= 2;
+                            top /= 2;
+                            right = std::min((right + 1) / 2, static_cast<uint32_t>(textureLevel.size.v[0]));
+                            bottom = std::min((bottom + 1) / 2, static_cast<uint32_t>(textureLevel.size.v[1]));
+                        }
+
+                        if (left >= right || top >= bottom)
+                        {
+                            break;
+                        }
+
+                        Region region = {
+                            static_cast<uint32_t>(level), left, top, right - left, bottom - top,
+                            static_cast<uint32_t>(uploadData.regionData.size())
+                        };
+
+                        uint32_t rowSize = region.width * 4;
+                        uploadData.regionData.resize(region.offset + rowSize * region.height);
+
+                        for (uint32_t row = 0; row < region.height; ++row)
+                        {
+                            memcpy(uploadData.regionData.data() + region.offset + row * rowSize,
+                                   data.data() + textureLevel.offset + (region.y + row) * textureLevel.pitch + region.x * 4,
+                                   rowSize);
+                        }
+
+                        uploadData.regions.push_back(region);
+                    }
+                }
+            }
 
+            dirtyRegions.clear();
             dirty = false;
         }
     } // namespace graphics
@@ -6,15 +6,20 @@
 #include <cstdint>
 #include <string>
 #include <vector>
+#include <atomic>
 #include "utils/Noncopyable.h"
+#include "utils/Types.h"
 #include "graphics/Resource.h"
+#include "graphics/PixelFormat.h"
 #include "math/Size2.h"
+#include "math/Rectangle.h"
 
 namespace ouzel
 {
     namespace graphics
     {
         class Renderer;
+        class Image;
 
         class Texture: public Resource, public Noncopyable
         {
@@ -32,47 +37,111 @@ namespace ouzel
             const std::string& getFilename() const { return filename; }
 
             virtual bool setData(const std::vector<uint8_t>& newData, const Size2& newSize);
+            // replaces a rectangle of a dynamic RGBA8 texture with tightly packed pixels, only the changed parts of the levels are uploaded
+            virtual bool setRegion(const Rectangle& newRegion, const std::vector<uint8_t>& newData);
 
             const Size2& getSize() const { return size; }
+            PixelFormat getPixelFormat() const { return pixelFormat; }
 
             bool isDynamic() const { return dynamic; }
 
+            // bytes of the levels that were last uploaded
+            uint64_t getMemorySize() const { return memorySize; }
+
+            // two step loading for worker threads: decodeFile touches only the decoded data,
+            // applyDecodedData must be called on the update thread after decodeFile has returned
+            bool decodeFile(const std::string& newFilename, bool newMipmaps = true);
+            bool applyDecodedData(bool newDynamic);
+
+            // draw commands use the placeholder until the texture's own data is applied
+            void setPlaceholder(const TexturePtr& newPlaceholder) { placeholder = newPlaceholder; }
+            const TexturePtr& getPlaceholder() const { return placeholder; }
+
+            // writes the image in the cooked format, which initFromFile and decodeFile load without decoding,
+            // the mip levels are generated and encoded (RGBA8, BC1 or BC3) ahead of time
+            static bool cook(const Image& image, PixelFormat newPixelFormat, bool newMipmaps, std::vector<uint8_t>& result);
+
         protected:
             Texture();
             virtual void update() override;
 
-            bool calculateData(const std::vector<uint8_t>& newData, const Size2& newSize);
-
+            // all levels of a texture are stored in one buffer, offset is the start of the level in it
             struct Level
             {
                 Size2 size;
                 uint32_t pitch;
-                std::vector<uint8_t> data;
+                uint32_t offset;
+            };
+
+            // a rectangle of one level, offset is the start of its pixels in Data::regionData (rows are width * 4 bytes)
+            struct Region
+            {
+                uint32_t level;
+                uint32_t x;
+                uint32_t y;
+                uint32_t width;
+                uint32_t height;
+                uint32_t offset;
             };
 
+            bool calculateData(const std::vector<uint8_t>& newData, const Size2& newSize);
+            static bool shouldGenerateMipMaps(const Size2& newSize);
+            static void calculateLevels(const std::vector<uint8_t>& newData, const Size2& newSize, bool generateMipMaps,
+                                        std::vector<Level>& newLevels, std::vector<uint8_t>& newLevelData);
+            // compressed images keep their own mip levels, or are decompressed if the renderer can't sample them
+            static bool calculateImageLevels(const Image& image, bool generateMipMaps, PixelFormat& newPixelFormat,
+                                             std::vector<Level>& newLevels, std::vector<uint8_t>& newLevelData);
+            static void copyImageLevels(const Image& image, uint32_t levelCount,
+                                        std::vector<Level>& newLevels, std::vector<uint8_t>& newLevelData);
+            static bool isCookedTexture(const std::vector<uint8_t>& fileData);
+            // the level offsets of a cooked texture point into the file data, which is moved to newLevelData
+            static bool calculateCookedLevels(std::vector<uint8_t>& fileData, bool newMipmaps, Size2& newSize, PixelFormat& newPixelFormat,
+                                              std::vector<Level>& newLevels, std::vector<uint8_t>& newLevelData);
+
             struct Data
             {
                 Size2 size;
+                PixelFormat pixelFormat = PixelFormat::RGBA8_UNORM;
                 bool dynamic = false;
                 bool mipmaps = false;
                 bool renderTarget = false;
                 bool dirty = false;
                 std::vector<Level> levels;
+                std::vector<uint8_t> data;
+                // partial updates of a texture whose levels were uploaded before, ignored when dirty is set
+                std::vector<Region> regions;
+                std::vector<uint8_t> regionData;
             };
 
             Data uploadData;
 
         private:
+            void setMemorySize(uint64_t newMemorySize);
+
+            std::atomic<uint64_t> memorySize;
+
             std::string filename;
             std::vector<Level> levels;
+            std::vector<uint8_t> data;
 
             Size2 size;
+            PixelFormat pixelFormat = PixelFormat::RGBA8_UNORM;
             bool dynamic = false;
             bool mipmaps = false;
             bool renderTarget = false;
             bool dirty = false;
             bool mipMapsGenerated = false;
+            // changed rectangles of level 0, dynamic textures keep their levels to update them
+            std::vector<Region> dirtyRegions;
+
+            TexturePtr placeholder;
 
+            std::string decodedFilename;
+            Size2 decodedSize;
+            PixelFormat decodedPixelFormat = PixelFormat::RGBA8_UNORM;
+            bool decodedMipMaps = false;
+            std::vector<Level> decodedLevels;
+            std::vector<uint8_t> decodedData;
         };
     } // namespace graphics
 } // namespace ouzel
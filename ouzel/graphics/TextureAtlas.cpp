@@ -0,0 +1,283 @@
+// Copyright (C) 2016 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#include <algorithm>
+#include <cstring>
+#include "TextureAtlas.h"
+#include "Image.h"
+#include "Texture.h"
+#include "Renderer.h"
+#include "core/Engine.h"
+#include "utils/Log.h"
+
+namespace ouzel
+{
+    namespace graphics
+    {
+        TextureAtlas::TextureAtlas()
+        {
+        }
+
+        void TextureAtlas::init(const Size2& newPageSize, uint32_t newMaxPages, const Size2& newMaxImageSize)
+        {
+            clear();
+
+            pageSize = newPageSize;
+            maxPages = newMaxPages;
+            maxImageSize = newMaxImageSize;
+        }
+
+        void TextureAtlas::clear()
+        {
+            entries.clear();
+            pages.clear();
+        }
+
+        bool TextureAtlas::getImage(const std::string& name, TexturePtr& texture, Rectangle& rectangle)
+        {
+            auto i = entries.find(name);
+
+            if (i == entries.end())
+            {
+                return false;
+            }
+
+            i->second.page->lastUse = ++useCounter;
+            texture = i->second.page->texture;
+            rectangle = i->second.rectangle;
+
+            return true;
+        }
+
+        bool TextureAtlas::addImage(const std::string& name, const Image& image, TexturePtr& texture, Rectangle& rectangle)
+        {
+            if (getImage(name, texture, rectangle))
+            {
+                return true;
+            }
+
+            // compressed images can't be copied into a page pixel by pixel
+            if (image.getPixelFormat() != PixelFormat::RGBA8_UNORM || maxPages == 0 ||
+                image.getSize().v[0] > maxImageSize.v[0] || image.getSize().v[1] > maxImageSize.v[1])
+            {
+                return false;
+            }
+
+            uint32_t imageWidth = static_cast<uint32_t>(image.getSize().v[0]);
+            uint32_t imageHeight = static_cast<uint32_t>(image.getSize().v[1]);
+            uint32_t width = imageWidth + PADDING * 2;
+            uint32_t height = imageHeight + PADDING * 2;
+
+            if (imageWidth == 0 || imageHeight == 0 ||
+                width > static_cast<uint32_t>(pageSize.v[0]) || height > static_cast<uint32_t>(pageSize.v[1]))
+            {
+                return false;
+            }
+
+            Page* page = nullptr;
+            size_t nodeIndex = 0;
+            uint32_t x = 0;
+            uint32_t y = 0;
+
+            for (const std::unique_ptr<Page>& currentPage : pages)
+            {
+                if (findPosition(*currentPage, width, height, nodeIndex, x, y))
+                {
+                    page = currentPage.get();
+                    break;
+                }
+            }
+
+            if (!page)
+            {
+                if (pages.size() >= maxPages)
+                {
+                    evictPage();
+                }
+
+                page = createPage();
+
+                if (!page || !findPosition(*page, width, height, nodeIndex, x, y))
+                {
+                    return false;
+                }
+            }
+
+            addSkylineLevel(*page, nodeIndex, x, y, width, height);
+
+            // copy the image and repeat its edge pixels in the padding, only this rectangle of the page is uploaded
+            uint32_t pitch = width * 4;
+            uint32_t imagePitch = imageWidth * 4;
+            const uint8_t* imageData = image.getData().data();
+            std::vector<uint8_t> regionData(pitch * height);
+
+            for (uint32_t row = 0; row < height; ++row)
+            {
+                uint32_t imageRow = std::min(std::max(row, PADDING) - PADDING, imageHeight - 1);
+                const uint8_t* src = imageData + imageRow * imagePitch;
+                uint8_t* dst = regionData.data() + row * pitch;
+
+                for (uint32_t column = 0; column < PADDING; ++column)
+                {
+                    memcpy(dst + column * 4, src, 4);
+                    memcpy(dst + (PADDING + imageWidth + column) * 4, src + imagePitch - 4, 4);
+                }
+
+                memcpy(dst + PADDING * 4, src, imagePitch);
+            }
+
+            if (!page->texture->setRegion(Rectangle(static_cast<float>(x), static_cast<float>(y),
+                                                    static_cast<float>(width), static_cast<float>(height)), regionData))
+            {
+                return false;
+            }
+
+            page->lastUse = ++useCounter;
+
+            Entry entry;
+            entry.page = page;
+            entry.rectangle = Rectangle(static_cast<float>(x + PADDING), static_cast<float>(y + PADDING),
+                                        static_cast<float>(imageWidth), static_cast<float>(imageHeight));
+            entries[name] = entry;
+
+            texture = page->texture;
+            rectangle = entry.rectangle;
+
+            return true;
+        }
+
+        bool TextureAtlas::findPosition(const Page& page, uint32_t width, uint32_t height, size_t& nodeIndex, uint32_t& x, uint32_t& y) const
+        {
+            uint32_t pageWidth = static_cast<uint32_t>(pageSize.v[0]);
+            uint32_t pageHeight = static_cast<uint32_t>(pageSize.v[1]);
+            uint32_t bestY = UINT32_MAX;
+            uint32_t bestWidth = UINT32_MAX;
+
+            // bottom-left rule: the lowest position, ties are broken by the narrowest segment
+            for (size_t i = 0; i < page.skyline.size(); ++i)
+            {
+                const Node& node = page.skyline[i];
+
+                if (node.x + width > pageWidth)
+                {
+                    break;
+                }
+
+                // the image rests on the highest segment it spans
+                uint32_t top = 0;
+                uint32_t spannedWidth = 0;
+
+                for (size_t j = i; spannedWidth < width; ++j)
+                {
+                    top = std::max(top, page.skyline[j].y);
+                    spannedWidth += page.skyline[j].width;
+                }
+
+                if (top + height <= pageHeight &&
+                    (top < bestY || (top == bestY && node.width < bestWidth)))
+                {
+                    bestY = top;
+                    bestWidth = node.width;
+                    nodeIndex = i;
+                    x = node.x;
+                    y = top;
+                }
+            }
+
+            return bestY != UINT32_MAX;
+        }
+
+        void TextureAtlas::addSkylineLevel(Page& page, size_t nodeIndex, uint32_t x, uint32_t y, uint32_t width, uint32_t height)
+        {
+            Node node = { x, y + height, width };
+            page.skyline.insert(page.skyline.begin() + static_cast<std::vector<Node>::difference_type>(nodeIndex), node);
+
+            // cut the segments below the new one
+            for (size_t i = nodeIndex + 1; i < page.skyline.size();)
+            {
+                Node& current = page.skyline[i];
+                uint32_t right = x + width;
+
+                if (current.x >= right)
+                {
+                    break;
+                }
+
+                uint32_t shrink = std::min(right - current.x, current.width);
+                current.x += shrink;
+                current.width -= shrink;
+
+                if (current.width == 0)
+                {
+                    page.skyline.erase(page.skyline.begin() + static_cast<std::vector<Node>::difference_type>(i));
+                }
+                else
+                {
+                    break;
+                }
+            }
+
+            // merge neighbouring segments at the same height
+            for (size_t i = 0; i + 1 < page.skyline.size();)
+            {
+                if (page.skyline[i].y == page.skyline[i + 1].y)
+                {
+                    page.skyline[i].width += page.skyline[i + 1].width;
+                    page.skyline.erase(page.skyline.begin() + static_cast<std::vector<Node>::difference_type>(i + 1));
+                }
+                else
+                {
+                    ++i;
+                }
+            }
+        }
+
+        TextureAtlas::Page* TextureAtlas::createPage()
+        {
+            std::unique_ptr<Page> page(new Page());
+            page->skyline.push_back({ 0, 0, static_cast<uint32_t>(pageSize.v[0]) });
+            page->lastUse = ++useCounter;
+
+            // mip levels would blend neighbouring images together, so pages are not mipmapped
+            std::vector<uint8_t> emptyData(static_cast<size_t>(pageSize.v[0]) * static_cast<size_t>(pageSize.v[1]) * 4);
+            page->texture = sharedEngine->getRenderer()->createTexture();
+
+            if (!page->texture->initFromBuffer(emptyData, pageSize, true, false))
+            {
+                Log(Log::Level::ERR) << "Failed to create texture atlas page";
+                return nullptr;
+            }
+
+            pages.push_back(std::move(page));
+
+            return pages.back().get();
+        }
+
+        void TextureAtlas::evictPage()
+        {
+            auto oldest = std::min_element(pages.begin(), pages.end(), [](const std::unique_ptr<Page>& a, const std::unique_ptr<Page>& b) {
+                return a->lastUse < b->lastUse;
+            });
+
+            if (oldest == pages.end())
+            {
+                return;
+            }
+
+            Page* page = oldest->get();
+
+            for (auto i = entries.begin(); i != entries.end();)
+            {
+                i = (i->second.page == page) ? entries.erase(i) : ++i;
+            }
+
+            // sprites that still use the page keep its texture alive, the atlas only releases its own reference
+            if (evictionCallback)
+            {
+                evictionCallback(page->texture);
+            }
+
+            pages.erase(oldest);
+        }
+    } // namespace graphics
+} // namespace ouzel
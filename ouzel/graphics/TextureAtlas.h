@@ -0,0 +1,80 @@
+// Copyright (C) 2016 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <unordered_map>
+#include "utils/Noncopyable.h"
+#include "utils/Types.h"
+#include "math/Rectangle.h"
+#include "math/Size2.h"
+
+namespace ouzel
+{
+    namespace graphics
+    {
+        class Image;
+
+        // packs images into shared texture pages at runtime with a skyline packer, so unrelated sprites can be batched
+        class TextureAtlas: public Noncopyable
+        {
+        public:
+            // every image is surrounded by its repeated edge pixels, so filtering doesn't sample the neighbouring images
+            static const uint32_t PADDING = 1;
+
+            TextureAtlas();
+
+            // images larger than maxImageSize are not packed, the least recently used page is evicted when maxPages are full
+            void init(const Size2& newPageSize, uint32_t newMaxPages, const Size2& newMaxImageSize);
+            void clear();
+
+            // texture and rectangle are the page and the image's rectangle in it in pixels
+            bool getImage(const std::string& name, TexturePtr& texture, Rectangle& rectangle);
+            bool addImage(const std::string& name, const Image& image, TexturePtr& texture, Rectangle& rectangle);
+
+            // called with the page's texture before it is evicted, images packed into it have to be added again
+            void setEvictionCallback(const std::function<void(const TexturePtr&)>& newEvictionCallback) { evictionCallback = newEvictionCallback; }
+
+        protected:
+            // the skyline is the top edge of the packed area, stored as horizontal segments from left to right
+            struct Node
+            {
+                uint32_t x;
+                uint32_t y;
+                uint32_t width;
+            };
+
+            struct Page
+            {
+                TexturePtr texture;
+                std::vector<Node> skyline;
+                uint32_t lastUse;
+            };
+
+            struct Entry
+            {
+                Page* page;
+                Rectangle rectangle;
+            };
+
+            bool findPosition(const Page& page, uint32_t width, uint32_t height, size_t& nodeIndex, uint32_t& x, uint32_t& y) const;
+            void addSkylineLevel(Page& page, size_t nodeIndex, uint32_t x, uint32_t y, uint32_t width, uint32_t height);
+            Page* createPage();
+            void evictPage();
+
+            Size2 pageSize;
+            uint32_t maxPages = 0;
+            Size2 maxImageSize;
+            uint32_t useCounter = 0;
+
+            std::vector<std::unique_ptr<Page>> pages;
+            std::unordered_map<std::string, Entry> entries;
+            std::function<void(const TexturePtr&)> evictionCallback;
+        };
+    } // namespace graphics
+} // namespace ouzel
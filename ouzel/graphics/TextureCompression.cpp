@@ -0,0 +1,703 @@
+// Copyright (C) 2016 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include "TextureCompression.h"
+
+namespace ouzel
+{
+    namespace graphics
+    {
+        // all supported compressed formats store 4x4 pixel blocks
+        static const uint32_t BLOCK_WIDTH = 4;
+        static const uint32_t BLOCK_HEIGHT = 4;
+
+        static const int32_t ETC1_MODIFIERS[8][2] = {
+            { 2, 8 }, { 5, 17 }, { 9, 29 }, { 13, 42 }, { 18, 60 }, { 24, 80 }, { 33, 106 }, { 47, 183 }
+        };
+
+        // 3 bit two's complement deltas of the differential mode
+        static const int32_t ETC1_DELTAS[8] = { 0, 1, 2, 3, -4, -3, -2, -1 };
+
+        static const int32_t ETC2_DISTANCES[8] = { 3, 6, 11, 16, 23, 32, 41, 64 };
+
+        static const int32_t EAC_MODIFIERS[16][8] = {
+            { -3, -6, -9, -15, 2, 5, 8, 14 },
+            { -3, -7, -10, -13, 2, 6, 9, 12 },
+            { -2, -5, -8, -13, 1, 4, 7, 12 },
+            { -2, -4, -6, -13, 1, 3, 5, 12 },
+            { -3, -6, -8, -12, 2, 5, 7, 11 },
+            { -3, -7, -9, -11, 2, 6, 8, 10 },
+            { -4, -7, -8, -11, 3, 6, 7, 10 },
+            { -3, -5, -8, -11, 2, 4, 7, 10 },
+            { -2, -6, -8, -10, 1, 5, 7, 9 },
+            { -2, -5, -8, -10, 1, 4, 7, 9 },
+            { -2, -4, -8, -10, 1, 3, 7, 9 },
+            { -2, -5, -7, -10, 1, 4, 6, 9 },
+            { -3, -4, -7, -10, 2, 3, 6, 9 },
+            { -1, -2, -3, -10, 0, 1, 2, 9 },
+            { -4, -6, -8, -9, 3, 5, 7, 8 },
+            { -3, -5, -7, -9, 2, 4, 6, 8 }
+        };
+
+        static uint32_t getBlockSize(PixelFormat pixelFormat)
+        {
+            switch (pixelFormat)
+            {
+                case PixelFormat::BC1_UNORM:
+                case PixelFormat::ETC2_RGB8_UNORM:
+                    return 8;
+                case PixelFormat::BC3_UNORM:
+                case PixelFormat::BC7_UNORM:
+                case PixelFormat::ETC2_RGBA8_UNORM:
+                    return 16;
+                default:
+                    return 0;
+            }
+        }
+
+        bool isCompressedPixelFormat(PixelFormat pixelFormat)
+        {
+            return getBlockSize(pixelFormat) > 0;
+        }
+
+        uint32_t getPixelFormatPitch(PixelFormat pixelFormat, uint32_t width)
+        {
+            if (pixelFormat == PixelFormat::RGBA8_UNORM)
+            {
+                return width * 4;
+            }
+
+            return ((width + BLOCK_WIDTH - 1) / BLOCK_WIDTH) * getBlockSize(pixelFormat);
+        }
+
+        uint32_t getPixelFormatSize(PixelFormat pixelFormat, uint32_t width, uint32_t height)
+        {
+            if (pixelFormat == PixelFormat::RGBA8_UNORM)
+            {
+                return width * height * 4;
+            }
+
+            return getPixelFormatPitch(pixelFormat, width) * ((height + BLOCK_HEIGHT - 1) / BLOCK_HEIGHT);
+        }
+
+        uint32_t getMaxLevelCount(uint32_t width, uint32_t height)
+        {
+            uint32_t levelCount = 1;
+
+            for (uint32_t size = std::max(width, height); size > 1; size >>= 1)
+            {
+                ++levelCount;
+            }
+
+            return levelCount;
+        }
+
+        static inline uint8_t clampColor(int32_t value)
+        {
+            return static_cast<uint8_t>(std::min(std::max(value, 0), 255));
+        }
+
+        static inline uint64_t readBigEndian64(const uint8_t* src)
+        {
+            uint64_t result = 0;
+
+            for (uint32_t i = 0; i < 8; ++i)
+            {
+                result = (result << 8) | src[i];
+            }
+
+            return result;
+        }
+
+        static inline uint32_t extend4(uint32_t value) { return (value << 4) | value; }
+        static inline uint32_t extend5(uint32_t value) { return (value << 3) | (value >> 2); }
+        static inline uint32_t extend6(uint32_t value) { return (value << 2) | (value >> 4); }
+        static inline uint32_t extend7(uint32_t value) { return (value << 1) | (value >> 6); }
+
+        // the blocks are decoded to 4x4 RGBA8 pixels, row by row
+
+        static void getBC1Colors(const uint32_t endpoints[2], bool fourColors, int32_t colors[4][4])
+        {
+            for (uint32_t i = 0; i < 2; ++i)
+            {
+                colors[i][0] = static_cast<int32_t>(extend5((endpoints[i] >> 11) & 0x1F));
+                colors[i][1] = static_cast<int32_t>(extend6((endpoints[i] >> 5) & 0x3F));
+                colors[i][2] = static_cast<int32_t>(extend5(endpoints[i] & 0x1F));
+                colors[i][3] = 255;
+            }
+
+            // BC3 color blocks always use four colors, BC1 has a transparent color when the first endpoint is not greater
+            if (fourColors || endpoints[0] > endpoints[1])
+            {
+                for (uint32_t c = 0; c < 3; ++c)
+                {
+                    colors[2][c] = (2 * colors[0][c] + colors[1][c] + 1) / 3;
+                    colors[3][c] = (colors[0][c] + 2 * colors[1][c] + 1) / 3;
+                }
+
+                colors[2][3] = 255;
+                colors[3][3] = 255;
+            }
+            else
+            {
+                for (uint32_t c = 0; c < 3; ++c)
+                {
+                    colors[2][c] = (colors[0][c] + colors[1][c] + 1) / 2;
+                    colors[3][c] = 0;
+                }
+
+                colors[2][3] = 255;
+                colors[3][3] = 0;
+            }
+        }
+
+        static void getBC3Alphas(int32_t alpha0, int32_t alpha1, int32_t alphas[8])
+        {
+            alphas[0] = alpha0;
+            alphas[1] = alpha1;
+
+            if (alphas[0] > alphas[1])
+            {
+                for (int32_t i = 1; i < 7; ++i)
+                {
+                    alphas[i + 1] = ((7 - i) * alphas[0] + i * alphas[1] + 3) / 7;
+                }
+            }
+            else
+            {
+                for (int32_t i = 1; i < 5; ++i)
+                {
+                    alphas[i + 1] = ((5 - i) * alphas[0] + i * alphas[1] + 2) / 5;
+                }
+
+                alphas[6] = 0;
+                alphas[7] = 255;
+            }
+        }
+
+        static void decodeBC1Block(const uint8_t* src, bool fourColors, uint8_t* dst)
+        {
+            uint32_t endpoints[2] = {
+                static_cast<uint32_t>(src[0] | (src[1] << 8)),
+                static_cast<uint32_t>(src[2] | (src[3] << 8))
+            };
+
+            int32_t colors[4][4];
+            getBC1Colors(endpoints, fourColors, colors);
+
+            uint32_t indices = static_cast<uint32_t>(src[4]) | (static_cast<uint32_t>(src[5]) << 8) |
+                               (static_cast<uint32_t>(src[6]) << 16) | (static_cast<uint32_t>(src[7]) << 24);
+
+            for (uint32_t i = 0; i < 16; ++i, indices >>= 2)
+            {
+                const int32_t* color = colors[indices & 0x03];
+
+                for (uint32_t c = 0; c < 4; ++c)
+                {
+                    dst[i * 4 + c] = static_cast<uint8_t>(color[c]);
+                }
+            }
+        }
+
+        static void decodeBC3AlphaBlock(const uint8_t* src, uint8_t* dst)
+        {
+            int32_t alphas[8];
+            getBC3Alphas(src[0], src[1], alphas);
+
+            uint64_t indices = 0;
+
+            for (uint32_t i = 0; i < 6; ++i)
+            {
+                indices |= static_cast<uint64_t>(src[2 + i]) << (8 * i);
+            }
+
+            for (uint32_t i = 0; i < 16; ++i, indices >>= 3)
+            {
+                dst[i * 4 + 3] = static_cast<uint8_t>(alphas[indices & 0x07]);
+            }
+        }
+
+        // ETC2 RGB blocks, including the T, H and planar modes that ETC2 added to ETC1, alpha is set to 255
+        static void decodeETC2Block(const uint8_t* src, uint8_t* dst)
+        {
+            uint64_t bits = readBigEndian64(src);
+
+            // pixels are stored column by column, pixel i has its index MSB in bit 16 + i and its LSB in bit i
+            uint32_t pixelIndices = static_cast<uint32_t>(bits);
+
+            // the ETC1 modes apply table modifiers to two base colors, the T and H modes pick one of four paint colors
+            int32_t paintColors[4][3];
+            bool baseColors = true;
+
+            if ((bits >> 33) & 0x01) // differential bit
+            {
+                int32_t red = static_cast<int32_t>((bits >> 59) & 0x1F);
+                int32_t green = static_cast<int32_t>((bits >> 51) & 0x1F);
+                int32_t blue = static_cast<int32_t>((bits >> 43) & 0x1F);
+
+                int32_t deltaRed = ETC1_DELTAS[(bits >> 56) & 0x07];
+                int32_t deltaGreen = ETC1_DELTAS[(bits >> 48) & 0x07];
+                int32_t deltaBlue = ETC1_DELTAS[(bits >> 40) & 0x07];
+
+                if (red + deltaRed < 0 || red + deltaRed > 31) // T mode
+                {
+                    int32_t color1[3] = {
+                        static_cast<int32_t>(extend4(static_cast<uint32_t>(((bits >> 57) & 0x0C) | ((bits >> 56) & 0x03)))),
+                        static_cast<int32_t>(extend4(static_cast<uint32_t>((bits >> 52) & 0x0F))),
+                        static_cast<int32_t>(extend4(static_cast<uint32_t>((bits >> 48) & 0x0F)))
+                    };
+                    int32_t color2[3] = {
+                        static_cast<int32_t>(extend4(static_cast<uint32_t>((bits >> 44) & 0x0F))),
+                        static_cast<int32_t>(extend4(static_cast<uint32_t>((bits >> 40) & 0x0F))),
+                        static_cast<int32_t>(extend4(static_cast<uint32_t>((bits >> 36) & 0x0F)))
+                    };
+                    int32_t distance = ETC2_DISTANCES[((bits >> 33) & 0x06) | ((bits >> 32) & 0x01)];
+
+                    for (uint32_t c = 0; c < 3; ++c)
+                    {
+                        paintColors[0][c] = color1[c];
+                        paintColors[1][c] = color2[c] + distance;
+                        paintColors[2][c] = color2[c];
+                        paintColors[3][c] = color2[c] - distance;
+                    }
+
+                    baseColors = false;
+                }
+                else if (green + deltaGreen < 0 || green + deltaGreen > 31) // H mode
+                {
+                    uint32_t color1[3] = {
+                        static_cast<uint32_t>((bits >> 59) & 0x0F),
+                        static_cast<uint32_t>(((bits >> 55) & 0x0E) | ((bits >> 52) & 0x01)),
+                        static_cast<uint32_t>(((bits >> 48) & 0x08) | ((bits >> 47) & 0x07))
+                    };
+                    uint32_t color2[3] = {
+                        static_cast<uint32_t>((bits >> 43) & 0x0F),
+                        static_cast<uint32_t>((bits >> 39) & 0x0F),
+                        static_cast<uint32_t>((bits >> 35) & 0x0F)
+                    };
+
+                    // the lowest bit of the distance index is implied by the order of the two base colors
+                    uint32_t value1 = (color1[0] << 8) | (color1[1] << 4) | color1[2];
+                    uint32_t value2 = (color2[0] << 8) | (color2[1] << 4) | color2[2];
+                    int32_t distance = ETC2_DISTANCES[((bits >> 32) & 0x04) | ((bits >> 31) & 0x02) | (value1 >= value2 ? 1 : 0)];
+
+                    for (uint32_t c = 0; c < 3; ++c)
+                    {
+                        paintColors[0][c] = static_cast<int32_t>(extend4(color1[c])) + distance;
+                        paintColors[1][c] = static_cast<int32_t>(extend4(color1[c])) - distance;
+                        paintColors[2][c] = static_cast<int32_t>(extend4(color2[c])) + distance;
+                        paintColors[3][c] = static_cast<int32_t>(extend4(color2[c])) - distance;
+                    }
+
+                    baseColors = false;
+                }
+                else if (blue + deltaBlue < 0 || blue + deltaBlue > 31) // planar mode
+                {
+                    int32_t origin[3] = {
+                        static_cast<int32_t>(extend6(static_cast<uint32_t>((bits >> 57) & 0x3F))),
+                        static_cast<int32_t>(extend7(static_cast<uint32_t>(((bits >> 50) & 0x40) | ((bits >> 49) & 0x3F)))),
+                        static_cast<int32_t>(extend6(static_cast<uint32_t>(((bits >> 43) & 0x20) | ((bits >> 40) & 0x18) | ((bits >> 39) & 0x07))))
+                    };
+                    int32_t horizontal[3] = {
+                        static_cast<int32_t>(extend6(static_cast<uint32_t>(((bits >> 33) & 0x3E) | ((bits >> 32) & 0x01)))),
+                        static_cast<int32_t>(extend7(static_cast<uint32_t>((bits >> 25) & 0x7F))),
+                        static_cast<int32_t>(extend6(static_cast<uint32_t>((bits >> 19) & 0x3F)))
+                    };
+                    int32_t vertical[3] = {
+                        static_cast<int32_t>(extend6(static_cast<uint32_t>((bits >> 13) & 0x3F))),
+                        static_cast<int32_t>(extend7(static_cast<uint32_t>((bits >> 6) & 0x7F))),
+                        static_cast<int32_t>(extend6(static_cast<uint32_t>(bits & 0x3F)))
+                    };
+
+                    for (int32_t y = 0; y < 4; ++y)
+                    {
+                        for (int32_t x = 0; x < 4; ++x)
+                        {
+                            uint8_t* pixel = dst + (y * 4 + x) * 4;
+
+                            for (uint32_t c = 0; c < 3; ++c)
+                            {
+                                // negative values are clamped to zero, so truncating instead of flooring them doesn't matter
+                                pixel[c] = clampColor((x * (horizontal[c] - origin[c]) + y * (vertical[c] - origin[c]) + 4 * origin[c] + 2) / 4);
+                            }
+
+                            pixel[3] = 255;
+                        }
+                    }
+
+                    return;
+                }
+                else
+                {
+                    paintColors[0][0] = static_cast<int32_t>(extend5(static_cast<uint32_t>(red)));
+                    paintColors[0][1] = static_cast<int32_t>(extend5(static_cast<uint32_t>(green)));
+                    paintColors[0][2] = static_cast<int32_t>(extend5(static_cast<uint32_t>(blue)));
+                    paintColors[1][0] = static_cast<int32_t>(extend5(static_cast<uint32_t>(red + deltaRed)));
+                    paintColors[1][1] = static_cast<int32_t>(extend5(static_cast<uint32_t>(green + deltaGreen)));
+                    paintColors[1][2] = static_cast<int32_t>(extend5(static_cast<uint32_t>(blue + deltaBlue)));
+                }
+            }
+            else
+            {
+                for (uint32_t c = 0; c < 3; ++c)
+                {
+                    paintColors[0][c] = static_cast<int32_t>(extend4(static_cast<uint32_t>((bits >> (60 - c * 8)) & 0x0F)));
+                    paintColors[1][c] = static_cast<int32_t>(extend4(static_cast<uint32_t>((bits >> (56 - c * 8)) & 0x0F)));
+                }
+            }
+
+            uint32_t tables[2] = {
+                static_cast<uint32_t>((bits >> 37) & 0x07),
+                static_cast<uint32_t>((bits >> 34) & 0x07)
+            };
+            bool flip = ((bits >> 32) & 0x01) != 0;
+
+            for (uint32_t i = 0; i < 16; ++i)
+            {
+                uint32_t x = i / 4;
+                uint32_t y = i % 4;
+                uint32_t index = ((pixelIndices >> (15 + i)) & 0x02) | ((pixelIndices >> i) & 0x01);
+
+                uint8_t* pixel = dst + (y * 4 + x) * 4;
+
+                if (baseColors)
+                {
+                    // two sub-blocks side by side, or on top of each other when flipped
+                    uint32_t subBlock = flip ? (y >= 2 ? 1 : 0) : (x >= 2 ? 1 : 0);
+                    int32_t modifier = ETC1_MODIFIERS[tables[subBlock]][index & 0x01];
+                    if (index & 0x02) modifier = -modifier;
+
+                    for (uint32_t c = 0; c < 3; ++c)
+                    {
+                        pixel[c] = clampColor(paintColors[subBlock][c] + modifier);
+                    }
+                }
+                else
+                {
+                    for (uint32_t c = 0; c < 3; ++c)
+                    {
+                        pixel[c] = clampColor(paintColors[index][c]);
+                    }
+                }
+
+                pixel[3] = 255;
+            }
+        }
+
+        static void decodeEACAlphaBlock(const uint8_t* src, uint8_t* dst)
+        {
+            uint64_t bits = readBigEndian64(src);
+
+            int32_t base = static_cast<int32_t>((bits >> 56) & 0xFF);
+            int32_t multiplier = static_cast<int32_t>((bits >> 52) & 0x0F);
+            const int32_t* modifiers = EAC_MODIFIERS[(bits >> 48) & 0x0F];
+
+            // 3 bit indices, column by column
+            for (uint32_t i = 0; i < 16; ++i)
+            {
+                uint32_t x = i / 4;
+                uint32_t y = i % 4;
+                uint32_t index = static_cast<uint32_t>((bits >> (45 - i * 3)) & 0x07);
+
+                dst[(y * 4 + x) * 4 + 3] = clampColor(base + modifiers[index] * multiplier);
+            }
+        }
+
+        bool decompressImage(PixelFormat pixelFormat, uint32_t width, uint32_t height,
+                             const uint8_t* src, std::vector<uint8_t>& dst)
+        {
+            switch (pixelFormat)
+            {
+                case PixelFormat::BC1_UNORM:
+                case PixelFormat::BC3_UNORM:
+                case PixelFormat::ETC2_RGB8_UNORM:
+                case PixelFormat::ETC2_RGBA8_UNORM:
+                    break;
+                default:
+                    return false;
+            }
+
+            uint32_t blockSize = getBlockSize(pixelFormat);
+            uint8_t block[BLOCK_WIDTH * BLOCK_HEIGHT * 4];
+
+            dst.resize(width * height * 4);
+
+            for (uint32_t blockY = 0; blockY < height; blockY += BLOCK_HEIGHT)
+            {
+                for (uint32_t blockX = 0; blockX < width; blockX += BLOCK_WIDTH, src += blockSize)
+                {
+                    switch (pixelFormat)
+                    {
+                        case PixelFormat::BC1_UNORM:
+                            decodeBC1Block(src, false, block);
+                            break;
+                        case PixelFormat::BC3_UNORM:
+                            decodeBC1Block(src + 8, true, block);
+                            decodeBC3AlphaBlock(src, block);
+                            break;
+                        case PixelFormat::ETC2_RGB8_UNORM:
+                            decodeETC2Block(src, block);
+                            break;
+                        case PixelFormat::ETC2_RGBA8_UNORM:
+                            decodeETC2Block(src + 8, block);
+                            decodeEACAlphaBlock(src, block);
+                            break;
+                        default:
+                            return false;
+                    }
+
+                    // blocks on the right and bottom edges can be partially outside of the image
+                    uint32_t columns = std::min(BLOCK_WIDTH, width - blockX);
+                    uint32_t rows = std::min(BLOCK_HEIGHT, height - blockY);
+
+                    for (uint32_t y = 0; y < rows; ++y)
+                    {
+                        memcpy(dst.data() + ((blockY + y) * width + blockX) * 4, block + y * BLOCK_WIDTH * 4, columns * 4);
+                    }
+                }
+            }
+
+            return true;
+        }
+
+        static inline uint32_t packColor565(const int32_t color[3])
+        {
+            return (static_cast<uint32_t>(color[0] * 31 + 127) / 255 << 11) |
+                   (static_cast<uint32_t>(color[1] * 63 + 127) / 255 << 5) |
+                   (static_cast<uint32_t>(color[2] * 31 + 127) / 255);
+        }
+
+        // the blocks are encoded from 4x4 RGBA8 pixels, row by row
+        // endpoints are the corners of the color bounding box along its main diagonal, inset to reduce the error at the ends
+
+        static void encodeBC1Block(const uint8_t* src, bool fourColors, uint8_t* dst)
+        {
+            // BC1 stores pixels with alpha below 128 as the transparent color of the three color mode
+            bool transparent = false;
+
+            int32_t minColor[3] = { 255, 255, 255 };
+            int32_t maxColor[3] = { 0, 0, 0 };
+            int32_t mean[3] = { 0, 0, 0 };
+            int32_t opaqueCount = 0;
+
+            for (uint32_t i = 0; i < 16; ++i)
+            {
+                const uint8_t* pixel = src + i * 4;
+
+                if (!fourColors && pixel[3] < 128)
+                {
+                    transparent = true;
+                    continue;
+                }
+
+                for (uint32_t c = 0; c < 3; ++c)
+                {
+                    minColor[c] = std::min(minColor[c], static_cast<int32_t>(pixel[c]));
+                    maxColor[c] = std::max(maxColor[c], static_cast<int32_t>(pixel[c]));
+                    mean[c] += pixel[c];
+                }
+
+                ++opaqueCount;
+            }
+
+            if (opaqueCount == 0)
+            {
+                // equal endpoints select the three color mode, all indices point to the transparent color
+                memset(dst, 0, 4);
+                memset(dst + 4, 0xFF, 4);
+                return;
+            }
+
+            uint32_t mainChannel = 0;
+
+            for (uint32_t c = 0; c < 3; ++c)
+            {
+                mean[c] /= opaqueCount;
+
+                if (maxColor[c] - minColor[c] > maxColor[mainChannel] - minColor[mainChannel])
+                {
+                    mainChannel = c;
+                }
+            }
+
+            // a channel that decreases while the main channel increases runs along the other diagonal of the box
+            for (uint32_t c = 0; c < 3; ++c)
+            {
+                if (c == mainChannel) continue;
+
+                int32_t covariance = 0;
+
+                for (uint32_t i = 0; i < 16; ++i)
+                {
+                    const uint8_t* pixel = src + i * 4;
+
+                    if (fourColors || pixel[3] >= 128)
+                    {
+                        covariance += (pixel[mainChannel] - mean[mainChannel]) * (pixel[c] - mean[c]);
+                    }
+                }
+
+                if (covariance < 0)
+                {
+                    std::swap(minColor[c], maxColor[c]);
+                }
+            }
+
+            for (uint32_t c = 0; c < 3; ++c)
+            {
+                int32_t inset = (maxColor[c] - minColor[c]) / 16;
+                maxColor[c] -= inset;
+                minColor[c] += inset;
+            }
+
+            uint32_t endpoints[2] = { packColor565(maxColor), packColor565(minColor) };
+
+            // the endpoint order selects the mode, four color mode needs the first endpoint to be greater
+            if ((!transparent && endpoints[0] < endpoints[1]) ||
+                (transparent && endpoints[0] > endpoints[1]))
+            {
+                std::swap(endpoints[0], endpoints[1]);
+            }
+
+            int32_t colors[4][4];
+            getBC1Colors(endpoints, fourColors, colors);
+            uint32_t colorCount = (fourColors || endpoints[0] > endpoints[1]) ? 4 : 3;
+
+            uint32_t indices = 0;
+
+            for (uint32_t i = 0; i < 16; ++i)
+            {
+                const uint8_t* pixel = src + i * 4;
+                uint32_t bestIndex = 3;
+
+                if (fourColors || pixel[3] >= 128)
+                {
+                    int32_t bestDistance = INT32_MAX;
+
+                    for (uint32_t index = 0; index < colorCount; ++index)
+                    {
+                        int32_t distance = 0;
+
+                        for (uint32_t c = 0; c < 3; ++c)
+                        {
+                            int32_t difference = colors[index][c] - pixel[c];
+                            distance += difference * difference;
+                        }
+
+                        if (distance < bestDistance)
+                        {
+                            bestDistance = distance;
+                            bestIndex = index;
+                        }
+                    }
+                }
+
+                indices |= bestIndex << (i * 2);
+            }
+
+            dst[0] = static_cast<uint8_t>(endpoints[0] & 0xFF);
+            dst[1] = static_cast<uint8_t>(endpoints[0] >> 8);
+            dst[2] = static_cast<uint8_t>(endpoints[1] & 0xFF);
+            dst[3] = static_cast<uint8_t>(endpoints[1] >> 8);
+            dst[4] = static_cast<uint8_t>(indices & 0xFF);
+            dst[5] = static_cast<uint8_t>((indices >> 8) & 0xFF);
+            dst[6] = static_cast<uint8_t>((indices >> 16) & 0xFF);
+            dst[7] = static_cast<uint8_t>(indices >> 24);
+        }
+
+        static void encodeBC3AlphaBlock(const uint8_t* src, uint8_t* dst)
+        {
+            int32_t minAlpha = 255;
+            int32_t maxAlpha = 0;
+
+            for (uint32_t i = 0; i < 16; ++i)
+            {
+                minAlpha = std::min(minAlpha, static_cast<int32_t>(src[i * 4 + 3]));
+                maxAlpha = std::max(maxAlpha, static_cast<int32_t>(src[i * 4 + 3]));
+            }
+
+            // the first endpoint is greater, so the block uses eight interpolated alphas
+            int32_t alphas[8];
+            getBC3Alphas(maxAlpha, minAlpha, alphas);
+
+            uint64_t indices = 0;
+
+            for (uint32_t i = 0; i < 16; ++i)
+            {
+                int32_t alpha = src[i * 4 + 3];
+                uint32_t bestIndex = 0;
+                int32_t bestDistance = INT32_MAX;
+
+                for (uint32_t index = 0; index < 8; ++index)
+                {
+                    int32_t distance = std::abs(alphas[index] - alpha);
+
+                    if (distance < bestDistance)
+                    {
+                        bestDistance = distance;
+                        bestIndex = index;
+                    }
+                }
+
+                indices |= static_cast<uint64_t>(bestIndex) << (i * 3);
+            }
+
+            dst[0] = static_cast<uint8_t>(maxAlpha);
+            dst[1] = static_cast<uint8_t>(minAlpha);
+
+            for (uint32_t i = 0; i < 6; ++i)
+            {
+                dst[2 + i] = static_cast<uint8_t>((indices >> (8 * i)) & 0xFF);
+            }
+        }
+
+        bool compressImage(PixelFormat pixelFormat, uint32_t width, uint32_t height,
+                           const uint8_t* src, std::vector<uint8_t>& dst)
+        {
+            if (pixelFormat != PixelFormat::BC1_UNORM &&
+                pixelFormat != PixelFormat::BC3_UNORM)
+            {
+                return false;
+            }
+
+            uint32_t blockSize = getBlockSize(pixelFormat);
+            uint8_t block[BLOCK_WIDTH * BLOCK_HEIGHT * 4];
+
+            dst.resize(getPixelFormatSize(pixelFormat, width, height));
+            uint8_t* blockData = dst.data();
+
+            for (uint32_t blockY = 0; blockY < height; blockY += BLOCK_HEIGHT)
+            {
+                for (uint32_t blockX = 0; blockX < width; blockX += BLOCK_WIDTH, blockData += blockSize)
+                {
+                    // the last row and column are repeated in blocks that are partially outside of the image
+                    for (uint32_t y = 0; y < BLOCK_HEIGHT; ++y)
+                    {
+                        for (uint32_t x = 0; x < BLOCK_WIDTH; ++x)
+                        {
+                            uint32_t srcX = std::min(blockX + x, width - 1);
+                            uint32_t srcY = std::min(blockY + y, height - 1);
+
+                            memcpy(block + (y * BLOCK_WIDTH + x) * 4, src + (srcY * width + srcX) * 4, 4);
+                        }
+                    }
+
+                    if (pixelFormat == PixelFormat::BC1_UNORM)
+                    {
+                        encodeBC1Block(block, false, blockData);
+                    }
+                    else
+                    {
+                        encodeBC3AlphaBlock(block, blockData);
+                        encodeBC1Block(block, true, blockData + 8);
+                    }
+                }
+            }
+
+            return true;
+        }
+    } // namespace graphics
+} // namespace ouzel
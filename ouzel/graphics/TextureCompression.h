@@ -0,0 +1,30 @@
+// Copyright (C) 2016 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "graphics/PixelFormat.h"
+
+namespace ouzel
+{
+    namespace graphics
+    {
+        bool isCompressedPixelFormat(PixelFormat pixelFormat);
+
+        // size of one row of pixels (or 4x4 blocks for compressed formats) and of a whole image, 0 for formats textures can't hold
+        uint32_t getPixelFormatPitch(PixelFormat pixelFormat, uint32_t width);
+        uint32_t getPixelFormatSize(PixelFormat pixelFormat, uint32_t width, uint32_t height);
+        // number of levels in a full mip chain, floor(log2(max(width, height))) + 1
+        uint32_t getMaxLevelCount(uint32_t width, uint32_t height);
+
+        // decodes BC1, BC3, ETC2 RGB8 and ETC2 RGBA8 (EAC alpha) images to RGBA8 for renderers that can't sample them
+        bool decompressImage(PixelFormat pixelFormat, uint32_t width, uint32_t height,
+                             const uint8_t* src, std::vector<uint8_t>& dst);
+
+        // encodes RGBA8 images to BC1 and BC3 for the texture cooker
+        bool compressImage(PixelFormat pixelFormat, uint32_t width, uint32_t height,
+                           const uint8_t* src, std::vector<uint8_t>& dst);
+    } // namespace graphics
+} // namespace ouzel
@@ -24,5 +24,16 @@ namespace ouzel
             position(aPosition), color(aColor), texCoord(aTexCoord)
         {
         }
+
+        VertexInstance::VertexInstance()
+        {
+        }
+
+        VertexInstance::VertexInstance(const Vector3& aPosition, const Vector2& aSize, float aRotation, Color aColor,
+                                       const Vector2& aTexCoordOffset, const Vector2& aTexCoordScale):
+            position(aPosition), size(aSize), rotation(aRotation), color(aColor),
+            texCoordOffset(aTexCoordOffset), texCoordScale(aTexCoordScale)
+        {
+        }
     } // namespace graphics
 } // namespace ouzel
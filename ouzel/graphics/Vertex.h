@@ -17,10 +17,20 @@ namespace ouzel
             VERTEX_COLOR = 0x02,
             VERTEX_NORMAL = 0x04,
             VERTEX_TEXCOORD0 = 0x08,
-            VERTEX_TEXCOORD1 = 0x10
+            VERTEX_TEXCOORD1 = 0x10,
+            // per-instance attributes
+            VERTEX_INSTANCE_POSITION = 0x20,
+            VERTEX_INSTANCE_SIZE = 0x40,
+            VERTEX_INSTANCE_ROTATION = 0x80,
+            VERTEX_INSTANCE_COLOR = 0x100,
+            VERTEX_INSTANCE_TEXCOORD_RECT = 0x200
         };
 
-        const uint32_t VERTEX_ATTRIBUTE_COUNT = 5;
+        const uint32_t VERTEX_ATTRIBUTE_COUNT = 10;
+        // attributes without the per-instance ones, devices without instancing might not support more
+        const uint32_t VERTEX_NON_INSTANCE_ATTRIBUTE_COUNT = 5;
+        const uint32_t VERTEX_INSTANCE_ATTRIBUTES = VERTEX_INSTANCE_POSITION | VERTEX_INSTANCE_SIZE |
+            VERTEX_INSTANCE_ROTATION | VERTEX_INSTANCE_COLOR | VERTEX_INSTANCE_TEXCOORD_RECT;
 
         class VertexPC
         {
@@ -46,5 +56,24 @@ namespace ouzel
             VertexPCT();
             VertexPCT(const Vector3& aPosition, Color aColor, const Vector2& aTexCoord);
         };
+
+        // per-instance data of a quad drawn with the instanced texture shader
+        class VertexInstance
+        {
+        public:
+            static const uint32_t ATTRIBUTES = VERTEX_INSTANCE_ATTRIBUTES;
+
+            Vector3 position; // center of the quad
+            Vector2 size;
+            float rotation = 0.0f; // in radians
+            Color color;
+            // texture coordinates of the unit quad are scaled and offset by these
+            Vector2 texCoordOffset;
+            Vector2 texCoordScale;
+
+            VertexInstance();
+            VertexInstance(const Vector3& aPosition, const Vector2& aSize, float aRotation, Color aColor,
+                           const Vector2& aTexCoordOffset, const Vector2& aTexCoordScale);
+        };
     } // namespace graphics
 } // namespace ouzel
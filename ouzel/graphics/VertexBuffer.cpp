@@ -9,18 +9,26 @@ namespace ouzel
 {
     namespace graphics
     {
-        VertexBuffer::VertexBuffer()
+        VertexBuffer::VertexBuffer():
+            memorySize(0), pendingData(nullptr), recycledData(nullptr)
         {
         }
 
         VertexBuffer::~VertexBuffer()
         {
+            setMemorySize(0);
+
+            delete pendingData.load();
+            delete recycledData.load();
         }
 
         void VertexBuffer::free()
         {
-            data.clear();
-            uploadData.data.clear();
+            setMemorySize(0);
+
+            // uploadData belongs to the render thread, so its data is released by committing an empty buffer
+            getStagingData().data.clear();
+            commitData(VERTEX_BUFFER_DIRTY);
         }
 
         bool VertexBuffer::init(bool newDynamic)
@@ -43,14 +51,20 @@ namespace ouzel
 
             updateVertexSize();
 
+            Data& staging = getStagingData();
+
             if (newVertices && vertexSize && vertexCount)
             {
-                data.assign(static_cast<const uint8_t*>(newVertices),
-                            static_cast<const uint8_t*>(newVertices) + vertexSize * vertexCount);
+                staging.data.assign(static_cast<const uint8_t*>(newVertices),
+                                    static_cast<const uint8_t*>(newVertices) + vertexSize * vertexCount);
+            }
+            else
+            {
+                // recycled staging data may still hold old contents
+                staging.data.clear();
             }
 
-            dirty = VERTEX_BUFFER_DIRTY | VERTEX_ATTRIBUTES_DIRTY;
-            sharedEngine->getRenderer()->scheduleUpdate(shared_from_this());
+            commitData(VERTEX_BUFFER_DIRTY | VERTEX_ATTRIBUTES_DIRTY);
 
             return true;
         }
@@ -64,11 +78,37 @@ namespace ouzel
 
             vertexCount = newVertexCount;
 
-            data.assign(static_cast<const uint8_t*>(newVertices),
-                        static_cast<const uint8_t*>(newVertices) + vertexSize * vertexCount);
+            // assign reuses the capacity of the recycled staging data
+            getStagingData().data.assign(static_cast<const uint8_t*>(newVertices),
+                                         static_cast<const uint8_t*>(newVertices) + vertexSize * vertexCount);
 
-            dirty |= VERTEX_BUFFER_DIRTY;
-            sharedEngine->getRenderer()->scheduleUpdate(shared_from_this());
+            commitData(VERTEX_BUFFER_DIRTY);
+
+            return true;
+        }
+
+        void* VertexBuffer::mapData(uint32_t newVertexCount)
+        {
+            if (!dynamic)
+            {
+                return nullptr;
+            }
+
+            vertexCount = newVertexCount;
+            Data& staging = getStagingData();
+            staging.data.resize(vertexSize * vertexCount);
+
+            return staging.data.data();
+        }
+
+        bool VertexBuffer::unmapData()
+        {
+            if (!dynamic)
+            {
+                return false;
+            }
+
+            commitData(VERTEX_BUFFER_DIRTY);
 
             return true;
         }
@@ -78,12 +118,59 @@ namespace ouzel
             vertexAttributes = newVertexAttributes;
             updateVertexSize();
 
-            dirty |= VERTEX_ATTRIBUTES_DIRTY;
-            sharedEngine->getRenderer()->scheduleUpdate(shared_from_this());
+            commitData(VERTEX_ATTRIBUTES_DIRTY);
 
             return true;
         }
 
+        void VertexBuffer::commitData(uint8_t newDirty)
+        {
+            getStagingData();
+
+            stagingData->vertexSize = vertexSize;
+            stagingData->vertexAttributes = vertexAttributes;
+            stagingData->dynamic = dynamic;
+            stagingData->dirty = newDirty;
+
+            // changes that the renderer hasn't taken yet are taken back and merged, update() only ever resets pendingData to null
+            std::unique_ptr<Data> previousData(pendingData.exchange(nullptr));
+
+            if (previousData)
+            {
+                if ((previousData->dirty & VERTEX_BUFFER_DIRTY) && !(newDirty & VERTEX_BUFFER_DIRTY))
+                {
+                    stagingData->data.swap(previousData->data);
+                }
+
+                stagingData->dirty |= previousData->dirty;
+            }
+
+            pendingData = stagingData.release();
+
+            // only one spare buffer is kept, so a dynamic buffer holds its data at most twice
+            if (previousData)
+            {
+                delete recycledData.exchange(previousData.release());
+            }
+
+            sharedEngine->getRenderer()->scheduleUpdate(shared_from_this());
+        }
+
+        VertexBuffer::Data& VertexBuffer::getStagingData()
+        {
+            if (!stagingData)
+            {
+                stagingData.reset(recycledData.exchange(nullptr));
+
+                if (!stagingData)
+                {
+                    stagingData.reset(new Data());
+                }
+            }
+
+            return *stagingData;
+        }
+
         void VertexBuffer::updateVertexSize()
         {
             vertexSize = 0;
@@ -112,18 +199,63 @@ namespace ouzel
             {
                 vertexSize += 2 * sizeof(float);
             }
+
+            if (vertexAttributes & VERTEX_INSTANCE_POSITION)
+            {
+                vertexSize += 3 * sizeof(float);
+            }
+
+            if (vertexAttributes & VERTEX_INSTANCE_SIZE)
+            {
+                vertexSize += 2 * sizeof(float);
+            }
+
+            if (vertexAttributes & VERTEX_INSTANCE_ROTATION)
+            {
+                vertexSize += sizeof(float);
+            }
+
+            if (vertexAttributes & VERTEX_INSTANCE_COLOR)
+            {
+                vertexSize += 4 * sizeof(uint8_t);
+            }
+
+            if (vertexAttributes & VERTEX_INSTANCE_TEXCOORD_RECT)
+            {
+                vertexSize += 4 * sizeof(float);
+            }
+        }
+
+        void VertexBuffer::setMemorySize(uint64_t newMemorySize)
+        {
+            uint64_t oldMemorySize = memorySize.exchange(newMemorySize);
+
+            if (newMemorySize != oldMemorySize)
+            {
+                sharedEngine->getRenderer()->vertexBufferMemory += newMemorySize - oldMemorySize;
+            }
         }
 
         void VertexBuffer::update()
         {
-            uploadData.vertexSize = vertexSize;
-            uploadData.vertexAttributes = vertexAttributes;
-            uploadData.dynamic = dynamic;
-            uploadData.dirty = dirty;
+            std::unique_ptr<Data> newData(pendingData.exchange(nullptr));
+
+            if (newData)
+            {
+                uploadData.vertexSize = newData->vertexSize;
+                uploadData.vertexAttributes = newData->vertexAttributes;
+                uploadData.dynamic = newData->dynamic;
+                uploadData.dirty = newData->dirty;
 
-            uploadData.data = std::move(data);
+                // the data of a commit without VERTEX_BUFFER_DIRTY is whatever the recycled buffer held
+                if (uploadData.dirty & VERTEX_BUFFER_DIRTY)
+                {
+                    uploadData.data.swap(newData->data);
+                    setMemorySize(uploadData.data.size());
+                }
 
-            dirty = 0;
+                delete recycledData.exchange(newData.release());
+            }
         }
     } // namespace graphics
 } // namespace ouzel
@@ -4,6 +4,8 @@
 #pragma once
 
 #include <vector>
+#include <memory>
+#include <atomic>
 #include "utils/Noncopyable.h"
 #include "graphics/Resource.h"
 
@@ -31,6 +33,10 @@ namespace ouzel
             uint32_t getVertexAttributes() const { return vertexAttributes; }
 
             virtual bool setData(const void* newVertices, uint32_t newVertexCount);
+            // returns memory for newVertexCount vertices that unmapData hands to the renderer without copying,
+            // its previous contents are undefined, so all the vertices have to be written
+            void* mapData(uint32_t newVertexCount);
+            bool unmapData();
 
         protected:
             VertexBuffer();
@@ -55,16 +61,25 @@ namespace ouzel
             Data uploadData;
 
         private:
+            void setMemorySize(uint64_t newMemorySize);
+            void commitData(uint8_t newDirty);
+            Data& getStagingData();
+
+            std::atomic<uint64_t> memorySize;
+
             uint32_t vertexCount = 0;
             uint32_t vertexSize = 0;
 
             uint32_t vertexAttributes = 0;
 
-            std::vector<uint8_t> data;
-
             bool dynamic = true;
 
-            uint8_t dirty = 0;
+            // the changes are written to stagingData and committed to pendingData, from where update() swaps them with uploadData,
+            // the previous upload data is recycled as the next staging data, so the buffers are passed around without copies or locks
+            // and a dynamic buffer allocates nothing in steady state
+            std::unique_ptr<Data> stagingData;
+            std::atomic<Data*> pendingData;
+            std::atomic<Data*> recycledData;
         };
     } // namespace graphics
 } // namespace ouzel
@@ -1,6 +1,7 @@
 // Copyright (C) 2016 Elviss Strazdins
 // This file is part of the Ouzel engine.
 
+#include <algorithm>
 #include "RendererD3D11.h"
 #include "core/Cache.h"
 #include "core/Engine.h"
@@ -15,14 +16,21 @@
 #include "TextureVSD3D11.h"
 #include "ColorPSD3D11.h"
 #include "ColorVSD3D11.h"
+#include "TextureInstancedVSD3D11.h"
 #include "BlendStateD3D11.h"
 #include "core/windows/WindowWin.h"
-#include "stb_image_write.h"
 
 namespace ouzel
 {
     namespace graphics
     {
+        static const UINT CONSTANT_BUFFER_ALIGNMENT = 256;
+
+        static inline UINT alignConstantBufferSize(UINT size)
+        {
+            return ((size + CONSTANT_BUFFER_ALIGNMENT - 1) / CONSTANT_BUFFER_ALIGNMENT) * CONSTANT_BUFFER_ALIGNMENT;
+        }
+
         RendererD3D11::RendererD3D11():
             Renderer(Driver::DIRECT3D11), dirty(false)
         {
@@ -36,6 +44,43 @@ namespace ouzel
 
         RendererD3D11::~RendererD3D11()
         {
+            // the staging textures of the last frames still hold screenshots, save them from the oldest one
+            if (context)
+            {
+                for (uint32_t i = 0; i < SCREENSHOT_TEXTURE_COUNT; ++i)
+                {
+                    uint32_t index = (screenshotTextureIndex + i) % SCREENSHOT_TEXTURE_COUNT;
+
+                    if (screenshotTextures[index].pending)
+                    {
+                        readScreenshotTexture(index);
+                    }
+                }
+            }
+
+            for (ScreenshotTexture& screenshotTexture : screenshotTextures)
+            {
+                if (screenshotTexture.texture)
+                {
+                    screenshotTexture.texture->Release();
+                }
+            }
+
+            if (resolveTexture)
+            {
+                resolveTexture->Release();
+            }
+
+            if (constantBuffer)
+            {
+                constantBuffer->Release();
+            }
+
+            if (context1)
+            {
+                context1->Release();
+            }
+
             if (depthStencilState)
             {
                 depthStencilState->Release();
@@ -73,12 +118,31 @@ namespace ouzel
             {
                 adapter->Release();
             }
+
+            if (compilerModule)
+            {
+                FreeLibrary(compilerModule);
+            }
         }
 
         void RendererD3D11::free()
         {
             Renderer::free();
 
+            if (constantBuffer)
+            {
+                constantBuffer->Release();
+                constantBuffer = nullptr;
+            }
+
+            constantBufferSize = 0;
+
+            if (context1)
+            {
+                context1->Release();
+                context1 = nullptr;
+            }
+
             if (depthStencilState)
             {
                 depthStencilState->Release();
@@ -123,6 +187,14 @@ namespace ouzel
                 adapter->Release();
                 adapter = nullptr;
             }
+
+            if (compilerModule)
+            {
+                FreeLibrary(compilerModule);
+                compilerModule = nullptr;
+            }
+
+            compileFunction = nullptr;
         }
 
         bool RendererD3D11::init(Window* newWindow,
@@ -169,6 +241,29 @@ namespace ouzel
                 npotTexturesSupported = false;
             }
 
+            // BC1 and BC3 are supported on every feature level, BC7 needs Direct3D 11 hardware
+            bcTexturesSupported = true;
+            bc7TexturesSupported = device->GetFeatureLevel() >= D3D_FEATURE_LEVEL_11_0;
+
+            // built-in shaders are precompiled with fxc, only the ones that are compiled at runtime need the compiler library
+            compilerModule = LoadLibraryA(D3DCOMPILER_DLL_A);
+
+            if (compilerModule)
+            {
+                compileFunction = reinterpret_cast<pD3DCompile>(GetProcAddress(compilerModule, "D3DCompile"));
+            }
+
+            // Direct3D 11.1 can bind ranges of a single constant buffer, so all the constants of a frame are uploaded at once
+            D3D11_FEATURE_DATA_D3D11_OPTIONS options;
+            if (SUCCEEDED(device->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options))) &&
+                options.ConstantBufferOffsetting)
+            {
+                if (FAILED(context->QueryInterface(IID_ID3D11DeviceContext1, (void**)&context1)))
+                {
+                    context1 = nullptr;
+                }
+            }
+
             IDXGIDevice* dxgiDevice;
             IDXGIFactory* factory;
 
@@ -373,6 +468,22 @@ namespace ouzel
 
             sharedEngine->getCache()->setShader(SHADER_TEXTURE, textureShader);
 
+            // per-instance vertex data needs feature level 9_3
+            if (compileFunction && device->GetFeatureLevel() >= D3D_FEATURE_LEVEL_9_3)
+            {
+                ShaderPtr textureInstancedShader = createShader();
+                textureInstancedShader->initFromBuffers(std::vector<uint8_t>(std::begin(TEXTURE_PIXEL_SHADER_D3D11), std::end(TEXTURE_PIXEL_SHADER_D3D11)),
+                                                        std::vector<uint8_t>(std::begin(TextureInstancedVS_hlsl), std::end(TextureInstancedVS_hlsl)),
+                                                        VertexPCT::ATTRIBUTES | VertexInstance::ATTRIBUTES,
+                                                        {{ "color", 4 * sizeof(float) }},
+                                                        {{ "modelViewProj", sizeof(Matrix4) }});
+
+                sharedEngine->getCache()->setShader(SHADER_TEXTURE_INSTANCED, textureInstancedShader);
+
+                instancedShader = textureInstancedShader;
+                instancingSupported = true;
+            }
+
             ShaderPtr colorShader = createShader();
             colorShader->initFromBuffers(std::vector<uint8_t>(std::begin(COLOR_PIXEL_SHADER_D3D11), std::end(COLOR_PIXEL_SHADER_D3D11)),
                                          std::vector<uint8_t>(std::begin(COLOR_VERTEX_SHADER_D3D11), std::end(COLOR_VERTEX_SHADER_D3D11)),
@@ -498,7 +609,10 @@ namespace ouzel
                 return false;
             }
 
-            std::vector<float> shaderData;
+            if (!uploadShaderConstants())
+            {
+                return false;
+            }
 
             D3D11_VIEWPORT viewport;
 
@@ -522,8 +636,10 @@ namespace ouzel
                     context->ClearRenderTargetView(renderTargetView, frameBufferClearColor);
                 }
             }
-            else for (const DrawCommand& drawCommand : drawQueue)
+            else for (size_t drawIndex = 0; drawIndex < drawQueue.size(); ++drawIndex)
             {
+                const DrawCommand& drawCommand = drawQueue[drawIndex];
+
                 // render target
                 ID3D11RenderTargetView* newRenderTargetView = nullptr;
                 const float* newClearColor;
@@ -615,66 +731,93 @@ namespace ouzel
                 // pixel shader constants
                 const std::vector<ShaderD3D11::Location>& pixelShaderConstantLocations = shaderD3D11->getPixelShaderConstantLocations();
 
-                if (drawCommand.pixelShaderConstants.size() > pixelShaderConstantLocations.size())
+                if (drawCommand.pixelShaderConstantCount > pixelShaderConstantLocations.size())
                 {
                     Log(Log::Level::ERR) << "Invalid pixel shader constant size";
                     return false;
                 }
 
-                shaderData.clear();
+                // constants of a draw command are stored contiguously, so they can be uploaded without copying
+                uint32_t pixelShaderDataSize = 0;
 
-                for (size_t i = 0; i < drawCommand.pixelShaderConstants.size(); ++i)
+                for (uint32_t i = 0; i < drawCommand.pixelShaderConstantCount; ++i)
                 {
                     const ShaderD3D11::Location& pixelShaderConstantLocation = pixelShaderConstantLocations[i];
-                    const std::vector<float>& pixelShaderConstant = drawCommand.pixelShaderConstants[i];
+                    const ShaderConstantRange& pixelShaderConstant = shaderConstants[drawCommand.pixelShaderConstantIndex + i];
 
-                    if (sizeof(float) * pixelShaderConstant.size() != pixelShaderConstantLocation.size)
+                    if (sizeof(float) * pixelShaderConstant.size != pixelShaderConstantLocation.size)
                     {
                         Log(Log::Level::ERR) << "Invalid pixel shader constant size";
                         return false;
                     }
 
-                    shaderData.insert(shaderData.end(), pixelShaderConstant.begin(), pixelShaderConstant.end());
+                    pixelShaderDataSize += pixelShaderConstant.size;
+                }
+
+                if (context1)
+                {
+                    // offsets and sizes are in 16-byte constants and must be multiples of 16 constants
+                    UINT firstConstant = pixelShaderConstantOffsets[drawIndex] / 16;
+                    UINT numConstants = alignConstantBufferSize(shaderD3D11->getPixelShaderConstantSize()) / 16;
+                    context1->PSSetConstantBuffers1(0, 1, &constantBuffer, &firstConstant, &numConstants);
                 }
+                else
+                {
+                    const float* pixelShaderData = drawCommand.pixelShaderConstantCount ?
+                        shaderConstantData.data() + shaderConstants[drawCommand.pixelShaderConstantIndex].offset : nullptr;
 
-                shaderD3D11->uploadBuffer(shaderD3D11->getPixelShaderConstantBuffer(),
-                                          shaderData.data(),
-                                          static_cast<uint32_t>(sizeof(float) * shaderData.size()));
+                    shaderD3D11->uploadBuffer(shaderD3D11->getPixelShaderConstantBuffer(),
+                                              pixelShaderData,
+                                              static_cast<uint32_t>(sizeof(float) * pixelShaderDataSize));
 
-                ID3D11Buffer* pixelShaderConstantBuffers[1] = { shaderD3D11->getPixelShaderConstantBuffer() };
-                context->PSSetConstantBuffers(0, 1, pixelShaderConstantBuffers);
+                    ID3D11Buffer* pixelShaderConstantBuffers[1] = { shaderD3D11->getPixelShaderConstantBuffer() };
+                    context->PSSetConstantBuffers(0, 1, pixelShaderConstantBuffers);
+                }
 
                 // vertex shader constants
                 const std::vector<ShaderD3D11::Location>& vertexShaderConstantLocations = shaderD3D11->getVertexShaderConstantLocations();
 
-                if (drawCommand.vertexShaderConstants.size() > vertexShaderConstantLocations.size())
+                if (drawCommand.vertexShaderConstantCount > vertexShaderConstantLocations.size())
                 {
                     Log(Log::Level::ERR) << "Invalid vertex shader constant size";
                     return false;
                 }
 
-                shaderData.clear();
+                // constants of a draw command are stored contiguously, so they can be uploaded without copying
+                uint32_t vertexShaderDataSize = 0;
 
-                for (size_t i = 0; i < drawCommand.vertexShaderConstants.size(); ++i)
+                for (uint32_t i = 0; i < drawCommand.vertexShaderConstantCount; ++i)
                 {
                     const ShaderD3D11::Location& vertexShaderConstantLocation = vertexShaderConstantLocations[i];
-                    const std::vector<float>& vertexShaderConstant = drawCommand.vertexShaderConstants[i];
+                    const ShaderConstantRange& vertexShaderConstant = shaderConstants[drawCommand.vertexShaderConstantIndex + i];
 
-                    if (sizeof(float) * vertexShaderConstant.size() != vertexShaderConstantLocation.size)
+                    if (sizeof(float) * vertexShaderConstant.size != vertexShaderConstantLocation.size)
                     {
                         Log(Log::Level::ERR) << "Invalid pixel shader constant size";
                         return false;
                     }
 
-                    shaderData.insert(shaderData.end(), vertexShaderConstant.begin(), vertexShaderConstant.end());
+                    vertexShaderDataSize += vertexShaderConstant.size;
+                }
+
+                if (context1)
+                {
+                    UINT firstConstant = vertexShaderConstantOffsets[drawIndex] / 16;
+                    UINT numConstants = alignConstantBufferSize(shaderD3D11->getVertexShaderConstantSize()) / 16;
+                    context1->VSSetConstantBuffers1(0, 1, &constantBuffer, &firstConstant, &numConstants);
                 }
+                else
+                {
+                    const float* vertexShaderData = drawCommand.vertexShaderConstantCount ?
+                        shaderConstantData.data() + shaderConstants[drawCommand.vertexShaderConstantIndex].offset : nullptr;
 
-                shaderD3D11->uploadBuffer(shaderD3D11->getVertexShaderConstantBuffer(),
-                                          shaderData.data(),
-                                          static_cast<uint32_t>(sizeof(float) * shaderData.size()));
+                    shaderD3D11->uploadBuffer(shaderD3D11->getVertexShaderConstantBuffer(),
+                                              vertexShaderData,
+                                              static_cast<uint32_t>(sizeof(float) * vertexShaderDataSize));
 
-                ID3D11Buffer* vertexShaderConstantBuffers[1] = { shaderD3D11->getVertexShaderConstantBuffer() };
-                context->VSSetConstantBuffers(0, 1, vertexShaderConstantBuffers);
+                    ID3D11Buffer* vertexShaderConstantBuffers[1] = { shaderD3D11->getVertexShaderConstantBuffer() };
+                    context->VSSetConstantBuffers(0, 1, vertexShaderConstantBuffers);
+                }
 
                 // blend state
                 std::shared_ptr<BlendStateD3D11> blendStateD3D11 = std::static_pointer_cast<BlendStateD3D11>(drawCommand.blendState);
@@ -692,12 +835,7 @@ namespace ouzel
                 // textures
                 for (uint32_t layer = 0; layer < Texture::LAYERS; ++layer)
                 {
-                    std::shared_ptr<TextureD3D11> textureD3D11;
-
-                    if (drawCommand.textures.size() > layer)
-                    {
-                        textureD3D11 = std::static_pointer_cast<TextureD3D11>(drawCommand.textures[layer]);
-                    }
+                    TextureD3D11* textureD3D11 = static_cast<TextureD3D11*>(drawCommand.textures[layer].get());
 
                     if (textureD3D11)
                     {
@@ -746,10 +884,23 @@ namespace ouzel
                     continue;
                 }
 
-                ID3D11Buffer* buffers[] = { vertexBufferD3D11->getBuffer() };
-                UINT strides[] = { vertexBufferD3D11->getVertexSize() };
-                UINT offsets[] = { 0 };
-                context->IASetVertexBuffers(0, 1, buffers, strides, offsets);
+                std::shared_ptr<VertexBufferD3D11> instanceBufferD3D11;
+
+                if (drawCommand.instanceCount)
+                {
+                    instanceBufferD3D11 = std::static_pointer_cast<VertexBufferD3D11>(meshBufferD3D11->getInstanceBuffer());
+
+                    if (!instanceBufferD3D11 || !instanceBufferD3D11->getBuffer())
+                    {
+                        continue;
+                    }
+                }
+
+                // instance data is read from the second slot
+                ID3D11Buffer* buffers[] = { vertexBufferD3D11->getBuffer(), instanceBufferD3D11 ? instanceBufferD3D11->getBuffer() : nullptr };
+                UINT strides[] = { vertexBufferD3D11->getVertexSize(), instanceBufferD3D11 ? instanceBufferD3D11->getVertexSize() : 0 };
+                UINT offsets[] = { 0, 0 };
+                context->IASetVertexBuffers(0, instanceBufferD3D11 ? 2 : 1, buffers, strides, offsets);
                 context->IASetIndexBuffer(indexBufferD3D11->getBuffer(), indexBufferD3D11->getFormat(), 0);
 
                 D3D_PRIMITIVE_TOPOLOGY topology;
@@ -766,7 +917,14 @@ namespace ouzel
 
                 context->IASetPrimitiveTopology(topology);
 
-                context->DrawIndexed(drawCommand.indexCount, drawCommand.startIndex, 0);
+                if (drawCommand.instanceCount)
+                {
+                    context->DrawIndexedInstanced(drawCommand.indexCount, drawCommand.instanceCount, drawCommand.startIndex, 0, drawCommand.startInstance);
+                }
+                else
+                {
+                    context->DrawIndexed(drawCommand.indexCount, drawCommand.startIndex, 0);
+                }
             }
 
             swapChain->Present(swapInterval, 0);
@@ -893,32 +1051,154 @@ namespace ouzel
             return meshBuffer;
         }
 
-        bool RendererD3D11::saveScreenshots()
+        static UINT packConstants(std::vector<uint8_t>& buffer, const float* data, uint32_t dataSize, uint32_t constantSize)
+        {
+            UINT offset = static_cast<UINT>(buffer.size());
+            buffer.resize(offset + alignConstantBufferSize(constantSize));
+
+            if (data)
+            {
+                uint32_t size = std::min(dataSize, constantSize);
+                std::copy(reinterpret_cast<const uint8_t*>(data),
+                          reinterpret_cast<const uint8_t*>(data) + size,
+                          buffer.begin() + offset);
+            }
+
+            return offset;
+        }
+
+        bool RendererD3D11::uploadShaderConstants()
         {
-            for (;;)
+            if (!context1)
+            {
+                return true;
+            }
+
+            constantBufferData.clear();
+            pixelShaderConstantOffsets.resize(drawQueue.size());
+            vertexShaderConstantOffsets.resize(drawQueue.size());
+
+            for (size_t i = 0; i < drawQueue.size(); ++i)
             {
-                std::string filename;
+                const DrawCommand& drawCommand = drawQueue[i];
+                ShaderD3D11* shaderD3D11 = static_cast<ShaderD3D11*>(drawCommand.shader.get());
 
+                if (!shaderD3D11)
                 {
-                    std::lock_guard<std::mutex> lock(screenshotMutex);
+                    continue;
+                }
+
+                // constants of a draw command are stored contiguously
+                uint32_t pixelShaderDataSize = 0;
+                for (uint32_t c = 0; c < drawCommand.pixelShaderConstantCount; ++c)
+                {
+                    pixelShaderDataSize += shaderConstants[drawCommand.pixelShaderConstantIndex + c].size;
+                }
 
-                    if (screenshotQueue.empty()) break;
+                pixelShaderConstantOffsets[i] = packConstants(constantBufferData,
+                                                              drawCommand.pixelShaderConstantCount ? shaderConstantData.data() + shaderConstants[drawCommand.pixelShaderConstantIndex].offset : nullptr,
+                                                              static_cast<uint32_t>(sizeof(float) * pixelShaderDataSize),
+                                                              shaderD3D11->getPixelShaderConstantSize());
 
-                    filename = screenshotQueue.front();
-                    screenshotQueue.pop();
+                uint32_t vertexShaderDataSize = 0;
+                for (uint32_t c = 0; c < drawCommand.vertexShaderConstantCount; ++c)
+                {
+                    vertexShaderDataSize += shaderConstants[drawCommand.vertexShaderConstantIndex + c].size;
                 }
 
-                ID3D11Texture2D* backBufferTexture;
-                HRESULT hr = backBuffer->QueryInterface(IID_ID3D11Texture2D, reinterpret_cast<void**>(&backBufferTexture));
+                vertexShaderConstantOffsets[i] = packConstants(constantBufferData,
+                                                               drawCommand.vertexShaderConstantCount ? shaderConstantData.data() + shaderConstants[drawCommand.vertexShaderConstantIndex].offset : nullptr,
+                                                               static_cast<uint32_t>(sizeof(float) * vertexShaderDataSize),
+                                                               shaderD3D11->getVertexShaderConstantSize());
+            }
+
+            if (constantBufferData.empty())
+            {
+                return true;
+            }
 
+            if (constantBufferData.size() > constantBufferSize)
+            {
+                if (constantBuffer) constantBuffer->Release();
+                constantBuffer = nullptr;
+
+                // grow in steps to avoid recreating the buffer every frame
+                constantBufferSize = static_cast<UINT>(constantBufferData.size() * 2);
+
+                D3D11_BUFFER_DESC constantBufferDesc;
+                memset(&constantBufferDesc, 0, sizeof(constantBufferDesc));
+
+                constantBufferDesc.ByteWidth = constantBufferSize;
+                constantBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+                constantBufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+                constantBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+
+                HRESULT hr = device->CreateBuffer(&constantBufferDesc, nullptr, &constantBuffer);
                 if (FAILED(hr))
                 {
-                    Log(Log::Level::ERR) << "Failed to get Direct3D 11 back buffer texture";
+                    constantBufferSize = 0;
+                    Log(Log::Level::ERR) << "Failed to create Direct3D 11 constant buffer";
                     return false;
                 }
+            }
+
+            D3D11_MAPPED_SUBRESOURCE mappedSubresource;
+            HRESULT hr = context->Map(constantBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedSubresource);
+            if (FAILED(hr))
+            {
+                Log(Log::Level::ERR) << "Failed to lock Direct3D 11 buffer";
+                return false;
+            }
+
+            std::copy(constantBufferData.begin(), constantBufferData.end(), static_cast<uint8_t*>(mappedSubresource.pData));
 
-                D3D11_TEXTURE2D_DESC backBufferDesc;
-                backBufferTexture->GetDesc(&backBufferDesc);
+            context->Unmap(constantBuffer, 0);
+
+            return true;
+        }
+
+        bool RendererD3D11::saveScreenshots()
+        {
+            // textures copied SCREENSHOT_TEXTURE_COUNT - 1 frames ago are complete by now
+            for (uint32_t i = 0; i < SCREENSHOT_TEXTURE_COUNT; ++i)
+            {
+                if (screenshotTextures[i].pending &&
+                    currentFrame - screenshotTextures[i].frame >= SCREENSHOT_TEXTURE_COUNT - 1)
+                {
+                    if (!readScreenshotTexture(i))
+                    {
+                        return false;
+                    }
+                }
+            }
+
+            std::vector<std::string> filenames = getScreenshotFilenames();
+
+            if (filenames.empty())
+            {
+                return true;
+            }
+
+            ScreenshotTexture& screenshotTexture = screenshotTextures[screenshotTextureIndex];
+
+            // all textures are in flight (screenshot every frame), so wait for the oldest one
+            if (screenshotTexture.pending && !readScreenshotTexture(screenshotTextureIndex))
+            {
+                return false;
+            }
+
+            D3D11_TEXTURE2D_DESC backBufferDesc;
+            backBuffer->GetDesc(&backBufferDesc);
+
+            if (!screenshotTexture.texture ||
+                screenshotTexture.width != backBufferDesc.Width ||
+                screenshotTexture.height != backBufferDesc.Height)
+            {
+                if (screenshotTexture.texture)
+                {
+                    screenshotTexture.texture->Release();
+                    screenshotTexture.texture = nullptr;
+                }
 
                 D3D11_TEXTURE2D_DESC desc = backBufferDesc;
                 desc.SampleDesc.Count = 1;
@@ -928,9 +1208,7 @@ namespace ouzel
                 desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
                 desc.MiscFlags = 0;
 
-                ID3D11Texture2D* texture;
-
-                hr = device->CreateTexture2D(&desc, nullptr, &texture);
+                HRESULT hr = device->CreateTexture2D(&desc, nullptr, &screenshotTexture.texture);
 
                 if (FAILED(hr))
                 {
@@ -938,60 +1216,96 @@ namespace ouzel
                     return false;
                 }
 
-                if (backBufferDesc.SampleDesc.Count > 1)
+                screenshotTexture.width = backBufferDesc.Width;
+                screenshotTexture.height = backBufferDesc.Height;
+            }
+
+            if (backBufferDesc.SampleDesc.Count > 1)
+            {
+                D3D11_TEXTURE2D_DESC resolveDesc;
+
+                if (resolveTexture)
+                {
+                    resolveTexture->GetDesc(&resolveDesc);
+
+                    if (resolveDesc.Width != backBufferDesc.Width ||
+                        resolveDesc.Height != backBufferDesc.Height)
+                    {
+                        resolveTexture->Release();
+                        resolveTexture = nullptr;
+                    }
+                }
+
+                if (!resolveTexture)
                 {
-                    D3D11_TEXTURE2D_DESC tempDesc = backBufferDesc;
-                    tempDesc.SampleDesc.Count = 1;
-                    tempDesc.SampleDesc.Quality = 0;
+                    resolveDesc = backBufferDesc;
+                    resolveDesc.SampleDesc.Count = 1;
+                    resolveDesc.SampleDesc.Quality = 0;
 
-                    ID3D11Texture2D* temp;
-                    hr = device->CreateTexture2D(&tempDesc, nullptr, &temp);
+                    HRESULT hr = device->CreateTexture2D(&resolveDesc, nullptr, &resolveTexture);
                     if (FAILED(hr))
                     {
-                        texture->Release();
                         Log(Log::Level::ERR) << "Failed to create Direct3D 11 texture";
                         return false;
                     }
+                }
 
-                    for (UINT item = 0; item < backBufferDesc.ArraySize; ++item)
+                for (UINT item = 0; item < backBufferDesc.ArraySize; ++item)
+                {
+                    for (UINT level = 0; level < backBufferDesc.MipLevels; ++level)
                     {
-                        for (UINT level = 0; level < desc.MipLevels; ++level)
-                        {
-                            UINT index = D3D11CalcSubresource(level, item, backBufferDesc.MipLevels);
-                            context->ResolveSubresource(temp, index, backBuffer, index, DXGI_FORMAT_R8G8B8A8_UNORM);
-                        }
+                        UINT index = D3D11CalcSubresource(level, item, backBufferDesc.MipLevels);
+                        context->ResolveSubresource(resolveTexture, index, backBuffer, index, DXGI_FORMAT_R8G8B8A8_UNORM);
                     }
-
-                    context->CopyResource(texture, temp);
-                    temp->Release();
-                }
-                else
-                {
-                    context->CopyResource(texture, backBuffer);
                 }
 
-                D3D11_MAPPED_SUBRESOURCE mappedSubresource;
-                hr = context->Map(texture, 0, D3D11_MAP_READ, 0, &mappedSubresource);
+                context->CopyResource(screenshotTexture.texture, resolveTexture);
+            }
+            else
+            {
+                context->CopyResource(screenshotTexture.texture, backBuffer);
+            }
+
+            screenshotTexture.frame = currentFrame;
+            screenshotTexture.pending = true;
+            screenshotTexture.filenames = std::move(filenames);
 
-                if (FAILED(hr))
-                {
-                    texture->Release();
-                    Log(Log::Level::ERR) << "Failed to map Direct3D 11 resource";
-                    return false;
-                }
+            screenshotTextureIndex = (screenshotTextureIndex + 1) % SCREENSHOT_TEXTURE_COUNT;
 
-                if (!stbi_write_png(filename.c_str(), desc.Width, desc.Height, 4, mappedSubresource.pData, static_cast<int>(mappedSubresource.RowPitch)))
-                {
-                    context->Unmap(texture, 0);
-                    texture->Release();
-                    Log(Log::Level::ERR) << "Failed to save screenshot to file";
-                    return false;
-                }
+            return true;
+        }
+
+        bool RendererD3D11::readScreenshotTexture(uint32_t index)
+        {
+            ScreenshotTexture& screenshotTexture = screenshotTextures[index];
+            screenshotTexture.pending = false;
+
+            D3D11_MAPPED_SUBRESOURCE mappedSubresource;
+            HRESULT hr = context->Map(screenshotTexture.texture, 0, D3D11_MAP_READ, 0, &mappedSubresource);
+
+            if (FAILED(hr))
+            {
+                Log(Log::Level::ERR) << "Failed to map Direct3D 11 resource";
+                return false;
+            }
+
+            const size_t pitch = static_cast<size_t>(screenshotTexture.width) * 4;
+            std::vector<uint8_t> data(pitch * screenshotTexture.height);
+
+            const uint8_t* source = static_cast<const uint8_t*>(mappedSubresource.pData);
 
-                context->Unmap(texture, 0);
-                texture->Release();
+            for (UINT row = 0; row < screenshotTexture.height; ++row)
+            {
+                std::copy(source + row * mappedSubresource.RowPitch,
+                          source + row * mappedSubresource.RowPitch + pitch,
+                          data.begin() + static_cast<std::ptrdiff_t>(row * pitch));
             }
 
+            context->Unmap(screenshotTexture.texture, 0);
+
+            saveScreenshotData(screenshotTexture.filenames, screenshotTexture.width, screenshotTexture.height, std::move(data));
+            screenshotTexture.filenames.clear();
+
             return true;
         }
 
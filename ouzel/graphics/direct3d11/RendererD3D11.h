@@ -6,6 +6,8 @@
 #include <atomic>
 #define NOMINMAX
 #include <d3d11.h>
+#include <d3d11_1.h>
+#include <d3dcompiler.h>
 #include "graphics/Renderer.h"
 #include "graphics/Texture.h"
 
@@ -36,6 +38,8 @@ namespace ouzel
 
             ID3D11Device* getDevice() const { return device; }
             ID3D11DeviceContext* getContext() const { return context; }
+            // null if the system doesn't have the HLSL compiler, shaders that are not compiled with fxc can't be used then
+            pD3DCompile getCompileFunction() const { return compileFunction; }
 
         protected:
             RendererD3D11();
@@ -50,6 +54,8 @@ namespace ouzel
             bool resizeBackBuffer(UINT newWidth, UINT newHeight);
 
             bool saveScreenshots();
+            bool readScreenshotTexture(uint32_t index);
+            bool uploadShaderConstants();
 
             virtual void setClearColor(Color color) override;
 
@@ -57,6 +63,7 @@ namespace ouzel
 
             ID3D11Device* device = nullptr;
             ID3D11DeviceContext* context = nullptr;
+            ID3D11DeviceContext1* context1 = nullptr; // only set if constant buffer offsetting is supported
             IDXGISwapChain* swapChain = nullptr;
             IDXGIAdapter* adapter = nullptr;
             ID3D11Texture2D* backBuffer = nullptr;
@@ -65,6 +72,15 @@ namespace ouzel
             ID3D11RasterizerState* rasterizerStates[4];
             ID3D11DepthStencilState* depthStencilState = nullptr;
 
+            ID3D11Buffer* constantBuffer = nullptr;
+            UINT constantBufferSize = 0;
+            std::vector<uint8_t> constantBufferData;
+            std::vector<UINT> pixelShaderConstantOffsets;
+            std::vector<UINT> vertexShaderConstantOffsets;
+
+            HMODULE compilerModule = nullptr;
+            pD3DCompile compileFunction = nullptr;
+
             UINT width = 0;
             UINT height = 0;
 
@@ -74,6 +90,23 @@ namespace ouzel
             UINT swapInterval = 0;
             FLOAT frameBufferClearColor[4];
 
+            // the back buffer is copied to staging textures that are mapped a few frames later, so that the readback does not stall the pipeline
+            static const uint32_t SCREENSHOT_TEXTURE_COUNT = 3;
+
+            struct ScreenshotTexture
+            {
+                ID3D11Texture2D* texture = nullptr;
+                UINT width = 0;
+                UINT height = 0;
+                uint32_t frame = 0;
+                bool pending = false;
+                std::vector<std::string> filenames;
+            };
+
+            ScreenshotTexture screenshotTextures[SCREENSHOT_TEXTURE_COUNT];
+            uint32_t screenshotTextureIndex = 0;
+            ID3D11Texture2D* resolveTexture = nullptr; // only used if the back buffer is multisampled
+
             bool sizeDirty = false;
             std::atomic<bool> dirty;
             std::mutex dataMutex;
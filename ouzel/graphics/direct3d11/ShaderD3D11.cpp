@@ -101,6 +101,58 @@ namespace ouzel
             return true;
         }
 
+        // shaders compiled with fxc start with this, anything else is HLSL source
+        static bool isBytecode(const std::vector<uint8_t>& data)
+        {
+            return data.size() >= 4 && data[0] == 'D' && data[1] == 'X' && data[2] == 'B' && data[3] == 'C';
+        }
+
+        bool ShaderD3D11::compile(const std::vector<uint8_t>& source, const std::string& function, const std::string& type, std::vector<uint8_t>& bytecode)
+        {
+            RendererD3D11* rendererD3D11 = static_cast<RendererD3D11*>(sharedEngine->getRenderer());
+
+            pD3DCompile compileFunction = rendererD3D11->getCompileFunction();
+
+            if (!compileFunction)
+            {
+                Log(Log::Level::ERR) << "Failed to compile Direct3D 11 shader, HLSL compiler is not available";
+                return false;
+            }
+
+            D3D_FEATURE_LEVEL featureLevel = rendererD3D11->getDevice()->GetFeatureLevel();
+
+            std::string target = type + "_4_0";
+
+            if (featureLevel < D3D_FEATURE_LEVEL_9_3) target += "_level_9_1";
+            else if (featureLevel < D3D_FEATURE_LEVEL_10_0) target += "_level_9_3";
+
+            ID3DBlob* code = nullptr;
+            ID3DBlob* errors = nullptr;
+
+            HRESULT hr = compileFunction(source.data(), source.size(), nullptr, nullptr, nullptr,
+                                         function.empty() ? "main" : function.c_str(), target.c_str(),
+                                         D3DCOMPILE_OPTIMIZATION_LEVEL3, 0, &code, &errors);
+
+            if (FAILED(hr))
+            {
+                std::string message = errors ? std::string(static_cast<const char*>(errors->GetBufferPointer()), errors->GetBufferSize()) : "";
+
+                if (code) code->Release();
+                if (errors) errors->Release();
+
+                Log(Log::Level::ERR) << "Failed to compile Direct3D 11 shader, " << message;
+                return false;
+            }
+
+            const uint8_t* codeData = static_cast<const uint8_t*>(code->GetBufferPointer());
+            bytecode.assign(codeData, codeData + code->GetBufferSize());
+
+            code->Release();
+            if (errors) errors->Release();
+
+            return true;
+        }
+
         bool ShaderD3D11::upload()
         {
             if (uploadData.dirty)
@@ -109,7 +161,20 @@ namespace ouzel
 
                 if (!pixelShader)
                 {
-                    HRESULT hr = rendererD3D11->getDevice()->CreatePixelShader(uploadData.pixelShaderData.data(), uploadData.pixelShaderData.size(), NULL, &pixelShader);
+                    std::vector<uint8_t> compiledPixelShader;
+                    const std::vector<uint8_t>* pixelShaderData = &uploadData.pixelShaderData;
+
+                    if (!isBytecode(*pixelShaderData))
+                    {
+                        if (!compile(*pixelShaderData, uploadData.pixelShaderFunction, "ps", compiledPixelShader))
+                        {
+                            return false;
+                        }
+
+                        pixelShaderData = &compiledPixelShader;
+                    }
+
+                    HRESULT hr = rendererD3D11->getDevice()->CreatePixelShader(pixelShaderData->data(), pixelShaderData->size(), NULL, &pixelShader);
                     if (FAILED(hr))
                     {
                         Log(Log::Level::ERR) << "Failed to create a Direct3D 11 pixel shader";
@@ -119,7 +184,20 @@ namespace ouzel
 
                 if (!vertexShader)
                 {
-                    HRESULT hr = rendererD3D11->getDevice()->CreateVertexShader(uploadData.vertexShaderData.data(), uploadData.vertexShaderData.size(), NULL, &vertexShader);
+                    std::vector<uint8_t> compiledVertexShader;
+                    const std::vector<uint8_t>* vertexShaderData = &uploadData.vertexShaderData;
+
+                    if (!isBytecode(*vertexShaderData))
+                    {
+                        if (!compile(*vertexShaderData, uploadData.vertexShaderFunction, "vs", compiledVertexShader))
+                        {
+                            return false;
+                        }
+
+                        vertexShaderData = &compiledVertexShader;
+                    }
+
+                    HRESULT hr = rendererD3D11->getDevice()->CreateVertexShader(vertexShaderData->data(), vertexShaderData->size(), NULL, &vertexShader);
                     if (FAILED(hr))
                     {
                         Log(Log::Level::ERR) << "Failed to create a Direct3D 11 vertex shader";
@@ -160,11 +238,44 @@ namespace ouzel
                         offset += 2 * sizeof(float);
                     }
 
+                    // per-instance data comes from the second vertex buffer slot
+                    offset = 0;
+
+                    if (uploadData.vertexAttributes & VERTEX_INSTANCE_POSITION)
+                    {
+                        vertexInputElements.push_back({ "INSTANCE_POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 1, offset, D3D11_INPUT_PER_INSTANCE_DATA, 1 });
+                        offset += 3 * sizeof(float);
+                    }
+
+                    if (uploadData.vertexAttributes & VERTEX_INSTANCE_SIZE)
+                    {
+                        vertexInputElements.push_back({ "INSTANCE_SIZE", 0, DXGI_FORMAT_R32G32_FLOAT, 1, offset, D3D11_INPUT_PER_INSTANCE_DATA, 1 });
+                        offset += 2 * sizeof(float);
+                    }
+
+                    if (uploadData.vertexAttributes & VERTEX_INSTANCE_ROTATION)
+                    {
+                        vertexInputElements.push_back({ "INSTANCE_ROTATION", 0, DXGI_FORMAT_R32_FLOAT, 1, offset, D3D11_INPUT_PER_INSTANCE_DATA, 1 });
+                        offset += sizeof(float);
+                    }
+
+                    if (uploadData.vertexAttributes & VERTEX_INSTANCE_COLOR)
+                    {
+                        vertexInputElements.push_back({ "INSTANCE_COLOR", 0, DXGI_FORMAT_R8G8B8A8_UNORM, 1, offset, D3D11_INPUT_PER_INSTANCE_DATA, 1 });
+                        offset += 4 * sizeof(uint8_t);
+                    }
+
+                    if (uploadData.vertexAttributes & VERTEX_INSTANCE_TEXCOORD_RECT)
+                    {
+                        vertexInputElements.push_back({ "INSTANCE_TEXCOORD_RECT", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, offset, D3D11_INPUT_PER_INSTANCE_DATA, 1 });
+                        offset += 4 * sizeof(float);
+                    }
+
                     hr = rendererD3D11->getDevice()->CreateInputLayout(
                         vertexInputElements.data(),
                         static_cast<UINT>(vertexInputElements.size()),
-                        uploadData.vertexShaderData.data(),
-                        uploadData.vertexShaderData.size(),
+                        vertexShaderData->data(),
+                        vertexShaderData->size(),
                         &inputLayout);
 
                     if (FAILED(hr))
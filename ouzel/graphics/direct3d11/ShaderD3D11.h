@@ -27,6 +27,8 @@ namespace ouzel
 
             const std::vector<Location>& getPixelShaderConstantLocations() const { return pixelShaderConstantLocations; }
             const std::vector<Location>& getVertexShaderConstantLocations() const { return vertexShaderConstantLocations; }
+            uint32_t getPixelShaderConstantSize() const { return pixelShaderConstantSize; }
+            uint32_t getVertexShaderConstantSize() const { return vertexShaderConstantSize; }
 
             virtual ID3D11PixelShader* getPixelShader() const { return pixelShader; }
             virtual ID3D11VertexShader* getVertexShader() const { return vertexShader; }
@@ -40,6 +42,9 @@ namespace ouzel
         protected:
             virtual bool upload() override;
 
+            // compiles HLSL source with the system's compiler for the feature level of the device
+            bool compile(const std::vector<uint8_t>& source, const std::string& function, const std::string& type, std::vector<uint8_t>& bytecode);
+
             ID3D11PixelShader* pixelShader = nullptr;
             ID3D11VertexShader* vertexShader = nullptr;
             ID3D11InputLayout* inputLayout = nullptr;
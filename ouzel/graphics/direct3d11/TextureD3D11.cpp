@@ -12,6 +12,17 @@ namespace ouzel
 {
     namespace graphics
     {
+        static DXGI_FORMAT getTextureFormat(PixelFormat pixelFormat)
+        {
+            switch (pixelFormat)
+            {
+                case PixelFormat::BC1_UNORM: return DXGI_FORMAT_BC1_UNORM;
+                case PixelFormat::BC3_UNORM: return DXGI_FORMAT_BC3_UNORM;
+                case PixelFormat::BC7_UNORM: return DXGI_FORMAT_BC7_UNORM;
+                default: return DXGI_FORMAT_R8G8B8A8_UNORM;
+            }
+        }
+
         TextureD3D11::TextureD3D11()
         {
         }
@@ -60,22 +71,26 @@ namespace ouzel
                 {
                     if (!texture ||
                         static_cast<UINT>(uploadData.size.v[0]) != width ||
-                        static_cast<UINT>(uploadData.size.v[1]) != height)
+                        static_cast<UINT>(uploadData.size.v[1]) != height ||
+                        uploadData.pixelFormat != pixelFormat)
                     {
                         if (texture) texture->Release();
 
                         width = static_cast<UINT>(uploadData.size.v[0]);
                         height = static_cast<UINT>(uploadData.size.v[1]);
+                        pixelFormat = uploadData.pixelFormat;
 
                         D3D11_TEXTURE2D_DESC textureDesc;
                         memset(&textureDesc, 0, sizeof(textureDesc));
                         textureDesc.Width = width;
                         textureDesc.Height = height;
-                        textureDesc.MipLevels = uploadData.mipmaps ? 0 : 1;
+                        // compressed images can carry an incomplete mip chain
+                        textureDesc.MipLevels = uploadData.mipmaps ? static_cast<UINT>(uploadData.levels.size()) : 1;
                         textureDesc.ArraySize = 1;
-                        textureDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-                        textureDesc.Usage = uploadData.dynamic ? D3D11_USAGE_DYNAMIC : D3D11_USAGE_DEFAULT;
-                        textureDesc.CPUAccessFlags = uploadData.dynamic ? D3D11_CPU_ACCESS_WRITE : 0;
+                        textureDesc.Format = getTextureFormat(pixelFormat);
+                        // dynamic textures are updated with UpdateSubresource too, which needs default usage
+                        textureDesc.Usage = D3D11_USAGE_DEFAULT;
+                        textureDesc.CPUAccessFlags = 0;
                         textureDesc.SampleDesc.Count = 1;
                         textureDesc.SampleDesc.Quality = 0;
                         textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE | (uploadData.renderTarget ? D3D11_BIND_RENDER_TARGET : 0);
@@ -90,7 +105,7 @@ namespace ouzel
 
                         D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc;
                         memset(&srvDesc, 0, sizeof(srvDesc));
-                        srvDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+                        srvDesc.Format = textureDesc.Format;
                         srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
                         srvDesc.Texture2D.MostDetailedMip = 0;
                         srvDesc.Texture2D.MipLevels = uploadData.mipmaps ? static_cast<UINT>(uploadData.levels.size()) : 1;
@@ -106,13 +121,34 @@ namespace ouzel
                     for (size_t level = 0; level < uploadData.levels.size(); ++level)
                     {
                         rendererD3D11->getContext()->UpdateSubresource(texture, static_cast<UINT>(level),
-                                                                       nullptr, uploadData.levels[level].data.data(),
+                                                                       nullptr, uploadData.data.data() + uploadData.levels[level].offset,
                                                                        static_cast<UINT>(uploadData.levels[level].pitch), 0);
                     }
                 }
 
                 uploadData.dirty = false;
             }
+            else if (!uploadData.regions.empty() && texture)
+            {
+                RendererD3D11* rendererD3D11 = static_cast<RendererD3D11*>(sharedEngine->getRenderer());
+
+                for (const Region& region : uploadData.regions)
+                {
+                    D3D11_BOX box;
+                    box.left = region.x;
+                    box.top = region.y;
+                    box.front = 0;
+                    box.right = region.x + region.width;
+                    box.bottom = region.y + region.height;
+                    box.back = 1;
+
+                    rendererD3D11->getContext()->UpdateSubresource(texture, region.level, &box,
+                                                                   uploadData.regionData.data() + region.offset,
+                                                                   region.width * 4, 0);
+                }
+
+                uploadData.regions.clear();
+            }
 
             return true;
         }
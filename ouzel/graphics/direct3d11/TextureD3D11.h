@@ -32,6 +32,7 @@ namespace ouzel
 
             UINT width = 0;
             UINT height = 0;
+            PixelFormat pixelFormat = PixelFormat::RGBA8_UNORM;
         };
     } // namespace graphics
 } // namespace ouzel
@@ -33,6 +33,11 @@ namespace ouzel
                 return false;
             }
 
+            // nothing is sampled, so every texture format is accepted as is
+            bcTexturesSupported = true;
+            bc7TexturesSupported = true;
+            etc2TexturesSupported = true;
+
             ShaderPtr textureShader = createShader();
 
             textureShader->initFromBuffers({ },
@@ -100,6 +105,37 @@ namespace ouzel
             return true;
         }
 
+        bool RendererEmpty::present()
+        {
+            if (!Renderer::present())
+            {
+                return false;
+            }
+
+            std::vector<std::string> filenames = getScreenshotFilenames();
+
+            if (!filenames.empty())
+            {
+                // nothing is drawn, so the frame is the clear color, which makes captures reproducible in headless runs
+                const uint32_t width = static_cast<uint32_t>(size.v[0]);
+                const uint32_t height = static_cast<uint32_t>(size.v[1]);
+
+                std::vector<uint8_t> data(width * height * 4);
+
+                for (size_t i = 0; i < data.size(); i += 4)
+                {
+                    data[i + 0] = clearColor.r();
+                    data[i + 1] = clearColor.g();
+                    data[i + 2] = clearColor.b();
+                    data[i + 3] = clearColor.a();
+                }
+
+                saveScreenshotData(filenames, width, height, std::move(data));
+            }
+
+            return true;
+        }
+
         BlendStatePtr RendererEmpty::createBlendState()
         {
             BlendStatePtr blendState = std::make_shared<BlendStateEmpty>();
@@ -23,6 +23,8 @@ namespace ouzel
             virtual IndexBufferPtr createIndexBuffer() override;
             virtual VertexBufferPtr createVertexBuffer() override;
 
+            virtual bool present() override;
+
         protected:
             RendererEmpty();
 
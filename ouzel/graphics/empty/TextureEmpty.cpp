@@ -2,6 +2,8 @@
 // This file is part of the Ouzel engine.
 
 #include "TextureEmpty.h"
+#include "graphics/TextureCompression.h"
+#include "utils/Log.h"
 
 namespace ouzel
 {
@@ -13,7 +15,52 @@ namespace ouzel
 
         bool TextureEmpty::upload()
         {
+            if (uploadData.dirty)
+            {
+                // validate the levels the same way a GPU upload would read them
+                uint32_t newMemorySize = 0;
+
+                for (const Level& level : uploadData.levels)
+                {
+                    uint32_t levelWidth = static_cast<uint32_t>(level.size.v[0]);
+                    uint32_t levelHeight = static_cast<uint32_t>(level.size.v[1]);
+                    uint32_t levelSize = getPixelFormatSize(uploadData.pixelFormat, levelWidth, levelHeight);
+
+                    if (levelSize == 0 ||
+                        level.pitch != getPixelFormatPitch(uploadData.pixelFormat, levelWidth) ||
+                        level.offset + levelSize > uploadData.data.size())
+                    {
+                        Log(Log::Level::ERR) << "Invalid texture level data";
+                        return false;
+                    }
+
+                    newMemorySize += levelSize;
+                }
+
+                // render targets have no levels, only the size
+                if (uploadData.levels.empty())
+                {
+                    newMemorySize = getPixelFormatSize(uploadData.pixelFormat,
+                                                       static_cast<uint32_t>(uploadData.size.v[0]),
+                                                       static_cast<uint32_t>(uploadData.size.v[1]));
+                }
+
+                memorySize = newMemorySize;
+            }
+            else
+            {
+                for (const Region& region : uploadData.regions)
+                {
+                    if (region.offset + region.width * region.height * 4 > uploadData.regionData.size())
+                    {
+                        Log(Log::Level::ERR) << "Invalid texture region data";
+                        return false;
+                    }
+                }
+            }
+
             uploadData.dirty = false;
+            uploadData.regions.clear();
 
             return true;
         }
@@ -17,8 +17,13 @@ namespace ouzel
         public:
             TextureEmpty();
 
+            // bytes a GPU texture with the uploaded levels would take
+            uint32_t getMemorySize() const { return memorySize; }
+
         protected:
             virtual bool upload() override;
+
+            uint32_t memorySize = 0;
         };
     } // namespace graphics
 } // namespace ouzel
@@ -10,6 +10,7 @@
 #include "IndexBufferMetal.h"
 #include "VertexBufferMetal.h"
 #include "BlendStateMetal.h"
+#include "TextureInstancedVSMetal.h"
 #include "events/EventDispatcher.h"
 #if OUZEL_PLATFORM_MACOS
     #include "core/macos/WindowMacOS.h"
@@ -45,7 +46,6 @@
 #include "core/Engine.h"
 #include "core/Cache.h"
 #include "utils/Log.h"
-#include "stb_image_write.h"
 
 namespace ouzel
 {
@@ -199,6 +199,14 @@ namespace ouzel
                 Log(Log::Level::INFO) << "Using " << [device.name cStringUsingEncoding:NSUTF8StringEncoding] << " for rendering";
             }
 
+            // Mac GPUs sample BC formats, iOS and tvOS GPUs sample ETC2
+#if OUZEL_PLATFORM_MACOS
+            bcTexturesSupported = true;
+            bc7TexturesSupported = true;
+#else
+            etc2TexturesSupported = true;
+#endif
+
 #if OUZEL_PLATFORM_MACOS
             view = (MTKViewPtr)static_cast<WindowMacOS*>(window)->getNativeView();
 #elif OUZEL_PLATFORM_TVOS
@@ -278,6 +286,21 @@ namespace ouzel
 
             sharedEngine->getCache()->setShader(SHADER_TEXTURE, textureShader);
 
+            // the instanced vertex shader is compiled from source when the shader is uploaded
+            ShaderPtr textureInstancedShader = createShader();
+            textureInstancedShader->initFromBuffers(std::vector<uint8_t>(std::begin(TEXTURE_PIXEL_SHADER_METAL), std::end(TEXTURE_PIXEL_SHADER_METAL)),
+                                                    std::vector<uint8_t>(std::begin(TextureInstancedVS_metal), std::end(TextureInstancedVS_metal)),
+                                                    VertexPCT::ATTRIBUTES | VertexInstance::ATTRIBUTES,
+                                                    {{"color", 4 * sizeof(float)}},
+                                                    {{"modelViewProj", sizeof(Matrix4)}},
+                                                    256, 256,
+                                                    "main_ps", "main_vs");
+
+            sharedEngine->getCache()->setShader(SHADER_TEXTURE_INSTANCED, textureInstancedShader);
+
+            instancedShader = textureInstancedShader;
+            instancingSupported = true;
+
             ShaderPtr colorShader = createShader();
             colorShader->initFromBuffers(std::vector<uint8_t>(std::begin(COLOR_PIXEL_SHADER_METAL), std::end(COLOR_PIXEL_SHADER_METAL)),
                                          std::vector<uint8_t>(std::begin(COLOR_VERTEX_SHADER_METAL), std::end(COLOR_VERTEX_SHADER_METAL)),
@@ -440,8 +463,6 @@ namespace ouzel
                 return false;
             }
 
-            std::vector<float> shaderData;
-
             MTLViewport viewport;
 
             if (drawQueue.empty())
@@ -560,32 +581,36 @@ namespace ouzel
                 // pixel shader constants
                 const std::vector<ShaderMetal::Location>& pixelShaderConstantLocations = shaderMetal->getPixelShaderConstantLocations();
 
-                if (drawCommand.pixelShaderConstants.size() > pixelShaderConstantLocations.size())
+                if (drawCommand.pixelShaderConstantCount > pixelShaderConstantLocations.size())
                 {
                     Log(Log::Level::ERR) << "Invalid pixel shader constant size";
                     return false;
                 }
 
-                shaderData.clear();
+                // constants of a draw command are stored contiguously, so they can be uploaded without copying
+                uint32_t pixelShaderDataSize = 0;
 
-                for (size_t i = 0; i < drawCommand.pixelShaderConstants.size(); ++i)
+                for (uint32_t i = 0; i < drawCommand.pixelShaderConstantCount; ++i)
                 {
                     const ShaderMetal::Location& pixelShaderConstantLocation = pixelShaderConstantLocations[i];
-                    const std::vector<float>& pixelShaderConstant = drawCommand.pixelShaderConstants[i];
+                    const ShaderConstantRange& pixelShaderConstant = shaderConstants[drawCommand.pixelShaderConstantIndex + i];
 
-                    if (sizeof(float) * pixelShaderConstant.size() != pixelShaderConstantLocation.size)
+                    if (sizeof(float) * pixelShaderConstant.size != pixelShaderConstantLocation.size)
                     {
                         Log(Log::Level::ERR) << "Invalid pixel shader constant size";
                         return false;
                     }
 
-                    shaderData.insert(shaderData.end(), pixelShaderConstant.begin(), pixelShaderConstant.end());
+                    pixelShaderDataSize += pixelShaderConstant.size;
                 }
 
+                const float* pixelShaderData = drawCommand.pixelShaderConstantCount ?
+                    shaderConstantData.data() + shaderConstants[drawCommand.pixelShaderConstantIndex].offset : nullptr;
+
                 shaderMetal->uploadBuffer(shaderMetal->getPixelShaderConstantBuffer(),
                                           shaderMetal->getPixelShaderConstantBufferOffset(),
-                                          shaderData.data(),
-                                          static_cast<uint32_t>(sizeof(float) * shaderData.size()));
+                                          pixelShaderData,
+                                          static_cast<uint32_t>(sizeof(float) * pixelShaderDataSize));
 
                 [currentRenderCommandEncoder setFragmentBuffer:shaderMetal->getPixelShaderConstantBuffer()
                                                         offset:shaderMetal->getPixelShaderConstantBufferOffset()
@@ -594,32 +619,36 @@ namespace ouzel
                 // vertex shader constants
                 const std::vector<ShaderMetal::Location>& vertexShaderConstantLocations = shaderMetal->getVertexShaderConstantLocations();
 
-                if (drawCommand.vertexShaderConstants.size() > vertexShaderConstantLocations.size())
+                if (drawCommand.vertexShaderConstantCount > vertexShaderConstantLocations.size())
                 {
                     Log(Log::Level::ERR) << "Invalid vertex shader constant size";
                     return false;
                 }
 
-                shaderData.clear();
+                // constants of a draw command are stored contiguously, so they can be uploaded without copying
+                uint32_t vertexShaderDataSize = 0;
 
-                for (size_t i = 0; i < drawCommand.vertexShaderConstants.size(); ++i)
+                for (uint32_t i = 0; i < drawCommand.vertexShaderConstantCount; ++i)
                 {
                     const ShaderMetal::Location& vertexShaderConstantLocation = vertexShaderConstantLocations[i];
-                    const std::vector<float>& vertexShaderConstant = drawCommand.vertexShaderConstants[i];
+                    const ShaderConstantRange& vertexShaderConstant = shaderConstants[drawCommand.vertexShaderConstantIndex + i];
 
-                    if (sizeof(float) * vertexShaderConstant.size() != vertexShaderConstantLocation.size)
+                    if (sizeof(float) * vertexShaderConstant.size != vertexShaderConstantLocation.size)
                     {
                         Log(Log::Level::ERR) << "Invalid vertex shader constant size";
                         return false;
                     }
 
-                    shaderData.insert(shaderData.end(), vertexShaderConstant.begin(), vertexShaderConstant.end());
+                    vertexShaderDataSize += vertexShaderConstant.size;
                 }
 
+                const float* vertexShaderData = drawCommand.vertexShaderConstantCount ?
+                    shaderConstantData.data() + shaderConstants[drawCommand.vertexShaderConstantIndex].offset : nullptr;
+
                 shaderMetal->uploadBuffer(shaderMetal->getVertexShaderConstantBuffer(),
                                           shaderMetal->getVertexShaderConstantBufferOffset(),
-                                          shaderData.data(),
-                                          static_cast<uint32_t>(sizeof(float) * shaderData.size()));
+                                          vertexShaderData,
+                                          static_cast<uint32_t>(sizeof(float) * vertexShaderDataSize));
 
                 [currentRenderCommandEncoder setVertexBuffer:shaderMetal->getVertexShaderConstantBuffer()
                                                       offset:shaderMetal->getVertexShaderConstantBufferOffset()
@@ -659,12 +688,7 @@ namespace ouzel
                 // textures
                 for (uint32_t layer = 0; layer < Texture::LAYERS; ++layer)
                 {
-                    std::shared_ptr<TextureMetal> textureMetal;
-
-                    if (drawCommand.textures.size() > layer)
-                    {
-                        textureMetal = std::static_pointer_cast<TextureMetal>(drawCommand.textures[layer]);
-                    }
+                    TextureMetal* textureMetal = static_cast<TextureMetal*>(drawCommand.textures[layer].get());
 
                     if (textureMetal)
                     {
@@ -708,6 +732,21 @@ namespace ouzel
 
                 [currentRenderCommandEncoder setVertexBuffer:vertexBufferMetal->getBuffer() offset:0 atIndex:0];
 
+                if (drawCommand.instanceCount)
+                {
+                    std::shared_ptr<VertexBufferMetal> instanceBufferMetal = std::static_pointer_cast<VertexBufferMetal>(meshBufferMetal->getInstanceBuffer());
+
+                    if (!instanceBufferMetal || !instanceBufferMetal->getBuffer())
+                    {
+                        continue;
+                    }
+
+                    // baseInstance is not available on all iOS GPUs, so the first instance is selected with the buffer offset
+                    [currentRenderCommandEncoder setVertexBuffer:instanceBufferMetal->getBuffer()
+                                                          offset:drawCommand.startInstance * instanceBufferMetal->getVertexSize()
+                                                         atIndex:ShaderMetal::INSTANCE_BUFFER_INDEX];
+                }
+
                 // draw
                 MTLPrimitiveType primitiveType;
 
@@ -725,7 +764,8 @@ namespace ouzel
                                                         indexCount:drawCommand.indexCount
                                                          indexType:indexBufferMetal->getType()
                                                        indexBuffer:indexBufferMetal->getBuffer()
-                                                 indexBufferOffset:drawCommand.startIndex * indexBufferMetal->getBytesPerIndex()];
+                                                 indexBufferOffset:drawCommand.startIndex * indexBufferMetal->getBytesPerIndex()
+                                                     instanceCount:drawCommand.instanceCount ? drawCommand.instanceCount : 1];
             }
 
             if (currentRenderCommandEncoder)
@@ -737,6 +777,12 @@ namespace ouzel
 
             if (currentCommandBuffer)
             {
+                // the copy is encoded into the frame's command buffer, so it is read back when the GPU has finished the frame
+                if (!saveScreenshots())
+                {
+                    return false;
+                }
+
                 [currentCommandBuffer presentDrawable:static_cast<id<CAMetalDrawable> _Nonnull>(view.currentDrawable)];
 
                 [currentCommandBuffer commit];
@@ -744,11 +790,6 @@ namespace ouzel
                 currentCommandBuffer = Nil;
             }
 
-            if (!saveScreenshots())
-            {
-                return false;
-            }
-
             return true;
         }
 
@@ -845,50 +886,69 @@ namespace ouzel
 
         bool RendererMetal::saveScreenshots()
         {
-            for (;;)
+            std::vector<std::string> filenames = getScreenshotFilenames();
+
+            if (filenames.empty())
             {
-                std::string filename;
+                return true;
+            }
 
-                {
-                    std::lock_guard<std::mutex> lock(screenshotMutex);
+            MTLTexturePtr texture = view.currentDrawable.texture;
 
-                    if (screenshotQueue.empty()) break;
+            if (!texture)
+            {
+                return false;
+            }
 
-                    filename = screenshotQueue.front();
-                    screenshotQueue.pop();
-                }
+            NSUInteger width = static_cast<NSUInteger>(texture.width);
+            NSUInteger height = static_cast<NSUInteger>(texture.height);
 
-                MTLTexturePtr texture = view.currentDrawable.texture;
+            id<MTLBuffer> buffer = [device newBufferWithLength:width * height * 4 options:MTLResourceStorageModeShared];
 
-                if (!texture)
-                {
-                    return false;
-                }
+            if (!buffer)
+            {
+                Log(Log::Level::ERR) << "Failed to create Metal buffer";
+                return false;
+            }
 
-                NSUInteger width = static_cast<NSUInteger>(texture.width);
-                NSUInteger height = static_cast<NSUInteger>(texture.height);
+            id<MTLBlitCommandEncoder> blitCommandEncoder = [currentCommandBuffer blitCommandEncoder];
 
-                std::shared_ptr<uint8_t> data(new uint8_t[width * height * 4]);
-                [texture getBytes:data.get() bytesPerRow:width * 4 fromRegion:MTLRegionMake2D(0, 0, width, height) mipmapLevel:0];
+            if (!blitCommandEncoder)
+            {
+                [buffer release];
+                Log(Log::Level::ERR) << "Failed to create Metal blit command encoder";
+                return false;
+            }
 
-                uint8_t temp;
-                for (uint32_t y = 0; y < height; ++y)
-                {
-                    for (uint32_t x = 0; x < width; ++x)
-                    {
-                        temp = data.get()[((y * width + x) * 4)];
-                        data.get()[((y * width + x) * 4)] = data.get()[((y * width + x) * 4) + 2];
-                        data.get()[((y * width + x) * 4) + 2] = temp;
-                        data.get()[((y * width + x) * 4) + 3] = 255;
-                    }
-                }
+            [blitCommandEncoder copyFromTexture:texture
+                                    sourceSlice:0
+                                    sourceLevel:0
+                                   sourceOrigin:MTLOriginMake(0, 0, 0)
+                                     sourceSize:MTLSizeMake(width, height, 1)
+                                       toBuffer:buffer
+                              destinationOffset:0
+                         destinationBytesPerRow:width * 4
+                       destinationBytesPerImage:width * height * 4];
+            [blitCommandEncoder endEncoding];
 
-                if (!stbi_write_png(filename.c_str(), static_cast<int>(width), static_cast<int>(height), 4, data.get(), static_cast<int>(width * 4)))
-                {
-                    Log(Log::Level::ERR) << "Failed to save image to file";
-                    return false;
-                }
-            }
+            [currentCommandBuffer addCompletedHandler:^(id<MTLCommandBuffer>)
+             {
+                 // drawable is BGRA
+                 const uint8_t* source = static_cast<const uint8_t*>([buffer contents]);
+                 std::vector<uint8_t> data(width * height * 4);
+
+                 for (NSUInteger i = 0; i < width * height * 4; i += 4)
+                 {
+                     data[i + 0] = source[i + 2];
+                     data[i + 1] = source[i + 1];
+                     data[i + 2] = source[i + 0];
+                     data[i + 3] = 255;
+                 }
+
+                 [buffer release];
+
+                 saveScreenshotData(filenames, static_cast<uint32_t>(width), static_cast<uint32_t>(height), std::move(data));
+             }];
 
             return true;
         }
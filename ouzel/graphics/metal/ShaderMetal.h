@@ -25,6 +25,9 @@ namespace ouzel
         class ShaderMetal: public Shader
         {
         public:
+            // vertex buffer 1 holds the vertex shader constants
+            static const uint32_t INSTANCE_BUFFER_INDEX = 2;
+
             ShaderMetal();
             virtual ~ShaderMetal();
             virtual void free() override;
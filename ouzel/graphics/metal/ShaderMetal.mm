@@ -95,6 +95,30 @@ namespace ouzel
             return true;
         }
 
+        // metallib files start with this, anything else is Metal shading language source
+        static bool isLibrary(const std::vector<uint8_t>& data)
+        {
+            return data.size() >= 4 && data[0] == 'M' && data[1] == 'T' && data[2] == 'L' && data[3] == 'B';
+        }
+
+        static id<MTLLibrary> createLibrary(id<MTLDevice> device, const std::vector<uint8_t>& data, NSError** err)
+        {
+            if (isLibrary(data))
+            {
+                dispatch_data_t dispatchData = dispatch_data_create(data.data(), data.size(), NULL, DISPATCH_DATA_DESTRUCTOR_DEFAULT);
+                id<MTLLibrary> library = [device newLibraryWithData:dispatchData error:err];
+                dispatch_release(dispatchData);
+
+                return library;
+            }
+
+            NSString* source = [[NSString alloc] initWithBytes:data.data() length:data.size() encoding:NSUTF8StringEncoding];
+            id<MTLLibrary> library = [device newLibraryWithSource:source options:Nil error:err];
+            [source release];
+
+            return library;
+        }
+
         bool ShaderMetal::upload()
         {
             if (uploadData.dirty)
@@ -158,18 +182,70 @@ namespace ouzel
                 vertexDescriptor.layouts[0].stepRate = 1;
                 vertexDescriptor.layouts[0].stepFunction = MTLVertexStepFunctionPerVertex;
 
+                offset = 0;
+
+                if (uploadData.vertexAttributes & VERTEX_INSTANCE_POSITION)
+                {
+                    vertexDescriptor.attributes[index].format = MTLVertexFormatFloat3;
+                    vertexDescriptor.attributes[index].offset = offset;
+                    vertexDescriptor.attributes[index].bufferIndex = INSTANCE_BUFFER_INDEX;
+                    ++index;
+                    offset += 3 * sizeof(float);
+                }
+
+                if (uploadData.vertexAttributes & VERTEX_INSTANCE_SIZE)
+                {
+                    vertexDescriptor.attributes[index].format = MTLVertexFormatFloat2;
+                    vertexDescriptor.attributes[index].offset = offset;
+                    vertexDescriptor.attributes[index].bufferIndex = INSTANCE_BUFFER_INDEX;
+                    ++index;
+                    offset += 2 * sizeof(float);
+                }
+
+                if (uploadData.vertexAttributes & VERTEX_INSTANCE_ROTATION)
+                {
+                    vertexDescriptor.attributes[index].format = MTLVertexFormatFloat;
+                    vertexDescriptor.attributes[index].offset = offset;
+                    vertexDescriptor.attributes[index].bufferIndex = INSTANCE_BUFFER_INDEX;
+                    ++index;
+                    offset += sizeof(float);
+                }
+
+                if (uploadData.vertexAttributes & VERTEX_INSTANCE_COLOR)
+                {
+                    vertexDescriptor.attributes[index].format = MTLVertexFormatUChar4Normalized;
+                    vertexDescriptor.attributes[index].offset = offset;
+                    vertexDescriptor.attributes[index].bufferIndex = INSTANCE_BUFFER_INDEX;
+                    ++index;
+                    offset += 4 * sizeof(uint8_t);
+                }
+
+                if (uploadData.vertexAttributes & VERTEX_INSTANCE_TEXCOORD_RECT)
+                {
+                    vertexDescriptor.attributes[index].format = MTLVertexFormatFloat4;
+                    vertexDescriptor.attributes[index].offset = offset;
+                    vertexDescriptor.attributes[index].bufferIndex = INSTANCE_BUFFER_INDEX;
+                    ++index;
+                    offset += 4 * sizeof(float);
+                }
+
+                if (offset > 0)
+                {
+                    vertexDescriptor.layouts[INSTANCE_BUFFER_INDEX].stride = offset;
+                    vertexDescriptor.layouts[INSTANCE_BUFFER_INDEX].stepRate = 1;
+                    vertexDescriptor.layouts[INSTANCE_BUFFER_INDEX].stepFunction = MTLVertexStepFunctionPerInstance;
+                }
+
                 NSError* err = Nil;
 
                 if (!pixelShader)
                 {
-                    dispatch_data_t pixelShaderDispatchData = dispatch_data_create(uploadData.pixelShaderData.data(), uploadData.pixelShaderData.size(), NULL, DISPATCH_DATA_DESTRUCTOR_DEFAULT);
-                    id<MTLLibrary> pixelShaderLibrary = [rendererMetal->getDevice() newLibraryWithData:pixelShaderDispatchData error:&err];
-                    dispatch_release(pixelShaderDispatchData);
+                    id<MTLLibrary> pixelShaderLibrary = createLibrary(rendererMetal->getDevice(), uploadData.pixelShaderData, &err);
 
-                    if (err != Nil)
+                    // compiling from source reports warnings through err too, so only a missing library is an error
+                    if (!pixelShaderLibrary)
                     {
-                        if (pixelShaderLibrary) [pixelShaderLibrary release];
-                        Log(Log::Level::ERR) << "Failed to load pixel shader, " << [err.localizedDescription cStringUsingEncoding:NSUTF8StringEncoding];
+                        Log(Log::Level::ERR) << "Failed to load pixel shader, " << (err ? [err.localizedDescription cStringUsingEncoding:NSUTF8StringEncoding] : "unknown error");
                         return false;
                     }
 
@@ -209,14 +285,11 @@ namespace ouzel
 
                 if (!vertexShader)
                 {
-                    dispatch_data_t vertexShaderDispatchData = dispatch_data_create(uploadData.vertexShaderData.data(), uploadData.vertexShaderData.size(), NULL, DISPATCH_DATA_DESTRUCTOR_DEFAULT);
-                    id<MTLLibrary> vertexShaderLibrary = [rendererMetal->getDevice() newLibraryWithData:vertexShaderDispatchData error:&err];
-                    dispatch_release(vertexShaderDispatchData);
+                    id<MTLLibrary> vertexShaderLibrary = createLibrary(rendererMetal->getDevice(), uploadData.vertexShaderData, &err);
 
-                    if (err != Nil)
+                    if (!vertexShaderLibrary)
                     {
-                        if (vertexShaderLibrary) [vertexShaderLibrary release];
-                        Log(Log::Level::ERR) << "Failed to load vertex shader, " << [err.localizedDescription cStringUsingEncoding:NSUTF8StringEncoding];
+                        Log(Log::Level::ERR) << "Failed to load vertex shader, " << (err ? [err.localizedDescription cStringUsingEncoding:NSUTF8StringEncoding] : "unknown error");
                         return false;
                     }
 
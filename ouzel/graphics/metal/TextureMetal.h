@@ -37,6 +37,7 @@ namespace ouzel
 
             NSUInteger width = 0;
             NSUInteger height = 0;
+            PixelFormat pixelFormat = PixelFormat::RGBA8_UNORM;
         };
     } // namespace graphics
 } // namespace ouzel
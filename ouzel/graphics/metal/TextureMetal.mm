@@ -11,6 +11,22 @@ namespace ouzel
 {
     namespace graphics
     {
+        static MTLPixelFormat getTextureFormat(PixelFormat pixelFormat)
+        {
+            switch (pixelFormat)
+            {
+#if OUZEL_PLATFORM_MACOS
+                case PixelFormat::BC1_UNORM: return MTLPixelFormatBC1_RGBA;
+                case PixelFormat::BC3_UNORM: return MTLPixelFormatBC3_RGBA;
+                case PixelFormat::BC7_UNORM: return MTLPixelFormatBC7_RGBAUnorm;
+#else
+                case PixelFormat::ETC2_RGB8_UNORM: return MTLPixelFormatETC2_RGB8;
+                case PixelFormat::ETC2_RGBA8_UNORM: return MTLPixelFormatEAC_RGBA8;
+#endif
+                default: return MTLPixelFormatRGBA8Unorm;
+            }
+        }
+
         TextureMetal::TextureMetal()
         {
         }
@@ -35,6 +51,7 @@ namespace ouzel
 
             width = 0;
             height = 0;
+            pixelFormat = PixelFormat::RGBA8_UNORM;
         }
 
         bool TextureMetal::upload()
@@ -48,20 +65,24 @@ namespace ouzel
                 {
                     if (!texture ||
                         static_cast<NSUInteger>(uploadData.size.v[0]) != width ||
-                        static_cast<NSUInteger>(uploadData.size.v[1]) != height)
+                        static_cast<NSUInteger>(uploadData.size.v[1]) != height ||
+                        uploadData.pixelFormat != pixelFormat)
                     {
                         if (texture) [texture release];
 
                         width = static_cast<NSUInteger>(uploadData.size.v[0]);
                         height = static_cast<NSUInteger>(uploadData.size.v[1]);
+                        pixelFormat = uploadData.pixelFormat;
 
                         if (width > 0 && height > 0)
                         {
-                            MTLTextureDescriptor* textureDescriptor = [MTLTextureDescriptor texture2DDescriptorWithPixelFormat:uploadData.renderTarget ? rendererMetal->getMetalView().colorPixelFormat : MTLPixelFormatRGBA8Unorm
+                            MTLTextureDescriptor* textureDescriptor = [MTLTextureDescriptor texture2DDescriptorWithPixelFormat:uploadData.renderTarget ? rendererMetal->getMetalView().colorPixelFormat : getTextureFormat(pixelFormat)
                                                                                                                          width:width
                                                                                                                         height:height
                                                                                                                      mipmapped:uploadData.mipmaps ? YES : NO];
                             textureDescriptor.textureType = MTLTextureType2D;
+                            // compressed images can carry an incomplete mip chain
+                            if (uploadData.mipmaps) textureDescriptor.mipmapLevelCount = uploadData.levels.size();
                             textureDescriptor.usage = MTLTextureUsageShaderRead | (uploadData.renderTarget ? MTLTextureUsageRenderTarget : 0);
 
                             texture = [rendererMetal->getDevice() newTextureWithDescriptor:textureDescriptor];
@@ -78,13 +99,24 @@ namespace ouzel
                         [texture replaceRegion:MTLRegionMake2D(0, 0,
                                                                static_cast<NSUInteger>(uploadData.levels[level].size.v[0]),
                                                                static_cast<NSUInteger>(uploadData.levels[level].size.v[1]))
-                                   mipmapLevel:level withBytes:uploadData.levels[level].data.data()
+                                   mipmapLevel:level withBytes:uploadData.data.data() + uploadData.levels[level].offset
                                    bytesPerRow:static_cast<NSUInteger>(uploadData.levels[level].pitch)];
                     }
                 }
 
                 uploadData.dirty = false;
             }
+            else if (!uploadData.regions.empty() && texture)
+            {
+                for (const Region& region : uploadData.regions)
+                {
+                    [texture replaceRegion:MTLRegionMake2D(region.x, region.y, region.width, region.height)
+                               mipmapLevel:region.level withBytes:uploadData.regionData.data() + region.offset
+                               bytesPerRow:region.width * 4];
+                }
+
+                uploadData.regions.clear();
+            }
 
             return true;
         }
@@ -4,6 +4,7 @@
 #include <algorithm>
 #include "IndexBufferOGL.h"
 #include "RendererOGL.h"
+#include "core/Engine.h"
 #include "utils/Log.h"
 
 namespace ouzel
@@ -33,17 +34,18 @@ namespace ouzel
             }
 
             bufferSize = 0;
+            streamBufferId = 0;
         }
 
         bool IndexBufferOGL::bindBuffer()
         {
-            if (!bufferId)
+            if (!getBufferId())
             {
                 Log(Log::Level::ERR) << "Index buffer not initialized";
                 return false;
             }
 
-            if (!RendererOGL::bindElementArrayBuffer(bufferId))
+            if (!RendererOGL::bindElementArrayBuffer(getBufferId()))
             {
                 return false;
             }
@@ -86,79 +88,152 @@ namespace ouzel
                 {
                     if (!uploadData.data.empty())
                     {
-                        RendererOGL::bindVertexArray(0);
-                        RendererOGL::bindElementArrayBuffer(bufferId);
-
-                        if (static_cast<GLsizeiptr>(uploadData.data.size()) > bufferSize)
+                        if (!uploadData.dynamic || !uploadStreamBuffer())
                         {
-                            bufferSize = static_cast<GLsizeiptr>(uploadData.data.size());
-
-                            glBufferData(GL_ELEMENT_ARRAY_BUFFER, bufferSize, nullptr,
-                                         uploadData.dynamic ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW);
-
-                            if (RendererOGL::checkOpenGLError())
+                            if (!uploadBuffer())
                             {
-                                Log(Log::Level::ERR) << "Failed to create index buffer";
                                 return false;
                             }
                         }
+                    }
+                    else
+                    {
+                        // the stream section holds the previous data
+                        streamBufferId = 0;
+                    }
+
+                    uploadData.dirty &= ~INDEX_BUFFER_DIRTY;
+                }
+
+                uploadData.dirty = 0;
+            }
+
+            return true;
+        }
+
+        bool IndexBufferOGL::uploadBuffer()
+        {
+            streamBufferId = 0;
+
+            RendererOGL::bindVertexArray(0);
+            RendererOGL::bindElementArrayBuffer(bufferId);
+
+            if (static_cast<GLsizeiptr>(uploadData.data.size()) > bufferSize)
+            {
+                bufferSize = static_cast<GLsizeiptr>(uploadData.data.size());
 
-                        void* bufferPtr;
+                glBufferData(GL_ELEMENT_ARRAY_BUFFER, bufferSize, nullptr,
+                             uploadData.dynamic ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW);
+
+                if (RendererOGL::checkOpenGLError())
+                {
+                    Log(Log::Level::ERR) << "Failed to create index buffer";
+                    return false;
+                }
+            }
+
+            void* bufferPtr;
 
 #if OUZEL_OPENGL_INTERFACE_EGL
     #if defined(GL_EXT_map_buffer_range)
-                        bufferPtr = mapBufferRangeEXT ? mapBufferRangeEXT(GL_ELEMENT_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(uploadData.data.size()), GL_MAP_UNSYNCHRONIZED_BIT_EXT | GL_MAP_WRITE_BIT_EXT) : nullptr;
+            bufferPtr = mapBufferRangeEXT ? mapBufferRangeEXT(GL_ELEMENT_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(uploadData.data.size()), GL_MAP_UNSYNCHRONIZED_BIT_EXT | GL_MAP_WRITE_BIT_EXT) : nullptr;
     #elif defined(GL_OES_mapbuffer)
-                        bufferPtr = mapBufferOES ? mapBufferOES(GL_ELEMENT_ARRAY_BUFFER, GL_WRITE_ONLY_OES) : nullptr;
+            bufferPtr = mapBufferOES ? mapBufferOES(GL_ELEMENT_ARRAY_BUFFER, GL_WRITE_ONLY_OES) : nullptr;
     #else
-                        bufferPtr = nullptr;
+            bufferPtr = nullptr;
     #endif
 #else
-                        bufferPtr = glMapBufferRange(GL_ELEMENT_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(uploadData.data.size()), GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_WRITE_BIT);
+            bufferPtr = glMapBufferRange(GL_ELEMENT_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(uploadData.data.size()), GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_WRITE_BIT);
 #endif
 
-                        if (bufferPtr)
-                        {
-                            std::copy(uploadData.data.begin(), uploadData.data.end(), static_cast<uint8_t*>(bufferPtr));
+            if (bufferPtr)
+            {
+                std::copy(uploadData.data.begin(), uploadData.data.end(), static_cast<uint8_t*>(bufferPtr));
 
 #if OUZEL_OPENGL_INTERFACE_EGL
 #if defined(GL_OES_mapbuffer)
-                            if (unmapBufferOES) unmapBufferOES(GL_ELEMENT_ARRAY_BUFFER);
+                if (unmapBufferOES) unmapBufferOES(GL_ELEMENT_ARRAY_BUFFER);
 #endif
 #else
-                            glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER);
+                glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER);
 #endif
 
-                            if (RendererOGL::checkOpenGLError())
-                            {
-                                Log(Log::Level::ERR) << "Failed to upload index buffer";
-                                return false;
-                            }
-                        }
-                        else
-                        {
-                            // glMapBufferRange failed
-                            if (RendererOGL::checkOpenGLError())
-                            {
-                                Log(Log::Level::ERR) << "Failed to map index buffer";
-                                return false;
-                            }
+                if (RendererOGL::checkOpenGLError())
+                {
+                    Log(Log::Level::ERR) << "Failed to upload index buffer";
+                    return false;
+                }
+            }
+            else
+            {
+                // glMapBufferRange failed
+                if (RendererOGL::checkOpenGLError())
+                {
+                    Log(Log::Level::ERR) << "Failed to map index buffer";
+                    return false;
+                }
 
-                            glBufferData(GL_ELEMENT_ARRAY_BUFFER, bufferSize, uploadData.data.data(),
-                                         uploadData.dynamic ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW);
+                glBufferData(GL_ELEMENT_ARRAY_BUFFER, bufferSize, uploadData.data.data(),
+                             uploadData.dynamic ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW);
 
-                            if (RendererOGL::checkOpenGLError())
-                            {
-                                Log(Log::Level::ERR) << "Failed to upload index buffer";
-                                return false;
-                            }
-                        }
+                if (RendererOGL::checkOpenGLError())
+                {
+                    Log(Log::Level::ERR) << "Failed to upload index buffer";
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        bool IndexBufferOGL::uploadStreamBuffer()
+        {
+            RendererOGL* rendererOGL = static_cast<RendererOGL*>(sharedEngine->getRenderer());
+            StreamBufferOGL* streamBuffer = rendererOGL->getIndexStreamBuffer();
+
+            if (!streamBuffer)
+            {
+                return false;
+            }
+
+            uint8_t* bufferPtr = streamBuffer->allocate(static_cast<GLsizeiptr>(uploadData.data.size()), streamOffset);
+
+            if (!bufferPtr)
+            {
+                // the section is full, so the data goes to the buffer's own storage
+                return false;
+            }
+
+            std::copy(uploadData.data.begin(), uploadData.data.end(), bufferPtr);
+
+            streamBufferId = streamBuffer->getBufferId();
+            streamSize = static_cast<GLsizeiptr>(uploadData.data.size());
+            streamFrame = streamBuffer->getFrame();
+
+            return true;
+        }
+
+        bool IndexBufferOGL::refreshStreamBuffer()
+        {
+            if (streamBufferId)
+            {
+                RendererOGL* rendererOGL = static_cast<RendererOGL*>(sharedEngine->getRenderer());
+                StreamBufferOGL* streamBuffer = rendererOGL->getIndexStreamBuffer();
+
+                if (streamBuffer && streamBuffer->getFrame() - streamFrame >= StreamBufferOGL::SECTION_COUNT)
+                {
+                    // uploadData is only replaced together with an upload, so it still holds the bound data
+                    if (static_cast<GLsizeiptr>(uploadData.data.size()) != streamSize)
+                    {
+                        Log(Log::Level::ERR) << "Index buffer data changed without an upload";
+                        return false;
                     }
 
-                    uploadData.dirty &= ~INDEX_BUFFER_DIRTY;
+                    if (!uploadStreamBuffer() && !uploadBuffer())
+                    {
+                        return false;
+                    }
                 }
-
-                uploadData.dirty = 0;
             }
 
             return true;
@@ -44,7 +44,9 @@ namespace ouzel
             virtual ~IndexBufferOGL();
             virtual void free() override;
 
-            GLuint getBufferId() const { return bufferId; }
+            // returns the stream buffer if the data was streamed
+            GLuint getBufferId() const { return streamBufferId ? streamBufferId : bufferId; }
+            GLintptr getBufferOffset() const { return streamBufferId ? streamOffset : 0; }
             GLenum getType() const { return type; }
             GLuint getBytesPerIndex() const { return bytesPerIndex; }
 
@@ -52,9 +54,20 @@ namespace ouzel
             bool bindBuffer();
             virtual bool upload() override;
 
+            bool uploadBuffer();
+            bool uploadStreamBuffer();
+            // copies the data to the current stream buffer section if its old section is about to be reused
+            bool refreshStreamBuffer();
+
             GLuint bufferId = 0;
             GLsizeiptr bufferSize = 0;
 
+            // dynamic data is written to the renderer's stream buffer if there is space for it
+            GLuint streamBufferId = 0;
+            GLintptr streamOffset = 0;
+            GLsizeiptr streamSize = 0;
+            uint32_t streamFrame = 0;
+
             GLenum type = 0;
             GLuint bytesPerIndex = 0;
         };
@@ -38,25 +38,49 @@ namespace ouzel
 
         bool MeshBufferOGL::bindBuffers()
         {
+            std::shared_ptr<IndexBufferOGL> indexBufferOGL = std::static_pointer_cast<IndexBufferOGL>(uploadData.indexBuffer);
+            std::shared_ptr<VertexBufferOGL> vertexBufferOGL = std::static_pointer_cast<VertexBufferOGL>(uploadData.vertexBuffer);
+            std::shared_ptr<VertexBufferOGL> instanceBufferOGL = std::static_pointer_cast<VertexBufferOGL>(uploadData.instanceBuffer);
+
+            if (!indexBufferOGL || !indexBufferOGL->refreshStreamBuffer() ||
+                !vertexBufferOGL || !vertexBufferOGL->refreshStreamBuffer() ||
+                (instanceBufferOGL && !instanceBufferOGL->refreshStreamBuffer()))
+            {
+                return false;
+            }
+
             if (vertexArrayId)
             {
-                if (!RendererOGL::bindVertexArray(vertexArrayId))
+                if (vertexArrayIndexBufferId != indexBufferOGL->getBufferId() ||
+                    vertexArrayVertexBufferId != vertexBufferOGL->getBufferId() ||
+                    vertexArrayVertexBufferOffset != vertexBufferOGL->getBufferOffset() ||
+                    (instanceBufferOGL &&
+                     (vertexArrayInstanceBufferId != instanceBufferOGL->getBufferId() ||
+                      vertexArrayInstanceBufferOffset != instanceBufferOGL->getBufferOffset())))
+                {
+                    if (!setupVertexArray())
+                    {
+                        return false;
+                    }
+                }
+                else if (!RendererOGL::bindVertexArray(vertexArrayId))
                 {
                     return false;
                 }
             }
             else
             {
-                std::shared_ptr<IndexBufferOGL> indexBufferOGL = std::static_pointer_cast<IndexBufferOGL>(uploadData.indexBuffer);
-
-                if (!indexBufferOGL || !indexBufferOGL->bindBuffer())
+                if (!indexBufferOGL->bindBuffer())
                 {
                     return false;
                 }
 
-                std::shared_ptr<VertexBufferOGL> vertexBufferOGL = std::static_pointer_cast<VertexBufferOGL>(uploadData.vertexBuffer);
+                if (!vertexBufferOGL->bindBuffer())
+                {
+                    return false;
+                }
 
-                if (!vertexBufferOGL || !vertexBufferOGL->bindBuffer())
+                if (instanceBufferOGL && !bindInstanceBuffer(0))
                 {
                     return false;
                 }
@@ -65,6 +89,22 @@ namespace ouzel
             return true;
         }
 
+        bool MeshBufferOGL::bindInstanceBuffer(uint32_t startInstance)
+        {
+            std::shared_ptr<VertexBufferOGL> vertexBufferOGL = std::static_pointer_cast<VertexBufferOGL>(uploadData.vertexBuffer);
+            std::shared_ptr<VertexBufferOGL> instanceBufferOGL = std::static_pointer_cast<VertexBufferOGL>(uploadData.instanceBuffer);
+
+            if (!vertexBufferOGL || !instanceBufferOGL)
+            {
+                return false;
+            }
+
+            // instance attributes follow the attributes of the vertex buffer
+            GLuint firstAttribute = static_cast<GLuint>(vertexBufferOGL->vertexAttribs.size());
+
+            return instanceBufferOGL->bindBuffer(firstAttribute, startInstance);
+        }
+
         bool MeshBufferOGL::upload()
         {
             if (uploadData.dirty)
@@ -79,6 +119,11 @@ namespace ouzel
                     return false;
                 }
 
+                if (uploadData.instanceBuffer && !uploadData.instanceBuffer->upload())
+                {
+                    return false;
+                }
+
                 if (!vertexArrayId)
                 {
 #if OUZEL_OPENGL_INTERFACE_EAGL
@@ -95,28 +140,51 @@ namespace ouzel
                     Log(Log::Level::WARN) << "Failed to create vertex array";
                 }
 
-                if (vertexArrayId)
+                if (vertexArrayId && !setupVertexArray())
                 {
-                    RendererOGL::bindVertexArray(vertexArrayId);
+                    return false;
+                }
 
-                    std::shared_ptr<IndexBufferOGL> indexBufferOGL = std::static_pointer_cast<IndexBufferOGL>(uploadData.indexBuffer);
+                uploadData.dirty = false;
+            }
 
-                    if (indexBufferOGL && !indexBufferOGL->bindBuffer())
-                    {
-                        return false;
-                    }
+            return true;
+        }
 
-                    std::shared_ptr<VertexBufferOGL> vertexBufferOGL = std::static_pointer_cast<VertexBufferOGL>(uploadData.vertexBuffer);
+        bool MeshBufferOGL::setupVertexArray()
+        {
+            if (!RendererOGL::bindVertexArray(vertexArrayId))
+            {
+                return false;
+            }
 
-                    if (vertexBufferOGL && !vertexBufferOGL->bindBuffer())
-                    {
-                        return false;
-                    }
-                }
+            std::shared_ptr<IndexBufferOGL> indexBufferOGL = std::static_pointer_cast<IndexBufferOGL>(uploadData.indexBuffer);
 
-                uploadData.dirty = false;
+            if (indexBufferOGL && !indexBufferOGL->bindBuffer())
+            {
+                return false;
             }
 
+            std::shared_ptr<VertexBufferOGL> vertexBufferOGL = std::static_pointer_cast<VertexBufferOGL>(uploadData.vertexBuffer);
+
+            if (vertexBufferOGL && !vertexBufferOGL->bindBuffer())
+            {
+                return false;
+            }
+
+            std::shared_ptr<VertexBufferOGL> instanceBufferOGL = std::static_pointer_cast<VertexBufferOGL>(uploadData.instanceBuffer);
+
+            if (instanceBufferOGL && !bindInstanceBuffer(0))
+            {
+                return false;
+            }
+
+            vertexArrayIndexBufferId = indexBufferOGL ? indexBufferOGL->getBufferId() : 0;
+            vertexArrayVertexBufferId = vertexBufferOGL ? vertexBufferOGL->getBufferId() : 0;
+            vertexArrayVertexBufferOffset = vertexBufferOGL ? vertexBufferOGL->getBufferOffset() : 0;
+            vertexArrayInstanceBufferId = instanceBufferOGL ? instanceBufferOGL->getBufferId() : 0;
+            vertexArrayInstanceBufferOffset = instanceBufferOGL ? instanceBufferOGL->getBufferOffset() : 0;
+
             return true;
         }
     } // namespace graphics
@@ -42,13 +42,24 @@ namespace ouzel
             virtual void free() override;
 
             bool bindBuffers();
+            // points the per-instance attributes at the given instance
+            bool bindInstanceBuffer(uint32_t startInstance);
 
             GLuint getVertexArrayId() const { return vertexArrayId; }
 
         protected:
             virtual bool upload() override;
+            // binds the buffers to the vertex array
+            bool setupVertexArray();
 
             GLuint vertexArrayId = 0;
+
+            // streamed buffers move every frame, so the vertex array is set up again when these change
+            GLuint vertexArrayIndexBufferId = 0;
+            GLuint vertexArrayVertexBufferId = 0;
+            GLintptr vertexArrayVertexBufferOffset = 0;
+            GLuint vertexArrayInstanceBufferId = 0;
+            GLintptr vertexArrayInstanceBufferOffset = 0;
         };
     } // namespace graphics
 } // namespace ouzel
@@ -1,6 +1,7 @@
 // Copyright (C) 2016 Elviss Strazdins
 // This file is part of the Ouzel engine.
 
+#include <algorithm>
 #include <sstream>
 #include <iterator>
 
@@ -16,7 +17,6 @@
 #include "core/Window.h"
 #include "core/Cache.h"
 #include "utils/Log.h"
-#include "stb_image_write.h"
 
 #if OUZEL_SUPPORTS_OPENGL
 #include "ColorPSGL2.h"
@@ -28,6 +28,7 @@
 #include "ColorVSGL3.h"
 #include "TexturePSGL3.h"
 #include "TextureVSGL3.h"
+#include "TextureInstancedVSGL3.h"
 #endif
 #endif
 
@@ -41,6 +42,7 @@
 #include "ColorVSGLES3.h"
 #include "TexturePSGLES3.h"
 #include "TextureVSGLES3.h"
+#include "TextureInstancedVSGLES3.h"
 #endif
 #endif
 
@@ -96,6 +98,30 @@ namespace ouzel
             {
                 glDeleteFramebuffers(1, &msaaFrameBufferId);
             }
+
+            if (uniformBufferId)
+            {
+                glDeleteBuffers(1, &uniformBufferId);
+            }
+
+            // screenshots taken in the last frames are still in the buffers, save them from the oldest one
+            for (uint32_t i = 0; i < SCREENSHOT_BUFFER_COUNT; ++i)
+            {
+                uint32_t index = (screenshotBufferIndex + i) % SCREENSHOT_BUFFER_COUNT;
+
+                if (screenshotBuffers[index].pending)
+                {
+                    readScreenshotBuffer(index);
+                }
+            }
+
+            for (ScreenshotBuffer& screenshotBuffer : screenshotBuffers)
+            {
+                if (screenshotBuffer.bufferId)
+                {
+                    glDeleteBuffers(1, &screenshotBuffer.bufferId);
+                }
+            }
         }
 
         bool RendererOGL::init(Window* newWindow,
@@ -194,6 +220,107 @@ namespace ouzel
             }
 #endif
 
+            // compressed texture formats, ETC2 is a core format of OpenGL ES 3
+#if OUZEL_SUPPORTS_OPENGLES
+            etc2TexturesSupported = apiMajorVersion >= 3;
+#endif
+
+            // pixel pack buffers are core in OpenGL 2.1 and OpenGL ES 3, but reading them back needs buffer mapping
+#ifdef GL_PIXEL_PACK_BUFFER
+#if OUZEL_OPENGL_INTERFACE_EGL
+#if defined(GL_EXT_map_buffer_range) && defined(GL_OES_mapbuffer)
+            pixelPackBuffersSupported = apiMajorVersion >= 3 && mapBufferRangeEXT && unmapBufferOES;
+#endif
+#else
+            pixelPackBuffersSupported = apiMajorVersion >= 3;
+#endif
+#endif
+
+            std::vector<std::string> extensions;
+
+#ifdef GL_NUM_EXTENSIONS
+            if (apiMajorVersion >= 3)
+            {
+                GLint extensionCount = 0;
+                glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+
+                for (GLint i = 0; i < extensionCount; ++i)
+                {
+                    const GLubyte* extensionPtr = glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i));
+                    if (extensionPtr) extensions.push_back(reinterpret_cast<const char*>(extensionPtr));
+                }
+            }
+            else
+#endif
+            {
+                const GLubyte* extensionPtr = glGetString(GL_EXTENSIONS);
+
+                if (extensionPtr)
+                {
+                    std::istringstream extensionStringStream(reinterpret_cast<const char*>(extensionPtr));
+
+                    for (std::string extension; extensionStringStream >> extension;)
+                    {
+                        extensions.push_back(extension);
+                    }
+                }
+            }
+
+            if (checkOpenGLError())
+            {
+                Log(Log::Level::WARN) << "Failed to get OpenGL extensions";
+            }
+
+            bool bufferStorageSupported = apiMajorVersion > 4 || (apiMajorVersion == 4 && apiMinorVersion >= 4);
+
+            for (const std::string& extension : extensions)
+            {
+                if (extension == "GL_EXT_texture_compression_s3tc" ||
+                    extension == "GL_WEBGL_compressed_texture_s3tc")
+                {
+                    bcTexturesSupported = true;
+                }
+                else if (extension == "GL_ARB_texture_compression_bptc" ||
+                         extension == "GL_EXT_texture_compression_bptc")
+                {
+                    bc7TexturesSupported = true;
+                }
+                else if (extension == "GL_ARB_ES3_compatibility")
+                {
+                    etc2TexturesSupported = true;
+                }
+                else if (extension == "GL_ARB_buffer_storage")
+                {
+                    bufferStorageSupported = true;
+                }
+            }
+
+            // dynamic vertex and index data is written to persistently mapped buffers instead of mapping every buffer on upload
+            if (bufferStorageSupported)
+            {
+                if (!vertexStreamBuffer.init(GL_ARRAY_BUFFER, VERTEX_STREAM_SECTION_SIZE) ||
+                    !indexStreamBuffer.init(GL_ELEMENT_ARRAY_BUFFER, INDEX_STREAM_SECTION_SIZE))
+                {
+                    Log(Log::Level::WARN) << "Failed to create stream buffers, dynamic buffers will be mapped on upload";
+                }
+            }
+
+#ifdef GL_UNIFORM_BUFFER
+            if (apiMajorVersion >= 3)
+            {
+                glGenBuffers(1, &uniformBufferId);
+                glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniformBufferOffsetAlignment);
+
+                if (checkOpenGLError())
+                {
+                    Log(Log::Level::ERR) << "Failed to create uniform buffer";
+                    return false;
+                }
+
+                if (uniformBufferOffsetAlignment < 1) uniformBufferOffsetAlignment = 1;
+            }
+#endif
+
             frameBufferWidth = static_cast<GLsizei>(size.v[0]);
             frameBufferHeight = static_cast<GLsizei>(size.v[1]);
 
@@ -252,6 +379,32 @@ namespace ouzel
 
             sharedEngine->getCache()->setShader(SHADER_TEXTURE, textureShader);
 
+#if defined(GL_VERSION_3_3) || defined(GL_ES_VERSION_3_0)
+            if (apiMajorVersion >= 3)
+            {
+                ShaderPtr textureInstancedShader = createShader();
+
+#if OUZEL_SUPPORTS_OPENGL3
+                textureInstancedShader->initFromBuffers(std::vector<uint8_t>(std::begin(TexturePSGL3_glsl), std::end(TexturePSGL3_glsl)),
+                                                        std::vector<uint8_t>(std::begin(TextureInstancedVSGL3_glsl), std::end(TextureInstancedVSGL3_glsl)),
+                                                        VertexPCT::ATTRIBUTES | VertexInstance::ATTRIBUTES,
+                                                        {{"color", 4 * sizeof(float)}},
+                                                        {{"modelViewProj", sizeof(Matrix4)}});
+#elif OUZEL_SUPPORTS_OPENGLES3
+                textureInstancedShader->initFromBuffers(std::vector<uint8_t>(std::begin(TexturePSGLES3_glsl), std::end(TexturePSGLES3_glsl)),
+                                                        std::vector<uint8_t>(std::begin(TextureInstancedVSGLES3_glsl), std::end(TextureInstancedVSGLES3_glsl)),
+                                                        VertexPCT::ATTRIBUTES | VertexInstance::ATTRIBUTES,
+                                                        {{"color", 4 * sizeof(float)}},
+                                                        {{"modelViewProj", sizeof(Matrix4)}});
+#endif
+
+                sharedEngine->getCache()->setShader(SHADER_TEXTURE_INSTANCED, textureInstancedShader);
+
+                instancedShader = textureInstancedShader;
+                instancingSupported = true;
+            }
+#endif
+
             ShaderPtr colorShader = createShader();
 
             switch (apiMajorVersion)
@@ -405,6 +558,17 @@ namespace ouzel
 
         bool RendererOGL::present()
         {
+            // start a new section before the dynamic buffers are uploaded
+            if (vertexStreamBuffer.isInitialized() && !vertexStreamBuffer.beginFrame())
+            {
+                return false;
+            }
+
+            if (indexStreamBuffer.isInitialized() && !indexStreamBuffer.beginFrame())
+            {
+                return false;
+            }
+
             if (!Renderer::present())
             {
                 return false;
@@ -417,6 +581,11 @@ namespace ouzel
                 return false;
             }
 
+            if (!uploadShaderConstants())
+            {
+                return false;
+            }
+
             if (drawQueue.empty())
             {
                 frameBufferClearedFrame = currentFrame;
@@ -462,8 +631,10 @@ namespace ouzel
                     }
                 }
             }
-            else for (const DrawCommand& drawCommand : drawQueue)
+            else for (size_t drawIndex = 0; drawIndex < drawQueue.size(); ++drawIndex)
             {
+                const DrawCommand& drawCommand = drawQueue[drawIndex];
+
 #ifndef OUZEL_SUPPORTS_OPENGL
                 if (drawCommand.wireframe)
                 {
@@ -496,12 +667,7 @@ namespace ouzel
                 // textures
                 for (uint32_t layer = 0; layer < Texture::LAYERS; ++layer)
                 {
-                    std::shared_ptr<TextureOGL> textureOGL;
-
-                    if (drawCommand.textures.size() > layer)
-                    {
-                        textureOGL = std::static_pointer_cast<TextureOGL>(drawCommand.textures[layer]);
-                    }
+                    TextureOGL* textureOGL = static_cast<TextureOGL*>(drawCommand.textures[layer].get());
 
                     if (textureOGL)
                     {
@@ -542,40 +708,55 @@ namespace ouzel
                 useProgram(shaderOGL->getProgramId());
 
                 // pixel shader constants
+                const ShaderOGL::ConstantBlock& pixelShaderConstantBlock = shaderOGL->getPixelShaderConstantBlock();
                 const std::vector<ShaderOGL::Location>& pixelShaderConstantLocations = shaderOGL->getPixelShaderConstantLocations();
 
-                if (drawCommand.pixelShaderConstants.size() > pixelShaderConstantLocations.size())
+                if (pixelShaderConstantBlock.valid)
+                {
+                    if (drawCommand.pixelShaderConstantCount > pixelShaderConstantBlock.offsets.size())
+                    {
+                        Log(Log::Level::ERR) << "Invalid pixel shader constant size";
+                        return false;
+                    }
+
+#ifdef GL_UNIFORM_BUFFER
+                    glBindBufferRange(GL_UNIFORM_BUFFER, ShaderOGL::PIXEL_SHADER_CONSTANT_BINDING, uniformBufferId,
+                                      static_cast<GLintptr>(pixelShaderConstantOffsets[drawIndex]),
+                                      static_cast<GLsizeiptr>(pixelShaderConstantBlock.size));
+#endif
+                }
+                else if (drawCommand.pixelShaderConstantCount > pixelShaderConstantLocations.size())
                 {
                     Log(Log::Level::ERR) << "Invalid pixel shader constant size";
                     return false;
                 }
-
-                for (size_t i = 0; i < drawCommand.pixelShaderConstants.size(); ++i)
+                else for (uint32_t i = 0; i < drawCommand.pixelShaderConstantCount; ++i)
                 {
                     const ShaderOGL::Location& pixelShaderConstantLocation = pixelShaderConstantLocations[i];
-                    const std::vector<float>& pixelShaderConstant = drawCommand.pixelShaderConstants[i];
+                    const ShaderConstantRange& pixelShaderConstant = shaderConstants[drawCommand.pixelShaderConstantIndex + i];
+                    const float* pixelShaderConstantData = shaderConstantData.data() + pixelShaderConstant.offset;
 
                     uint32_t components = pixelShaderConstantLocation.size / 4;
 
                     switch (components)
                     {
                         case 1:
-                            glUniform1fv(pixelShaderConstantLocation.location, static_cast<GLsizei>(pixelShaderConstant.size() / components), pixelShaderConstant.data());
+                            glUniform1fv(pixelShaderConstantLocation.location, static_cast<GLsizei>(pixelShaderConstant.size / components), pixelShaderConstantData);
                             break;
                         case 2:
-                            glUniform2fv(pixelShaderConstantLocation.location, static_cast<GLsizei>(pixelShaderConstant.size() / components), pixelShaderConstant.data());
+                            glUniform2fv(pixelShaderConstantLocation.location, static_cast<GLsizei>(pixelShaderConstant.size / components), pixelShaderConstantData);
                             break;
                         case 3:
-                            glUniform3fv(pixelShaderConstantLocation.location, static_cast<GLsizei>(pixelShaderConstant.size() / components), pixelShaderConstant.data());
+                            glUniform3fv(pixelShaderConstantLocation.location, static_cast<GLsizei>(pixelShaderConstant.size / components), pixelShaderConstantData);
                             break;
                         case 4:
-                            glUniform4fv(pixelShaderConstantLocation.location, static_cast<GLsizei>(pixelShaderConstant.size() / components), pixelShaderConstant.data());
+                            glUniform4fv(pixelShaderConstantLocation.location, static_cast<GLsizei>(pixelShaderConstant.size / components), pixelShaderConstantData);
                             break;
                         case 9:
-                            glUniformMatrix3fv(pixelShaderConstantLocation.location, static_cast<GLsizei>(pixelShaderConstant.size() / components), GL_FALSE, pixelShaderConstant.data());
+                            glUniformMatrix3fv(pixelShaderConstantLocation.location, static_cast<GLsizei>(pixelShaderConstant.size / components), GL_FALSE, pixelShaderConstantData);
                             break;
                         case 16:
-                            glUniformMatrix4fv(pixelShaderConstantLocation.location, static_cast<GLsizei>(pixelShaderConstant.size() / components), GL_FALSE, pixelShaderConstant.data());
+                            glUniformMatrix4fv(pixelShaderConstantLocation.location, static_cast<GLsizei>(pixelShaderConstant.size / components), GL_FALSE, pixelShaderConstantData);
                             break;
                         default:
                             Log(Log::Level::ERR) << "Unsupported uniform size";
@@ -584,40 +765,55 @@ namespace ouzel
                 }
 
                 // vertex shader constants
+                const ShaderOGL::ConstantBlock& vertexShaderConstantBlock = shaderOGL->getVertexShaderConstantBlock();
                 const std::vector<ShaderOGL::Location>& vertexShaderConstantLocations = shaderOGL->getVertexShaderConstantLocations();
 
-                if (drawCommand.vertexShaderConstants.size() > vertexShaderConstantLocations.size())
+                if (vertexShaderConstantBlock.valid)
+                {
+                    if (drawCommand.vertexShaderConstantCount > vertexShaderConstantBlock.offsets.size())
+                    {
+                        Log(Log::Level::ERR) << "Invalid vertex shader constant size";
+                        return false;
+                    }
+
+#ifdef GL_UNIFORM_BUFFER
+                    glBindBufferRange(GL_UNIFORM_BUFFER, ShaderOGL::VERTEX_SHADER_CONSTANT_BINDING, uniformBufferId,
+                                      static_cast<GLintptr>(vertexShaderConstantOffsets[drawIndex]),
+                                      static_cast<GLsizeiptr>(vertexShaderConstantBlock.size));
+#endif
+                }
+                else if (drawCommand.vertexShaderConstantCount > vertexShaderConstantLocations.size())
                 {
                     Log(Log::Level::ERR) << "Invalid vertex shader constant size";
                     return false;
                 }
-
-                for (size_t i = 0; i < drawCommand.vertexShaderConstants.size(); ++i)
+                else for (uint32_t i = 0; i < drawCommand.vertexShaderConstantCount; ++i)
                 {
                     const ShaderOGL::Location& vertexShaderConstantLocation = vertexShaderConstantLocations[i];
-                    const std::vector<float>& vertexShaderConstant = drawCommand.vertexShaderConstants[i];
+                    const ShaderConstantRange& vertexShaderConstant = shaderConstants[drawCommand.vertexShaderConstantIndex + i];
+                    const float* vertexShaderConstantData = shaderConstantData.data() + vertexShaderConstant.offset;
 
                     uint32_t components = vertexShaderConstantLocation.size / 4;
 
                     switch (components)
                     {
                         case 1:
-                            glUniform1fv(vertexShaderConstantLocation.location, static_cast<GLsizei>(vertexShaderConstant.size() / components), vertexShaderConstant.data());
+                            glUniform1fv(vertexShaderConstantLocation.location, static_cast<GLsizei>(vertexShaderConstant.size / components), vertexShaderConstantData);
                             break;
                         case 2:
-                            glUniform2fv(vertexShaderConstantLocation.location, static_cast<GLsizei>(vertexShaderConstant.size() / components), vertexShaderConstant.data());
+                            glUniform2fv(vertexShaderConstantLocation.location, static_cast<GLsizei>(vertexShaderConstant.size / components), vertexShaderConstantData);
                             break;
                         case 3:
-                            glUniform3fv(vertexShaderConstantLocation.location, static_cast<GLsizei>(vertexShaderConstant.size() / components), vertexShaderConstant.data());
+                            glUniform3fv(vertexShaderConstantLocation.location, static_cast<GLsizei>(vertexShaderConstant.size / components), vertexShaderConstantData);
                             break;
                         case 4:
-                            glUniform4fv(vertexShaderConstantLocation.location, static_cast<GLsizei>(vertexShaderConstant.size() / components), vertexShaderConstant.data());
+                            glUniform4fv(vertexShaderConstantLocation.location, static_cast<GLsizei>(vertexShaderConstant.size / components), vertexShaderConstantData);
                             break;
                         case 9:
-                            glUniformMatrix3fv(vertexShaderConstantLocation.location, static_cast<GLsizei>(vertexShaderConstant.size() / components), GL_FALSE, vertexShaderConstant.data());
+                            glUniformMatrix3fv(vertexShaderConstantLocation.location, static_cast<GLsizei>(vertexShaderConstant.size / components), GL_FALSE, vertexShaderConstantData);
                             break;
                         case 16:
-                            glUniformMatrix4fv(vertexShaderConstantLocation.location, static_cast<GLsizei>(vertexShaderConstant.size() / components), GL_FALSE, vertexShaderConstant.data());
+                            glUniformMatrix4fv(vertexShaderConstantLocation.location, static_cast<GLsizei>(vertexShaderConstant.size / components), GL_FALSE, vertexShaderConstantData);
                             break;
                         default:
                             Log(Log::Level::ERR) << "Unsupported uniform size";
@@ -746,10 +942,29 @@ namespace ouzel
                     return false;
                 }
 
-                glDrawElements(mode,
-                               static_cast<GLsizei>(drawCommand.indexCount),
-                               indexBufferOGL->getType(),
-                               static_cast<const char*>(nullptr) + (drawCommand.startIndex * indexBufferOGL->getBytesPerIndex()));
+                if (drawCommand.instanceCount)
+                {
+#if defined(GL_VERSION_3_3) || defined(GL_ES_VERSION_3_0)
+                    // there is no base instance in GL 3.3 and GLES 3, so the instance attributes are offset instead
+                    if (!meshBufferOGL->bindInstanceBuffer(drawCommand.startInstance))
+                    {
+                        return false;
+                    }
+
+                    glDrawElementsInstanced(mode,
+                                            static_cast<GLsizei>(drawCommand.indexCount),
+                                            indexBufferOGL->getType(),
+                                            static_cast<const char*>(nullptr) + indexBufferOGL->getBufferOffset() + (drawCommand.startIndex * indexBufferOGL->getBytesPerIndex()),
+                                            static_cast<GLsizei>(drawCommand.instanceCount));
+#endif
+                }
+                else
+                {
+                    glDrawElements(mode,
+                                   static_cast<GLsizei>(drawCommand.indexCount),
+                                   indexBufferOGL->getType(),
+                                   static_cast<const char*>(nullptr) + indexBufferOGL->getBufferOffset() + (drawCommand.startIndex * indexBufferOGL->getBytesPerIndex()));
+                }
 
                 if (checkOpenGLError())
                 {
@@ -758,6 +973,16 @@ namespace ouzel
                 }
             }
 
+            if (vertexStreamBuffer.isInitialized() && !vertexStreamBuffer.endFrame())
+            {
+                return false;
+            }
+
+            if (indexStreamBuffer.isInitialized() && !indexStreamBuffer.endFrame())
+            {
+                return false;
+            }
+
             if (sampleCount > 1)
             {
 #if OUZEL_PLATFORM_MACOS
@@ -890,57 +1115,241 @@ namespace ouzel
             return meshBuffer;
         }
 
-        bool RendererOGL::saveScreenshots()
+        bool RendererOGL::uploadShaderConstants()
         {
-            for (;;)
+            if (!uniformBufferId)
             {
-                std::string filename;
+                return true;
+            }
 
+            uniformBufferData.clear();
+            pixelShaderConstantOffsets.resize(drawQueue.size());
+            vertexShaderConstantOffsets.resize(drawQueue.size());
+
+            for (size_t i = 0; i < drawQueue.size(); ++i)
+            {
+                const DrawCommand& drawCommand = drawQueue[i];
+                ShaderOGL* shaderOGL = static_cast<ShaderOGL*>(drawCommand.shader.get());
+
+                if (shaderOGL)
                 {
-                    std::lock_guard<std::mutex> lock(screenshotMutex);
+                    pixelShaderConstantOffsets[i] = packConstantBlock(shaderOGL->getPixelShaderConstantBlock(),
+                                                                      drawCommand.pixelShaderConstantIndex,
+                                                                      drawCommand.pixelShaderConstantCount);
+
+                    vertexShaderConstantOffsets[i] = packConstantBlock(shaderOGL->getVertexShaderConstantBlock(),
+                                                                       drawCommand.vertexShaderConstantIndex,
+                                                                       drawCommand.vertexShaderConstantCount);
+                }
+            }
 
-                    if (screenshotQueue.empty()) break;
+#ifdef GL_UNIFORM_BUFFER
+            if (!uniformBufferData.empty())
+            {
+                glBindBuffer(GL_UNIFORM_BUFFER, uniformBufferId);
+                // orphans the storage used by the previous frame
+                glBufferData(GL_UNIFORM_BUFFER, static_cast<GLsizeiptr>(uniformBufferData.size()),
+                             uniformBufferData.data(), GL_STREAM_DRAW);
 
-                    filename = screenshotQueue.front();
-                    screenshotQueue.pop();
+                if (checkOpenGLError())
+                {
+                    Log(Log::Level::ERR) << "Failed to upload uniform buffer";
+                    return false;
                 }
+            }
+#endif
 
-                bindFrameBuffer(frameBufferId);
+            return true;
+        }
 
-                const GLsizei width = frameBufferWidth;
-                const GLsizei height = frameBufferHeight;
-                const GLsizei depth = 4;
+        uint32_t RendererOGL::packConstantBlock(const ShaderOGL::ConstantBlock& constantBlock,
+                                                uint32_t constantIndex,
+                                                uint32_t constantCount)
+        {
+            if (!constantBlock.valid)
+            {
+                return 0;
+            }
 
-                std::vector<uint8_t> data(static_cast<size_t>(width * height * depth));
+            uint32_t alignment = static_cast<uint32_t>(uniformBufferOffsetAlignment);
+            uint32_t blockOffset = ((static_cast<uint32_t>(uniformBufferData.size()) + alignment - 1) / alignment) * alignment;
 
-                glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, data.data());
+            uniformBufferData.resize(blockOffset + constantBlock.size);
 
-                if (checkOpenGLError())
+            for (uint32_t i = 0; i < constantCount && i < constantBlock.offsets.size(); ++i)
+            {
+                const ShaderConstantRange& range = shaderConstants[constantIndex + i];
+                const uint8_t* data = reinterpret_cast<const uint8_t*>(shaderConstantData.data() + range.offset);
+
+                uint32_t offset = constantBlock.offsets[i];
+                uint32_t size = std::min(static_cast<uint32_t>(range.size * sizeof(float)), constantBlock.size - offset);
+
+                std::copy(data, data + size, uniformBufferData.begin() + blockOffset + offset);
+            }
+
+            return blockOffset;
+        }
+
+        bool RendererOGL::saveScreenshots()
+        {
+            // buffers written SCREENSHOT_BUFFER_COUNT - 1 frames ago are complete by now
+            for (uint32_t i = 0; i < SCREENSHOT_BUFFER_COUNT; ++i)
+            {
+                if (screenshotBuffers[i].pending &&
+                    currentFrame - screenshotBuffers[i].frame >= SCREENSHOT_BUFFER_COUNT - 1)
+                {
+                    if (!readScreenshotBuffer(i))
+                    {
+                        return false;
+                    }
+                }
+            }
+
+            std::vector<std::string> filenames = getScreenshotFilenames();
+
+            if (filenames.empty())
+            {
+                return true;
+            }
+
+            bindFrameBuffer(frameBufferId);
+
+            const GLsizei width = frameBufferWidth;
+            const GLsizei height = frameBufferHeight;
+            const GLsizeiptr size = static_cast<GLsizeiptr>(width) * height * 4;
+
+#ifdef GL_PIXEL_PACK_BUFFER
+            if (pixelPackBuffersSupported)
+            {
+                ScreenshotBuffer& screenshotBuffer = screenshotBuffers[screenshotBufferIndex];
+
+                // all buffers are in flight (screenshot every frame), so wait for the oldest one
+                if (screenshotBuffer.pending && !readScreenshotBuffer(screenshotBufferIndex))
                 {
-                    Log(Log::Level::ERR) << "Failed to read pixels from frame buffer";
                     return false;
                 }
 
-                uint8_t temp;
-                for (GLsizei row = 0; row < height / 2; ++row)
+                if (!screenshotBuffer.bufferId)
                 {
-                    for (GLsizei col = 0; col < width; ++col)
-                    {
-                        for (GLsizei z = 0; z < depth; ++z)
-                        {
-                            temp = data[static_cast<size_t>(((height - row - 1) * width + col) * depth + z)];
-                            data[static_cast<size_t>(((height - row - 1) * width + col) * depth + z)] = data[static_cast<size_t>((row * width + col) * depth + z)];
-                            data[static_cast<size_t>((row * width + col) * depth + z)] = temp;
-                        }
-                    }
+                    glGenBuffers(1, &screenshotBuffer.bufferId);
+                }
+
+                glBindBuffer(GL_PIXEL_PACK_BUFFER, screenshotBuffer.bufferId);
+
+                if (screenshotBuffer.size != size)
+                {
+                    glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+                    screenshotBuffer.size = size;
                 }
 
-                if (!stbi_write_png(filename.c_str(), width, height, depth, data.data(), width * depth))
+                glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+                glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+                if (checkOpenGLError())
                 {
-                    Log(Log::Level::ERR) << "Failed to save image to file";
+                    Log(Log::Level::ERR) << "Failed to read pixels from frame buffer";
                     return false;
                 }
+
+                screenshotBuffer.width = width;
+                screenshotBuffer.height = height;
+                screenshotBuffer.frame = currentFrame;
+                screenshotBuffer.pending = true;
+                screenshotBuffer.filenames = std::move(filenames);
+
+                screenshotBufferIndex = (screenshotBufferIndex + 1) % SCREENSHOT_BUFFER_COUNT;
+
+                return true;
             }
+#endif
+
+            std::vector<uint8_t> data(static_cast<size_t>(size));
+
+            glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, data.data());
+
+            if (checkOpenGLError())
+            {
+                Log(Log::Level::ERR) << "Failed to read pixels from frame buffer";
+                return false;
+            }
+
+            const size_t pitch = static_cast<size_t>(width) * 4;
+
+            for (GLsizei row = 0; row < height / 2; ++row)
+            {
+                std::swap_ranges(data.begin() + static_cast<std::ptrdiff_t>(static_cast<size_t>(row) * pitch),
+                                 data.begin() + static_cast<std::ptrdiff_t>(static_cast<size_t>(row + 1) * pitch),
+                                 data.begin() + static_cast<std::ptrdiff_t>(static_cast<size_t>(height - row - 1) * pitch));
+            }
+
+            saveScreenshotData(filenames, static_cast<uint32_t>(width), static_cast<uint32_t>(height), std::move(data));
+
+            return true;
+        }
+
+        bool RendererOGL::readScreenshotBuffer(uint32_t index)
+        {
+            ScreenshotBuffer& screenshotBuffer = screenshotBuffers[index];
+            screenshotBuffer.pending = false;
+
+#ifdef GL_PIXEL_PACK_BUFFER
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, screenshotBuffer.bufferId);
+
+            const void* bufferPtr;
+
+#if OUZEL_OPENGL_INTERFACE_EGL
+#if defined(GL_EXT_map_buffer_range)
+            bufferPtr = mapBufferRangeEXT(GL_PIXEL_PACK_BUFFER, 0, screenshotBuffer.size, GL_MAP_READ_BIT_EXT);
+#else
+            bufferPtr = nullptr;
+#endif
+#else
+            bufferPtr = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, screenshotBuffer.size, GL_MAP_READ_BIT);
+#endif
+
+            if (!bufferPtr)
+            {
+                checkOpenGLError();
+                glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+                Log(Log::Level::ERR) << "Failed to map pixel pack buffer";
+                return false;
+            }
+
+            // OpenGL stores the rows bottom-up
+            const size_t pitch = static_cast<size_t>(screenshotBuffer.width) * 4;
+            std::vector<uint8_t> data(static_cast<size_t>(screenshotBuffer.size));
+
+            const uint8_t* source = static_cast<const uint8_t*>(bufferPtr);
+
+            for (GLsizei row = 0; row < screenshotBuffer.height; ++row)
+            {
+                std::copy(source + static_cast<size_t>(screenshotBuffer.height - row - 1) * pitch,
+                          source + static_cast<size_t>(screenshotBuffer.height - row) * pitch,
+                          data.begin() + static_cast<std::ptrdiff_t>(static_cast<size_t>(row) * pitch));
+            }
+
+#if OUZEL_OPENGL_INTERFACE_EGL
+#if defined(GL_OES_mapbuffer)
+            unmapBufferOES(GL_PIXEL_PACK_BUFFER);
+#endif
+#else
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+#endif
+
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+            if (checkOpenGLError())
+            {
+                Log(Log::Level::ERR) << "Failed to read pixel pack buffer";
+                return false;
+            }
+
+            saveScreenshotData(screenshotBuffer.filenames,
+                               static_cast<uint32_t>(screenshotBuffer.width),
+                               static_cast<uint32_t>(screenshotBuffer.height),
+                               std::move(data));
+            screenshotBuffer.filenames.clear();
+#endif
 
             return true;
         }
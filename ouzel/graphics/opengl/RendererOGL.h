@@ -56,6 +56,8 @@
 
 #include "graphics/Renderer.h"
 #include "graphics/Texture.h"
+#include "graphics/opengl/ShaderOGL.h"
+#include "graphics/opengl/StreamBufferOGL.h"
 #include "utils/Log.h"
 
 namespace ouzel
@@ -85,6 +87,10 @@ namespace ouzel
             virtual IndexBufferPtr createIndexBuffer() override;
             virtual VertexBufferPtr createVertexBuffer() override;
 
+            // return nullptr if dynamic buffers can not be streamed
+            StreamBufferOGL* getVertexStreamBuffer() { return vertexStreamBuffer.isInitialized() ? &vertexStreamBuffer : nullptr; }
+            StreamBufferOGL* getIndexStreamBuffer() { return indexStreamBuffer.isInitialized() ? &indexStreamBuffer : nullptr; }
+
             static inline bool checkOpenGLError(bool logError = true)
             {
                 GLenum error = glGetError();
@@ -437,9 +443,15 @@ namespace ouzel
             virtual bool update();
 
             virtual bool saveScreenshots();
+            bool readScreenshotBuffer(uint32_t index);
 
             bool createMSAAFrameBuffer();
 
+            bool uploadShaderConstants();
+            uint32_t packConstantBlock(const ShaderOGL::ConstantBlock& constantBlock,
+                                       uint32_t constantIndex,
+                                       uint32_t constantCount);
+
             static void deleteResources();
 
             GLuint frameBufferId = 0;
@@ -452,6 +464,38 @@ namespace ouzel
             GLbitfield clearMask = 0;
             GLfloat frameBufferClearColor[4];
 
+            // frames are read into pixel pack buffers and mapped a few frames later, so that the readback does not stall the pipeline
+            static const uint32_t SCREENSHOT_BUFFER_COUNT = 3;
+
+            struct ScreenshotBuffer
+            {
+                GLuint bufferId = 0;
+                GLsizeiptr size = 0;
+                GLsizei width = 0;
+                GLsizei height = 0;
+                uint32_t frame = 0;
+                bool pending = false;
+                std::vector<std::string> filenames;
+            };
+
+            bool pixelPackBuffersSupported = false;
+            ScreenshotBuffer screenshotBuffers[SCREENSHOT_BUFFER_COUNT];
+            uint32_t screenshotBufferIndex = 0;
+
+            // shader constants of all draw commands of a frame, used if uniform buffers are supported
+            GLuint uniformBufferId = 0;
+            GLint uniformBufferOffsetAlignment = 1;
+            std::vector<uint8_t> uniformBufferData;
+            std::vector<uint32_t> pixelShaderConstantOffsets;
+            std::vector<uint32_t> vertexShaderConstantOffsets;
+
+            // per frame section sizes of the buffers that dynamic vertex and index data is streamed to
+            static const GLsizeiptr VERTEX_STREAM_SECTION_SIZE = 4 * 1024 * 1024;
+            static const GLsizeiptr INDEX_STREAM_SECTION_SIZE = 1024 * 1024;
+
+            StreamBufferOGL vertexStreamBuffer;
+            StreamBufferOGL indexStreamBuffer;
+
             struct StateCache
             {
                 GLuint textureId[Texture::LAYERS] = { 0 };
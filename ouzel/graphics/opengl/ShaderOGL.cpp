@@ -6,6 +6,7 @@
 #include "RendererOGL.h"
 #include "files/FileSystem.h"
 #include "utils/Log.h"
+#include "utils/Utils.h"
 
 namespace ouzel
 {
@@ -39,6 +40,8 @@ namespace ouzel
 
             pixelShaderConstantLocations.clear();
             vertexShaderConstantLocations.clear();
+            pixelShaderConstantBlock = ConstantBlock();
+            vertexShaderConstantBlock = ConstantBlock();
 
             if (programId)
             {
@@ -175,6 +178,36 @@ namespace ouzel
                         ++index;
                     }
 
+                    if (uploadData.vertexAttributes & VERTEX_INSTANCE_POSITION)
+                    {
+                        glBindAttribLocation(programId, index, "in_InstancePosition");
+                        ++index;
+                    }
+
+                    if (uploadData.vertexAttributes & VERTEX_INSTANCE_SIZE)
+                    {
+                        glBindAttribLocation(programId, index, "in_InstanceSize");
+                        ++index;
+                    }
+
+                    if (uploadData.vertexAttributes & VERTEX_INSTANCE_ROTATION)
+                    {
+                        glBindAttribLocation(programId, index, "in_InstanceRotation");
+                        ++index;
+                    }
+
+                    if (uploadData.vertexAttributes & VERTEX_INSTANCE_COLOR)
+                    {
+                        glBindAttribLocation(programId, index, "in_InstanceColor");
+                        ++index;
+                    }
+
+                    if (uploadData.vertexAttributes & VERTEX_INSTANCE_TEXCOORD_RECT)
+                    {
+                        glBindAttribLocation(programId, index, "in_InstanceTexCoordRect");
+                        ++index;
+                    }
+
                     glLinkProgram(programId);
 
                     GLint status;
@@ -219,35 +252,55 @@ namespace ouzel
                 }
 
                 pixelShaderConstantLocations.clear();
-                pixelShaderConstantLocations.reserve(uploadData.pixelShaderConstantInfo.size());
 
-                for (const ConstantInfo& info : uploadData.pixelShaderConstantInfo)
+                if (!initConstantBlock("PixelShaderConstants", PIXEL_SHADER_CONSTANT_BINDING,
+                                       uploadData.pixelShaderConstantInfo, pixelShaderConstantBlock))
                 {
-                    GLint location = glGetUniformLocation(programId, info.name.c_str());
+                    return false;
+                }
 
-                    if (location == -1 || RendererOGL::checkOpenGLError())
+                if (!pixelShaderConstantBlock.valid)
+                {
+                    pixelShaderConstantLocations.reserve(uploadData.pixelShaderConstantInfo.size());
+
+                    for (const ConstantInfo& info : uploadData.pixelShaderConstantInfo)
                     {
-                        Log(Log::Level::ERR) << "Failed to get OpenGL uniform location";
-                        return false;
-                    }
+                        GLint location = glGetUniformLocation(programId, info.name.c_str());
+
+                        if (location == -1 || RendererOGL::checkOpenGLError())
+                        {
+                            Log(Log::Level::ERR) << "Failed to get OpenGL uniform location";
+                            return false;
+                        }
 
-                    pixelShaderConstantLocations.push_back({ location, info.size });
+                        pixelShaderConstantLocations.push_back({ location, info.size });
+                    }
                 }
 
                 vertexShaderConstantLocations.clear();
-                vertexShaderConstantLocations.reserve(uploadData.vertexShaderConstantInfo.size());
 
-                for (const ConstantInfo& info : uploadData.vertexShaderConstantInfo)
+                if (!initConstantBlock("VertexShaderConstants", VERTEX_SHADER_CONSTANT_BINDING,
+                                       uploadData.vertexShaderConstantInfo, vertexShaderConstantBlock))
+                {
+                    return false;
+                }
+
+                if (!vertexShaderConstantBlock.valid)
                 {
-                    GLint location = glGetUniformLocation(programId, info.name.c_str());
+                    vertexShaderConstantLocations.reserve(uploadData.vertexShaderConstantInfo.size());
 
-                    if (location == -1 || RendererOGL::checkOpenGLError())
+                    for (const ConstantInfo& info : uploadData.vertexShaderConstantInfo)
                     {
-                        Log(Log::Level::ERR) << "Failed to get OpenGL uniform location";
-                        return false;
-                    }
+                        GLint location = glGetUniformLocation(programId, info.name.c_str());
 
-                    vertexShaderConstantLocations.push_back({ location, info.size });
+                        if (location == -1 || RendererOGL::checkOpenGLError())
+                        {
+                            Log(Log::Level::ERR) << "Failed to get OpenGL uniform location";
+                            return false;
+                        }
+
+                        vertexShaderConstantLocations.push_back({ location, info.size });
+                    }
                 }
 
                 uploadData.dirty = false;
@@ -255,5 +308,90 @@ namespace ouzel
 
             return true;
         }
+
+        bool ShaderOGL::initConstantBlock(const char* blockName, GLuint binding,
+                                          const std::vector<ConstantInfo>& constantInfo,
+                                          ConstantBlock& constantBlock)
+        {
+            constantBlock = ConstantBlock();
+
+#ifdef GL_UNIFORM_BUFFER
+            if (sharedEngine->getRenderer()->getAPIMajorVersion() < 3)
+            {
+                return true;
+            }
+
+            GLuint blockIndex = glGetUniformBlockIndex(programId, blockName);
+
+            if (blockIndex == GL_INVALID_INDEX)
+            {
+                // shader uses plain uniforms
+                return true;
+            }
+
+            glUniformBlockBinding(programId, blockIndex, binding);
+
+            GLint blockSize = 0;
+            glGetActiveUniformBlockiv(programId, blockIndex, GL_UNIFORM_BLOCK_DATA_SIZE, &blockSize);
+
+            if (RendererOGL::checkOpenGLError())
+            {
+                Log(Log::Level::ERR) << "Failed to get OpenGL uniform block " << blockName;
+                return false;
+            }
+
+            constantBlock.size = static_cast<uint32_t>(blockSize);
+            constantBlock.offsets.reserve(constantInfo.size());
+
+            for (const ConstantInfo& info : constantInfo)
+            {
+                const GLchar* name = info.name.c_str();
+                GLuint index = GL_INVALID_INDEX;
+                glGetUniformIndices(programId, 1, &name, &index);
+
+                if (index == GL_INVALID_INDEX || RendererOGL::checkOpenGLError())
+                {
+                    Log(Log::Level::ERR) << "Failed to get OpenGL uniform index";
+                    return false;
+                }
+
+                GLint offset = 0;
+                GLint arraySize = 0;
+                GLint arrayStride = 0;
+                GLint matrixStride = 0;
+                glGetActiveUniformsiv(programId, 1, &index, GL_UNIFORM_OFFSET, &offset);
+                glGetActiveUniformsiv(programId, 1, &index, GL_UNIFORM_SIZE, &arraySize);
+                glGetActiveUniformsiv(programId, 1, &index, GL_UNIFORM_ARRAY_STRIDE, &arrayStride);
+                glGetActiveUniformsiv(programId, 1, &index, GL_UNIFORM_MATRIX_STRIDE, &matrixStride);
+
+                if (RendererOGL::checkOpenGLError())
+                {
+                    Log(Log::Level::ERR) << "Failed to get OpenGL uniform info";
+                    return false;
+                }
+
+                // constant data is tightly packed, so only layouts without padding can be copied directly
+                uint32_t elementSize = info.size / static_cast<uint32_t>(arraySize > 0 ? arraySize : 1);
+
+                if ((arraySize > 1 && static_cast<uint32_t>(arrayStride) != elementSize) ||
+                    (matrixStride != 0 && (matrixStride != 16 || elementSize != 64)) ||
+                    static_cast<uint32_t>(offset) + info.size > constantBlock.size)
+                {
+                    Log(Log::Level::ERR) << "Unsupported layout of uniform " << info.name << " in block " << blockName;
+                    return false;
+                }
+
+                constantBlock.offsets.push_back(static_cast<uint32_t>(offset));
+            }
+
+            constantBlock.valid = true;
+#else
+            OUZEL_UNUSED(blockName);
+            OUZEL_UNUSED(binding);
+            OUZEL_UNUSED(constantInfo);
+#endif
+
+            return true;
+        }
     } // namespace graphics
 } // namespace ouzel
@@ -50,6 +50,20 @@ namespace ouzel
             const std::vector<Location>& getPixelShaderConstantLocations() const { return pixelShaderConstantLocations; }
             const std::vector<Location>& getVertexShaderConstantLocations() const { return vertexShaderConstantLocations; }
 
+            // uniform block binding points for shaders that declare PixelShaderConstants and VertexShaderConstants blocks
+            static const GLuint PIXEL_SHADER_CONSTANT_BINDING = 0;
+            static const GLuint VERTEX_SHADER_CONSTANT_BINDING = 1;
+
+            struct ConstantBlock
+            {
+                bool valid = false;
+                uint32_t size = 0;
+                std::vector<uint32_t> offsets; // offset of each constant in the block
+            };
+
+            const ConstantBlock& getPixelShaderConstantBlock() const { return pixelShaderConstantBlock; }
+            const ConstantBlock& getVertexShaderConstantBlock() const { return vertexShaderConstantBlock; }
+
             GLuint getProgramId() const { return programId; }
 
         protected:
@@ -58,12 +72,19 @@ namespace ouzel
             void printShaderMessage(GLuint shaderId);
             void printProgramMessage();
 
+            bool initConstantBlock(const char* blockName, GLuint binding,
+                                   const std::vector<ConstantInfo>& constantInfo,
+                                   ConstantBlock& constantBlock);
+
             GLuint pixelShaderId = 0;
             GLuint vertexShaderId = 0;
             GLuint programId = 0;
 
             std::vector<Location> pixelShaderConstantLocations;
             std::vector<Location> vertexShaderConstantLocations;
+
+            ConstantBlock pixelShaderConstantBlock;
+            ConstantBlock vertexShaderConstantBlock;
         };
     } // namespace graphics
 } // namespace ouzel
@@ -0,0 +1,163 @@
+// Copyright (C) 2016 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#include "StreamBufferOGL.h"
+#include "RendererOGL.h"
+#include "utils/Log.h"
+
+namespace ouzel
+{
+    namespace graphics
+    {
+        StreamBufferOGL::StreamBufferOGL()
+        {
+        }
+
+        StreamBufferOGL::~StreamBufferOGL()
+        {
+#ifdef GL_MAP_PERSISTENT_BIT
+            for (GLsync fence : fences)
+            {
+                if (fence) glDeleteSync(fence);
+            }
+#endif
+
+            if (bufferId)
+            {
+                glDeleteBuffers(1, &bufferId);
+            }
+        }
+
+        static bool bindStreamBuffer(GLenum target, GLuint bufferId)
+        {
+            if (target == GL_ELEMENT_ARRAY_BUFFER)
+            {
+                // element array binding is part of the vertex array state
+                return RendererOGL::bindVertexArray(0) &&
+                    RendererOGL::bindElementArrayBuffer(bufferId);
+            }
+            else
+            {
+                return RendererOGL::bindArrayBuffer(bufferId);
+            }
+        }
+
+        bool StreamBufferOGL::init(GLenum newTarget, GLsizeiptr newSectionSize)
+        {
+#ifdef GL_MAP_PERSISTENT_BIT
+            target = newTarget;
+            sectionSize = newSectionSize;
+
+            glGenBuffers(1, &bufferId);
+
+            if (!bindStreamBuffer(target, bufferId))
+            {
+                return false;
+            }
+
+            const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            GLsizeiptr bufferSize = sectionSize * SECTION_COUNT;
+
+            glBufferStorage(target, bufferSize, nullptr, flags);
+
+            if (RendererOGL::checkOpenGLError())
+            {
+                Log(Log::Level::ERR) << "Failed to create stream buffer";
+                return false;
+            }
+
+            mappedData = static_cast<uint8_t*>(glMapBufferRange(target, 0, bufferSize, flags));
+
+            if (RendererOGL::checkOpenGLError() || !mappedData)
+            {
+                Log(Log::Level::ERR) << "Failed to map stream buffer";
+                mappedData = nullptr;
+                return false;
+            }
+
+            return true;
+#else
+            (void)newTarget;
+            (void)newSectionSize;
+            return false;
+#endif
+        }
+
+        bool StreamBufferOGL::beginFrame()
+        {
+            if (!mappedData)
+            {
+                return false;
+            }
+
+            section = (section + 1) % SECTION_COUNT;
+            sectionUsed = 0;
+            ++frame;
+
+#ifdef GL_MAP_PERSISTENT_BIT
+            if (fences[section])
+            {
+                // the section was last written SECTION_COUNT frames ago, so this only blocks if the GPU is that far behind
+                GLenum result = glClientWaitSync(fences[section], GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+
+                while (result == GL_TIMEOUT_EXPIRED)
+                {
+                    result = glClientWaitSync(fences[section], 0, 1000000);
+                }
+
+                glDeleteSync(fences[section]);
+                fences[section] = nullptr;
+
+                if (result == GL_WAIT_FAILED)
+                {
+                    Log(Log::Level::ERR) << "Failed to wait for stream buffer fence";
+                    return false;
+                }
+            }
+#endif
+
+            return true;
+        }
+
+        bool StreamBufferOGL::endFrame()
+        {
+            if (!mappedData)
+            {
+                return false;
+            }
+
+#ifdef GL_MAP_PERSISTENT_BIT
+            if (fences[section])
+            {
+                glDeleteSync(fences[section]);
+            }
+
+            fences[section] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+            if (RendererOGL::checkOpenGLError())
+            {
+                Log(Log::Level::ERR) << "Failed to create stream buffer fence";
+                return false;
+            }
+#endif
+
+            return true;
+        }
+
+        uint8_t* StreamBufferOGL::allocate(GLsizeiptr size, GLintptr& offset)
+        {
+            // keep allocations aligned for any vertex attribute or index type
+            GLsizeiptr alignedSize = (size + 15) & ~static_cast<GLsizeiptr>(15);
+
+            if (!mappedData || sectionUsed + alignedSize > sectionSize)
+            {
+                return nullptr;
+            }
+
+            offset = static_cast<GLintptr>(section * sectionSize + sectionUsed);
+            sectionUsed += alignedSize;
+
+            return mappedData + offset;
+        }
+    } // namespace graphics
+} // namespace ouzel
@@ -0,0 +1,78 @@
+// Copyright (C) 2016 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#pragma once
+
+#include <cstdint>
+#include "core/CompileConfig.h"
+
+#if OUZEL_PLATFORM_MACOS
+    #include <OpenGL/gl3.h>
+#elif OUZEL_PLATFORM_IOS || OUZEL_PLATFORM_TVOS
+    #include <OpenGLES/ES2/gl.h>
+    #include <OpenGLES/ES2/glext.h>
+#elif OUZEL_PLATFORM_ANDROID
+    #include <GLES2/gl2platform.h>
+    #define GL_GLEXT_PROTOTYPES 1
+    #include <GLES2/gl2.h>
+    #include <GLES2/gl2ext.h>
+    #include <EGL/egl.h>
+#elif OUZEL_PLATFORM_LINUX
+    #define GL_GLEXT_PROTOTYPES 1
+    #include <GL/gl.h>
+    #include <GL/glx.h>
+    #include <GL/glext.h>
+#elif OUZEL_PLATFORM_RASPBIAN || OUZEL_PLATFORM_EMSCRIPTEN
+    #define GL_GLEXT_PROTOTYPES 1
+    #include <GLES2/gl2.h>
+    #include <GLES2/gl2ext.h>
+    #include <EGL/egl.h>
+#endif
+
+#include "utils/Noncopyable.h"
+
+namespace ouzel
+{
+    namespace graphics
+    {
+        // persistently mapped buffer that dynamic vertex and index data is written to every frame
+        // the buffer is split into sections, one per frame in flight, and a fence guards each section
+        class StreamBufferOGL: public Noncopyable
+        {
+        public:
+            static const uint32_t SECTION_COUNT = 3;
+
+            StreamBufferOGL();
+            ~StreamBufferOGL();
+
+            // returns false if persistent buffer mapping is not supported
+            bool init(GLenum newTarget, GLsizeiptr newSectionSize);
+
+            // moves to the next section, waits for the GPU if it is still reading it
+            bool beginFrame();
+            // fences the current section after the draw calls that read it
+            bool endFrame();
+
+            // returns nullptr if there is no space left in the current section
+            uint8_t* allocate(GLsizeiptr size, GLintptr& offset);
+
+            bool isInitialized() const { return mappedData != nullptr; }
+            GLuint getBufferId() const { return bufferId; }
+            uint32_t getFrame() const { return frame; }
+
+        protected:
+            GLenum target = 0;
+            GLuint bufferId = 0;
+            GLsizeiptr sectionSize = 0;
+            uint8_t* mappedData = nullptr;
+
+            uint32_t section = 0;
+            uint32_t frame = 0;
+            GLsizeiptr sectionUsed = 0;
+
+#ifdef GL_MAP_PERSISTENT_BIT
+            GLsync fences[SECTION_COUNT] = { nullptr };
+#endif
+        };
+    } // namespace graphics
+} // namespace ouzel
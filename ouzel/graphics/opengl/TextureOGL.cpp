@@ -5,12 +5,42 @@
 #include "core/Engine.h"
 #include "RendererOGL.h"
 #include "graphics/Image.h"
+#include "graphics/TextureCompression.h"
 #include "utils/Log.h"
 
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM
+#define GL_COMPRESSED_RGBA_BPTC_UNORM 0x8E8C
+#endif
+#ifndef GL_COMPRESSED_RGB8_ETC2
+#define GL_COMPRESSED_RGB8_ETC2 0x9274
+#endif
+#ifndef GL_COMPRESSED_RGBA8_ETC2_EAC
+#define GL_COMPRESSED_RGBA8_ETC2_EAC 0x9278
+#endif
+
 namespace ouzel
 {
     namespace graphics
     {
+        static GLenum getCompressedFormat(PixelFormat pixelFormat)
+        {
+            switch (pixelFormat)
+            {
+                case PixelFormat::BC1_UNORM: return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+                case PixelFormat::BC3_UNORM: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+                case PixelFormat::BC7_UNORM: return GL_COMPRESSED_RGBA_BPTC_UNORM;
+                case PixelFormat::ETC2_RGB8_UNORM: return GL_COMPRESSED_RGB8_ETC2;
+                case PixelFormat::ETC2_RGBA8_UNORM: return GL_COMPRESSED_RGBA8_ETC2_EAC;
+                default: return 0;
+            }
+        }
+
         TextureOGL::TextureOGL()
         {
         }
@@ -35,6 +65,7 @@ namespace ouzel
 
             width = 0;
             height = 0;
+            pixelFormat = PixelFormat::RGBA8_UNORM;
         }
 
         bool TextureOGL::upload()
@@ -79,6 +110,14 @@ namespace ouzel
                                 glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
                                 break;
                         }
+
+#ifdef GL_TEXTURE_MAX_LEVEL
+                        // compressed images can carry an incomplete mip chain
+                        if (rendererOGL->getAPIMajorVersion() >= 3)
+                        {
+                            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(uploadData.levels.size() - 1));
+                        }
+#endif
                     }
                     else
                     {
@@ -91,28 +130,69 @@ namespace ouzel
                         return false;
                     }
 
+                    // compressed levels are uploaded as they are, the texture is recreated when the size or format changes
+                    GLenum compressedFormat = getCompressedFormat(uploadData.pixelFormat);
+
                     if (static_cast<GLsizei>(uploadData.size.v[0]) != width ||
-                        static_cast<GLsizei>(uploadData.size.v[1]) != height)
+                        static_cast<GLsizei>(uploadData.size.v[1]) != height ||
+                        uploadData.pixelFormat != pixelFormat)
                     {
                         width = static_cast<GLsizei>(uploadData.size.v[0]);
                         height = static_cast<GLsizei>(uploadData.size.v[1]);
+                        pixelFormat = uploadData.pixelFormat;
 
                         for (size_t level = 0; level < uploadData.levels.size(); ++level)
                         {
-                            glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), GL_RGBA,
-                                         static_cast<GLsizei>(uploadData.levels[level].size.v[0]),
-                                         static_cast<GLsizei>(uploadData.levels[level].size.v[1]), 0,
-                                         GL_RGBA, GL_UNSIGNED_BYTE, uploadData.levels[level].data.data());
+                            const Level& textureLevel = uploadData.levels[level];
+                            GLsizei levelWidth = static_cast<GLsizei>(textureLevel.size.v[0]);
+                            GLsizei levelHeight = static_cast<GLsizei>(textureLevel.size.v[1]);
+
+                            if (compressedFormat)
+                            {
+                                glCompressedTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), compressedFormat,
+                                                       levelWidth, levelHeight, 0,
+                                                       static_cast<GLsizei>(getPixelFormatSize(pixelFormat,
+                                                                                               static_cast<uint32_t>(levelWidth),
+                                                                                               static_cast<uint32_t>(levelHeight))),
+                                                       uploadData.data.data() + textureLevel.offset);
+                            }
+                            else
+                            {
+                                glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), GL_RGBA,
+                                             levelWidth, levelHeight, 0,
+                                             GL_RGBA, GL_UNSIGNED_BYTE, uploadData.data.data() + textureLevel.offset);
+                            }
+                        }
+
+                        if (RendererOGL::checkOpenGLError())
+                        {
+                            Log(Log::Level::ERR) << "Failed to upload texture data";
+                            return false;
                         }
                     }
                     else
                     {
                         for (size_t level = 0; level < uploadData.levels.size(); ++level)
                         {
-                            glTexSubImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), 0, 0,
-                                            static_cast<GLsizei>(uploadData.levels[level].size.v[0]),
-                                            static_cast<GLsizei>(uploadData.levels[level].size.v[1]),
-                                            GL_RGBA, GL_UNSIGNED_BYTE, uploadData.levels[level].data.data());
+                            const Level& textureLevel = uploadData.levels[level];
+                            GLsizei levelWidth = static_cast<GLsizei>(textureLevel.size.v[0]);
+                            GLsizei levelHeight = static_cast<GLsizei>(textureLevel.size.v[1]);
+
+                            if (compressedFormat)
+                            {
+                                glCompressedTexSubImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), 0, 0,
+                                                          levelWidth, levelHeight, compressedFormat,
+                                                          static_cast<GLsizei>(getPixelFormatSize(pixelFormat,
+                                                                                                  static_cast<uint32_t>(levelWidth),
+                                                                                                  static_cast<uint32_t>(levelHeight))),
+                                                          uploadData.data.data() + textureLevel.offset);
+                            }
+                            else
+                            {
+                                glTexSubImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), 0, 0,
+                                                levelWidth, levelHeight,
+                                                GL_RGBA, GL_UNSIGNED_BYTE, uploadData.data.data() + textureLevel.offset);
+                            }
 
                             if (RendererOGL::checkOpenGLError())
                             {
@@ -125,6 +205,27 @@ namespace ouzel
 
                 uploadData.dirty = false;
             }
+            else if (!uploadData.regions.empty() && textureId)
+            {
+                RendererOGL::bindTexture(textureId, 0);
+
+                // region rows are tightly packed RGBA8 pixels, so the default unpack alignment of 4 fits them
+                for (const Region& region : uploadData.regions)
+                {
+                    glTexSubImage2D(GL_TEXTURE_2D, static_cast<GLint>(region.level),
+                                    static_cast<GLint>(region.x), static_cast<GLint>(region.y),
+                                    static_cast<GLsizei>(region.width), static_cast<GLsizei>(region.height),
+                                    GL_RGBA, GL_UNSIGNED_BYTE, uploadData.regionData.data() + region.offset);
+                }
+
+                if (RendererOGL::checkOpenGLError())
+                {
+                    Log(Log::Level::ERR) << "Failed to upload texture region";
+                    return false;
+                }
+
+                uploadData.regions.clear();
+            }
 
             return true;
         }
@@ -53,6 +53,7 @@ namespace ouzel
 
             GLsizei width = 0;
             GLsizei height = 0;
+            PixelFormat pixelFormat = PixelFormat::RGBA8_UNORM;
         };
     } // namespace graphics
 } // namespace ouzel
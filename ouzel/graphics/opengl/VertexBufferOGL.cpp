@@ -4,6 +4,8 @@
 #include <algorithm>
 #include "VertexBufferOGL.h"
 #include "RendererOGL.h"
+#include "core/Engine.h"
+#include "utils/Log.h"
 
 namespace ouzel
 {
@@ -32,32 +34,46 @@ namespace ouzel
             }
 
             bufferSize = 0;
+            streamBufferId = 0;
         }
 
-        bool VertexBufferOGL::bindBuffer()
+        bool VertexBufferOGL::bindBuffer(GLuint firstAttribute, GLuint startVertex)
         {
-            if (!bufferId)
+            if (!getBufferId())
             {
                 Log(Log::Level::ERR) << "Vertex buffer not initialized";
                 return false;
             }
 
-            if (!RendererOGL::bindArrayBuffer(bufferId))
+            if (!RendererOGL::bindArrayBuffer(getBufferId()))
             {
                 return false;
             }
 
-            for (GLuint index = 0; index < VERTEX_ATTRIBUTE_COUNT; ++index)
+            GLuint attributeCount = sharedEngine->getRenderer()->isInstancingSupported() ?
+                VERTEX_ATTRIBUTE_COUNT : VERTEX_NON_INSTANCE_ATTRIBUTE_COUNT;
+            uintptr_t startOffset = static_cast<uintptr_t>(getBufferOffset()) + static_cast<uintptr_t>(startVertex) * uploadData.vertexSize;
+
+            for (GLuint index = firstAttribute; index < attributeCount; ++index)
             {
-                if (index < vertexAttribs.size())
+                GLuint attribute = index - firstAttribute;
+
+                if (attribute < vertexAttribs.size())
                 {
                     glEnableVertexAttribArray(index);
                     glVertexAttribPointer(index,
-                                          vertexAttribs[index].size,
-                                          vertexAttribs[index].type,
-                                          vertexAttribs[index].normalized,
-                                          vertexAttribs[index].stride,
-                                          vertexAttribs[index].pointer);
+                                          vertexAttribs[attribute].size,
+                                          vertexAttribs[attribute].type,
+                                          vertexAttribs[attribute].normalized,
+                                          vertexAttribs[attribute].stride,
+                                          reinterpret_cast<const GLvoid*>(reinterpret_cast<uintptr_t>(vertexAttribs[attribute].pointer) + startOffset));
+
+#if defined(GL_VERSION_3_3) || defined(GL_ES_VERSION_3_0)
+                    if (vertexAttribs[attribute].divisor)
+                    {
+                        glVertexAttribDivisor(index, vertexAttribs[attribute].divisor);
+                    }
+#endif
                 }
                 else
                 {
@@ -94,7 +110,8 @@ namespace ouzel
                         vertexAttribs.push_back({
                             3, GL_FLOAT, GL_FALSE,
                             static_cast<GLsizei>(uploadData.vertexSize),
-                            reinterpret_cast<const GLvoid*>(offset)
+                            reinterpret_cast<const GLvoid*>(offset),
+                            0
                         });
                         offset += 3 * sizeof(float);
                     }
@@ -103,7 +120,8 @@ namespace ouzel
                         vertexAttribs.push_back({
                             4, GL_UNSIGNED_BYTE, GL_TRUE,
                             static_cast<GLsizei>(uploadData.vertexSize),
-                            reinterpret_cast<const GLvoid*>(offset)
+                            reinterpret_cast<const GLvoid*>(offset),
+                            0
                         });
                         offset += 4 * sizeof(uint8_t);
                     }
@@ -112,7 +130,8 @@ namespace ouzel
                         vertexAttribs.push_back({
                             3, GL_FLOAT, GL_FALSE,
                             static_cast<GLsizei>(uploadData.vertexSize),
-                            reinterpret_cast<const GLvoid*>(offset)
+                            reinterpret_cast<const GLvoid*>(offset),
+                            0
                         });
                         offset += 3 * sizeof(float);
                     }
@@ -121,7 +140,8 @@ namespace ouzel
                         vertexAttribs.push_back({
                             2, GL_FLOAT, GL_FALSE,
                             static_cast<GLsizei>(uploadData.vertexSize),
-                            reinterpret_cast<const GLvoid*>(offset)
+                            reinterpret_cast<const GLvoid*>(offset),
+                            0
                         });
                         offset += 2 * sizeof(float);
                     }
@@ -130,11 +150,63 @@ namespace ouzel
                         vertexAttribs.push_back({
                             2, GL_FLOAT, GL_FALSE,
                             static_cast<GLsizei>(uploadData.vertexSize),
-                            reinterpret_cast<const GLvoid*>(offset)
+                            reinterpret_cast<const GLvoid*>(offset),
+                            0
                         });
                         offset += 2 * sizeof(float);
                     }
 
+                    if (uploadData.vertexAttributes & VERTEX_INSTANCE_POSITION)
+                    {
+                        vertexAttribs.push_back({
+                            3, GL_FLOAT, GL_FALSE,
+                            static_cast<GLsizei>(uploadData.vertexSize),
+                            reinterpret_cast<const GLvoid*>(offset),
+                            1
+                        });
+                        offset += 3 * sizeof(float);
+                    }
+                    if (uploadData.vertexAttributes & VERTEX_INSTANCE_SIZE)
+                    {
+                        vertexAttribs.push_back({
+                            2, GL_FLOAT, GL_FALSE,
+                            static_cast<GLsizei>(uploadData.vertexSize),
+                            reinterpret_cast<const GLvoid*>(offset),
+                            1
+                        });
+                        offset += 2 * sizeof(float);
+                    }
+                    if (uploadData.vertexAttributes & VERTEX_INSTANCE_ROTATION)
+                    {
+                        vertexAttribs.push_back({
+                            1, GL_FLOAT, GL_FALSE,
+                            static_cast<GLsizei>(uploadData.vertexSize),
+                            reinterpret_cast<const GLvoid*>(offset),
+                            1
+                        });
+                        offset += sizeof(float);
+                    }
+                    if (uploadData.vertexAttributes & VERTEX_INSTANCE_COLOR)
+                    {
+                        vertexAttribs.push_back({
+                            4, GL_UNSIGNED_BYTE, GL_TRUE,
+                            static_cast<GLsizei>(uploadData.vertexSize),
+                            reinterpret_cast<const GLvoid*>(offset),
+                            1
+                        });
+                        offset += 4 * sizeof(uint8_t);
+                    }
+                    if (uploadData.vertexAttributes & VERTEX_INSTANCE_TEXCOORD_RECT)
+                    {
+                        vertexAttribs.push_back({
+                            4, GL_FLOAT, GL_FALSE,
+                            static_cast<GLsizei>(uploadData.vertexSize),
+                            reinterpret_cast<const GLvoid*>(offset),
+                            1
+                        });
+                        offset += 4 * sizeof(float);
+                    }
+
                     if (offset != uploadData.vertexSize)
                     {
                         Log(Log::Level::ERR) << "Invalid vertex size";
@@ -148,81 +220,152 @@ namespace ouzel
                 {
                     if (!uploadData.data.empty())
                     {
-                        RendererOGL::bindVertexArray(0);
-                        RendererOGL::bindArrayBuffer(bufferId);
-
-                        if (static_cast<GLsizeiptr>(uploadData.data.size()) > bufferSize)
+                        if (!uploadData.dynamic || !uploadStreamBuffer())
                         {
-                            bufferSize = static_cast<GLsizeiptr>(uploadData.data.size());
-
-                            glBufferData(GL_ARRAY_BUFFER, bufferSize, nullptr,
-                                         uploadData.dynamic ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW);
-
-                            if (RendererOGL::checkOpenGLError())
+                            if (!uploadBuffer())
                             {
-                                Log(Log::Level::ERR) << "Failed to create vertex buffer";
                                 return false;
                             }
                         }
+                    }
+                    else
+                    {
+                        // the stream section holds the previous data
+                        streamBufferId = 0;
+                    }
+
+                    uploadData.dirty &= ~VERTEX_BUFFER_DIRTY;
+                }
+
+                uploadData.dirty = 0;
+            }
+
+            return true;
+        }
+
+        bool VertexBufferOGL::uploadBuffer()
+        {
+            streamBufferId = 0;
+
+            RendererOGL::bindVertexArray(0);
+            RendererOGL::bindArrayBuffer(bufferId);
+
+            if (static_cast<GLsizeiptr>(uploadData.data.size()) > bufferSize)
+            {
+                bufferSize = static_cast<GLsizeiptr>(uploadData.data.size());
+
+                glBufferData(GL_ARRAY_BUFFER, bufferSize, nullptr,
+                             uploadData.dynamic ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW);
 
-                        void* bufferPtr;
+                if (RendererOGL::checkOpenGLError())
+                {
+                    Log(Log::Level::ERR) << "Failed to create vertex buffer";
+                    return false;
+                }
+            }
+
+            void* bufferPtr;
 
 #if OUZEL_OPENGL_INTERFACE_EGL
     #if defined(GL_EXT_map_buffer_range)
-                        bufferPtr = mapBufferRangeEXT ? mapBufferRangeEXT(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(uploadData.data.size()), GL_MAP_UNSYNCHRONIZED_BIT_EXT | GL_MAP_WRITE_BIT_EXT) : nullptr;
+            bufferPtr = mapBufferRangeEXT ? mapBufferRangeEXT(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(uploadData.data.size()), GL_MAP_UNSYNCHRONIZED_BIT_EXT | GL_MAP_WRITE_BIT_EXT) : nullptr;
     #elif defined(GL_OES_mapbuffer)
-                        bufferPtr = mapBufferOES ? mapBufferOES(GL_ARRAY_BUFFER, GL_WRITE_ONLY_OES) : nullptr;
+            bufferPtr = mapBufferOES ? mapBufferOES(GL_ARRAY_BUFFER, GL_WRITE_ONLY_OES) : nullptr;
     #else
-                        bufferPtr = nullptr;
+            bufferPtr = nullptr;
     #endif
 #else
-                        bufferPtr = glMapBufferRange(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(uploadData.data.size()), GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_WRITE_BIT);
+            bufferPtr = glMapBufferRange(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(uploadData.data.size()), GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_WRITE_BIT);
 #endif
 
-                        if (bufferPtr)
-                        {
-                            std::copy(uploadData.data.begin(), uploadData.data.end(), static_cast<uint8_t*>(bufferPtr));
+            if (bufferPtr)
+            {
+                std::copy(uploadData.data.begin(), uploadData.data.end(), static_cast<uint8_t*>(bufferPtr));
 
 #if OUZEL_OPENGL_INTERFACE_EGL
 #if defined(GL_OES_mapbuffer)
-                            if (unmapBufferOES) unmapBufferOES(GL_ARRAY_BUFFER);
+                if (unmapBufferOES) unmapBufferOES(GL_ARRAY_BUFFER);
 #endif
 #else
-                            glUnmapBuffer(GL_ARRAY_BUFFER);
+                glUnmapBuffer(GL_ARRAY_BUFFER);
 #endif
-                            
-                            if (RendererOGL::checkOpenGLError())
-                            {
-                                Log(Log::Level::ERR) << "Failed to upload vertex buffer";
-                                return false;
-                            }
-                        }
-                        else
-                        {
-                            // glMapBufferRange failed
-                            if (RendererOGL::checkOpenGLError())
-                            {
-                                Log(Log::Level::ERR) << "Failed to map vertex buffer";
-                                return false;
-                            }
 
-                            glBufferData(GL_ARRAY_BUFFER, bufferSize, uploadData.data.data(),
-                                         uploadData.dynamic ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW);
+                if (RendererOGL::checkOpenGLError())
+                {
+                    Log(Log::Level::ERR) << "Failed to upload vertex buffer";
+                    return false;
+                }
+            }
+            else
+            {
+                // glMapBufferRange failed
+                if (RendererOGL::checkOpenGLError())
+                {
+                    Log(Log::Level::ERR) << "Failed to map vertex buffer";
+                    return false;
+                }
 
-                            if (RendererOGL::checkOpenGLError())
-                            {
-                                Log(Log::Level::ERR) << "Failed to upload vertex buffer";
-                                return false;
-                            }
-                        }
+                glBufferData(GL_ARRAY_BUFFER, bufferSize, uploadData.data.data(),
+                             uploadData.dynamic ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW);
+
+                if (RendererOGL::checkOpenGLError())
+                {
+                    Log(Log::Level::ERR) << "Failed to upload vertex buffer";
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        bool VertexBufferOGL::uploadStreamBuffer()
+        {
+            RendererOGL* rendererOGL = static_cast<RendererOGL*>(sharedEngine->getRenderer());
+            StreamBufferOGL* streamBuffer = rendererOGL->getVertexStreamBuffer();
+
+            if (!streamBuffer)
+            {
+                return false;
+            }
 
+            uint8_t* bufferPtr = streamBuffer->allocate(static_cast<GLsizeiptr>(uploadData.data.size()), streamOffset);
 
+            if (!bufferPtr)
+            {
+                // the section is full, so the data goes to the buffer's own storage
+                return false;
+            }
+
+            std::copy(uploadData.data.begin(), uploadData.data.end(), bufferPtr);
+
+            streamBufferId = streamBuffer->getBufferId();
+            streamSize = static_cast<GLsizeiptr>(uploadData.data.size());
+            streamFrame = streamBuffer->getFrame();
+
+            return true;
+        }
+
+        bool VertexBufferOGL::refreshStreamBuffer()
+        {
+            if (streamBufferId)
+            {
+                RendererOGL* rendererOGL = static_cast<RendererOGL*>(sharedEngine->getRenderer());
+                StreamBufferOGL* streamBuffer = rendererOGL->getVertexStreamBuffer();
+
+                if (streamBuffer && streamBuffer->getFrame() - streamFrame >= StreamBufferOGL::SECTION_COUNT)
+                {
+                    // uploadData is only replaced together with an upload, so it still holds the bound data
+                    if (static_cast<GLsizeiptr>(uploadData.data.size()) != streamSize)
+                    {
+                        Log(Log::Level::ERR) << "Vertex buffer data changed without an upload";
+                        return false;
                     }
 
-                    uploadData.dirty &= ~VERTEX_BUFFER_DIRTY;
+                    if (!uploadStreamBuffer() && !uploadBuffer())
+                    {
+                        return false;
+                    }
                 }
-
-                uploadData.dirty = 0;
             }
 
             return true;
@@ -44,15 +44,29 @@ namespace ouzel
             virtual ~VertexBufferOGL();
             virtual void free() override;
 
-            GLuint getBufferId() const { return bufferId; }
+            // returns the stream buffer if the data was streamed
+            GLuint getBufferId() const { return streamBufferId ? streamBufferId : bufferId; }
+            GLintptr getBufferOffset() const { return streamBufferId ? streamOffset : 0; }
 
         protected:
-            bool bindBuffer();
+            // binds the attributes starting at location firstAttribute, startVertex is used to offset per-instance data
+            bool bindBuffer(GLuint firstAttribute = 0, GLuint startVertex = 0);
             virtual bool upload() override;
 
+            bool uploadBuffer();
+            bool uploadStreamBuffer();
+            // copies the data to the current stream buffer section if its old section is about to be reused
+            bool refreshStreamBuffer();
+
             GLuint bufferId = 0;
             GLsizeiptr bufferSize = 0;
 
+            // dynamic data is written to the renderer's stream buffer if there is space for it
+            GLuint streamBufferId = 0;
+            GLintptr streamOffset = 0;
+            GLsizeiptr streamSize = 0;
+            uint32_t streamFrame = 0;
+
             struct VertexAttrib
             {
                 GLint size;
@@ -60,6 +74,7 @@ namespace ouzel
                 GLboolean normalized;
                 GLsizei stride;
                 const GLvoid* pointer;
+                GLuint divisor;
             };
             std::vector<VertexAttrib> vertexAttribs;
         };
@@ -37,6 +37,6 @@ namespace ouzel
         // Calculate the new maximum point.
         max.v[0] = std::max(max.v[0], box.max.v[0]);
         max.v[1] = std::max(max.v[1], box.max.v[1]);
-        max.v[2] = std::max(max.v[1], box.max.v[2]);
+        max.v[2] = std::max(max.v[2], box.max.v[2]);
     }
 }
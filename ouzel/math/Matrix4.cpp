@@ -2,10 +2,18 @@
 // This file is part of the Ouzel engine.
 
 #include <algorithm>
+#include <cstdint>
 #include <cmath>
 #include <cassert>
 #include "Matrix4.h"
+#include "AABB3.h"
 #include "MathUtils.h"
+#if OUZEL_SUPPORTS_NEON || OUZEL_SUPPORTS_NEON64
+#include <arm_neon.h>
+#endif
+#if OUZEL_SUPPORTS_NEON_CHECK
+#include "utils/Utils.h"
+#endif
 
 namespace ouzel
 {
@@ -567,8 +575,190 @@ namespace ouzel
         return invert(*this);
     }
 
+#if OUZEL_SUPPORTS_NEON || OUZEL_SUPPORTS_NEON64
+    // NEON has no general shuffle, the lane orders used by the inversion are built from pairs of halves
+    static inline float32x4_t shuffle3300(float32x4_t v)
+    {
+        return vcombine_f32(vdup_lane_f32(vget_high_f32(v), 1), vdup_lane_f32(vget_low_f32(v), 0));
+    }
+
+    static inline float32x4_t shuffle1122(float32x4_t v)
+    {
+        return vcombine_f32(vdup_lane_f32(vget_low_f32(v), 1), vdup_lane_f32(vget_high_f32(v), 0));
+    }
+
+    static inline float32x4_t shuffle2301(float32x4_t v)
+    {
+        return vextq_f32(v, v, 2);
+    }
+
+    static inline float32x4_t shuffle1032(float32x4_t v)
+    {
+        return vrev64q_f32(v);
+    }
+
+    static inline float32x4_t shuffle0303(float32x4_t v)
+    {
+        float32x2_t t = vext_f32(vrev64_f32(vget_low_f32(v)), vrev64_f32(vget_high_f32(v)), 1);
+        return vcombine_f32(t, t);
+    }
+
+    static inline float32x4_t shuffle3030(float32x4_t v)
+    {
+        float32x2_t t = vext_f32(vget_high_f32(v), vget_low_f32(v), 1);
+        return vcombine_f32(t, t);
+    }
+
+    static inline float32x4_t shuffle2121(float32x4_t v)
+    {
+        float32x2_t t = vext_f32(vrev64_f32(vget_high_f32(v)), vrev64_f32(vget_low_f32(v)), 1);
+        return vcombine_f32(t, t);
+    }
+
+    static inline float32x4_t shuffle0213(float32x4_t v)
+    {
+        float32x2x2_t t = vtrn_f32(vget_low_f32(v), vget_high_f32(v));
+        return vcombine_f32(t.val[0], t.val[1]);
+    }
+#endif
+
     bool Matrix4::invert(Matrix4& dst) const
     {
+#if OUZEL_SUPPORTS_NEON || OUZEL_SUPPORTS_NEON64
+    #if OUZEL_SUPPORTS_NEON_CHECK
+        if (anrdoidNEONChecker.isNEONAvailable())
+        {
+    #endif
+        // the same block-wise inversion as the SSE version
+        float32x4_t col0 = vld1q_f32(m);
+        float32x4_t col1 = vld1q_f32(m + 4);
+        float32x4_t col2 = vld1q_f32(m + 8);
+        float32x4_t col3 = vld1q_f32(m + 12);
+
+        float32x4_t a = vcombine_f32(vget_low_f32(col0), vget_low_f32(col1));
+        float32x4_t b = vcombine_f32(vget_high_f32(col0), vget_high_f32(col1));
+        float32x4_t c = vcombine_f32(vget_low_f32(col2), vget_low_f32(col3));
+        float32x4_t d = vcombine_f32(vget_high_f32(col2), vget_high_f32(col3));
+
+        // determinants of the sub-matrices (|A| |B| |C| |D|)
+        float32x4x2_t col02 = vuzpq_f32(col0, col2);
+        float32x4x2_t col13 = vuzpq_f32(col1, col3);
+        float32x4_t detSub = vsubq_f32(vmulq_f32(col02.val[0], col13.val[1]), vmulq_f32(col02.val[1], col13.val[0]));
+        float detA = vgetq_lane_f32(detSub, 0);
+        float detB = vgetq_lane_f32(detSub, 1);
+        float detC = vgetq_lane_f32(detSub, 2);
+        float detD = vgetq_lane_f32(detSub, 3);
+
+        // adjugate(D) * C and adjugate(A) * B
+        float32x4_t dc = vsubq_f32(vmulq_f32(shuffle3300(d), c), vmulq_f32(shuffle1122(d), shuffle2301(c)));
+        float32x4_t ab = vsubq_f32(vmulq_f32(shuffle3300(a), b), vmulq_f32(shuffle1122(a), shuffle2301(b)));
+
+        float32x4_t x = vsubq_f32(vmulq_n_f32(a, detD),
+                                  vaddq_f32(vmulq_f32(b, shuffle0303(dc)), vmulq_f32(shuffle1032(b), shuffle2121(dc))));
+        float32x4_t w = vsubq_f32(vmulq_n_f32(d, detA),
+                                  vaddq_f32(vmulq_f32(c, shuffle0303(ab)), vmulq_f32(shuffle1032(c), shuffle2121(ab))));
+        float32x4_t y = vsubq_f32(vmulq_n_f32(c, detB),
+                                  vsubq_f32(vmulq_f32(d, shuffle3030(ab)), vmulq_f32(shuffle1032(d), shuffle2121(ab))));
+        float32x4_t z = vsubq_f32(vmulq_n_f32(b, detC),
+                                  vsubq_f32(vmulq_f32(a, shuffle3030(dc)), vmulq_f32(shuffle1032(a), shuffle2121(dc))));
+
+        float32x4_t trace = vmulq_f32(ab, shuffle0213(dc));
+        float32x2_t traceSum = vadd_f32(vget_low_f32(trace), vget_high_f32(trace));
+
+        float det = detA * detD + detB * detC - vget_lane_f32(vpadd_f32(traceSum, traceSum), 0);
+
+        // Close to zero, can't invert.
+        if (fabs(det) <= TOLERANCE)
+            return false;
+
+        static const float SIGNS[] = {1.0f, -1.0f, -1.0f, 1.0f};
+        float32x4_t invDet = vmulq_n_f32(vld1q_f32(SIGNS), 1.0f / det);
+
+        x = vmulq_f32(x, invDet);
+        y = vmulq_f32(y, invDet);
+        z = vmulq_f32(z, invDet);
+        w = vmulq_f32(w, invDet);
+
+        // the adjugate of each block is applied while storing, this also supports the case where m == dst
+        float32x4x2_t xy = vuzpq_f32(x, y);
+        float32x4x2_t zw = vuzpq_f32(z, w);
+        vst1q_f32(dst.m, vrev64q_f32(xy.val[1]));
+        vst1q_f32(dst.m + 4, vrev64q_f32(xy.val[0]));
+        vst1q_f32(dst.m + 8, vrev64q_f32(zw.val[1]));
+        vst1q_f32(dst.m + 12, vrev64q_f32(zw.val[0]));
+
+        return true;
+    #if OUZEL_SUPPORTS_NEON_CHECK
+        }
+    #endif
+#elif OUZEL_SUPPORTS_SSE
+        // block-wise inversion of the 2x2 sub-matrices, each sub-matrix is stored in one register
+        __m128 a = _mm_movelh_ps(col[0], col[1]);
+        __m128 b = _mm_movehl_ps(col[1], col[0]);
+        __m128 c = _mm_movelh_ps(col[2], col[3]);
+        __m128 d = _mm_movehl_ps(col[3], col[2]);
+
+        // determinants of the sub-matrices (|A| |B| |C| |D|)
+        __m128 detSub = _mm_sub_ps(_mm_mul_ps(_mm_shuffle_ps(col[0], col[2], _MM_SHUFFLE(2, 0, 2, 0)),
+                                              _mm_shuffle_ps(col[1], col[3], _MM_SHUFFLE(3, 1, 3, 1))),
+                                   _mm_mul_ps(_mm_shuffle_ps(col[0], col[2], _MM_SHUFFLE(3, 1, 3, 1)),
+                                              _mm_shuffle_ps(col[1], col[3], _MM_SHUFFLE(2, 0, 2, 0))));
+        __m128 detA = _mm_shuffle_ps(detSub, detSub, _MM_SHUFFLE(0, 0, 0, 0));
+        __m128 detB = _mm_shuffle_ps(detSub, detSub, _MM_SHUFFLE(1, 1, 1, 1));
+        __m128 detC = _mm_shuffle_ps(detSub, detSub, _MM_SHUFFLE(2, 2, 2, 2));
+        __m128 detD = _mm_shuffle_ps(detSub, detSub, _MM_SHUFFLE(3, 3, 3, 3));
+
+        // adjugate(D) * C and adjugate(A) * B
+        __m128 dc = _mm_sub_ps(_mm_mul_ps(_mm_shuffle_ps(d, d, _MM_SHUFFLE(0, 0, 3, 3)), c),
+                               _mm_mul_ps(_mm_shuffle_ps(d, d, _MM_SHUFFLE(2, 2, 1, 1)), _mm_shuffle_ps(c, c, _MM_SHUFFLE(1, 0, 3, 2))));
+        __m128 ab = _mm_sub_ps(_mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 0, 3, 3)), b),
+                               _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 1, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 0, 3, 2))));
+
+        // X = |D| * A - B * (adjugate(D) * C)
+        __m128 x = _mm_sub_ps(_mm_mul_ps(detD, a),
+                              _mm_add_ps(_mm_mul_ps(b, _mm_shuffle_ps(dc, dc, _MM_SHUFFLE(3, 0, 3, 0))),
+                                         _mm_mul_ps(_mm_shuffle_ps(b, b, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_ps(dc, dc, _MM_SHUFFLE(1, 2, 1, 2)))));
+        // W = |A| * D - C * (adjugate(A) * B)
+        __m128 w = _mm_sub_ps(_mm_mul_ps(detA, d),
+                              _mm_add_ps(_mm_mul_ps(c, _mm_shuffle_ps(ab, ab, _MM_SHUFFLE(3, 0, 3, 0))),
+                                         _mm_mul_ps(_mm_shuffle_ps(c, c, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_ps(ab, ab, _MM_SHUFFLE(1, 2, 1, 2)))));
+        // Y = |B| * C - D * adjugate(adjugate(A) * B)
+        __m128 y = _mm_sub_ps(_mm_mul_ps(detB, c),
+                              _mm_sub_ps(_mm_mul_ps(d, _mm_shuffle_ps(ab, ab, _MM_SHUFFLE(0, 3, 0, 3))),
+                                         _mm_mul_ps(_mm_shuffle_ps(d, d, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_ps(ab, ab, _MM_SHUFFLE(1, 2, 1, 2)))));
+        // Z = |C| * B - A * adjugate(adjugate(D) * C)
+        __m128 z = _mm_sub_ps(_mm_mul_ps(detC, b),
+                              _mm_sub_ps(_mm_mul_ps(a, _mm_shuffle_ps(dc, dc, _MM_SHUFFLE(0, 3, 0, 3))),
+                                         _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_ps(dc, dc, _MM_SHUFFLE(1, 2, 1, 2)))));
+
+        // |M| = |A| * |D| + |B| * |C| - trace(adjugate(A) * B * adjugate(D) * C)
+        __m128 trace = _mm_mul_ps(ab, _mm_shuffle_ps(dc, dc, _MM_SHUFFLE(3, 1, 2, 0)));
+        trace = _mm_add_ps(trace, _mm_movehl_ps(trace, trace));
+        trace = _mm_add_ss(trace, _mm_shuffle_ps(trace, trace, _MM_SHUFFLE(1, 1, 1, 1)));
+
+        __m128 det = _mm_sub_ss(_mm_add_ss(_mm_mul_ss(detA, detD), _mm_mul_ss(detB, detC)), trace);
+
+        // Close to zero, can't invert.
+        if (fabs(_mm_cvtss_f32(det)) <= TOLERANCE)
+            return false;
+
+        __m128 invDet = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), _mm_shuffle_ps(det, det, _MM_SHUFFLE(0, 0, 0, 0)));
+
+        x = _mm_mul_ps(x, invDet);
+        y = _mm_mul_ps(y, invDet);
+        z = _mm_mul_ps(z, invDet);
+        w = _mm_mul_ps(w, invDet);
+
+        // the adjugate of each block is applied while storing, this also supports the case where m == dst
+        dst.col[0] = _mm_shuffle_ps(x, y, _MM_SHUFFLE(1, 3, 1, 3));
+        dst.col[1] = _mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 2, 0, 2));
+        dst.col[2] = _mm_shuffle_ps(z, w, _MM_SHUFFLE(1, 3, 1, 3));
+        dst.col[3] = _mm_shuffle_ps(z, w, _MM_SHUFFLE(0, 2, 0, 2));
+
+        return true;
+#endif
+
+#if (!OUZEL_SUPPORTS_NEON && !OUZEL_SUPPORTS_NEON64 && !OUZEL_SUPPORTS_SSE) || OUZEL_SUPPORTS_NEON_CHECK
         float a0 = m[0] * m[5] - m[1] * m[4];
         float a1 = m[0] * m[6] - m[2] * m[4];
         float a2 = m[0] * m[7] - m[3] * m[4];
@@ -614,6 +804,7 @@ namespace ouzel
         multiply(inverse, 1.0f / det, dst);
 
         return true;
+#endif
     }
 
     bool Matrix4::isIdentity() const
@@ -1255,6 +1446,263 @@ namespace ouzel
 #endif
     }
 
+    void Matrix4::transformPoints(const Vector3* points, Vector3* dst, size_t count,
+                                  size_t pointStride, size_t dstStride) const
+    {
+        const uint8_t* pointData = reinterpret_cast<const uint8_t*>(points);
+        uint8_t* dstData = reinterpret_cast<uint8_t*>(dst);
+
+#if OUZEL_SUPPORTS_NEON || OUZEL_SUPPORTS_NEON64
+    #if OUZEL_SUPPORTS_NEON_CHECK
+        if (anrdoidNEONChecker.isNEONAvailable())
+        {
+    #endif
+        float32x4_t col0 = vld1q_f32(m);
+        float32x4_t col1 = vld1q_f32(m + 4);
+        float32x4_t col2 = vld1q_f32(m + 8);
+        float32x4_t col3 = vld1q_f32(m + 12);
+
+        for (size_t i = 0; i < count; ++i, pointData += pointStride, dstData += dstStride)
+        {
+            const Vector3& point = *reinterpret_cast<const Vector3*>(pointData);
+            Vector3& result = *reinterpret_cast<Vector3*>(dstData);
+
+            float32x4_t t = vmlaq_n_f32(vmlaq_n_f32(vmlaq_n_f32(col3, col0, point.v[0]), col1, point.v[1]), col2, point.v[2]);
+
+            vst1_f32(result.v, vget_low_f32(t));
+            vst1q_lane_f32(&result.v[2], t, 2);
+        }
+    #if OUZEL_SUPPORTS_NEON_CHECK
+        }
+    #endif
+#elif OUZEL_SUPPORTS_SSE
+        for (size_t i = 0; i < count; ++i, pointData += pointStride, dstData += dstStride)
+        {
+            const Vector3& point = *reinterpret_cast<const Vector3*>(pointData);
+            Vector3& result = *reinterpret_cast<Vector3*>(dstData);
+
+            __m128 t = _mm_add_ps(_mm_add_ps(_mm_mul_ps(col[0], _mm_set1_ps(point.v[0])),
+                                             _mm_mul_ps(col[1], _mm_set1_ps(point.v[1]))),
+                                  _mm_add_ps(_mm_mul_ps(col[2], _mm_set1_ps(point.v[2])),
+                                             col[3]));
+
+            _mm_storel_pi(reinterpret_cast<__m64*>(result.v), t);
+            _mm_store_ss(&result.v[2], _mm_movehl_ps(t, t));
+        }
+#endif
+
+#if (!OUZEL_SUPPORTS_NEON && !OUZEL_SUPPORTS_NEON64 && !OUZEL_SUPPORTS_SSE) || OUZEL_SUPPORTS_NEON_CHECK
+    #if OUZEL_SUPPORTS_NEON_CHECK
+        else
+        {
+    #endif
+        for (size_t i = 0; i < count; ++i, pointData += pointStride, dstData += dstStride)
+        {
+            const Vector3& point = *reinterpret_cast<const Vector3*>(pointData);
+            Vector3& result = *reinterpret_cast<Vector3*>(dstData);
+
+            float x = point.v[0] * m[0] + point.v[1] * m[4] + point.v[2] * m[8] + m[12];
+            float y = point.v[0] * m[1] + point.v[1] * m[5] + point.v[2] * m[9] + m[13];
+            float z = point.v[0] * m[2] + point.v[1] * m[6] + point.v[2] * m[10] + m[14];
+
+            result.v[0] = x;
+            result.v[1] = y;
+            result.v[2] = z;
+        }
+    #if OUZEL_SUPPORTS_NEON_CHECK
+        }
+    #endif
+#endif
+    }
+
+    void Matrix4::transformPoints(const float* x, const float* y, const float* z,
+                                  float* dstX, float* dstY, float* dstZ, size_t count) const
+    {
+        size_t i = 0;
+
+#if OUZEL_SUPPORTS_NEON || OUZEL_SUPPORTS_NEON64
+    #if OUZEL_SUPPORTS_NEON_CHECK
+        if (anrdoidNEONChecker.isNEONAvailable())
+        {
+    #endif
+        float32x4_t m12 = vdupq_n_f32(m[12]);
+        float32x4_t m13 = vdupq_n_f32(m[13]);
+        float32x4_t m14 = vdupq_n_f32(m[14]);
+
+        for (; i + 4 <= count; i += 4)
+        {
+            float32x4_t px = vld1q_f32(x + i);
+            float32x4_t py = vld1q_f32(y + i);
+            float32x4_t pz = vld1q_f32(z + i);
+
+            float32x4_t rx = vmlaq_n_f32(vmlaq_n_f32(vmlaq_n_f32(m12, px, m[0]), py, m[4]), pz, m[8]);
+            float32x4_t ry = vmlaq_n_f32(vmlaq_n_f32(vmlaq_n_f32(m13, px, m[1]), py, m[5]), pz, m[9]);
+            float32x4_t rz = vmlaq_n_f32(vmlaq_n_f32(vmlaq_n_f32(m14, px, m[2]), py, m[6]), pz, m[10]);
+
+            vst1q_f32(dstX + i, rx);
+            vst1q_f32(dstY + i, ry);
+            vst1q_f32(dstZ + i, rz);
+        }
+    #if OUZEL_SUPPORTS_NEON_CHECK
+        }
+    #endif
+#elif OUZEL_SUPPORTS_SSE
+        __m128 m0 = _mm_set1_ps(m[0]), m1 = _mm_set1_ps(m[1]), m2 = _mm_set1_ps(m[2]);
+        __m128 m4 = _mm_set1_ps(m[4]), m5 = _mm_set1_ps(m[5]), m6 = _mm_set1_ps(m[6]);
+        __m128 m8 = _mm_set1_ps(m[8]), m9 = _mm_set1_ps(m[9]), m10 = _mm_set1_ps(m[10]);
+        __m128 m12 = _mm_set1_ps(m[12]), m13 = _mm_set1_ps(m[13]), m14 = _mm_set1_ps(m[14]);
+
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128 px = _mm_loadu_ps(x + i);
+            __m128 py = _mm_loadu_ps(y + i);
+            __m128 pz = _mm_loadu_ps(z + i);
+
+            __m128 rx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(px, m0), _mm_mul_ps(py, m4)), _mm_add_ps(_mm_mul_ps(pz, m8), m12));
+            __m128 ry = _mm_add_ps(_mm_add_ps(_mm_mul_ps(px, m1), _mm_mul_ps(py, m5)), _mm_add_ps(_mm_mul_ps(pz, m9), m13));
+            __m128 rz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(px, m2), _mm_mul_ps(py, m6)), _mm_add_ps(_mm_mul_ps(pz, m10), m14));
+
+            _mm_storeu_ps(dstX + i, rx);
+            _mm_storeu_ps(dstY + i, ry);
+            _mm_storeu_ps(dstZ + i, rz);
+        }
+#endif
+
+        for (; i < count; ++i)
+        {
+            float px = x[i];
+            float py = y[i];
+            float pz = z[i];
+
+            dstX[i] = px * m[0] + py * m[4] + pz * m[8] + m[12];
+            dstY[i] = px * m[1] + py * m[5] + pz * m[9] + m[13];
+            dstZ[i] = px * m[2] + py * m[6] + pz * m[10] + m[14];
+        }
+    }
+
+    void Matrix4::transformAABBs(const AABB3* boxes, AABB3* dst, size_t count) const
+    {
+        // every version transforms the center and projects the half extents on the absolute values of the axes
+#if OUZEL_SUPPORTS_NEON || OUZEL_SUPPORTS_NEON64
+    #if OUZEL_SUPPORTS_NEON_CHECK
+        if (anrdoidNEONChecker.isNEONAvailable())
+        {
+    #endif
+        float32x4_t col0 = vld1q_f32(m);
+        float32x4_t col1 = vld1q_f32(m + 4);
+        float32x4_t col2 = vld1q_f32(m + 8);
+        float32x4_t col3 = vld1q_f32(m + 12);
+        float32x4_t abs0 = vabsq_f32(col0);
+        float32x4_t abs1 = vabsq_f32(col1);
+        float32x4_t abs2 = vabsq_f32(col2);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            const AABB3& box = boxes[i];
+
+            if (box.isEmpty())
+            {
+                dst[i] = box;
+                continue;
+            }
+
+            Vector3 center((box.min.v[0] + box.max.v[0]) * 0.5f,
+                           (box.min.v[1] + box.max.v[1]) * 0.5f,
+                           (box.min.v[2] + box.max.v[2]) * 0.5f);
+            Vector3 extent((box.max.v[0] - box.min.v[0]) * 0.5f,
+                           (box.max.v[1] - box.min.v[1]) * 0.5f,
+                           (box.max.v[2] - box.min.v[2]) * 0.5f);
+
+            float32x4_t c = vmlaq_n_f32(vmlaq_n_f32(vmlaq_n_f32(col3, col0, center.v[0]), col1, center.v[1]), col2, center.v[2]);
+            float32x4_t e = vmlaq_n_f32(vmlaq_n_f32(vmulq_n_f32(abs0, extent.v[0]), abs1, extent.v[1]), abs2, extent.v[2]);
+
+            float32x4_t newMin = vsubq_f32(c, e);
+            float32x4_t newMax = vaddq_f32(c, e);
+
+            vst1_f32(dst[i].min.v, vget_low_f32(newMin));
+            vst1q_lane_f32(&dst[i].min.v[2], newMin, 2);
+            vst1_f32(dst[i].max.v, vget_low_f32(newMax));
+            vst1q_lane_f32(&dst[i].max.v[2], newMax, 2);
+        }
+    #if OUZEL_SUPPORTS_NEON_CHECK
+        }
+    #endif
+#elif OUZEL_SUPPORTS_SSE
+        const __m128 signMask = _mm_set1_ps(-0.0f);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            const AABB3& box = boxes[i];
+
+            if (box.isEmpty())
+            {
+                dst[i] = box;
+                continue;
+            }
+
+            Vector3 center((box.min.v[0] + box.max.v[0]) * 0.5f,
+                           (box.min.v[1] + box.max.v[1]) * 0.5f,
+                           (box.min.v[2] + box.max.v[2]) * 0.5f);
+            Vector3 extent((box.max.v[0] - box.min.v[0]) * 0.5f,
+                           (box.max.v[1] - box.min.v[1]) * 0.5f,
+                           (box.max.v[2] - box.min.v[2]) * 0.5f);
+
+            __m128 c = _mm_add_ps(_mm_add_ps(_mm_mul_ps(col[0], _mm_set1_ps(center.v[0])),
+                                             _mm_mul_ps(col[1], _mm_set1_ps(center.v[1]))),
+                                  _mm_add_ps(_mm_mul_ps(col[2], _mm_set1_ps(center.v[2])),
+                                             col[3]));
+            __m128 e = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_andnot_ps(signMask, col[0]), _mm_set1_ps(extent.v[0])),
+                                             _mm_mul_ps(_mm_andnot_ps(signMask, col[1]), _mm_set1_ps(extent.v[1]))),
+                                  _mm_mul_ps(_mm_andnot_ps(signMask, col[2]), _mm_set1_ps(extent.v[2])));
+
+            __m128 newMin = _mm_sub_ps(c, e);
+            __m128 newMax = _mm_add_ps(c, e);
+
+            _mm_storel_pi(reinterpret_cast<__m64*>(dst[i].min.v), newMin);
+            _mm_store_ss(&dst[i].min.v[2], _mm_movehl_ps(newMin, newMin));
+            _mm_storel_pi(reinterpret_cast<__m64*>(dst[i].max.v), newMax);
+            _mm_store_ss(&dst[i].max.v[2], _mm_movehl_ps(newMax, newMax));
+        }
+#endif
+
+#if (!OUZEL_SUPPORTS_NEON && !OUZEL_SUPPORTS_NEON64 && !OUZEL_SUPPORTS_SSE) || OUZEL_SUPPORTS_NEON_CHECK
+    #if OUZEL_SUPPORTS_NEON_CHECK
+        else
+        {
+    #endif
+        for (size_t i = 0; i < count; ++i)
+        {
+            const AABB3& box = boxes[i];
+
+            if (box.isEmpty())
+            {
+                dst[i] = box;
+                continue;
+            }
+
+            Vector3 center((box.min.v[0] + box.max.v[0]) * 0.5f,
+                           (box.min.v[1] + box.max.v[1]) * 0.5f,
+                           (box.min.v[2] + box.max.v[2]) * 0.5f);
+            Vector3 extent((box.max.v[0] - box.min.v[0]) * 0.5f,
+                           (box.max.v[1] - box.min.v[1]) * 0.5f,
+                           (box.max.v[2] - box.min.v[2]) * 0.5f);
+
+            Vector3 newCenter;
+            transformPoint(center, newCenter);
+
+            Vector3 newExtent(fabsf(m[0]) * extent.v[0] + fabsf(m[4]) * extent.v[1] + fabsf(m[8]) * extent.v[2],
+                              fabsf(m[1]) * extent.v[0] + fabsf(m[5]) * extent.v[1] + fabsf(m[9]) * extent.v[2],
+                              fabsf(m[2]) * extent.v[0] + fabsf(m[6]) * extent.v[1] + fabsf(m[10]) * extent.v[2]);
+
+            dst[i].min = newCenter - newExtent;
+            dst[i].max = newCenter + newExtent;
+        }
+    #if OUZEL_SUPPORTS_NEON_CHECK
+        }
+    #endif
+#endif
+    }
+
     void Matrix4::translate(float x, float y, float z)
     {
         translate(x, y, z, *this);
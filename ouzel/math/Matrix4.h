@@ -12,6 +12,8 @@
 
 namespace ouzel
 {
+    class AABB3;
+
     class Matrix4
     {
     public:
@@ -158,6 +160,15 @@ namespace ouzel
         
         void transformVector(const Vector4& vector, Vector4& dst) const;
 
+        // batch transformPoint, strides are in bytes so that positions can be transformed in place in vertex and particle arrays
+        void transformPoints(const Vector3* points, Vector3* dst, size_t count,
+                             size_t pointStride = sizeof(Vector3), size_t dstStride = sizeof(Vector3)) const;
+        // same for points stored as separate coordinate arrays, four points are transformed at a time
+        void transformPoints(const float* x, const float* y, const float* z,
+                             float* dstX, float* dstY, float* dstZ, size_t count) const;
+        // calculates the boxes that enclose the transformed boxes, empty boxes stay empty
+        void transformAABBs(const AABB3* boxes, AABB3* dst, size_t count) const;
+
         void translate(float x, float y, float z);
         void translate(float x, float y, float z, Matrix4& dst) const;
         void translate(const Vector3& t);
@@ -212,7 +223,7 @@ namespace ouzel
             return *this;
         }
 
-        inline bool operator==(const Matrix4& matrix)
+        inline bool operator==(const Matrix4& matrix) const
         {
             return m[0] == matrix.m[0] &&
                    m[1] == matrix.m[1] &&
@@ -232,7 +243,7 @@ namespace ouzel
                    m[15] == matrix.m[15];
         }
 
-        inline bool operator!=(const Matrix4& matrix)
+        inline bool operator!=(const Matrix4& matrix) const
         {
             return m[0] != matrix.m[0] ||
                    m[1] != matrix.m[1] ||
@@ -3,6 +3,15 @@
 
 #pragma once
 
+#include "core/CompileConfig.h"
+#if OUZEL_SUPPORTS_SSE
+#include <xmmintrin.h>
+#elif OUZEL_SUPPORTS_NEON || OUZEL_SUPPORTS_NEON64
+#include <arm_neon.h>
+#endif
+#if OUZEL_SUPPORTS_NEON_CHECK
+#include "utils/Utils.h"
+#endif
 #include "math/Matrix4.h"
 #include "math/Vector3.h"
 
@@ -14,7 +23,15 @@ namespace ouzel
         static const Quaternion IDENTITY;
         static const Quaternion ZERO;
 
+#if OUZEL_SUPPORTS_SSE
+        union
+        {
+            __m128 s;
+            float v[4];
+        };
+#else
         float v[4];
+#endif
 
         Quaternion()
         {
@@ -53,14 +70,56 @@ namespace ouzel
 
         Quaternion operator*(const Quaternion& q) const
         {
-            return Quaternion(v[3] * q.v[0] + q.v[3] * v[0] + v[1] * q.v[2] - v[2] * q.v[1],
-                              v[3] * q.v[1] + q.v[3] * v[1] + v[2] * q.v[0] - v[0] * q.v[2],
-                              v[3] * q.v[2] + q.v[3] * v[2] + v[0] * q.v[1] - v[1] * q.v[0],
-                              v[3] * q.v[3] - (v[0] * q.v[0] + v[1] * q.v[1] + v[2] * q.v[2]));
+            Quaternion result(*this);
+            result *= q;
+            return result;
         }
 
         const Quaternion& operator*=(const Quaternion& q)
         {
+#if OUZEL_SUPPORTS_NEON || OUZEL_SUPPORTS_NEON64
+    #if OUZEL_SUPPORTS_NEON_CHECK
+            if (anrdoidNEONChecker.isNEONAvailable())
+            {
+    #endif
+            // the same products as the SSE version, the lane orders are built from (x y) and (z w) halves
+            static const float SIGNS[] = {1.0f, 1.0f, 1.0f, -1.0f};
+
+            float32x4_t q1 = vld1q_f32(v);
+            float32x4_t q2 = vld1q_f32(q.v);
+            float32x2_t xy1 = vget_low_f32(q1);
+            float32x2_t zw1 = vget_high_f32(q1);
+            float32x2_t xy2 = vget_low_f32(q2);
+            float32x2_t zw2 = vget_high_f32(q2);
+            float32x2_t zx1 = vext_f32(vrev64_f32(zw1), xy1, 1);
+            float32x2_t yz1 = vext_f32(xy1, zw1, 1);
+            float32x2_t zx2 = vext_f32(vrev64_f32(zw2), xy2, 1);
+            float32x2_t yz2 = vext_f32(xy2, zw2, 1);
+
+            float32x4_t t0 = vmulq_n_f32(q2, v[3]);
+            float32x4_t t1 = vmulq_f32(vcombine_f32(xy1, zx1), vcombine_f32(vdup_lane_f32(zw2, 1), vext_f32(zw2, xy2, 1)));
+            float32x4_t t2 = vmulq_f32(vcombine_f32(yz1, xy1), vcombine_f32(zx2, vdup_lane_f32(xy2, 1)));
+            float32x4_t t3 = vmulq_f32(vcombine_f32(zx1, yz1), vcombine_f32(yz2, vtrn_f32(xy2, zw2).val[0]));
+
+            vst1q_f32(v, vsubq_f32(vaddq_f32(t0, vmulq_f32(vaddq_f32(t1, t2), vld1q_f32(SIGNS))), t3));
+
+            return *this;
+    #if OUZEL_SUPPORTS_NEON_CHECK
+            }
+    #endif
+#elif OUZEL_SUPPORTS_SSE
+            // w1 * q2 + (x1 y1 z1 -x1) * (w2 w2 w2 x2) + (y1 z1 x1 -y1) * (z2 x2 y2 y2) - (z1 x1 y1 z1) * (y2 z2 x2 z2)
+            const __m128 signMask = _mm_setr_ps(0.0f, 0.0f, 0.0f, -0.0f);
+
+            __m128 t0 = _mm_mul_ps(_mm_shuffle_ps(s, s, _MM_SHUFFLE(3, 3, 3, 3)), q.s);
+            __m128 t1 = _mm_mul_ps(_mm_shuffle_ps(s, s, _MM_SHUFFLE(0, 2, 1, 0)), _mm_shuffle_ps(q.s, q.s, _MM_SHUFFLE(0, 3, 3, 3)));
+            __m128 t2 = _mm_mul_ps(_mm_shuffle_ps(s, s, _MM_SHUFFLE(1, 0, 2, 1)), _mm_shuffle_ps(q.s, q.s, _MM_SHUFFLE(1, 1, 0, 2)));
+            __m128 t3 = _mm_mul_ps(_mm_shuffle_ps(s, s, _MM_SHUFFLE(2, 1, 0, 2)), _mm_shuffle_ps(q.s, q.s, _MM_SHUFFLE(2, 0, 2, 1)));
+
+            s = _mm_sub_ps(_mm_add_ps(t0, _mm_xor_ps(_mm_add_ps(t1, t2), signMask)), t3);
+#endif
+
+#if (!OUZEL_SUPPORTS_NEON && !OUZEL_SUPPORTS_NEON64 && !OUZEL_SUPPORTS_SSE) || OUZEL_SUPPORTS_NEON_CHECK
             float tempX = v[3] * q.v[0] + q.v[3] * v[0] + v[1] * q.v[2] - v[2] * q.v[1];
             float tempY = v[3] * q.v[1] + q.v[3] * v[1] + v[2] * q.v[0] - v[0] * q.v[2];
             float tempZ = v[3] * q.v[2] + q.v[3] * v[2] + v[0] * q.v[1] - v[1] * q.v[0];
@@ -70,6 +129,7 @@ namespace ouzel
             v[1] = tempY;
             v[2] = tempZ;
             v[3] = tempW;
+#endif
 
             return *this;
         }
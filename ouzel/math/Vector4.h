@@ -96,18 +96,26 @@ namespace ouzel
 
         void add(const Vector4& vec)
         {
+#if OUZEL_SUPPORTS_SSE
+            s = _mm_add_ps(s, vec.s);
+#else
             v[0] += vec.v[0];
             v[1] += vec.v[1];
             v[2] += vec.v[2];
             v[3] += vec.v[3];
+#endif
         }
 
         static void add(const Vector4& v1, const Vector4& v2, Vector4& dst)
         {
+#if OUZEL_SUPPORTS_SSE
+            dst.s = _mm_add_ps(v1.s, v2.s);
+#else
             dst.v[0] = v1.v[0] + v2.v[0];
             dst.v[1] = v1.v[1] + v2.v[1];
             dst.v[2] = v1.v[2] + v2.v[2];
             dst.v[3] = v1.v[3] + v2.v[3];
+#endif
         }
 
         void clamp(const Vector4& min, const Vector4& max);
@@ -154,18 +162,26 @@ namespace ouzel
 
         void scale(float scalar)
         {
+#if OUZEL_SUPPORTS_SSE
+            s = _mm_mul_ps(s, _mm_set1_ps(scalar));
+#else
             v[0] *= scalar;
             v[1] *= scalar;
             v[2] *= scalar;
             v[3] *= scalar;
+#endif
         }
 
         void scale(const Vector4& scale)
         {
+#if OUZEL_SUPPORTS_SSE
+            s = _mm_mul_ps(s, scale.s);
+#else
             v[0] *= scale.v[0];
             v[1] *= scale.v[1];
             v[2] *= scale.v[2];
             v[3] *= scale.v[3];
+#endif
         }
 
         void set(float newX, float newY, float newZ, float newW)
@@ -186,18 +202,26 @@ namespace ouzel
 
         void subtract(const Vector4& vec)
         {
+#if OUZEL_SUPPORTS_SSE
+            s = _mm_sub_ps(s, vec.s);
+#else
             v[0] -= vec.v[0];
             v[1] -= vec.v[1];
             v[2] -= vec.v[2];
             v[3] -= vec.v[3];
+#endif
         }
 
         static void subtract(const Vector4& v1, const Vector4& v2, Vector4& dst)
         {
+#if OUZEL_SUPPORTS_SSE
+            dst.s = _mm_sub_ps(v1.s, v2.s);
+#else
             dst.v[0] = v1.v[0] - v2.v[0];
             dst.v[1] = v1.v[1] - v2.v[1];
             dst.v[2] = v1.v[2] - v2.v[2];
             dst.v[3] = v1.v[3] - v2.v[3];
+#endif
         }
 
         void smooth(const Vector4& target, float elapsedTime, float responseTime);
@@ -20,6 +20,7 @@
 #include "core/Cache.h"
 #include "core/CompileConfig.h"
 #include "core/Engine.h"
+#include "core/JobSystem.h"
 #include "core/Settings.h"
 #include "core/UpdateCallback.h"
 #include "core/Window.h"
@@ -19,6 +19,7 @@ namespace ouzel
         Camera::Camera(Type aType, float aFov, float aNearPlane, float aFarPlane):
             type(aType), fov(aFov), nearPlane(aNearPlane), farPlane(aFarPlane)
         {
+            transformNotifications = true;
         }
 
         Camera::~Camera()
@@ -26,10 +27,8 @@ namespace ouzel
             if (layer) layer->removeCamera(this);
         }
 
-        void Camera::calculateTransform() const
+        void Camera::transformChanged() const
         {
-            Node::calculateTransform();
-
             viewProjectionDirty = inverseViewProjectionDirty = true;
         }
 
@@ -99,8 +98,16 @@ namespace ouzel
             viewProjectionDirty = inverseViewProjectionDirty = true;
         }
 
+        graphics::Renderer::DrawList& Camera::getDrawList() const
+        {
+            return layer ? layer->getDrawList() : sharedEngine->getRenderer()->getDrawList();
+        }
+
         const Matrix4& Camera::getViewProjection() const
         {
+            // apply the pending transform changes of the camera and its parents
+            if (transformHierarchy) transformHierarchy->update();
+
             if (viewProjectionDirty || transformDirty)
             {
                 calculateViewProjection();
@@ -111,6 +118,8 @@ namespace ouzel
 
         const Matrix4& Camera::getRenderViewProjection() const
         {
+            if (transformHierarchy) transformHierarchy->update();
+
             if (viewProjectionDirty || transformDirty)
             {
                 calculateViewProjection();
@@ -121,6 +130,8 @@ namespace ouzel
 
         const Matrix4& Camera::getInverseViewProjection() const
         {
+            if (transformHierarchy) transformHierarchy->update();
+
             if (inverseViewProjectionDirty || transformDirty)
             {
                 inverseViewProjection = getViewProjection();
@@ -140,6 +151,22 @@ namespace ouzel
 
             renderViewProjection = sharedEngine->getRenderer()->getProjectionTransform(renderTarget != nullptr) * renderViewProjection;
 
+            // extract the frustum planes from the rows of the view projection matrix, clip space depth is from 0 to 1
+            for (uint32_t i = 0; i < 4; ++i)
+            {
+                float row0 = viewProjection.m[i * 4 + 0];
+                float row1 = viewProjection.m[i * 4 + 1];
+                float row2 = viewProjection.m[i * 4 + 2];
+                float row3 = viewProjection.m[i * 4 + 3];
+
+                frustumPlanes[0].v[i] = row3 + row0;
+                frustumPlanes[1].v[i] = row3 - row0;
+                frustumPlanes[2].v[i] = row3 + row1;
+                frustumPlanes[3].v[i] = row3 - row1;
+                frustumPlanes[4].v[i] = row2;
+                frustumPlanes[5].v[i] = row3 - row2;
+            }
+
             viewProjectionDirty = false;
         }
 
@@ -169,7 +196,7 @@ namespace ouzel
         {
             if (type == Type::PERSPECTIVE)
             {
-                return true;
+                return checkVisibility(boxTransform, AABB3(Vector3(boundingBox.min), Vector3(boundingBox.max)));
             }
 
             // calculate center point of the bounding box
@@ -215,6 +242,46 @@ namespace ouzel
             return visibleRect.containsPoint(v2p);
         }
 
+        bool Camera::checkVisibility(const Matrix4& boxTransform, const AABB3& boundingBox) const
+        {
+            if (type != Type::PERSPECTIVE)
+            {
+                // orthographic cameras ignore the depth of the box
+                return checkVisibility(boxTransform, AABB2(Vector2(boundingBox.min), Vector2(boundingBox.max)));
+            }
+
+            // make sure the frustum planes are up to date
+            getViewProjection();
+
+            // the transformed box is an oriented box with its center at the transformed center of the bounding box
+            Vector3 center((boundingBox.min.v[0] + boundingBox.max.v[0]) * 0.5f,
+                           (boundingBox.min.v[1] + boundingBox.max.v[1]) * 0.5f,
+                           (boundingBox.min.v[2] + boundingBox.max.v[2]) * 0.5f);
+            Vector3 halfSize((boundingBox.max.v[0] - boundingBox.min.v[0]) * 0.5f,
+                             (boundingBox.max.v[1] - boundingBox.min.v[1]) * 0.5f,
+                             (boundingBox.max.v[2] - boundingBox.min.v[2]) * 0.5f);
+
+            boxTransform.transformPoint(center);
+
+            for (const Vector4& plane : frustumPlanes)
+            {
+                float distance = plane.v[0] * center.v[0] + plane.v[1] * center.v[1] + plane.v[2] * center.v[2] + plane.v[3];
+
+                // projection of the box extents on the plane normal, the axes of the box are the columns of the transform
+                float radius = halfSize.v[0] * fabsf(plane.v[0] * boxTransform.m[0] + plane.v[1] * boxTransform.m[1] + plane.v[2] * boxTransform.m[2]) +
+                    halfSize.v[1] * fabsf(plane.v[0] * boxTransform.m[4] + plane.v[1] * boxTransform.m[5] + plane.v[2] * boxTransform.m[6]) +
+                    halfSize.v[2] * fabsf(plane.v[0] * boxTransform.m[8] + plane.v[1] * boxTransform.m[9] + plane.v[2] * boxTransform.m[10]);
+
+                // the whole box is behind the plane
+                if (distance + radius < 0.0f)
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
         void Camera::setViewport(const Rectangle& newViewport)
         {
             viewport = newViewport;
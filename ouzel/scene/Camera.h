@@ -7,6 +7,9 @@
 #include "scene/Node.h"
 #include "math/MathUtils.h"
 #include "math/Rectangle.h"
+#include "math/AABB3.h"
+#include "math/Vector4.h"
+#include "graphics/Renderer.h"
 
 namespace ouzel
 {
@@ -58,6 +61,7 @@ namespace ouzel
             Vector2 convertWorldToNormalized(const Vector3& position) const;
 
             bool checkVisibility(const Matrix4& boxTransform, const AABB2& boundingBox) const;
+            bool checkVisibility(const Matrix4& boxTransform, const AABB3& boundingBox) const;
 
             void setViewport(const Rectangle& newViewport);
             const Rectangle& getViewport() const { return viewport; }
@@ -79,8 +83,12 @@ namespace ouzel
             bool getWireframe() const { return wireframe; }
             void setWireframe(bool newWireframe) { wireframe = newWireframe; }
 
+            Layer* getLayer() const { return layer; }
+            // components record into the draw list of the layer, or add their commands to the renderer if the camera is not in a layer
+            graphics::Renderer::DrawList& getDrawList() const;
+
         protected:
-            virtual void calculateTransform() const override;
+            virtual void transformChanged() const override;
             void calculateViewProjection() const;
 
             Type type;
@@ -103,6 +111,9 @@ namespace ouzel
             mutable Matrix4 viewProjection;
             mutable Matrix4 renderViewProjection;
 
+            // left, right, bottom, top, near and far planes in world space, normals point inside the frustum
+            mutable Vector4 frustumPlanes[6];
+
             mutable bool inverseViewProjectionDirty = false;
             mutable Matrix4 inverseViewProjection;
 
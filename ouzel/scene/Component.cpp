@@ -27,6 +27,22 @@ namespace ouzel
         {
         }
 
+        void Component::setHidden(bool newHidden)
+        {
+            hidden = newHidden;
+
+            contentChanged();
+        }
+
+        void Component::contentChanged()
+        {
+            if (node)
+            {
+                node->boundingBoxChanged();
+                node->contentChanged();
+            }
+        }
+
         bool Component::pointOn(const Vector2& position) const
         {
             return boundingBox.containsPoint(position);
@@ -6,6 +6,7 @@
 #include <vector>
 #include "utils/Noncopyable.h"
 #include "math/AABB2.h"
+#include "math/AABB3.h"
 #include "math/Matrix4.h"
 #include "math/Color.h"
 
@@ -31,15 +32,20 @@ namespace ouzel
                                        scene::Camera* camera);
 
             virtual const AABB2& getBoundingBox() const { return boundingBox; }
+            // used by perspective cameras, flat components have no depth
+            virtual AABB3 getBoundingBox3D() const { return AABB3(Vector3(boundingBox.min), Vector3(boundingBox.max)); }
             bool isAddedToNode() const { return node != nullptr; }
 
             virtual bool pointOn(const Vector2& position) const;
             virtual bool shapeOverlaps(const std::vector<Vector2>& edges) const;
 
             bool isHidden() const { return hidden; }
-            void setHidden(bool newHidden) { hidden = newHidden; }
+            void setHidden(bool newHidden);
 
         protected:
+            // notify the node (and the layer) that the drawn content has changed
+            void contentChanged();
+
             AABB2 boundingBox;
             bool hidden = false;
 
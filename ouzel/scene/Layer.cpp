@@ -15,7 +15,8 @@ namespace ouzel
 {
     namespace scene
     {
-        Layer::Layer()
+        Layer::Layer():
+            transformHierarchy(this)
         {
         }
 
@@ -31,17 +32,51 @@ namespace ouzel
 
         void Layer::draw()
         {
+            if (!drawListRecorded)
+            {
+                recordDrawList();
+            }
+
+            drawListRecorded = false;
+
+            sharedEngine->getRenderer()->addDrawList(drawList);
+        }
+
+        void Layer::recordDrawList()
+        {
+            if (transformHierarchyEnabled)
+            {
+                transformHierarchy.update();
+            }
+
+            if (staticLayer && !drawListDirty && !camerasChanged())
+            {
+                return;
+            }
+
+            drawList.clear();
+
             for (Camera* camera : cameras)
             {
-                std::vector<Node*> drawQueue;
+                drawQueue.clear();
 
                 for (Node* child : children)
                 {
                     child->visit(drawQueue, Matrix4::IDENTITY, false, camera, 0);
                 }
 
-                for (Node* node : drawQueue)
+                sortDrawQueue();
+
+                for (size_t i = 0; i < drawQueue.size(); ++i)
                 {
+                    Node* node = drawQueue[i];
+
+                    // only nodes with the same world order may be reordered by the renderer
+                    if (i == 0 || node->worldOrder != drawQueue[i - 1]->worldOrder)
+                    {
+                        drawList.nextSortBucket();
+                    }
+
                     node->draw(camera);
 
                     if (camera->getWireframe())
@@ -50,6 +85,151 @@ namespace ouzel
                     }
                 }
             }
+
+            if (staticLayer)
+            {
+                cameraStates.clear();
+
+                for (Camera* camera : cameras)
+                {
+                    cameraStates.push_back({ camera,
+                                             camera->getRenderViewProjection(),
+                                             camera->getRenderViewport(),
+                                             camera->getRenderTarget(),
+                                             camera->getWireframe() });
+                }
+
+                drawListDirty = false;
+            }
+        }
+
+        void Layer::setStatic(bool newStatic)
+        {
+            staticLayer = newStatic;
+            drawListDirty = true;
+
+            if (!staticLayer)
+            {
+                drawList.clear();
+                cameraStates.clear();
+            }
+        }
+
+        void Layer::setTransformHierarchyEnabled(bool newTransformHierarchyEnabled)
+        {
+            if (transformHierarchyEnabled == newTransformHierarchyEnabled)
+            {
+                return;
+            }
+
+            transformHierarchyEnabled = newTransformHierarchyEnabled;
+
+            if (transformHierarchyEnabled)
+            {
+                transformHierarchy.setNeedsRebuild();
+            }
+            else
+            {
+                for (Node* child : children)
+                {
+                    child->updateTransform(Matrix4::IDENTITY);
+                    child->detachTransformHierarchy();
+                }
+            }
+
+            drawListDirty = true;
+        }
+
+        void Layer::contentChanged()
+        {
+            drawListDirty = true;
+        }
+
+        void Layer::childrenChanged()
+        {
+            if (transformHierarchyEnabled)
+            {
+                transformHierarchy.setNeedsRebuild();
+            }
+        }
+
+        bool Layer::camerasChanged() const
+        {
+            if (cameraStates.size() != cameras.size())
+            {
+                return true;
+            }
+
+            for (size_t i = 0; i < cameras.size(); ++i)
+            {
+                const CameraState& cameraState = cameraStates[i];
+                Camera* camera = cameras[i];
+
+                if (cameraState.camera != camera ||
+                    cameraState.renderViewProjection != camera->getRenderViewProjection() ||
+                    cameraState.renderViewport != camera->getRenderViewport() ||
+                    cameraState.renderTarget != camera->getRenderTarget() ||
+                    cameraState.wireframe != camera->getWireframe())
+                {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        void Layer::sortDrawQueue()
+        {
+            // nodes are drawn from the highest to the lowest world order, nodes with the same order
+            // keep their traversal order, so the sort must be stable
+            drawEntries.clear();
+
+            for (Node* node : drawQueue)
+            {
+                // flip the sign bit to get an unsigned ascending key, invert it to sort descending
+                uint32_t key = ~(static_cast<uint32_t>(node->worldOrder) ^ 0x80000000);
+                drawEntries.push_back({ key, node });
+            }
+
+            sortBuffer.resize(drawEntries.size());
+
+            // LSD radix sort, 8 bits per pass
+            for (uint32_t shift = 0; shift < 32 && !drawEntries.empty(); shift += 8)
+            {
+                uint32_t offsets[256] = { 0 };
+
+                for (const DrawEntry& entry : drawEntries)
+                {
+                    ++offsets[(entry.key >> shift) & 0xFF];
+                }
+
+                // all keys have the same digit, nothing to do in this pass
+                if (offsets[(drawEntries.front().key >> shift) & 0xFF] == drawEntries.size())
+                {
+                    continue;
+                }
+
+                uint32_t offset = 0;
+
+                for (uint32_t& count : offsets)
+                {
+                    uint32_t current = count;
+                    count = offset;
+                    offset += current;
+                }
+
+                for (const DrawEntry& entry : drawEntries)
+                {
+                    sortBuffer[offsets[(entry.key >> shift) & 0xFF]++] = entry;
+                }
+
+                drawEntries.swap(sortBuffer);
+            }
+
+            for (size_t i = 0; i < drawEntries.size(); ++i)
+            {
+                drawQueue[i] = drawEntries[i].node;
+            }
         }
 
         void Layer::addChild(Node* node)
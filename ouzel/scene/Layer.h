@@ -6,7 +6,11 @@
 #include <cstdint>
 #include <vector>
 #include "scene/NodeContainer.h"
+#include "scene/TransformHierarchy.h"
 #include "math/Vector2.h"
+#include "math/Matrix4.h"
+#include "math/Rectangle.h"
+#include "graphics/Renderer.h"
 
 namespace ouzel
 {
@@ -23,6 +27,7 @@ namespace ouzel
             Layer();
             virtual ~Layer();
 
+            // records the draw list unless the scene has already recorded it this frame and submits it to the renderer
             virtual void draw();
 
             virtual void addChild(Node* node) override;
@@ -38,15 +43,72 @@ namespace ouzel
             int32_t getOrder() const { return order; }
             void setOrder(int32_t newOrder);
 
+            // merge compatible sprites into batched draw calls
+            bool isBatchingEnabled() const { return batchingEnabled; }
+            void setBatchingEnabled(bool newBatchingEnabled) { batchingEnabled = newBatchingEnabled; }
+
+            // static layers reuse their draw commands until a node, a component or a camera changes
+            bool isStatic() const { return staticLayer; }
+            void setStatic(bool newStatic);
+            void invalidateDrawList() { drawListDirty = true; }
+
+            // keep the world transforms of the nodes in contiguous arrays and update only the changed subtrees once per frame
+            bool isTransformHierarchyEnabled() const { return transformHierarchyEnabled; }
+            void setTransformHierarchyEnabled(bool newTransformHierarchyEnabled);
+
+            // components of this layer record their draw commands here instead of adding them to the renderer directly
+            graphics::Renderer::DrawList& getDrawList() { return drawList; }
+
         protected:
             virtual void recalculateProjection();
             virtual void enter() override;
+            virtual void contentChanged() override;
+            virtual void childrenChanged() override;
+
+            // fills the draw list, layers of a scene are recorded in parallel, so overrides may run on a job system worker
+            // and must add their commands to drawList instead of the renderer
+            virtual void recordDrawList();
+
+            struct DrawEntry
+            {
+                uint32_t key;
+                Node* node;
+            };
+
+            void sortDrawQueue();
+
+            struct CameraState
+            {
+                Camera* camera;
+                Matrix4 renderViewProjection;
+                Rectangle renderViewport;
+                graphics::RenderTargetPtr renderTarget;
+                bool wireframe;
+            };
+
+            bool camerasChanged() const;
 
             Scene* scene = nullptr;
 
             std::vector<Camera*> cameras;
 
             int32_t order = 0;
+            bool batchingEnabled = true;
+
+            bool transformHierarchyEnabled = false;
+            TransformHierarchy transformHierarchy;
+
+            bool staticLayer = false;
+            bool drawListDirty = true;
+            // set by the scene for layers it has recorded on the job system, cleared when the layer is drawn
+            bool drawListRecorded = false;
+            std::vector<CameraState> cameraStates;
+            graphics::Renderer::DrawList drawList;
+
+            // reused between frames to avoid allocations
+            std::vector<Node*> drawQueue;
+            std::vector<DrawEntry> drawEntries;
+            std::vector<DrawEntry> sortBuffer;
         };
     } // namespace scene
 } // namespace ouzel
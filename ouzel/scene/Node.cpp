@@ -44,47 +44,108 @@ namespace ouzel
                          Camera* camera,
                          int32_t parentOrder)
         {
+            bool worldOrderChanged = (worldOrder != parentOrder + order);
             worldOrder = parentOrder + order;
 
-            if (parentTransformDirty)
+            // transforms in a transform hierarchy are recalculated by the layer before the traversal
+            if (!transformHierarchy)
             {
-                updateTransform(newParentTransform);
+                if (parentTransformDirty)
+                {
+                    updateTransform(newParentTransform);
+                }
+
+                if (transformDirty)
+                {
+                    calculateTransform();
+                }
             }
 
-            if (transformDirty)
+            const Matrix4& currentTransform = getTransform();
+
+            const AABB3& subtreeBox = getSubtreeBoundingBox();
+
+            if (!subtreeCullDisabled && (subtreeBox.isEmpty() || !camera->checkVisibility(currentTransform, subtreeBox)))
             {
-                calculateTransform();
+                // nothing in the subtree is visible, only bring the transforms and orders of the descendants up to date
+                if (updateChildrenTransform || subtreeChanged || worldOrderChanged)
+                {
+                    for (Node* child : children)
+                    {
+                        child->visitCulled(currentTransform, updateChildrenTransform, worldOrder);
+                    }
+                }
             }
+            else
+            {
+                if (!hidden)
+                {
+                    // the subtree bounding box of a leaf is its own bounding box, so it has already been tested
+                    if (children.empty())
+                    {
+                        // sorted by the layer after the traversal
+                        drawQueue.push_back(this);
+                    }
+                    else
+                    {
+                        AABB3 boundingBox = getBoundingBox3D();
+
+                        if (cullDisabled || (!boundingBox.isEmpty() && camera->checkVisibility(currentTransform, boundingBox)))
+                        {
+                            drawQueue.push_back(this);
+                        }
+                    }
+                }
 
-            if (!hidden)
+                for (Node* child : children)
+                {
+                    child->visit(drawQueue, currentTransform, updateChildrenTransform, camera, worldOrder);
+                }
+            }
+
+            updateChildrenTransform = false;
+            subtreeChanged = false;
+        }
+
+        void Node::visitCulled(const Matrix4& newParentTransform,
+                               bool parentTransformDirty,
+                               int32_t parentOrder)
+        {
+            // nothing below this node has changed since the last traversal
+            if (!parentTransformDirty && !subtreeChanged && worldOrder == parentOrder + order)
             {
-                AABB2 boundingBox = getBoundingBox();
+                return;
+            }
+
+            worldOrder = parentOrder + order;
 
-                if (cullDisabled || (!boundingBox.isEmpty() && camera->checkVisibility(getTransform(), boundingBox)))
+            if (!transformHierarchy)
+            {
+                if (parentTransformDirty)
                 {
-                    auto upperBound = std::upper_bound(drawQueue.begin(), drawQueue.end(), this,
-                                                       [](Node* a, Node* b) {
-                                                           return a->worldOrder > b->worldOrder;
-                                                       });
+                    updateTransform(newParentTransform);
+                }
 
-                    drawQueue.insert(upperBound, this);
+                if (transformDirty)
+                {
+                    calculateTransform();
                 }
             }
 
+            const Matrix4& currentTransform = getTransform();
+
             for (Node* child : children)
             {
-                child->visit(drawQueue, transform, updateChildrenTransform, camera, worldOrder);
+                child->visitCulled(currentTransform, updateChildrenTransform, worldOrder);
             }
 
             updateChildrenTransform = false;
+            subtreeChanged = false;
         }
 
         void Node::draw(Camera* camera)
         {
-            if (transformDirty)
-            {
-                calculateTransform();
-            }
+            const Matrix4& currentTransform = getTransform();
 
             Color drawColor(color.v[0], color.v[1], color.v[2], static_cast<uint8_t>(color.v[3] * opacity));
 
@@ -92,17 +153,14 @@ namespace ouzel
             {
                 if (!component->isHidden())
                 {
-                    component->draw(transform, drawColor, camera);
+                    component->draw(currentTransform, drawColor, camera);
                 }
             }
         }
 
         void Node::drawWireframe(Camera* camera)
         {
-            if (transformDirty)
-            {
-                calculateTransform();
-            }
+            const Matrix4& currentTransform = getTransform();
 
             Color drawColor(color.v[0], color.v[1], color.v[2], 255);
 
@@ -110,7 +168,7 @@ namespace ouzel
             {
                 if (!component->isHidden())
                 {
-                    component->drawWireframe(transform, drawColor, camera);
+                    component->drawWireframe(currentTransform, drawColor, camera);
                 }
             }
         }
@@ -141,7 +199,9 @@ namespace ouzel
                 position.v[0] = newPosition.v[0];
                 position.v[1] = newPosition.v[1];
 
-                localTransformDirty = transformDirty = inverseTransformDirty = true;
+                localTransformChanged();
+
+                contentChanged();
             }
         }
 
@@ -151,7 +211,9 @@ namespace ouzel
             {
                 position = newPosition;
 
-                localTransformDirty = transformDirty = inverseTransformDirty = true;
+                localTransformChanged();
+
+                contentChanged();
             }
         }
 
@@ -161,7 +223,9 @@ namespace ouzel
             {
                 rotation = newRotation;
 
-                localTransformDirty = transformDirty = inverseTransformDirty = true;
+                localTransformChanged();
+
+                contentChanged();
             }
         }
 
@@ -174,7 +238,9 @@ namespace ouzel
             {
                 rotation = roationQuaternion;
 
-                localTransformDirty = transformDirty = inverseTransformDirty = true;
+                localTransformChanged();
+
+                contentChanged();
             }
         }
 
@@ -187,7 +253,9 @@ namespace ouzel
             {
                 rotation = roationQuaternion;
 
-                localTransformDirty = transformDirty = inverseTransformDirty = true;
+                localTransformChanged();
+
+                contentChanged();
             }
         }
 
@@ -199,7 +267,9 @@ namespace ouzel
                 scale.v[0] = newScale.v[0];
                 scale.v[1] = newScale.v[1];
 
-                localTransformDirty = transformDirty = inverseTransformDirty = true;
+                localTransformChanged();
+
+                contentChanged();
             }
         }
 
@@ -209,18 +279,24 @@ namespace ouzel
             {
                 scale = newScale;
 
-                localTransformDirty = transformDirty = inverseTransformDirty = true;
+                localTransformChanged();
+
+                contentChanged();
             }
         }
 
         void Node::setColor(const Color& newColor)
         {
             color = newColor;
+
+            contentChanged();
         }
 
         void Node::setOpacity(float newOpacity)
         {
             opacity = clamp(newOpacity, 0.0f, 1.0f);
+
+            contentChanged();
         }
 
         void Node::setFlipX(bool newFlipX)
@@ -229,7 +305,9 @@ namespace ouzel
             {
                 flipX = newFlipX;
 
-                localTransformDirty = transformDirty = inverseTransformDirty = true;
+                localTransformChanged();
+
+                contentChanged();
             }
         }
 
@@ -239,13 +317,18 @@ namespace ouzel
             {
                 flipY = newFlipY;
 
-                localTransformDirty = transformDirty = inverseTransformDirty = true;
+                localTransformChanged();
+
+                contentChanged();
             }
         }
 
         void Node::setHidden(bool newHidden)
         {
             hidden = newHidden;
+
+            boundingBoxChanged();
+            contentChanged();
         }
 
         bool Node::pointOn(const Vector2& worldPosition) const
@@ -292,7 +375,11 @@ namespace ouzel
         void Node::updateTransform(const Matrix4& newParentTransform)
         {
             parentTransform = newParentTransform;
-            transformDirty = inverseTransformDirty = true;
+
+            if (!transformHierarchy)
+            {
+                transformDirty = inverseTransformDirty = true;
+            }
         }
 
         Vector3 Node::getWorldPosition() const
@@ -365,6 +452,74 @@ namespace ouzel
             }
         }
 
+        void Node::contentChanged()
+        {
+            subtreeChanged = true;
+
+            if (parent)
+            {
+                parent->contentChanged();
+            }
+        }
+
+        void Node::childrenChanged()
+        {
+            if (parent)
+            {
+                parent->childrenChanged();
+            }
+        }
+
+        void Node::boundingBoxChanged()
+        {
+            // ancestors of a dirty node are always dirty
+            if (!subtreeBoundingBoxDirty)
+            {
+                subtreeBoundingBoxDirty = true;
+
+                if (parent)
+                {
+                    parent->boundingBoxChanged();
+                }
+            }
+        }
+
+        void Node::localTransformChanged()
+        {
+            localTransformDirty = true;
+
+            // the subtree bounding box is in local space, so only the bounding box of the parent changes
+            if (parent)
+            {
+                parent->boundingBoxChanged();
+            }
+
+            if (transformHierarchy)
+            {
+                transformHierarchy->setLocalTransformDirty(transformIndex);
+            }
+            else
+            {
+                transformDirty = inverseTransformDirty = true;
+            }
+        }
+
+        void Node::detachTransformHierarchy()
+        {
+            if (transformHierarchy)
+            {
+                transformHierarchy = nullptr;
+
+                // the world transform has to be calculated from the parent transform again
+                transformDirty = inverseTransformDirty = updateChildrenTransform = true;
+
+                for (Node* child : children)
+                {
+                    child->detachTransformHierarchy();
+                }
+            }
+        }
+
         void Node::calculateLocalTransform() const
         {
             localTransform.setIdentity();
@@ -386,6 +541,8 @@ namespace ouzel
             transformDirty = false;
 
             updateChildrenTransform = true;
+
+            transformChanged();
         }
 
         void Node::calculateInverseTransform() const
@@ -395,6 +552,37 @@ namespace ouzel
             inverseTransformDirty = false;
         }
 
+        void Node::calculateSubtreeBoundingBox() const
+        {
+            subtreeBoundingBox.reset();
+            subtreeCullDisabled = false;
+
+            if (!hidden)
+            {
+                subtreeBoundingBox = getBoundingBox3D();
+                subtreeCullDisabled = cullDisabled;
+            }
+
+            for (Node* child : children)
+            {
+                const AABB3& childBoundingBox = child->getSubtreeBoundingBox();
+
+                if (child->subtreeCullDisabled)
+                {
+                    subtreeCullDisabled = true;
+                }
+
+                if (!childBoundingBox.isEmpty())
+                {
+                    AABB3 transformedBoundingBox;
+                    child->getLocalTransform().transformAABBs(&childBoundingBox, &transformedBoundingBox, 1);
+                    subtreeBoundingBox.merge(transformedBoundingBox);
+                }
+            }
+
+            subtreeBoundingBoxDirty = false;
+        }
+
         void Node::addComponent(Component* component)
         {
             Node* oldNode = component->node;
@@ -406,6 +594,9 @@ namespace ouzel
 
             component->node = this;
             components.push_back(component);
+
+            boundingBoxChanged();
+            contentChanged();
         }
 
         bool Node::removeComponent(uint32_t index)
@@ -420,6 +611,9 @@ namespace ouzel
 
             components.erase(components.begin() + static_cast<int>(index));
 
+            boundingBoxChanged();
+            contentChanged();
+
             return true;
         }
 
@@ -431,6 +625,10 @@ namespace ouzel
                 {
                     component->node = nullptr;
                     components.erase(i);
+
+                    boundingBoxChanged();
+                    contentChanged();
+
                     return true;
                 }
                 else
@@ -445,6 +643,9 @@ namespace ouzel
         void Node::removeAllComponents()
         {
             components.clear();
+
+            boundingBoxChanged();
+            contentChanged();
         }
 
         void Node::updateAnimation(float delta)
@@ -479,5 +680,20 @@ namespace ouzel
 
             return boundingBox;
         }
+
+        AABB3 Node::getBoundingBox3D() const
+        {
+            AABB3 boundingBox;
+
+            for (Component* component : components)
+            {
+                if (!component->isHidden())
+                {
+                    boundingBox.merge(component->getBoundingBox3D());
+                }
+            }
+
+            return boundingBox;
+        }
     } // namespace scene
 } // namespace ouzel
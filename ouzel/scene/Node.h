@@ -5,7 +5,9 @@
 
 #include <vector>
 #include "scene/NodeContainer.h"
+#include "scene/TransformHierarchy.h"
 #include "math/AABB2.h"
+#include "math/AABB3.h"
 #include "math/Color.h"
 #include "math/Matrix4.h"
 #include "math/Quaternion.h"
@@ -27,6 +29,8 @@ namespace ouzel
             friend NodeContainer;
             friend Layer;
             friend Animator;
+            friend Component;
+            friend TransformHierarchy;
         public:
             Node();
             virtual ~Node();
@@ -47,7 +51,7 @@ namespace ouzel
             virtual void setPosition(const Vector3& newPosition);
             virtual const Vector3& getPosition() const { return position; }
 
-            void setOrder(int32_t newOrder) { order = newOrder; }
+            void setOrder(int32_t newOrder) { order = newOrder; contentChanged(); }
             int32_t getOrder() const { return order; }
 
             virtual void setRotation(const Quaternion& newRotation);
@@ -75,7 +79,7 @@ namespace ouzel
             virtual bool isPickable() const { return pickable; }
 
             virtual bool isCullDisabled() const { return cullDisabled; }
-            virtual void setCullDisabled(bool newCullDisabled) { cullDisabled = newCullDisabled; }
+            virtual void setCullDisabled(bool newCullDisabled) { cullDisabled = newCullDisabled; boundingBoxChanged(); }
 
             virtual void setHidden(bool newHidden);
             virtual bool isHidden() const { return hidden; }
@@ -95,6 +99,11 @@ namespace ouzel
 
             const Matrix4& getTransform() const
             {
+                if (transformHierarchy)
+                {
+                    return transformHierarchy->getTransform(transformIndex);
+                }
+
                 if (transformDirty)
                 {
                     calculateTransform();
@@ -105,6 +114,11 @@ namespace ouzel
 
             const Matrix4& getInverseTransform() const
             {
+                if (transformHierarchy)
+                {
+                    return transformHierarchy->getInverseTransform(transformIndex);
+                }
+
                 if (inverseTransformDirty)
                 {
                     calculateInverseTransform();
@@ -132,8 +146,28 @@ namespace ouzel
             void removeAllComponents();
 
             AABB2 getBoundingBox() const;
+            AABB3 getBoundingBox3D() const;
+
+            // bounding box of the node and all its visible descendants in the local space of the node
+            const AABB3& getSubtreeBoundingBox() const
+            {
+                if (subtreeBoundingBoxDirty)
+                {
+                    calculateSubtreeBoundingBox();
+                }
+
+                return subtreeBoundingBox;
+            }
 
         protected:
+            virtual void contentChanged() override;
+            virtual void childrenChanged() override;
+            virtual void boundingBoxChanged() override;
+
+            void visitCulled(const Matrix4& newParentTransform,
+                             bool parentTransformDirty,
+                             int32_t parentOrder);
+
             void removeAnimator(Animator* animator);
 
             virtual void calculateLocalTransform() const;
@@ -141,6 +175,13 @@ namespace ouzel
 
             virtual void calculateInverseTransform() const;
 
+            void calculateSubtreeBoundingBox() const;
+
+            void localTransformChanged();
+            // called when the world transform of the node changes, only if transformNotifications is set
+            virtual void transformChanged() const {}
+            void detachTransformHierarchy();
+
             void updateAnimation(float delta);
 
             Matrix4 parentTransform;
@@ -153,6 +194,18 @@ namespace ouzel
             mutable bool localTransformDirty = true;
             mutable bool updateChildrenTransform = true;
 
+            // set while the layer of the node keeps its world transform in a transform hierarchy
+            TransformHierarchy* transformHierarchy = nullptr;
+            uint32_t transformIndex = 0;
+            bool transformNotifications = false;
+
+            mutable AABB3 subtreeBoundingBox;
+            mutable bool subtreeBoundingBoxDirty = true;
+            mutable bool subtreeCullDisabled = false;
+
+            // set when the node or any of its descendants changed since the last traversal
+            bool subtreeChanged = true;
+
             bool flipX = false;
             bool flipY = false;
 
@@ -19,6 +19,7 @@ namespace ouzel
             {
                 if (entered) node->leave();
                 node->parent = nullptr;
+                node->detachTransformHierarchy();
             }
         }
 
@@ -35,6 +36,10 @@ namespace ouzel
                 node->parent = this;
                 if (entered) node->enter();
                 children.push_back(node);
+
+                contentChanged();
+                childrenChanged();
+                boundingBoxChanged();
             }
         }
 
@@ -46,8 +51,13 @@ namespace ouzel
             {
                 if (entered) node->leave();
                 node->parent = nullptr;
+                node->detachTransformHierarchy();
                 children.erase(i);
 
+                contentChanged();
+                childrenChanged();
+                boundingBoxChanged();
+
                 return true;
             }
             else
@@ -64,9 +74,14 @@ namespace ouzel
             {
                 if (entered) node->leave();
                 node->parent = nullptr;
+                node->detachTransformHierarchy();
             }
 
             children.clear();
+
+            contentChanged();
+            childrenChanged();
+            boundingBoxChanged();
         }
 
         bool NodeContainer::hasChild(Node* node, bool recursive) const
@@ -104,6 +119,18 @@ namespace ouzel
             }
         }
 
+        void NodeContainer::contentChanged()
+        {
+        }
+
+        void NodeContainer::childrenChanged()
+        {
+        }
+
+        void NodeContainer::boundingBoxChanged()
+        {
+        }
+
         void NodeContainer::findNodes(const Vector2& position, std::vector<Node*>& nodes) const
         {
             for (auto i = children.rbegin(); i != children.rend(); ++i)
@@ -15,6 +15,7 @@ namespace ouzel
 
         class NodeContainer: public Noncopyable
         {
+            friend Node;
         public:
             NodeContainer();
             virtual ~NodeContainer();
@@ -32,6 +33,15 @@ namespace ouzel
             virtual void enter();
             virtual void leave();
 
+            // called when this container or any of its descendants changes in a way that affects drawing
+            virtual void contentChanged();
+
+            // called when nodes are added to or removed from this container or any of its descendants
+            virtual void childrenChanged();
+
+            // called when the bounding box of this container or any of its descendants changes
+            virtual void boundingBoxChanged();
+
             std::vector<Node*> children;
             bool entered = false;
         };
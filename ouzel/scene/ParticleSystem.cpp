@@ -43,12 +43,6 @@ namespace ouzel
 
             if (particleCount)
             {
-                if (needsMeshUpdate)
-                {
-                    updateParticleMesh();
-                    needsMeshUpdate = false;
-                }
-
                 Matrix4 transform;
 
                 if (particleDefinition.positionType == ParticleDefinition::PositionType::FREE ||
@@ -61,25 +55,50 @@ namespace ouzel
                     transform = camera->getRenderViewProjection() * transformMatrix;
                 }
 
+                graphics::Renderer* renderer = sharedEngine->getRenderer();
+                graphics::Renderer::DrawList& drawList = camera->getDrawList();
+
+                if (renderer->isInstancingSupported())
+                {
+                    if (needsInstanceUpdate)
+                    {
+                        updateParticleInstances();
+                        needsInstanceUpdate = false;
+                    }
+
+                    // falls back to the vertex mesh if the instanced draw command can't be used
+                    if (drawList.addInstancedDrawCommand(texture,
+                                                         blendState,
+                                                         transform,
+                                                         drawColor,
+                                                         instances.data(),
+                                                         particleCount,
+                                                         camera->getRenderTarget(),
+                                                         camera->getRenderViewport()))
+                    {
+                        return;
+                    }
+                }
+
+                if (needsMeshUpdate)
+                {
+                    updateParticleMesh();
+                    needsMeshUpdate = false;
+                }
+
                 float colorVector[] = { drawColor.normR(), drawColor.normG(), drawColor.normB(), drawColor.normA() };
 
-                std::vector<std::vector<float>> pixelShaderConstants(1);
-                pixelShaderConstants[0] = { std::begin(colorVector), std::end(colorVector) };
-
-                std::vector<std::vector<float>> vertexShaderConstants(1);
-                vertexShaderConstants[0] = { std::begin(transform.m), std::end(transform.m) };
-
-                sharedEngine->getRenderer()->addDrawCommand({ texture },
-                                                            shader,
-                                                            pixelShaderConstants,
-                                                            vertexShaderConstants,
-                                                            blendState,
-                                                            meshBuffer,
-                                                            particleCount * 6,
-                                                            graphics::Renderer::DrawMode::TRIANGLE_LIST,
-                                                            0,
-                                                            camera->getRenderTarget(),
-                                                            camera->getRenderViewport());
+                drawList.addDrawCommand({ texture },
+                                        shader,
+                                        { colorVector },
+                                        { transform.m },
+                                        blendState,
+                                        meshBuffer,
+                                        particleCount * 6,
+                                        graphics::Renderer::DrawMode::TRIANGLE_LIST,
+                                        0,
+                                        camera->getRenderTarget(),
+                                        camera->getRenderViewport());
             }
         }
 
@@ -91,6 +110,12 @@ namespace ouzel
 
             if (particleCount)
             {
+                if (needsMeshUpdate)
+                {
+                    updateParticleMesh();
+                    needsMeshUpdate = false;
+                }
+
                 Matrix4 transform;
 
                 if (particleDefinition.positionType == ParticleDefinition::PositionType::FREE ||
@@ -105,24 +130,18 @@ namespace ouzel
 
                 float colorVector[] = { drawColor.normR(), drawColor.normG(), drawColor.normB(), drawColor.normA() };
 
-                std::vector<std::vector<float>> pixelShaderConstants(1);
-                pixelShaderConstants[0] = { std::begin(colorVector), std::end(colorVector) };
-
-                std::vector<std::vector<float>> vertexShaderConstants(1);
-                vertexShaderConstants[0] = { std::begin(transform.m), std::end(transform.m) };
-
-                sharedEngine->getRenderer()->addDrawCommand({ whitePixelTexture },
-                                                            shader,
-                                                            pixelShaderConstants,
-                                                            vertexShaderConstants,
-                                                            blendState,
-                                                            meshBuffer,
-                                                            particleCount * 6,
-                                                            graphics::Renderer::DrawMode::TRIANGLE_LIST,
-                                                            0,
-                                                            camera->getRenderTarget(),
-                                                            camera->getRenderViewport(),
-                                                            true);
+                camera->getDrawList().addDrawCommand({ whitePixelTexture },
+                                                     shader,
+                                                     { colorVector },
+                                                     { transform.m },
+                                                     blendState,
+                                                     meshBuffer,
+                                                     particleCount * 6,
+                                                     graphics::Renderer::DrawMode::TRIANGLE_LIST,
+                                                     0,
+                                                     camera->getRenderTarget(),
+                                                     camera->getRenderViewport(),
+                                                     true);
             }
         }
 
@@ -243,10 +262,20 @@ namespace ouzel
                     {
                         const Matrix4& inverseTransform = node->getInverseTransform();
 
+                        transformedPositions.resize(particleCount);
+
                         for (uint32_t i = 0; i < particleCount; i++)
                         {
-                            Vector3 position = particles[i].position;
-                            inverseTransform.transformPoint(position);
+                            transformedPositions[i] = particles[i].position;
+                        }
+
+                        if (particleCount)
+                        {
+                            inverseTransform.transformPoints(transformedPositions.data(), transformedPositions.data(), particleCount);
+                        }
+
+                        for (const Vector3& position : transformedPositions)
+                        {
                             boundingBox.insertPoint(Vector2(position.v[0], position.v[1]));
                         }
                     }
@@ -260,6 +289,8 @@ namespace ouzel
                 }
 
                 needsMeshUpdate = true;
+                needsInstanceUpdate = true;
+                contentChanged();
             }
         }
 
@@ -327,6 +358,9 @@ namespace ouzel
 
         bool ParticleSystem::createParticleMesh()
         {
+            // the vertices are written straight to the vertex buffer's staging memory by updateParticleMesh
+            std::vector<graphics::VertexPCT> vertices;
+
             indices.reserve(particleDefinition.maxParticles * 6);
             vertices.reserve(particleDefinition.maxParticles * 4);
 
@@ -365,10 +399,10 @@ namespace ouzel
         {
             if (node)
             {
-                for (uint32_t counter = particleCount; counter > 0; --counter)
-                {
-                    size_t i = counter - 1;
+                graphics::VertexPCT* vertices = static_cast<graphics::VertexPCT*>(vertexBuffer->mapData(particleCount * 4));
 
+                for (uint32_t i = 0; i < particleCount; ++i)
+                {
                     Vector2 position;
 
                     if (particleDefinition.positionType == ParticleDefinition::PositionType::FREE)
@@ -398,20 +432,14 @@ namespace ouzel
                                 static_cast<uint8_t>(particles[i].colorBlue * 255),
                                 static_cast<uint8_t>(particles[i].colorAlpha * 255));
 
-                    vertices[i * 4 + 0].position = a + position;
-                    vertices[i * 4 + 0].color = color;
-
-                    vertices[i * 4 + 1].position = b + position;
-                    vertices[i * 4 + 1].color = color;
-
-                    vertices[i * 4 + 2].position = d + position;
-                    vertices[i * 4 + 2].color = color;
-
-                    vertices[i * 4 + 3].position = c + position;
-                    vertices[i * 4 + 3].color = color;
+                    // the staging memory is recycled, so the texture coordinates are written every time too
+                    vertices[i * 4 + 0] = graphics::VertexPCT(a + position, color, Vector2(0.0f, 1.0f));
+                    vertices[i * 4 + 1] = graphics::VertexPCT(b + position, color, Vector2(1.0f, 1.0f));
+                    vertices[i * 4 + 2] = graphics::VertexPCT(d + position, color, Vector2(0.0f, 0.0f));
+                    vertices[i * 4 + 3] = graphics::VertexPCT(c + position, color, Vector2(1.0f, 0.0f));
                 }
 
-                if (!vertexBuffer->setData(vertices.data(), static_cast<uint32_t>(vertices.size())))
+                if (!vertexBuffer->unmapData())
                 {
                     return false;
                 }
@@ -420,6 +448,41 @@ namespace ouzel
             return true;
         }
 
+        void ParticleSystem::updateParticleInstances()
+        {
+            if (node)
+            {
+                instances.resize(particleCount);
+
+                for (uint32_t i = 0; i < particleCount; ++i)
+                {
+                    Vector2 position;
+
+                    if (particleDefinition.positionType == ParticleDefinition::PositionType::FREE)
+                    {
+                        position = particles[i].position;
+                    }
+                    else if (particleDefinition.positionType == ParticleDefinition::PositionType::PARENT)
+                    {
+                        position = node->getPosition() + particles[i].position;
+                    }
+
+                    graphics::VertexInstance& instance = instances[i];
+
+                    // the unit quad spans from -0.5 to 0.5, so the instance size is the full particle size
+                    instance.position = position;
+                    instance.size = Vector2(particles[i].size, particles[i].size);
+                    instance.rotation = -degToRad(particles[i].rotation);
+                    instance.color = Color(static_cast<uint8_t>(particles[i].colorRed * 255),
+                                           static_cast<uint8_t>(particles[i].colorGreen * 255),
+                                           static_cast<uint8_t>(particles[i].colorBlue * 255),
+                                           static_cast<uint8_t>(particles[i].colorAlpha * 255));
+                    instance.texCoordOffset = Vector2(0.0f, 0.0f);
+                    instance.texCoordScale = Vector2(1.0f, 1.0f);
+                }
+            }
+        }
+
         void ParticleSystem::emitParticles(uint32_t count)
         {
             if (particleCount + count > particleDefinition.maxParticles)
@@ -10,6 +10,7 @@
 #include "utils/Types.h"
 #include "scene/ParticleDefinition.h"
 #include "math/Vector2.h"
+#include "math/Vector3.h"
 #include "math/Color.h"
 #include "graphics/Vertex.h"
 #include "core/UpdateCallback.h"
@@ -52,6 +53,7 @@ namespace ouzel
         protected:
             bool createParticleMesh();
             bool updateParticleMesh();
+            void updateParticleInstances();
 
             void emitParticles(uint32_t count);
 
@@ -97,13 +99,16 @@ namespace ouzel
             };
 
             std::vector<Particle> particles;
+            // scratch buffer for transforming the particle positions in one batch
+            std::vector<Vector3> transformedPositions;
 
             graphics::MeshBufferPtr meshBuffer;
             graphics::IndexBufferPtr indexBuffer;
             graphics::VertexBufferPtr vertexBuffer;
 
             std::vector<uint16_t> indices;
-            std::vector<graphics::VertexPCT> vertices;
+            // one instance per particle, used instead of the vertices if the renderer supports instancing
+            std::vector<graphics::VertexInstance> instances;
 
             uint32_t particleCount = 0;
 
@@ -114,6 +119,7 @@ namespace ouzel
             bool finished = false;
 
             bool needsMeshUpdate = false;
+            bool needsInstanceUpdate = false;
 
             UpdateCallback updateCallback;
 
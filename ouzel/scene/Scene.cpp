@@ -7,6 +7,7 @@
 #include "Camera.h"
 #include "SceneManager.h"
 #include "core/Engine.h"
+#include "core/JobSystem.h"
 #include "events/EventDispatcher.h"
 
 namespace ouzel
@@ -36,16 +37,45 @@ namespace ouzel
 
         void Scene::draw()
         {
-            std::stable_sort(layers.begin(), layers.end(), [](Layer* a, Layer* b) {
-                return a->getOrder() > b->getOrder();
-            });
+            // stable insertion sort, std::stable_sort would allocate a temporary buffer every frame and scenes have only a few layers
+            for (std::vector<Layer*>::iterator i = layers.begin(); i != layers.end(); ++i)
+            {
+                std::rotate(std::upper_bound(layers.begin(), i, *i, [](Layer* a, Layer* b) {
+                    return a->getOrder() > b->getOrder();
+                }), i, i + 1);
+            }
+
+            JobSystem* jobSystem = sharedEngine->getJobSystem();
+
+            if (jobSystem->getWorkerCount() > 0 && layers.size() > 1)
+            {
+                // layers don't share nodes, so their traversal and command recording can run in parallel,
+                // cameras of one layer are recorded sequentially because they visit the same nodes
+                JobSystem::TaskGroup group;
+
+                for (Layer* layer : layers)
+                {
+                    layer->drawListRecorded = true;
+                    jobSystem->run(group, &Scene::recordDrawList, layer);
+                }
+
+                jobSystem->wait(group);
+            }
 
+            // layers are drawn in order on this thread, so that the result does not depend on which task finished first
+            // and overrides of draw can still add commands to the renderer
             for (Layer* layer : layers)
             {
                 layer->draw();
+                layer->drawListRecorded = false;
             }
         }
 
+        void Scene::recordDrawList(void* layer)
+        {
+            static_cast<Layer*>(layer)->recordDrawList();
+        }
+
         void Scene::addLayer(Layer* layer)
         {
             if (layer && !hasLayer(layer))
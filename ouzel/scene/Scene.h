@@ -43,6 +43,9 @@ namespace ouzel
             virtual void enter();
             virtual void leave();
 
+            // job system task that records the draw list of a layer
+            static void recordDrawList(void* layer);
+
             bool handleWindow(Event::Type type, const WindowEvent& event);
             bool handleMouse(Event::Type type, const MouseEvent& event);
             bool handleTouch(Event::Type type, const TouchEvent& event);
@@ -53,23 +53,17 @@ namespace ouzel
 
             for (const DrawCommand& drawCommand : drawCommands)
             {
-                std::vector<std::vector<float>> pixelShaderConstants(1);
-                pixelShaderConstants[0] = { std::begin(colorVector), std::end(colorVector) };
-
-                std::vector<std::vector<float>> vertexShaderConstants(1);
-                vertexShaderConstants[0] = { std::begin(modelViewProj.m), std::end(modelViewProj.m) };
-
-                sharedEngine->getRenderer()->addDrawCommand(std::vector<graphics::TexturePtr>(),
-                                                            shader,
-                                                            pixelShaderConstants,
-                                                            vertexShaderConstants,
-                                                            blendState,
-                                                            meshBuffer,
-                                                            drawCommand.indexCount,
-                                                            drawCommand.mode,
-                                                            drawCommand.startIndex,
-                                                            camera->getRenderTarget(),
-                                                            camera->getRenderViewport());
+                camera->getDrawList().addDrawCommand({ },
+                                                     shader,
+                                                     { colorVector },
+                                                     { modelViewProj.m },
+                                                     blendState,
+                                                     meshBuffer,
+                                                     drawCommand.indexCount,
+                                                     drawCommand.mode,
+                                                     drawCommand.startIndex,
+                                                     camera->getRenderTarget(),
+                                                     camera->getRenderViewport());
             }
         }
 
@@ -91,24 +85,18 @@ namespace ouzel
 
             for (const DrawCommand& drawCommand : drawCommands)
             {
-                std::vector<std::vector<float>> pixelShaderConstants(1);
-                pixelShaderConstants[0] = { std::begin(colorVector), std::end(colorVector) };
-
-                std::vector<std::vector<float>> vertexShaderConstants(1);
-                vertexShaderConstants[0] = { std::begin(modelViewProj.m), std::end(modelViewProj.m) };
-
-                sharedEngine->getRenderer()->addDrawCommand(std::vector<graphics::TexturePtr>(),
-                                                            shader,
-                                                            pixelShaderConstants,
-                                                            vertexShaderConstants,
-                                                            blendState,
-                                                            meshBuffer,
-                                                            drawCommand.indexCount,
-                                                            drawCommand.mode,
-                                                            drawCommand.startIndex,
-                                                            camera->getRenderTarget(),
-                                                            camera->getRenderViewport(),
-                                                            true);
+                camera->getDrawList().addDrawCommand({ },
+                                                     shader,
+                                                     { colorVector },
+                                                     { modelViewProj.m },
+                                                     blendState,
+                                                     meshBuffer,
+                                                     drawCommand.indexCount,
+                                                     drawCommand.mode,
+                                                     drawCommand.startIndex,
+                                                     camera->getRenderTarget(),
+                                                     camera->getRenderViewport(),
+                                                     true);
             }
         }
 
@@ -121,6 +109,7 @@ namespace ouzel
             vertices.clear();
 
             dirty = true;
+            contentChanged();
         }
 
         void ShapeDrawable::point(const Vector2& position, const Color& color)
@@ -141,6 +130,7 @@ namespace ouzel
             boundingBox.insertPoint(position);
 
             dirty = true;
+            contentChanged();
         }
 
         void ShapeDrawable::line(const Vector2& start, const Vector2& finish, const Color& color)
@@ -165,6 +155,7 @@ namespace ouzel
             boundingBox.insertPoint(finish);
 
             dirty = true;
+            contentChanged();
         }
 
         void ShapeDrawable::circle(const Vector2& position, float radius, const Color& color, bool fill, uint32_t segments)
@@ -228,6 +219,7 @@ namespace ouzel
             boundingBox.insertPoint(Vector2(position.v[0] + radius, position.v[1] + radius));
 
             dirty = true;
+            contentChanged();
         }
 
         void ShapeDrawable::rectangle(const Rectangle& rectangle, const Color& color, bool fill)
@@ -271,6 +263,7 @@ namespace ouzel
             boundingBox.insertPoint(rectangle.topRight());
 
             dirty = true;
+            contentChanged();
         }
 
         void ShapeDrawable::triangle(const Vector2 (&positions)[3], const Color& color, bool fill)
@@ -302,6 +295,7 @@ namespace ouzel
             drawCommands.push_back(command);
 
             dirty = true;
+            contentChanged();
         }
 
         void ShapeDrawable::polygon(const std::vector<Vector2>& edges, const Color& color, bool fill)
@@ -347,6 +341,7 @@ namespace ouzel
             drawCommands.push_back(command);
             
             dirty = true;
+            contentChanged();
         }
 
     } // namespace scene
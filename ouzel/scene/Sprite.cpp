@@ -1,6 +1,7 @@
 // Copyright (C) 2016 Elviss Strazdins
 // This file is part of the Ouzel engine.
 
+#include <cmath>
 #include <rapidjson/rapidjson.h>
 #include <rapidjson/filereadstream.h>
 #include <rapidjson/document.h>
@@ -24,6 +25,7 @@ namespace ouzel
         Sprite::Sprite()
         {
             shader = sharedEngine->getCache()->getShader(graphics::SHADER_TEXTURE);
+            textureShader = shader;
             whitePixelTexture = sharedEngine->getCache()->getTexture(graphics::TEXTURE_WHITE_PIXEL);
 
             updateCallback.callback = std::bind(&Sprite::update, this, std::placeholders::_1);
@@ -125,6 +127,38 @@ namespace ouzel
             }
         }
 
+        // succeeds only for transforms made of a 2D translation, rotation and scale without skew
+        static bool transformInstance(const Matrix4& transform, graphics::VertexInstance& instance)
+        {
+            if (transform.m[2] != 0.0f || transform.m[6] != 0.0f ||
+                transform.m[3] != 0.0f || transform.m[7] != 0.0f || transform.m[15] != 1.0f)
+            {
+                return false;
+            }
+
+            Vector2 xAxis(transform.m[0], transform.m[1]);
+            Vector2 yAxis(transform.m[4], transform.m[5]);
+
+            float xLength = xAxis.length();
+            float yLength = yAxis.length();
+
+            if (xLength == 0.0f || yLength == 0.0f ||
+                fabsf(xAxis.dot(yAxis)) > 0.0001f * xLength * yLength)
+            {
+                return false;
+            }
+
+            // mirrored transforms flip the quad vertically
+            float cross = xAxis.x() * yAxis.y() - xAxis.y() * yAxis.x();
+
+            transform.transformPoint(instance.position);
+            instance.size.v[0] *= xLength;
+            instance.size.v[1] *= (cross < 0.0f) ? -yLength : yLength;
+            instance.rotation = atan2f(xAxis.y(), xAxis.x());
+
+            return true;
+        }
+
         void Sprite::draw(const Matrix4& transformMatrix,
                           const Color& drawColor,
                           scene::Camera* camera)
@@ -133,26 +167,60 @@ namespace ouzel
 
             if (currentFrame < frames.size())
             {
+                const SpriteFrame& frame = frames[currentFrame];
+
+                if (camera->getLayer() && camera->getLayer()->isBatchingEnabled())
+                {
+                    graphics::Renderer* renderer = sharedEngine->getRenderer();
+                    graphics::Renderer::DrawList& drawList = camera->getDrawList();
+                    Matrix4 transform = transformMatrix * offsetMatrix;
+
+                    if (frame.isQuad() && shader == textureShader && renderer->isInstancingSupported())
+                    {
+                        graphics::VertexInstance instance = frame.getQuadInstance();
+
+                        if (transformInstance(transform, instance) &&
+                            drawList.addInstancedDrawCommand(frame.getTexture(),
+                                                             blendState,
+                                                             camera->getRenderViewProjection(),
+                                                             drawColor,
+                                                             &instance, 1,
+                                                             camera->getRenderTarget(),
+                                                             camera->getRenderViewport()))
+                        {
+                            return;
+                        }
+                    }
+
+                    drawList.addBatchedDrawCommand(frame.getTexture(),
+                                                   shader,
+                                                   blendState,
+                                                   camera->getRenderViewProjection(),
+                                                   transform,
+                                                   drawColor,
+                                                   frame.getVertices().data(),
+                                                   static_cast<uint32_t>(frame.getVertices().size()),
+                                                   frame.getIndices().data(),
+                                                   static_cast<uint32_t>(frame.getIndices().size()),
+                                                   camera->getRenderTarget(),
+                                                   camera->getRenderViewport());
+                    return;
+                }
+
                 Matrix4 modelViewProj = camera->getRenderViewProjection() * transformMatrix * offsetMatrix;
                 float colorVector[] = { drawColor.normR(), drawColor.normG(), drawColor.normB(), drawColor.normA() };
 
-                std::vector<std::vector<float>> pixelShaderConstants(1);
-                pixelShaderConstants[0] = { std::begin(colorVector), std::end(colorVector) };
-
-                std::vector<std::vector<float>> vertexShaderConstants(1);
-                vertexShaderConstants[0] = { std::begin(modelViewProj.m), std::end(modelViewProj.m) };
-
-                sharedEngine->getRenderer()->addDrawCommand({ frames[currentFrame].getTexture() },
-                                                            shader,
-                                                            pixelShaderConstants,
-                                                            vertexShaderConstants,
-                                                            blendState,
-                                                            frames[currentFrame].getMeshBuffer(),
-                                                            0,
-                                                            graphics::Renderer::DrawMode::TRIANGLE_LIST,
-                                                            0,
-                                                            camera->getRenderTarget(),
-                                                            camera->getRenderViewport());
+                camera->getDrawList().addDrawCommand({ frame.getTexture() },
+                                                     shader,
+                                                     { colorVector },
+                                                     { modelViewProj.m },
+                                                     blendState,
+                                                     frame.getMeshBuffer(),
+                                                     0,
+                                                     graphics::Renderer::DrawMode::TRIANGLE_LIST,
+                                                     0,
+                                                     camera->getRenderTarget(),
+                                                     camera->getRenderViewport());
             }
         }
 
@@ -167,24 +235,18 @@ namespace ouzel
                 Matrix4 modelViewProj = camera->getRenderViewProjection() * transformMatrix * offsetMatrix;
                 float colorVector[] = { drawColor.normR(), drawColor.normG(), drawColor.normB(), drawColor.normA() };
 
-                std::vector<std::vector<float>> pixelShaderConstants(1);
-                pixelShaderConstants[0] = { std::begin(colorVector), std::end(colorVector) };
-
-                std::vector<std::vector<float>> vertexShaderConstants(1);
-                vertexShaderConstants[0] = { std::begin(modelViewProj.m), std::end(modelViewProj.m) };
-
-                sharedEngine->getRenderer()->addDrawCommand({ whitePixelTexture },
-                                                            shader,
-                                                            pixelShaderConstants,
-                                                            vertexShaderConstants,
-                                                            blendState,
-                                                            frames[currentFrame].getMeshBuffer(),
-                                                            0,
-                                                            graphics::Renderer::DrawMode::TRIANGLE_LIST,
-                                                            0,
-                                                            camera->getRenderTarget(),
-                                                            camera->getRenderViewport(),
-                                                            true);
+                camera->getDrawList().addDrawCommand({ whitePixelTexture },
+                                                     shader,
+                                                     { colorVector },
+                                                     { modelViewProj.m },
+                                                     blendState,
+                                                     frames[currentFrame].getMeshBuffer(),
+                                                     0,
+                                                     graphics::Renderer::DrawMode::TRIANGLE_LIST,
+                                                     0,
+                                                     camera->getRenderTarget(),
+                                                     camera->getRenderViewport(),
+                                                     true);
             }
         }
 
@@ -284,6 +346,8 @@ namespace ouzel
                 size.v[0] = size.v[1] = 0.0f;
                 boundingBox.reset();
             }
+
+            contentChanged();
         }
     } // namespace scene
 } // namespace ouzel
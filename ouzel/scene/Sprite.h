@@ -58,6 +58,8 @@ namespace ouzel
             void updateBoundingBox();
 
             graphics::ShaderPtr shader;
+            // instancing replaces only the default texture shader
+            graphics::ShaderPtr textureShader;
             graphics::BlendStatePtr blendState;
             graphics::TexturePtr whitePixelTexture;
 
@@ -1,6 +1,7 @@
 // Copyright (C) 2016 Elviss Strazdins
 // This file is part of the Ouzel engine.
 
+#include <algorithm>
 #include <rapidjson/rapidjson.h>
 #include <rapidjson/memorystream.h>
 #include <rapidjson/document.h>
@@ -42,7 +43,14 @@ namespace ouzel
 
             const rapidjson::Value& metaObject = document["meta"];
 
-            graphics::TexturePtr texture = sharedEngine->getCache()->getTexture(metaObject["image"].GetString(), false, mipmaps);
+            // the sheet's image can be packed into a texture atlas page, the frames are then offset by its position in the page
+            Rectangle region;
+            graphics::TexturePtr texture = sharedEngine->getCache()->getTextureRegion(metaObject["image"].GetString(), mipmaps, region);
+
+            if (!texture)
+            {
+                return frames;
+            }
 
             const rapidjson::Value& framesArray = document["frames"];
 
@@ -54,8 +62,8 @@ namespace ouzel
 
                 const rapidjson::Value& frameRectangleObject = frameObject["frame"];
 
-                Rectangle frameRectangle(static_cast<float>(frameRectangleObject["x"].GetInt()),
-                                         static_cast<float>(frameRectangleObject["y"].GetInt()),
+                Rectangle frameRectangle(static_cast<float>(frameRectangleObject["x"].GetInt()) + region.position.x(),
+                                         static_cast<float>(frameRectangleObject["y"].GetInt()) + region.position.y(),
                                          static_cast<float>(frameRectangleObject["w"].GetInt()),
                                          static_cast<float>(frameRectangleObject["h"].GetInt()));
 
@@ -111,8 +119,8 @@ namespace ouzel
                                                                        -static_cast<float>(vertexObject[1].GetInt()) - finalOffset.y(),
                                                                        0.0f),
                                                                Color::WHITE,
-                                                               Vector2(static_cast<float>(vertexUVObject[0].GetInt()) / textureSize.v[0],
-                                                                       static_cast<float>(vertexUVObject[1].GetInt()) / textureSize.v[1])));
+                                                               Vector2((static_cast<float>(vertexUVObject[0].GetInt()) + region.position.x()) / textureSize.v[0],
+                                                                       (static_cast<float>(vertexUVObject[1].GetInt()) + region.position.y()) / textureSize.v[1])));
                     }
 
                     frames.push_back(SpriteFrame(texture, indices, vertices, frameRectangle, sourceSize, sourceOffset, pivot));
@@ -137,7 +145,7 @@ namespace ouzel
         {
             texture = pTexture;
 
-            std::vector<uint16_t> indices = {0, 1, 2, 1, 3, 2};
+            indices = {0, 1, 2, 1, 3, 2};
 
             Vector2 textCoords[4];
             Vector2 finalOffset(-sourceSize.v[0] * pivot.x() + sourceOffset.x(),
@@ -172,7 +180,7 @@ namespace ouzel
                 textCoords[3] = Vector2(rightBottom.x(), rightBottom.y());
             }
 
-            std::vector<graphics::VertexPCT> vertices = {
+            vertices = {
                 graphics::VertexPCT(Vector3(finalOffset.x(), finalOffset.y(), 0.0f), Color::WHITE, textCoords[0]),
                 graphics::VertexPCT(Vector3(finalOffset.x() + frameRectangle.size.v[0], finalOffset.y(), 0.0f), Color::WHITE, textCoords[1]),
                 graphics::VertexPCT(Vector3(finalOffset.x(), finalOffset.y() + frameRectangle.size.v[1], 0.0f),  Color::WHITE, textCoords[2]),
@@ -194,15 +202,18 @@ namespace ouzel
 
             meshBuffer = sharedEngine->getRenderer()->createMeshBuffer();
             meshBuffer->init(indexBuffer, vertexBuffer);
+
+            updateQuad();
         }
 
         SpriteFrame::SpriteFrame(const graphics::TexturePtr& pTexture,
-                                 const std::vector<uint16_t>& indices,
-                                 const std::vector<graphics::VertexPCT>& vertices,
+                                 const std::vector<uint16_t>& frameIndices,
+                                 const std::vector<graphics::VertexPCT>& frameVertices,
                                  const Rectangle& frameRectangle,
                                  const Size2& sourceSize,
                                  const Vector2& sourceOffset,
-                                 const Vector2& pivot)
+                                 const Vector2& pivot):
+            indices(frameIndices), vertices(frameVertices)
         {
             texture = pTexture;
 
@@ -227,7 +238,62 @@ namespace ouzel
 
             meshBuffer = sharedEngine->getRenderer()->createMeshBuffer();
             meshBuffer->init(indexBuffer, vertexBuffer);
+
+            updateQuad();
         }
 
+        void SpriteFrame::updateQuad()
+        {
+            static const uint16_t quadIndices[] = { 0, 1, 2, 1, 3, 2 };
+
+            quad = false;
+
+            if (indices.size() != 6 || vertices.size() != 4 ||
+                !std::equal(indices.begin(), indices.end(), quadIndices))
+            {
+                return;
+            }
+
+            // vertices are ordered left-bottom, right-bottom, left-top, right-top
+            const graphics::VertexPCT& leftBottom = vertices[0];
+            const graphics::VertexPCT& rightBottom = vertices[1];
+            const graphics::VertexPCT& leftTop = vertices[2];
+            const graphics::VertexPCT& rightTop = vertices[3];
+
+            if (leftBottom.position.z() != 0.0f || rightBottom.position.z() != 0.0f ||
+                leftTop.position.z() != 0.0f || rightTop.position.z() != 0.0f ||
+                leftBottom.position.x() != leftTop.position.x() || rightBottom.position.x() != rightTop.position.x() ||
+                leftBottom.position.y() != rightBottom.position.y() || leftTop.position.y() != rightTop.position.y())
+            {
+                return;
+            }
+
+            // rotated frames can't be expressed as offset and scale of the quad's texture coordinates
+            if (leftBottom.texCoord.x() != leftTop.texCoord.x() || rightBottom.texCoord.x() != rightTop.texCoord.x() ||
+                leftBottom.texCoord.y() != rightBottom.texCoord.y() || leftTop.texCoord.y() != rightTop.texCoord.y())
+            {
+                return;
+            }
+
+            for (const graphics::VertexPCT& vertex : vertices)
+            {
+                if (vertex.color.getIntValue() != Color::WHITE)
+                {
+                    return;
+                }
+            }
+
+            quadInstance.position = Vector3((leftBottom.position.x() + rightTop.position.x()) / 2.0f,
+                                            (leftBottom.position.y() + rightTop.position.y()) / 2.0f,
+                                            0.0f);
+            quadInstance.size = Vector2(rightTop.position.x() - leftBottom.position.x(),
+                                        rightTop.position.y() - leftBottom.position.y());
+            quadInstance.rotation = 0.0f;
+            quadInstance.color = Color::WHITE;
+            quadInstance.texCoordOffset = leftTop.texCoord;
+            quadInstance.texCoordScale = rightBottom.texCoord - leftTop.texCoord;
+
+            quad = true;
+        }
     } // scene
 } // ouzel
@@ -40,13 +40,29 @@ namespace ouzel
             const graphics::MeshBufferPtr& getMeshBuffer() const { return meshBuffer; }
             const graphics::TexturePtr& getTexture() const { return texture; }
 
+            const std::vector<uint16_t>& getIndices() const { return indices; }
+            const std::vector<graphics::VertexPCT>& getVertices() const { return vertices; }
+
+            // frames made of a single axis-aligned quad can be drawn as an instance of the renderer's unit quad
+            bool isQuad() const { return quad; }
+            const graphics::VertexInstance& getQuadInstance() const { return quadInstance; }
+
         protected:
+            void updateQuad();
+
             Rectangle rectangle;
             AABB2 boundingBox;
             graphics::MeshBufferPtr meshBuffer;
             graphics::IndexBufferPtr indexBuffer;
             graphics::VertexBufferPtr vertexBuffer;
             graphics::TexturePtr texture;
+
+            // CPU copies of the mesh used for batching
+            std::vector<uint16_t> indices;
+            std::vector<graphics::VertexPCT> vertices;
+
+            bool quad = false;
+            graphics::VertexInstance quadInstance;
         };
     } // scene
 } // ouzel
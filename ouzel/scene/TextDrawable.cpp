@@ -8,6 +8,7 @@
 #include "graphics/IndexBuffer.h"
 #include "graphics/VertexBuffer.h"
 #include "scene/Camera.h"
+#include "scene/Layer.h"
 #include "core/Cache.h"
 #include "utils/Utils.h"
 
@@ -76,23 +77,17 @@ namespace ouzel
             Matrix4 modelViewProj = camera->getRenderViewProjection() * transformMatrix;
             float colorVector[] = { drawColor.normR(), drawColor.normG(), drawColor.normB(), drawColor.normA() };
 
-            std::vector<std::vector<float>> pixelShaderConstants(1);
-            pixelShaderConstants[0] = { std::begin(colorVector), std::end(colorVector) };
-
-            std::vector<std::vector<float>> vertexShaderConstants(1);
-            vertexShaderConstants[0] = { std::begin(modelViewProj.m), std::end(modelViewProj.m) };
-
-            sharedEngine->getRenderer()->addDrawCommand({ texture },
-                                                        shader,
-                                                        pixelShaderConstants,
-                                                        vertexShaderConstants,
-                                                        blendState,
-                                                        meshBuffer,
-                                                        static_cast<uint32_t>(indices.size()),
-                                                        graphics::Renderer::DrawMode::TRIANGLE_LIST,
-                                                        0,
-                                                        camera->getRenderTarget(),
-                                                        camera->getRenderViewport());
+            camera->getDrawList().addDrawCommand({ texture },
+                                                 shader,
+                                                 { colorVector },
+                                                 { modelViewProj.m },
+                                                 blendState,
+                                                 meshBuffer,
+                                                 static_cast<uint32_t>(indices.size()),
+                                                 graphics::Renderer::DrawMode::TRIANGLE_LIST,
+                                                 0,
+                                                 camera->getRenderTarget(),
+                                                 camera->getRenderViewport());
         }
 
         void TextDrawable::drawWireframe(const Matrix4& transformMatrix,
@@ -104,24 +99,18 @@ namespace ouzel
             Matrix4 modelViewProj = camera->getRenderViewProjection() * transformMatrix;
             float colorVector[] = { drawColor.normR(), drawColor.normG(), drawColor.normB(), drawColor.normA() };
 
-            std::vector<std::vector<float>> pixelShaderConstants(1);
-            pixelShaderConstants[0] = { std::begin(colorVector), std::end(colorVector) };
-
-            std::vector<std::vector<float>> vertexShaderConstants(1);
-            vertexShaderConstants[0] = { std::begin(modelViewProj.m), std::end(modelViewProj.m) };
-
-            sharedEngine->getRenderer()->addDrawCommand({ whitePixelTexture },
-                                                        shader,
-                                                        pixelShaderConstants,
-                                                        vertexShaderConstants,
-                                                        blendState,
-                                                        meshBuffer,
-                                                        static_cast<uint32_t>(indices.size()),
-                                                        graphics::Renderer::DrawMode::TRIANGLE_LIST,
-                                                        0,
-                                                        camera->getRenderTarget(),
-                                                        camera->getRenderViewport(),
-                                                        true);
+            camera->getDrawList().addDrawCommand({ whitePixelTexture },
+                                                 shader,
+                                                 { colorVector },
+                                                 { modelViewProj.m },
+                                                 blendState,
+                                                 meshBuffer,
+                                                 static_cast<uint32_t>(indices.size()),
+                                                 graphics::Renderer::DrawMode::TRIANGLE_LIST,
+                                                 0,
+                                                 camera->getRenderTarget(),
+                                                 camera->getRenderViewport(),
+                                                 true);
         }
 
         void TextDrawable::setText(const std::string& newText)
@@ -142,6 +131,7 @@ namespace ouzel
         {
             font.getVertices(text, color, textAnchor, indices, vertices);
             needsMeshUpdate = true;
+            contentChanged();
 
             boundingBox.reset();
 
@@ -0,0 +1,123 @@
+// Copyright (C) 2016 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#include <algorithm>
+#include "TransformHierarchy.h"
+#include "Node.h"
+
+namespace ouzel
+{
+    namespace scene
+    {
+        TransformHierarchy::TransformHierarchy(NodeContainer* aRoot):
+            root(aRoot)
+        {
+        }
+
+        void TransformHierarchy::update()
+        {
+            if (needsRebuild)
+            {
+                rebuild();
+            }
+
+            if (dirtyIndices.empty())
+            {
+                return;
+            }
+
+            std::sort(dirtyIndices.begin(), dirtyIndices.end());
+
+            uint32_t end = 0;
+
+            for (uint32_t dirtyIndex : dirtyIndices)
+            {
+                // already recalculated together with a dirty ancestor
+                if (dirtyIndex < end)
+                {
+                    continue;
+                }
+
+                end = dirtyIndex + subtreeSizes[dirtyIndex];
+
+                // parents are always recalculated before their children
+                for (uint32_t i = dirtyIndex; i < end; ++i)
+                {
+                    if (flags[i] & LOCAL_TRANSFORM_DIRTY)
+                    {
+                        localTransforms[i] = nodes[i]->getLocalTransform();
+                    }
+
+                    uint32_t parent = parents[i];
+
+                    if (parent == NO_PARENT)
+                    {
+                        transforms[i] = localTransforms[i];
+                    }
+                    else
+                    {
+                        Matrix4::multiply(transforms[parent], localTransforms[i], transforms[i]);
+                    }
+
+                    flags[i] = static_cast<uint8_t>((flags[i] & ~LOCAL_TRANSFORM_DIRTY) | INVERSE_TRANSFORM_DIRTY);
+
+                    if (flags[i] & NOTIFY_NODE)
+                    {
+                        nodes[i]->transformChanged();
+                    }
+                }
+            }
+
+            dirtyIndices.clear();
+        }
+
+        void TransformHierarchy::rebuild()
+        {
+            // removed nodes have already detached themselves, so old entries must not be dereferenced
+            nodes.clear();
+            parents.clear();
+            subtreeSizes.clear();
+            flags.clear();
+            dirtyIndices.clear();
+
+            for (Node* node : root->getChildren())
+            {
+                addNode(node, NO_PARENT);
+            }
+
+            localTransforms.resize(nodes.size());
+            transforms.resize(nodes.size());
+            inverseTransforms.resize(nodes.size());
+
+            needsRebuild = false;
+        }
+
+        void TransformHierarchy::addNode(Node* node, uint32_t parentIndex)
+        {
+            uint32_t index = static_cast<uint32_t>(nodes.size());
+
+            nodes.push_back(node);
+            parents.push_back(parentIndex);
+            subtreeSizes.push_back(1);
+            flags.push_back(LOCAL_TRANSFORM_DIRTY | INVERSE_TRANSFORM_DIRTY | (node->transformNotifications ? NOTIFY_NODE : 0));
+
+            node->transformHierarchy = this;
+            node->transformIndex = index;
+            // the transforms cached in the node are not used until it is detached
+            node->transformDirty = node->inverseTransformDirty = false;
+
+            // a dirty root covers its whole subtree
+            if (parentIndex == NO_PARENT)
+            {
+                dirtyIndices.push_back(index);
+            }
+
+            for (Node* child : node->children)
+            {
+                addNode(child, index);
+            }
+
+            subtreeSizes[index] = static_cast<uint32_t>(nodes.size()) - index;
+        }
+    } // namespace scene
+} // namespace ouzel
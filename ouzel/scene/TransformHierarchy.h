@@ -0,0 +1,91 @@
+// Copyright (C) 2016 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "utils/Noncopyable.h"
+#include "math/Matrix4.h"
+
+namespace ouzel
+{
+    namespace scene
+    {
+        class Node;
+        class NodeContainer;
+
+        // keeps the transforms of a node tree in contiguous arrays sorted in depth-first order, so parents
+        // always come before their children and every subtree is a contiguous range of entries
+        class TransformHierarchy: public Noncopyable
+        {
+        public:
+            static const uint32_t NO_PARENT = 0xFFFFFFFF;
+
+            TransformHierarchy(NodeContainer* aRoot);
+
+            // called when nodes are added to or removed from the tree, entries are laid out again on the next update
+            void setNeedsRebuild() { needsRebuild = true; }
+
+            void setLocalTransformDirty(uint32_t index)
+            {
+                if (!(flags[index] & LOCAL_TRANSFORM_DIRTY))
+                {
+                    flags[index] |= LOCAL_TRANSFORM_DIRTY;
+                    dirtyIndices.push_back(index);
+                }
+            }
+
+            // recalculates the world transforms of all dirty subtrees
+            void update();
+
+            const Matrix4& getTransform(uint32_t index)
+            {
+                update();
+
+                return transforms[index];
+            }
+
+            const Matrix4& getInverseTransform(uint32_t index)
+            {
+                update();
+
+                if (flags[index] & INVERSE_TRANSFORM_DIRTY)
+                {
+                    inverseTransforms[index] = transforms[index];
+                    inverseTransforms[index].invert();
+                    flags[index] &= ~INVERSE_TRANSFORM_DIRTY;
+                }
+
+                return inverseTransforms[index];
+            }
+
+            uint32_t getSize() const { return static_cast<uint32_t>(nodes.size()); }
+
+        protected:
+            enum Flags: uint8_t
+            {
+                LOCAL_TRANSFORM_DIRTY = 0x01,
+                INVERSE_TRANSFORM_DIRTY = 0x02,
+                NOTIFY_NODE = 0x04
+            };
+
+            void rebuild();
+            void addNode(Node* node, uint32_t parentIndex);
+
+            NodeContainer* root;
+            bool needsRebuild = true;
+
+            std::vector<Node*> nodes;
+            std::vector<uint32_t> parents;
+            std::vector<uint32_t> subtreeSizes;
+            std::vector<uint8_t> flags;
+            std::vector<Matrix4> localTransforms;
+            std::vector<Matrix4> transforms;
+            std::vector<Matrix4> inverseTransforms;
+
+            // roots of the subtrees that have to be recalculated
+            std::vector<uint32_t> dirtyIndices;
+        };
+    } // namespace scene
+} // namespace ouzel
@@ -0,0 +1,37 @@
+// Copyright (C) 2016 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+cbuffer Constants : register(b0)
+{
+    float4x4 modelViewProj;
+}
+
+struct VSInput
+{
+    float3 position : POSITION;
+    float4 color : COLOR;
+    float2 texCoord0 : TEXCOORD0;
+    float3 instancePosition : INSTANCE_POSITION;
+    float2 instanceSize : INSTANCE_SIZE;
+    float instanceRotation : INSTANCE_ROTATION;
+    float4 instanceColor : INSTANCE_COLOR;
+    float4 instanceTexCoordRect : INSTANCE_TEXCOORD_RECT;
+};
+
+struct VS2PS
+{
+    float4 position : SV_POSITION;
+    float4 color : COLOR;
+    float2 texCoord : TEXCOORD;
+};
+
+void main(in VSInput input, out VS2PS output)
+{
+    float2 scaled = input.position.xy * input.instanceSize;
+    float s = sin(input.instanceRotation);
+    float c = cos(input.instanceRotation);
+    float2 rotated = float2(scaled.x * c - scaled.y * s, scaled.x * s + scaled.y * c);
+    output.position = mul(modelViewProj, float4(input.instancePosition + float3(rotated, input.position.z), 1));
+    output.color = input.color * input.instanceColor;
+    output.texCoord = input.instanceTexCoordRect.xy + input.texCoord0 * input.instanceTexCoordRect.zw;
+}
@@ -0,0 +1,2 @@
+# shaders that are compiled when the renderer starts, fxc output of the others is generated with compile.bat
+xxd -i TextureInstancedVS.hlsl ../../ouzel/graphics/direct3d11/TextureInstancedVSD3D11.h
@@ -0,0 +1,48 @@
+// Copyright (C) 2016 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#include <metal_stdlib>
+#include <simd/simd.h>
+
+using namespace metal;
+
+typedef struct __attribute__((__aligned__(256)))
+{
+    matrix_float4x4 modelViewProj;
+} uniforms_t;
+
+typedef struct
+{
+    float3 position [[attribute(0)]];
+    half4 color [[attribute(1)]];
+    float2 texCoords [[attribute(2)]];
+    float3 instancePosition [[attribute(3)]];
+    float2 instanceSize [[attribute(4)]];
+    float instanceRotation [[attribute(5)]];
+    half4 instanceColor [[attribute(6)]];
+    float4 instanceTexCoordRect [[attribute(7)]];
+} VertexInstancedPCT;
+
+typedef struct
+{
+    float4 position [[position]];
+    half4  color;
+    float2 texCoords;
+} ColorInOut;
+
+// Vertex shader function
+vertex ColorInOut main_vs(VertexInstancedPCT vert [[stage_in]],
+                          constant uniforms_t& uniforms [[buffer(1)]])
+{
+    ColorInOut out;
+
+    float2 scaled = vert.position.xy * vert.instanceSize;
+    float s = sin(vert.instanceRotation);
+    float c = cos(vert.instanceRotation);
+    float2 rotated = float2(scaled.x * c - scaled.y * s, scaled.x * s + scaled.y * c);
+    out.position = uniforms.modelViewProj * float4(vert.instancePosition + float3(rotated, vert.position.z), 1.0);
+
+    out.color = vert.color * vert.instanceColor;
+    out.texCoords = vert.instanceTexCoordRect.xy + vert.texCoords * vert.instanceTexCoordRect.zw;
+    return out;
+}
@@ -72,6 +72,9 @@ xxd -i ColorVSTVOS.metallib ../../ouzel/graphics/metal/ColorVSTVOS.h
 xxd -i TexturePSTVOS.metallib ../../ouzel/graphics/metal/TexturePSTVOS.h
 xxd -i TextureVSTVOS.metallib ../../ouzel/graphics/metal/TextureVSTVOS.h
 
+# compiled from source when the renderer starts
+xxd -i TextureInstancedVS.metal ../../ouzel/graphics/metal/TextureInstancedVSMetal.h
+
 rm -rf ./*.air
 rm -rf ./*.metalar
 rm -rf ./*.metallib
\ No newline at end of file
@@ -1,5 +1,8 @@
 #version 330
-uniform vec4 color;
+layout(std140) uniform PixelShaderConstants
+{
+    vec4 color;
+};
 in vec4 ex_Color;
 out vec4 out_Color;
 void main()
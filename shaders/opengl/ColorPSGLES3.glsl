@@ -1,6 +1,9 @@
 #version 300 es
 precision mediump float;
-uniform lowp vec4 color;
+layout(std140) uniform PixelShaderConstants
+{
+    lowp vec4 color;
+};
 in lowp vec4 ex_Color;
 out vec4 out_Color;
 void main()
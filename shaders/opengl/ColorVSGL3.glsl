@@ -1,7 +1,10 @@
 #version 330
 in vec3 in_Position;
 in vec4 in_Color;
-uniform mat4 modelViewProj;
+layout(std140) uniform VertexShaderConstants
+{
+    mat4 modelViewProj;
+};
 out vec4 ex_Color;
 void main()
 {
@@ -2,7 +2,10 @@
 precision highp float;
 in vec3 in_Position;
 in vec4 in_Color;
-uniform mat4 modelViewProj;
+layout(std140) uniform VertexShaderConstants
+{
+    mat4 modelViewProj;
+};
 out lowp vec4 ex_Color;
 void main()
 {
@@ -0,0 +1,26 @@
+#version 300 es
+precision highp float;
+in vec3 in_Position;
+in vec4 in_Color;
+in vec2 in_TexCoord0;
+in vec3 in_InstancePosition;
+in vec2 in_InstanceSize;
+in float in_InstanceRotation;
+in vec4 in_InstanceColor;
+in vec4 in_InstanceTexCoordRect;
+layout(std140) uniform VertexShaderConstants
+{
+    mat4 modelViewProj;
+};
+out lowp vec4 ex_Color;
+out vec2 ex_TexCoord;
+void main()
+{
+    vec2 scaled = in_Position.xy * in_InstanceSize;
+    float s = sin(in_InstanceRotation);
+    float c = cos(in_InstanceRotation);
+    vec2 rotated = vec2(scaled.x * c - scaled.y * s, scaled.x * s + scaled.y * c);
+    gl_Position = modelViewProj * vec4(in_InstancePosition + vec3(rotated, in_Position.z), 1.0);
+    ex_Color = in_Color * in_InstanceColor;
+    ex_TexCoord = in_InstanceTexCoordRect.xy + in_TexCoord0 * in_InstanceTexCoordRect.zw;
+}
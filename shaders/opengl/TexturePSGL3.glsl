@@ -1,5 +1,8 @@
 #version 330
-uniform vec4 color;
+layout(std140) uniform PixelShaderConstants
+{
+    vec4 color;
+};
 uniform sampler2D texture0;
 in vec4 ex_Color;
 in vec2 ex_TexCoord;
@@ -1,6 +1,9 @@
 #version 300 es
 precision mediump float;
-uniform lowp vec4 color;
+layout(std140) uniform PixelShaderConstants
+{
+    lowp vec4 color;
+};
 uniform lowp sampler2D texture0;
 in lowp vec4 ex_Color;
 in vec2 ex_TexCoord;
@@ -3,7 +3,10 @@ precision highp float;
 in vec3 in_Position;
 in vec4 in_Color;
 in vec2 in_TexCoord0;
-uniform mat4 modelViewProj;
+layout(std140) uniform VertexShaderConstants
+{
+    mat4 modelViewProj;
+};
 out lowp vec4 ex_Color;
 out vec2 ex_TexCoord;
 void main()
@@ -9,6 +9,7 @@ xxd -i ColorPSGL3.glsl ../../ouzel/graphics/opengl/ColorPSGL3.h
 xxd -i ColorVSGL3.glsl ../../ouzel/graphics/opengl/ColorVSGL3.h
 xxd -i TexturePSGL3.glsl ../../ouzel/graphics/opengl/TexturePSGL3.h
 xxd -i TextureVSGL3.glsl ../../ouzel/graphics/opengl/TextureVSGL3.h
+xxd -i TextureInstancedVSGL3.glsl ../../ouzel/graphics/opengl/TextureInstancedVSGL3.h
 
 # OpenGL ES 2
 xxd -i ColorPSGLES2.glsl ../../ouzel/graphics/opengl/ColorPSGLES2.h
@@ -20,4 +21,5 @@ xxd -i TextureVSGLES2.glsl ../../ouzel/graphics/opengl/TextureVSGLES2.h
 xxd -i ColorPSGLES3.glsl ../../ouzel/graphics/opengl/ColorPSGLES3.h
 xxd -i ColorVSGLES3.glsl ../../ouzel/graphics/opengl/ColorVSGLES3.h
 xxd -i TexturePSGLES3.glsl ../../ouzel/graphics/opengl/TexturePSGLES3.h
-xxd -i TextureVSGLES3.glsl ../../ouzel/graphics/opengl/TextureVSGLES3.h
\ No newline at end of file
+xxd -i TextureVSGLES3.glsl ../../ouzel/graphics/opengl/TextureVSGLES3.h
+xxd -i TextureInstancedVSGLES3.glsl ../../ouzel/graphics/opengl/TextureInstancedVSGLES3.h
\ No newline at end of file
@@ -0,0 +1,151 @@
+// Copyright (C) 2016 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include "Benchmarks.h"
+
+static const uint32_t SPRITE_COUNT = 5000;
+static const uint32_t SHAPE_COUNT = 500;
+static const uint32_t TEXT_COUNT = 200;
+static const uint32_t PARTICLE_SYSTEM_COUNT = 50;
+static const uint32_t NODE_COUNT = SPRITE_COUNT + SHAPE_COUNT + TEXT_COUNT + PARTICLE_SYSTEM_COUNT;
+// more than one layer, so that Scene::draw records the layers on the job system
+static const uint32_t LAYER_COUNT = 2;
+// enough for all renderer ring buffers, draw queues and the double buffered particle vertices to reach their final capacity
+static const uint32_t WARMUP_FRAMES = 20;
+static const uint32_t FRAME_COUNT = 100;
+
+int checkAllocations()
+{
+    ouzel::graphics::TexturePtr texture = createTestTexture(64);
+
+    if (!texture)
+    {
+        return EXIT_FAILURE;
+    }
+
+    std::vector<ouzel::scene::SpriteFrame> spriteFrames = createTestSpriteFrames(texture);
+
+    // the font of the samples, its page and the particles use the test texture, so no image has to be decoded
+    ouzel::sharedApplication->getFileSystem()->addResourcePath("../../samples/Resources");
+    ouzel::sharedEngine->getCache()->setTexture("arial.png", texture);
+    ouzel::sharedEngine->getCache()->setTexture("particle.png", texture);
+
+    // particles are emitted and die every frame, the short fixed lifespan makes the particle count periodic before the warmup ends
+    ouzel::scene::ParticleDefinition particleDefinition;
+    particleDefinition.emissionRate = 1000.0f;
+    particleDefinition.particleLifespan = 0.1f;
+    particleDefinition.textureFilename = "particle.png";
+
+    ouzel::scene::Scene scene;
+    ouzel::scene::Layer layers[LAYER_COUNT];
+    ouzel::scene::Camera cameras[LAYER_COUNT];
+
+    for (uint32_t i = 0; i < LAYER_COUNT; ++i)
+    {
+        layers[i].addCamera(&cameras[i]);
+        layers[i].setOrder(static_cast<int32_t>(i));
+        scene.addLayer(&layers[i]);
+    }
+
+    std::vector<std::unique_ptr<ouzel::scene::Node>> nodes;
+    std::vector<std::unique_ptr<ouzel::scene::Component>> components;
+    std::vector<ouzel::scene::ParticleSystem*> particleSystems;
+
+    const ouzel::Size2& size = ouzel::sharedEngine->getRenderer()->getSize();
+
+    for (uint32_t i = 0; i < NODE_COUNT; ++i)
+    {
+        ouzel::scene::Node* node = new ouzel::scene::Node();
+        nodes.push_back(std::unique_ptr<ouzel::scene::Node>(node));
+
+        node->setPosition(ouzel::Vector2(static_cast<float>(i % 100) / 100.0f * size.width() - size.width() / 2.0f,
+                                         static_cast<float>(i / 100) / (NODE_COUNT / 100.0f) * size.height() - size.height() / 2.0f));
+        node->setOrder(static_cast<int32_t>(i % 7));
+
+        if (i < SPRITE_COUNT)
+        {
+            ouzel::scene::Sprite* sprite = new ouzel::scene::Sprite(spriteFrames);
+            components.push_back(std::unique_ptr<ouzel::scene::Component>(sprite));
+            node->addComponent(sprite);
+        }
+        else if (i < SPRITE_COUNT + SHAPE_COUNT)
+        {
+            ouzel::scene::ShapeDrawable* shape = new ouzel::scene::ShapeDrawable();
+            shape->rectangle(ouzel::Rectangle(0.0f, 0.0f, 16.0f, 16.0f), ouzel::Color::RED, true);
+            shape->circle(ouzel::Vector2(), 8.0f, ouzel::Color::BLUE, false);
+            components.push_back(std::unique_ptr<ouzel::scene::Component>(shape));
+            node->addComponent(shape);
+        }
+        else if (i < SPRITE_COUNT + SHAPE_COUNT + TEXT_COUNT)
+        {
+            ouzel::scene::TextDrawable* text = new ouzel::scene::TextDrawable("arial.fnt", false, "Allocations " + std::to_string(i));
+            components.push_back(std::unique_ptr<ouzel::scene::Component>(text));
+            node->addComponent(text);
+        }
+        else
+        {
+            ouzel::scene::ParticleSystem* particleSystem = new ouzel::scene::ParticleSystem();
+
+            if (!particleSystem->initFromParticleDefinition(particleDefinition))
+            {
+                delete particleSystem;
+                return EXIT_FAILURE;
+            }
+
+            components.push_back(std::unique_ptr<ouzel::scene::Component>(particleSystem));
+            particleSystems.push_back(particleSystem);
+            node->addComponent(particleSystem);
+        }
+
+        layers[i % LAYER_COUNT].addChild(node);
+    }
+
+    ouzel::sharedEngine->getSceneManager()->setScene(&scene);
+
+    uint64_t maxFrameAllocations = 0;
+
+    for (uint32_t frame = 0; frame < WARMUP_FRAMES + FRAME_COUNT; ++frame)
+    {
+        // keep transforms and the draw list changing, static content would hide allocations on those paths
+        for (uint32_t i = 0; i < nodes.size(); i += 10)
+        {
+            nodes[i]->setRotation(static_cast<float>(frame) * 0.01f);
+        }
+
+        startCountingAllocations();
+
+        // the update loop of the engine doesn't run in the benchmarks, so the particles are advanced here
+        for (ouzel::scene::ParticleSystem* particleSystem : particleSystems)
+        {
+            particleSystem->update(1.0f / 60.0f);
+        }
+
+        updateFrame();
+        uint64_t allocationCount = stopCountingAllocations();
+
+        if (frame >= WARMUP_FRAMES && allocationCount > maxFrameAllocations)
+        {
+            maxFrameAllocations = allocationCount;
+        }
+
+        if (!presentFrame())
+        {
+            return EXIT_FAILURE;
+        }
+    }
+
+    ouzel::Log(ouzel::Log::Level::INFO) << "allocations: " << SPRITE_COUNT << " sprites, " << SHAPE_COUNT << " shapes, " <<
+        TEXT_COUNT << " texts, " << PARTICLE_SYSTEM_COUNT << " particle systems in " << LAYER_COUNT << " layers, " <<
+        maxFrameAllocations << " heap allocations in the worst of " << FRAME_COUNT << " frames";
+
+    if (maxFrameAllocations > 0)
+    {
+        ouzel::Log(ouzel::Log::Level::ERR) << "Update thread allocated memory while drawing";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,54 @@
+// Copyright (C) 2016 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include "Benchmarks.h"
+
+static std::atomic<bool> countAllocations(false);
+static std::atomic<uint64_t> allocationCount(0);
+
+// array new and delete forward to these by default
+void* operator new(std::size_t size)
+{
+    if (countAllocations) ++allocationCount;
+
+    if (void* result = std::malloc(size ? size : 1))
+    {
+        return result;
+    }
+
+    throw std::bad_alloc();
+}
+
+// used by std::stable_sort for its temporary buffer
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    if (countAllocations) ++allocationCount;
+
+    return std::malloc(size ? size : 1);
+}
+
+void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept
+{
+    std::free(pointer);
+}
+
+void startCountingAllocations()
+{
+    allocationCount = 0;
+    countAllocations = true;
+}
+
+uint64_t stopCountingAllocations()
+{
+    countAllocations = false;
+
+    return allocationCount;
+}
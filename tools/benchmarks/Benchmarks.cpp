@@ -0,0 +1,55 @@
+// Copyright (C) 2016 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#include "Benchmarks.h"
+
+ouzel::graphics::TexturePtr createTestTexture(uint32_t size)
+{
+    std::vector<uint8_t> data(size * size * 4);
+
+    for (uint32_t y = 0; y < size; ++y)
+    {
+        for (uint32_t x = 0; x < size; ++x)
+        {
+            uint8_t value = (((x / 8) + (y / 8)) % 2) ? 255 : 64;
+            uint8_t* pixel = &data[(y * size + x) * 4];
+
+            pixel[0] = value;
+            pixel[1] = value;
+            pixel[2] = value;
+            pixel[3] = 255;
+        }
+    }
+
+    ouzel::graphics::TexturePtr texture = ouzel::sharedEngine->getRenderer()->createTexture();
+
+    if (!texture->initFromBuffer(data, ouzel::Size2(static_cast<float>(size), static_cast<float>(size)), false, false))
+    {
+        return nullptr;
+    }
+
+    return texture;
+}
+
+std::vector<ouzel::scene::SpriteFrame> createTestSpriteFrames(const ouzel::graphics::TexturePtr& texture)
+{
+    const ouzel::Size2& size = texture->getSize();
+
+    return {ouzel::scene::SpriteFrame(texture,
+                                      ouzel::Rectangle(0.0f, 0.0f, size.width(), size.height()),
+                                      false,
+                                      size,
+                                      ouzel::Vector2(),
+                                      ouzel::Vector2(0.5f, 0.5f))};
+}
+
+void updateFrame()
+{
+    ouzel::sharedEngine->getSceneManager()->draw();
+    ouzel::sharedEngine->getRenderer()->flushDrawCommands();
+}
+
+bool presentFrame()
+{
+    return ouzel::sharedEngine->getRenderer()->present();
+}
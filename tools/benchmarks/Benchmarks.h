@@ -0,0 +1,35 @@
+// Copyright (C) 2016 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include "ouzel.h"
+
+// generates a checkerboard texture, so that benchmarks don't depend on resource files
+ouzel::graphics::TexturePtr createTestTexture(uint32_t size);
+std::vector<ouzel::scene::SpriteFrame> createTestSpriteFrames(const ouzel::graphics::TexturePtr& texture);
+
+// runs the update thread part of a frame (scene traversal and command recording) on the calling thread
+void updateFrame();
+// hands the recorded frame over to the renderer, as the main thread does after the update thread
+bool presentFrame();
+
+inline double getMilliseconds(const std::chrono::steady_clock::time_point& start)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count() / 1000.0;
+}
+
+// the global operator new is replaced to count the heap allocations of all threads between these calls
+void startCountingAllocations();
+uint64_t stopCountingAllocations();
+
+// every benchmark returns EXIT_SUCCESS or EXIT_FAILURE
+int checkAllocations();
+int measureVisit();
+int measureLayers();
+int measureMipmaps();
+int measureTransforms();
+int measureCulling();
@@ -0,0 +1,169 @@
+// Copyright (C) 2016 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#include <cstdlib>
+#include <memory>
+#include "Benchmarks.h"
+
+// exposes the traversal of Layer::recordDrawList without recording draw commands
+class CullingLayer: public ouzel::scene::Layer
+{
+public:
+    void visit(ouzel::scene::Camera* camera)
+    {
+        drawQueue.clear();
+
+        for (ouzel::scene::Node* child : children)
+        {
+            child->visit(drawQueue, ouzel::Matrix4::IDENTITY, false, camera, 0);
+        }
+    }
+
+    const std::vector<ouzel::scene::Node*>& getDrawQueue() const { return drawQueue; }
+};
+
+static const uint32_t GROUP_COUNT = 500;
+static const uint32_t SPRITES_PER_GROUP = 10;
+static const uint32_t ITERATIONS = 50;
+
+static float getRandom(uint32_t& random, float range)
+{
+    random = random * 1103515245 + 12345;
+    return (static_cast<float>((random >> 8) % 10001) / 5000.0f - 1.0f) * range;
+}
+
+// a box is outside of the frustum if all of its corners are outside of the same clip plane
+static bool isVisible(const ouzel::Matrix4& viewProjection, const ouzel::Matrix4& transform, const ouzel::AABB3& box)
+{
+    ouzel::Matrix4 matrix = viewProjection * transform;
+    uint32_t outside[6] = {0, 0, 0, 0, 0, 0};
+
+    for (uint32_t i = 0; i < 8; ++i)
+    {
+        ouzel::Vector4 corner((i & 1) ? box.max.v[0] : box.min.v[0],
+                              (i & 2) ? box.max.v[1] : box.min.v[1],
+                              (i & 4) ? box.max.v[2] : box.min.v[2],
+                              1.0f);
+        matrix.transformVector(corner);
+
+        if (corner.v[0] < -corner.v[3]) ++outside[0];
+        if (corner.v[0] > corner.v[3]) ++outside[1];
+        if (corner.v[1] < -corner.v[3]) ++outside[2];
+        if (corner.v[1] > corner.v[3]) ++outside[3];
+        if (corner.v[2] < 0.0f) ++outside[4];
+        if (corner.v[2] > corner.v[3]) ++outside[5];
+    }
+
+    for (uint32_t count : outside)
+    {
+        if (count == 8)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int measureCulling()
+{
+    ouzel::graphics::TexturePtr texture = createTestTexture(64);
+
+    if (!texture)
+    {
+        return EXIT_FAILURE;
+    }
+
+    std::vector<ouzel::scene::SpriteFrame> spriteFrames = createTestSpriteFrames(texture);
+
+    // the camera setup of the perspective sample
+    ouzel::scene::Scene scene;
+    CullingLayer layer;
+    ouzel::scene::Camera camera;
+    camera.setType(ouzel::scene::Camera::Type::PERSPECTIVE);
+    camera.setFarPlane(1000.0f);
+    camera.setPosition(ouzel::Vector3(0.0f, 0.0f, -400.0f));
+    layer.addCamera(&camera);
+    scene.addLayer(&layer);
+
+    std::vector<std::unique_ptr<ouzel::scene::Node>> nodes;
+    std::vector<std::unique_ptr<ouzel::scene::Sprite>> sprites;
+    std::vector<ouzel::scene::Node*> spriteNodes;
+    uint32_t random = 1;
+
+    // groups without components spread in front of, behind and around the camera, their sprites are turned around
+    // the vertical axis and spread in depth, so only the merged depth of the children keeps a group from being culled
+    for (uint32_t i = 0; i < GROUP_COUNT; ++i)
+    {
+        ouzel::scene::Node* group = new ouzel::scene::Node();
+        nodes.push_back(std::unique_ptr<ouzel::scene::Node>(group));
+        group->setPosition(ouzel::Vector3(getRandom(random, 1200.0f), getRandom(random, 600.0f), getRandom(random, 1200.0f)));
+        layer.addChild(group);
+
+        for (uint32_t j = 0; j < SPRITES_PER_GROUP; ++j)
+        {
+            ouzel::scene::Node* node = new ouzel::scene::Node();
+            nodes.push_back(std::unique_ptr<ouzel::scene::Node>(node));
+
+            ouzel::scene::Sprite* sprite = new ouzel::scene::Sprite(spriteFrames);
+            sprites.push_back(std::unique_ptr<ouzel::scene::Sprite>(sprite));
+            node->addComponent(sprite);
+
+            node->setPosition(ouzel::Vector3(getRandom(random, 50.0f), getRandom(random, 20.0f), getRandom(random, 300.0f)));
+            node->setRotation(ouzel::Vector3(0.0f, getRandom(random, ouzel::TAU_2), 0.0f));
+            group->addChild(node);
+            spriteNodes.push_back(node);
+        }
+    }
+
+    ouzel::sharedEngine->getSceneManager()->setScene(&scene);
+
+    // enters the scene and calculates the camera projection and all transforms
+    updateFrame();
+
+    if (!presentFrame())
+    {
+        return EXIT_FAILURE;
+    }
+
+    double visitTime = 0.0;
+
+    for (uint32_t i = 0; i < ITERATIONS; ++i)
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        layer.visit(&camera);
+        visitTime += getMilliseconds(start);
+    }
+
+    uint32_t expectedCount = 0;
+
+    for (ouzel::scene::Node* node : spriteNodes)
+    {
+        if (isVisible(camera.getViewProjection(), node->getTransform(), node->getBoundingBox3D()))
+        {
+            ++expectedCount;
+        }
+    }
+
+    uint32_t nodeCount = static_cast<uint32_t>(spriteNodes.size());
+    uint32_t visibleCount = static_cast<uint32_t>(layer.getDrawQueue().size());
+
+    // the frustum test and the subtree boxes must neither cull visible sprites nor keep invisible ones
+    if (visibleCount != expectedCount)
+    {
+        ouzel::Log(ouzel::Log::Level::ERR) << "Perspective camera kept " << visibleCount << " of " << nodeCount <<
+            " sprites, but " << expectedCount << " are inside of the frustum";
+        return EXIT_FAILURE;
+    }
+
+    if (expectedCount == 0 || expectedCount == nodeCount)
+    {
+        ouzel::Log(ouzel::Log::Level::ERR) << "Culling scene has " << expectedCount << " of " << nodeCount << " sprites in the frustum";
+        return EXIT_FAILURE;
+    }
+
+    ouzel::Log(ouzel::Log::Level::INFO) << "culling: " << nodeCount << " sprites, " << nodeCount - visibleCount << " culled, " <<
+        visibleCount << " visible, " << visitTime / ITERATIONS << " ms visit";
+
+    return EXIT_SUCCESS;
+}
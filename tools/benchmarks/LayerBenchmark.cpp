@@ -0,0 +1,205 @@
+// Copyright (C) 2016 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#include <cstdlib>
+#include <memory>
+#include "Benchmarks.h"
+
+// overrides both drawing hooks, the recording hook adds a triangle to the draw list of the layer and
+// draw adds one through the renderer after the layer has been submitted, like layers written before draw lists did
+class CustomLayer: public ouzel::scene::Layer
+{
+public:
+    CustomLayer(const ouzel::graphics::MeshBufferPtr& aMeshBuffer):
+        meshBuffer(aMeshBuffer)
+    {
+    }
+
+    virtual void draw() override
+    {
+        ++drawCount;
+
+        Layer::draw();
+
+        float colorVector[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+
+        ouzel::sharedEngine->getRenderer()->addDrawCommand({ },
+                                                           ouzel::sharedEngine->getCache()->getShader(ouzel::graphics::SHADER_COLOR),
+                                                           { colorVector },
+                                                           { ouzel::Matrix4::IDENTITY.m },
+                                                           ouzel::sharedEngine->getCache()->getBlendState(ouzel::graphics::BLEND_ALPHA),
+                                                           meshBuffer);
+    }
+
+    uint32_t getDrawCount() const { return drawCount; }
+    uint32_t getRecordCount() const { return recordCount; }
+
+protected:
+    virtual void recordDrawList() override
+    {
+        ++recordCount;
+
+        Layer::recordDrawList();
+
+        float colorVector[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+
+        drawList.addDrawCommand({ },
+                                ouzel::sharedEngine->getCache()->getShader(ouzel::graphics::SHADER_COLOR),
+                                { colorVector },
+                                { ouzel::Matrix4::IDENTITY.m },
+                                ouzel::sharedEngine->getCache()->getBlendState(ouzel::graphics::BLEND_ALPHA),
+                                meshBuffer);
+    }
+
+    ouzel::graphics::MeshBufferPtr meshBuffer;
+    uint32_t drawCount = 0;
+    uint32_t recordCount = 0;
+};
+
+static const uint32_t LAYER_COUNT = 8;
+static const uint32_t SPRITES_PER_LAYER = 2500;
+static const uint32_t FRAME_COUNT = 50;
+
+static ouzel::graphics::MeshBufferPtr createTriangle()
+{
+    ouzel::graphics::Renderer* renderer = ouzel::sharedEngine->getRenderer();
+
+    const uint16_t indices[] = { 0, 1, 2 };
+    const ouzel::graphics::VertexPC vertices[] = {
+        ouzel::graphics::VertexPC(ouzel::Vector3(0.0f, 0.0f, 0.0f), ouzel::Color::WHITE),
+        ouzel::graphics::VertexPC(ouzel::Vector3(1.0f, 0.0f, 0.0f), ouzel::Color::WHITE),
+        ouzel::graphics::VertexPC(ouzel::Vector3(0.0f, 1.0f, 0.0f), ouzel::Color::WHITE)
+    };
+
+    ouzel::graphics::IndexBufferPtr indexBuffer = renderer->createIndexBuffer();
+    ouzel::graphics::VertexBufferPtr vertexBuffer = renderer->createVertexBuffer();
+    ouzel::graphics::MeshBufferPtr meshBuffer = renderer->createMeshBuffer();
+
+    if (!indexBuffer->initFromBuffer(indices, sizeof(uint16_t), 3, false) ||
+        !vertexBuffer->initFromBuffer(vertices, ouzel::graphics::VertexPC::ATTRIBUTES, 3, false) ||
+        !meshBuffer->init(indexBuffer, vertexBuffer))
+    {
+        return nullptr;
+    }
+
+    return meshBuffer;
+}
+
+int measureLayers()
+{
+    ouzel::graphics::TexturePtr texture = createTestTexture(16);
+    ouzel::graphics::MeshBufferPtr triangle = createTriangle();
+
+    if (!texture || !triangle)
+    {
+        return EXIT_FAILURE;
+    }
+
+    std::vector<ouzel::scene::SpriteFrame> spriteFrames = createTestSpriteFrames(texture);
+
+    ouzel::scene::Scene scene;
+    std::vector<std::unique_ptr<CustomLayer>> layers;
+    std::vector<std::unique_ptr<ouzel::scene::Camera>> cameras;
+    std::vector<std::unique_ptr<ouzel::scene::Node>> nodes;
+    std::vector<std::unique_ptr<ouzel::scene::Sprite>> sprites;
+
+    const ouzel::Size2& size = ouzel::sharedEngine->getRenderer()->getSize();
+
+    for (uint32_t i = 0; i < LAYER_COUNT; ++i)
+    {
+        CustomLayer* layer = new CustomLayer(triangle);
+        layers.push_back(std::unique_ptr<CustomLayer>(layer));
+
+        ouzel::scene::Camera* camera = new ouzel::scene::Camera();
+        cameras.push_back(std::unique_ptr<ouzel::scene::Camera>(camera));
+        layer->addCamera(camera);
+        layer->setOrder(static_cast<int32_t>(i));
+
+        for (uint32_t j = 0; j < SPRITES_PER_LAYER; ++j)
+        {
+            ouzel::scene::Node* node = new ouzel::scene::Node();
+            nodes.push_back(std::unique_ptr<ouzel::scene::Node>(node));
+
+            ouzel::scene::Sprite* sprite = new ouzel::scene::Sprite(spriteFrames);
+            sprites.push_back(std::unique_ptr<ouzel::scene::Sprite>(sprite));
+            node->addComponent(sprite);
+
+            node->setPosition(ouzel::Vector2(static_cast<float>(j % 50) / 50.0f * size.width() - size.width() / 2.0f,
+                                             static_cast<float>(j / 50) / 50.0f * size.height() - size.height() / 2.0f));
+            node->setOrder(static_cast<int32_t>(j % 5));
+            layer->addChild(node);
+        }
+
+        scene.addLayer(layer);
+    }
+
+    ouzel::sharedEngine->getSceneManager()->setScene(&scene);
+
+    ouzel::graphics::Renderer* renderer = ouzel::sharedEngine->getRenderer();
+
+    // the same frames recorded layer by layer on this thread
+    double serialTime = 0.0;
+    std::vector<uint32_t> serialCommandCounts;
+
+    for (uint32_t frame = 0; frame < FRAME_COUNT; ++frame)
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        for (const std::unique_ptr<CustomLayer>& layer : layers)
+        {
+            layer->draw();
+        }
+
+        renderer->flushDrawCommands();
+        serialTime += getMilliseconds(start);
+
+        if (!presentFrame())
+        {
+            return EXIT_FAILURE;
+        }
+    }
+
+    for (const std::unique_ptr<CustomLayer>& layer : layers)
+    {
+        serialCommandCounts.push_back(layer->getDrawList().getDrawCommandCount());
+    }
+
+    double parallelTime = 0.0;
+
+    for (uint32_t frame = 0; frame < FRAME_COUNT; ++frame)
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        updateFrame();
+        parallelTime += getMilliseconds(start);
+
+        if (!presentFrame())
+        {
+            return EXIT_FAILURE;
+        }
+    }
+
+    for (uint32_t i = 0; i < LAYER_COUNT; ++i)
+    {
+        CustomLayer* layer = layers[i].get();
+
+        if (layer->getDrawCount() != 2 * FRAME_COUNT || layer->getRecordCount() != 2 * FRAME_COUNT)
+        {
+            ouzel::Log(ouzel::Log::Level::ERR) << "Layer " << i << " was drawn " << layer->getDrawCount() << " times and recorded " <<
+                layer->getRecordCount() << " times instead of " << 2 * FRAME_COUNT;
+            return EXIT_FAILURE;
+        }
+
+        if (layer->getDrawList().getDrawCommandCount() != serialCommandCounts[i])
+        {
+            ouzel::Log(ouzel::Log::Level::ERR) << "Layer " << i << " recorded " << layer->getDrawList().getDrawCommandCount() <<
+                " draw commands in parallel and " << serialCommandCounts[i] << " serially";
+            return EXIT_FAILURE;
+        }
+    }
+
+    ouzel::Log(ouzel::Log::Level::INFO) << "layers: " << LAYER_COUNT << " layers of " << SPRITES_PER_LAYER << " sprites, " <<
+        serialTime / FRAME_COUNT << " ms serial, " << parallelTime / FRAME_COUNT << " ms parallel with " <<
+        ouzel::sharedEngine->getJobSystem()->getWorkerCount() << " workers";
+
+    return EXIT_SUCCESS;
+}
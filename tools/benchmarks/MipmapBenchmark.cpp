@@ -0,0 +1,146 @@
+// Copyright (C) 2016 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include "Benchmarks.h"
+
+// gives access to the mip chain generation of the engine
+class MipmapTexture: public ouzel::graphics::Texture
+{
+public:
+    using Texture::Level;
+    using Texture::calculateLevels;
+};
+
+static const uint32_t TEXTURE_SIZES[] = {256, 512, 1024, 2048, 4096};
+
+// the powf based 2x2 box filter the lookup tables replaced, it is the reference for the generated levels,
+// the last column and row are repeated for levels that are one pixel wide or high
+static void referenceDownsample(uint32_t width, uint32_t height, const std::vector<uint8_t>& src,
+                                uint32_t dstWidth, uint32_t dstHeight, std::vector<uint8_t>& dst)
+{
+    dst.resize(dstWidth * dstHeight * 4);
+
+    for (uint32_t y = 0; y < dstHeight; ++y)
+    {
+        for (uint32_t x = 0; x < dstWidth; ++x)
+        {
+            uint32_t x0 = x * 2;
+            uint32_t x1 = std::min(x * 2 + 1, width - 1);
+            uint32_t y0 = y * 2;
+            uint32_t y1 = std::min(y * 2 + 1, height - 1);
+
+            const uint8_t* pixels[] = {
+                &src[(y0 * width + x0) * 4],
+                &src[(y0 * width + x1) * 4],
+                &src[(y1 * width + x0) * 4],
+                &src[(y1 * width + x1) * 4]
+            };
+
+            float count = 0.0f;
+            float r = 0.0f, g = 0.0f, b = 0.0f, a = 0.0f;
+
+            for (const uint8_t* pixel : pixels)
+            {
+                if (pixel[3] > 0)
+                {
+                    r += powf(pixel[0], 2.2f);
+                    g += powf(pixel[1], 2.2f);
+                    b += powf(pixel[2], 2.2f);
+                    count += 1.0f;
+                }
+                a += pixel[3];
+            }
+
+            if (count > 0.0f)
+            {
+                r /= count;
+                g /= count;
+                b /= count;
+            }
+
+            a *= 0.25f;
+
+            uint8_t* result = &dst[(y * dstWidth + x) * 4];
+            result[0] = static_cast<uint8_t>(powf(r, 1.0f / 2.2f));
+            result[1] = static_cast<uint8_t>(powf(g, 1.0f / 2.2f));
+            result[2] = static_cast<uint8_t>(powf(b, 1.0f / 2.2f));
+            result[3] = static_cast<uint8_t>(a);
+        }
+    }
+}
+
+static bool measure(uint32_t size)
+{
+    // random colors, a quarter of the pixels is fully transparent, so that their color is ignored
+    std::vector<uint8_t> data(size * size * 4);
+    uint32_t random = size;
+
+    for (uint8_t& value : data)
+    {
+        random = random * 1103515245 + 12345;
+        value = static_cast<uint8_t>(random >> 16);
+    }
+
+    for (size_t i = 3; i < data.size(); i += 16)
+    {
+        data[i] = 0;
+    }
+
+    std::vector<MipmapTexture::Level> levels;
+    std::vector<uint8_t> levelData;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    MipmapTexture::calculateLevels(data, ouzel::Size2(static_cast<float>(size), static_cast<float>(size)), true, levels, levelData);
+    double time = getMilliseconds(start);
+
+    std::vector<uint8_t> source = data;
+    std::vector<uint8_t> expected;
+    uint32_t width = size;
+    uint32_t height = size;
+
+    start = std::chrono::steady_clock::now();
+
+    for (size_t level = 1; level < levels.size(); ++level)
+    {
+        uint32_t dstWidth = (width >= 2) ? width / 2 : 1;
+        uint32_t dstHeight = (height >= 2) ? height / 2 : 1;
+
+        referenceDownsample(width, height, source, dstWidth, dstHeight, expected);
+
+        if (static_cast<uint32_t>(levels[level].size.width()) != dstWidth ||
+            static_cast<uint32_t>(levels[level].size.height()) != dstHeight ||
+            !std::equal(expected.begin(), expected.end(), levelData.begin() + levels[level].offset))
+        {
+            ouzel::Log(ouzel::Log::Level::ERR) << "Level " << static_cast<uint32_t>(level) << " of a " << size << "x" << size <<
+                " texture doesn't match the reference";
+            return false;
+        }
+
+        source.swap(expected);
+        width = dstWidth;
+        height = dstHeight;
+    }
+
+    double referenceTime = getMilliseconds(start);
+
+    ouzel::Log(ouzel::Log::Level::INFO) << "mipmaps: " << size << "x" << size << ", " << static_cast<uint32_t>(levels.size()) << " levels, " <<
+        time << " ms, " << referenceTime << " ms with powf, output identical";
+
+    return true;
+}
+
+int measureMipmaps()
+{
+    for (uint32_t size : TEXTURE_SIZES)
+    {
+        if (!measure(size))
+        {
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
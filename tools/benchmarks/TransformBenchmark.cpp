@@ -0,0 +1,145 @@
+// Copyright (C) 2016 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include "Benchmarks.h"
+
+// exposes the transform update and the traversal of Layer::recordDrawList without recording draw commands
+class TransformLayer: public ouzel::scene::Layer
+{
+public:
+    void updateTransforms()
+    {
+        if (transformHierarchyEnabled)
+        {
+            transformHierarchy.update();
+        }
+    }
+
+    void visit(ouzel::scene::Camera* camera)
+    {
+        drawQueue.clear();
+
+        for (ouzel::scene::Node* child : children)
+        {
+            child->visit(drawQueue, ouzel::Matrix4::IDENTITY, false, camera, 0);
+        }
+    }
+};
+
+static const uint32_t NODE_COUNT = 100000;
+static const uint32_t NODES_PER_TREE = 1000;
+static const uint32_t MOVING_NODE_COUNT = NODE_COUNT / 100;
+static const uint32_t FRAME_COUNT = 50;
+
+struct TransformTree
+{
+    TransformLayer layer;
+    ouzel::scene::Camera camera;
+    std::vector<std::unique_ptr<ouzel::scene::Node>> nodes;
+    double updateTime = 0.0;
+    double visitTime = 0.0;
+};
+
+// random deep trees, every node is attached to a random earlier node of its tree,
+// the nodes have no components, so the traversal only brings the transforms up to date
+static void createTree(TransformTree& tree, bool transformHierarchy)
+{
+    tree.layer.addCamera(&tree.camera);
+    tree.layer.setTransformHierarchyEnabled(transformHierarchy);
+
+    uint32_t random = 1;
+
+    for (uint32_t i = 0; i < NODE_COUNT; ++i)
+    {
+        ouzel::scene::Node* node = new ouzel::scene::Node();
+        tree.nodes.push_back(std::unique_ptr<ouzel::scene::Node>(node));
+
+        random = random * 1103515245 + 12345;
+        node->setPosition(ouzel::Vector2(static_cast<float>((random >> 16) % 64), static_cast<float>((random >> 8) % 64)));
+        node->setRotation(static_cast<float>((random >> 4) % 360) * ouzel::TAU / 360.0f);
+
+        uint32_t treeStart = i - i % NODES_PER_TREE;
+
+        if (i == treeStart)
+        {
+            tree.layer.addChild(node);
+        }
+        else
+        {
+            tree.nodes[treeStart + (random >> 16) % (i - treeStart)]->addChild(node);
+        }
+    }
+}
+
+static void measureFrame(TransformTree& tree)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    tree.layer.updateTransforms();
+    tree.updateTime += getMilliseconds(start);
+
+    start = std::chrono::steady_clock::now();
+    tree.layer.visit(&tree.camera);
+    tree.visitTime += getMilliseconds(start);
+}
+
+int measureTransforms()
+{
+    // the same trees with per node transforms and with the transform hierarchy
+    ouzel::scene::Scene scene;
+    TransformTree nodeTree;
+    TransformTree hierarchyTree;
+
+    createTree(nodeTree, false);
+    createTree(hierarchyTree, true);
+
+    scene.addLayer(&nodeTree.layer);
+    scene.addLayer(&hierarchyTree.layer);
+    ouzel::sharedEngine->getSceneManager()->setScene(&scene);
+
+    // enters the scene and calculates all transforms
+    updateFrame();
+
+    if (!presentFrame())
+    {
+        return EXIT_FAILURE;
+    }
+
+    uint32_t random = 1;
+
+    for (uint32_t frame = 0; frame < FRAME_COUNT; ++frame)
+    {
+        for (uint32_t i = 0; i < MOVING_NODE_COUNT; ++i)
+        {
+            random = random * 1103515245 + 12345;
+            uint32_t index = (random >> 8) % NODE_COUNT;
+            ouzel::Vector2 position(static_cast<float>((random >> 16) % 64), static_cast<float>(frame));
+
+            nodeTree.nodes[index]->setPosition(position);
+            hierarchyTree.nodes[index]->setPosition(position);
+        }
+
+        measureFrame(nodeTree);
+        measureFrame(hierarchyTree);
+    }
+
+    for (uint32_t i = 0; i < NODE_COUNT; ++i)
+    {
+        const ouzel::Matrix4& expected = nodeTree.nodes[i]->getTransform();
+        const ouzel::Matrix4& transform = hierarchyTree.nodes[i]->getTransform();
+
+        if (!std::equal(expected.m, expected.m + 16, transform.m))
+        {
+            ouzel::Log(ouzel::Log::Level::ERR) << "Transform of node " << i << " in the transform hierarchy doesn't match the per node transform";
+            return EXIT_FAILURE;
+        }
+    }
+
+    ouzel::Log(ouzel::Log::Level::INFO) << "transforms: " << NODE_COUNT << " nodes, " << MOVING_NODE_COUNT << " moving, " <<
+        nodeTree.visitTime / FRAME_COUNT << " ms per node, " <<
+        hierarchyTree.updateTime / FRAME_COUNT << " ms hierarchy update + " << hierarchyTree.visitTime / FRAME_COUNT << " ms visit";
+
+    return EXIT_SUCCESS;
+}
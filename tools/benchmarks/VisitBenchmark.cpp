@@ -0,0 +1,140 @@
+// Copyright (C) 2016 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include "Benchmarks.h"
+
+// exposes the traversal and sorting steps of Layer::recordDrawList without recording draw commands
+class VisitLayer: public ouzel::scene::Layer
+{
+public:
+    void visit(ouzel::scene::Camera* camera)
+    {
+        drawQueue.clear();
+
+        for (ouzel::scene::Node* child : children)
+        {
+            child->visit(drawQueue, ouzel::Matrix4::IDENTITY, false, camera, 0);
+        }
+    }
+
+    void sort()
+    {
+        sortDrawQueue();
+    }
+
+    const std::vector<ouzel::scene::Node*>& getDrawQueue() const { return drawQueue; }
+};
+
+static const uint32_t NODE_COUNTS[] = {1000, 10000, 100000};
+static const uint32_t CHILDREN_PER_ROOT = 10;
+static const uint32_t ITERATIONS = 50;
+
+static bool measure(uint32_t nodeCount, const std::vector<ouzel::scene::SpriteFrame>& spriteFrames)
+{
+    ouzel::scene::Scene scene;
+    VisitLayer layer;
+    ouzel::scene::Camera camera;
+    layer.addCamera(&camera);
+    scene.addLayer(&layer);
+
+    std::vector<std::unique_ptr<ouzel::scene::Node>> nodes;
+    std::vector<std::unique_ptr<ouzel::scene::Sprite>> sprites;
+
+    const ouzel::Size2& size = ouzel::sharedEngine->getRenderer()->getSize();
+    uint32_t random = 1;
+
+    for (uint32_t i = 0; i < nodeCount; ++i)
+    {
+        ouzel::scene::Node* node = new ouzel::scene::Node();
+        nodes.push_back(std::unique_ptr<ouzel::scene::Node>(node));
+
+        ouzel::scene::Sprite* sprite = new ouzel::scene::Sprite(spriteFrames);
+        sprites.push_back(std::unique_ptr<ouzel::scene::Sprite>(sprite));
+        node->addComponent(sprite);
+
+        // many nodes share an order, so the stability of the sort matters
+        random = random * 1103515245 + 12345;
+        node->setOrder(static_cast<int32_t>((random >> 16) % 16) - 8);
+
+        if (i % CHILDREN_PER_ROOT == 0)
+        {
+            node->setPosition(ouzel::Vector2(static_cast<float>((random >> 8) % 1000) / 1000.0f * size.width() - size.width() / 2.0f,
+                                             static_cast<float>((random >> 4) % 1000) / 1000.0f * size.height() - size.height() / 2.0f));
+            layer.addChild(node);
+        }
+        else
+        {
+            node->setPosition(ouzel::Vector2(static_cast<float>(i % CHILDREN_PER_ROOT) * 4.0f, 0.0f));
+            nodes[i - i % CHILDREN_PER_ROOT]->addChild(node);
+        }
+    }
+
+    ouzel::sharedEngine->getSceneManager()->setScene(&scene);
+
+    // enters the scene and calculates the camera projection and all transforms
+    updateFrame();
+
+    if (!presentFrame())
+    {
+        return false;
+    }
+
+    // draw order must match a stable sort of the traversal order from the highest to the lowest world order
+    layer.visit(&camera);
+    std::vector<ouzel::scene::Node*> expected = layer.getDrawQueue();
+    std::stable_sort(expected.begin(), expected.end(), [](ouzel::scene::Node* a, ouzel::scene::Node* b) {
+        return a->getWorldOrder() > b->getWorldOrder();
+    });
+
+    layer.sort();
+
+    if (layer.getDrawQueue() != expected)
+    {
+        ouzel::Log(ouzel::Log::Level::ERR) << "Sorted draw queue of " << nodeCount << " nodes doesn't match the expected order";
+        return false;
+    }
+
+    double visitTime = 0.0;
+    double sortTime = 0.0;
+
+    for (uint32_t i = 0; i < ITERATIONS; ++i)
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        layer.visit(&camera);
+        visitTime += getMilliseconds(start);
+
+        start = std::chrono::steady_clock::now();
+        layer.sort();
+        sortTime += getMilliseconds(start);
+    }
+
+    ouzel::Log(ouzel::Log::Level::INFO) << "visit: " << nodeCount << " nodes, " << static_cast<uint32_t>(layer.getDrawQueue().size()) << " visible, " <<
+        visitTime / ITERATIONS << " ms visit, " << sortTime / ITERATIONS << " ms sort";
+
+    return true;
+}
+
+int measureVisit()
+{
+    ouzel::graphics::TexturePtr texture = createTestTexture(16);
+
+    if (!texture)
+    {
+        return EXIT_FAILURE;
+    }
+
+    std::vector<ouzel::scene::SpriteFrame> spriteFrames = createTestSpriteFrames(texture);
+
+    for (uint32_t nodeCount : NODE_COUNTS)
+    {
+        if (!measure(nodeCount, spriteFrames))
+        {
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,101 @@
+// Copyright (C) 2016 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#include <cstdlib>
+#include <string>
+#include "Benchmarks.h"
+
+struct Benchmark
+{
+    const char* name;
+    int (*function)();
+};
+
+static const Benchmark BENCHMARKS[] = {
+    {"allocations", checkAllocations},
+    {"visit", measureVisit},
+    {"layers", measureLayers},
+    {"mipmaps", measureMipmaps},
+    {"transforms", measureTransforms},
+    {"culling", measureCulling}
+};
+
+ouzel::Engine engine;
+
+static void printUsage()
+{
+    std::string names;
+
+    for (const Benchmark& benchmark : BENCHMARKS)
+    {
+        names += std::string(names.empty() ? "" : "|") + benchmark.name;
+    }
+
+    ouzel::Log(ouzel::Log::Level::INFO) << "Usage: benchmarks [-benchmark " << names << "]";
+}
+
+void ouzelMain(const std::vector<std::string>& args)
+{
+    std::string name;
+
+    for (auto arg = args.begin(); arg != args.end(); ++arg)
+    {
+        if (arg == args.begin())
+        {
+            // skip the first parameter
+            continue;
+        }
+
+        if (*arg == "-benchmark" && arg + 1 != args.end())
+        {
+            name = *++arg;
+        }
+        else
+        {
+            printUsage();
+            std::exit(EXIT_FAILURE);
+        }
+    }
+
+    // benchmarks measure the engine itself, so nothing is sent to a GPU or an audio device
+    ouzel::Settings settings;
+    settings.renderDriver = ouzel::graphics::Renderer::Driver::EMPTY;
+    settings.audioDriver = ouzel::audio::Audio::Driver::EMPTY;
+    settings.size = ouzel::Size2(1280.0f, 720.0f);
+
+    if (!engine.init(settings))
+    {
+        std::exit(EXIT_FAILURE);
+    }
+
+    bool found = false;
+    int result = EXIT_SUCCESS;
+
+    for (const Benchmark& benchmark : BENCHMARKS)
+    {
+        if (name.empty() || name == benchmark.name)
+        {
+            found = true;
+
+            if (benchmark.function() != EXIT_SUCCESS)
+            {
+                ouzel::Log(ouzel::Log::Level::ERR) << "Benchmark " << benchmark.name << " failed";
+                result = EXIT_FAILURE;
+            }
+        }
+    }
+
+    if (!found)
+    {
+        printUsage();
+        result = EXIT_FAILURE;
+    }
+
+    // the application loop starts after this function returns, there is nothing left for it to run
+    if (result != EXIT_SUCCESS)
+    {
+        std::exit(result);
+    }
+
+    engine.exit();
+}
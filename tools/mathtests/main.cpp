@@ -0,0 +1,466 @@
+// Copyright (C) 2016 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "math/AABB3.h"
+#include "math/Matrix4.h"
+#include "math/Quaternion.h"
+#include "math/Vector4.h"
+
+// checks the math classes against double precision reference implementations and measures them,
+// the Makefile builds it with the SIMD paths of the platform and as the scalar reference build
+
+#if OUZEL_SUPPORTS_SSE
+static const char* BUILD_NAME = "SSE";
+#elif OUZEL_SUPPORTS_NEON || OUZEL_SUPPORTS_NEON64
+static const char* BUILD_NAME = "NEON";
+#else
+static const char* BUILD_NAME = "scalar";
+#endif
+
+static const size_t TEST_COUNT = 100000;
+static const size_t MEASURE_COUNT = 1000000;
+static const double TOLERANCE = 1e-5;
+
+static std::mt19937 randomEngine(1);
+
+static float getRandom()
+{
+    return std::uniform_real_distribution<float>(-1.0f, 1.0f)(randomEngine);
+}
+
+// diagonally dominant, so that the matrices are always invertible and well conditioned
+static ouzel::Matrix4 getRandomMatrix()
+{
+    ouzel::Matrix4 matrix;
+
+    for (size_t i = 0; i < 16; ++i)
+    {
+        matrix.m[i] = getRandom();
+    }
+
+    for (size_t i = 0; i < 4; ++i)
+    {
+        matrix.m[i * 5] += (matrix.m[i * 5] < 0.0f) ? -4.0f : 4.0f;
+    }
+
+    return matrix;
+}
+
+static bool check(const char* name, double error)
+{
+    if (error > TOLERANCE)
+    {
+        printf("%s: %s differs from the reference by %g\n", BUILD_NAME, name, error);
+        return false;
+    }
+
+    return true;
+}
+
+static void referenceMultiply(const float* m1, const float* m2, double* dst)
+{
+    for (size_t column = 0; column < 4; ++column)
+    {
+        for (size_t row = 0; row < 4; ++row)
+        {
+            double sum = 0.0;
+
+            for (size_t i = 0; i < 4; ++i)
+            {
+                sum += static_cast<double>(m1[i * 4 + row]) * m2[column * 4 + i];
+            }
+
+            dst[column * 4 + row] = sum;
+        }
+    }
+}
+
+static bool testMultiply()
+{
+    double error = 0.0;
+
+    for (size_t n = 0; n < TEST_COUNT; ++n)
+    {
+        ouzel::Matrix4 m1 = getRandomMatrix();
+        ouzel::Matrix4 m2 = getRandomMatrix();
+        ouzel::Matrix4 result;
+        ouzel::Matrix4::multiply(m1, m2, result);
+
+        double expected[16];
+        referenceMultiply(m1.m, m2.m, expected);
+
+        for (size_t i = 0; i < 16; ++i)
+        {
+            // the products are around 16, so the error is relative to that
+            error = std::max(error, fabs(result.m[i] - expected[i]) / 16.0);
+        }
+
+        // the destination may be one of the operands
+        ouzel::Matrix4::multiply(m1, m2, m1);
+
+        if (!std::equal(m1.m, m1.m + 16, result.m))
+        {
+            printf("%s: multiply into an operand gives a different result\n", BUILD_NAME);
+            return false;
+        }
+    }
+
+    return check("multiply", error);
+}
+
+static bool testInvert()
+{
+    double error = 0.0;
+
+    for (size_t n = 0; n < TEST_COUNT; ++n)
+    {
+        ouzel::Matrix4 matrix = getRandomMatrix();
+        ouzel::Matrix4 inverse;
+
+        if (!matrix.invert(inverse))
+        {
+            printf("%s: failed to invert an invertible matrix\n", BUILD_NAME);
+            return false;
+        }
+
+        double product[16];
+        referenceMultiply(matrix.m, inverse.m, product);
+
+        for (size_t i = 0; i < 16; ++i)
+        {
+            error = std::max(error, fabs(product[i] - ((i % 5 == 0) ? 1.0 : 0.0)));
+        }
+
+        // in place inversion must give the same result
+        if (!matrix.invert() || !std::equal(matrix.m, matrix.m + 16, inverse.m))
+        {
+            printf("%s: in place inversion gives a different result\n", BUILD_NAME);
+            return false;
+        }
+    }
+
+    ouzel::Matrix4 singular(1.0f, 2.0f, 3.0f, 4.0f,
+                            2.0f, 4.0f, 6.0f, 8.0f,
+                            0.0f, 1.0f, 0.0f, 1.0f,
+                            1.0f, 0.0f, 1.0f, 0.0f);
+    ouzel::Matrix4 inverse;
+
+    if (singular.invert(inverse))
+    {
+        printf("%s: a singular matrix was inverted\n", BUILD_NAME);
+        return false;
+    }
+
+    return check("invert", error);
+}
+
+static bool testTransform()
+{
+    double error = 0.0;
+
+    for (size_t n = 0; n < TEST_COUNT; ++n)
+    {
+        ouzel::Matrix4 matrix = getRandomMatrix();
+        ouzel::Vector4 vector(getRandom(), getRandom(), getRandom(), getRandom());
+        ouzel::Vector4 result;
+        matrix.transformVector(vector, result);
+
+        for (size_t row = 0; row < 4; ++row)
+        {
+            double expected = 0.0;
+
+            for (size_t i = 0; i < 4; ++i)
+            {
+                expected += static_cast<double>(matrix.m[i * 4 + row]) * vector.v[i];
+            }
+
+            error = std::max(error, fabs(result.v[row] - expected));
+        }
+
+        ouzel::Vector3 point(vector.v[0], vector.v[1], vector.v[2]);
+        ouzel::Vector3 transformedPoint;
+        matrix.transformPoint(point, transformedPoint);
+
+        for (size_t row = 0; row < 3; ++row)
+        {
+            double expected = static_cast<double>(matrix.m[12 + row]);
+
+            for (size_t i = 0; i < 3; ++i)
+            {
+                expected += static_cast<double>(matrix.m[i * 4 + row]) * point.v[i];
+            }
+
+            error = std::max(error, fabs(transformedPoint.v[row] - expected));
+        }
+    }
+
+    return check("transform", error);
+}
+
+// the batch versions are checked against transformPoint, the point counts are not multiples of four,
+// so that the scalar remainder of the SIMD loops runs too
+static const size_t BATCH_SIZE = 37;
+
+// a vertex like layout, so that the strided version skips over other data
+struct StridedPoint
+{
+    ouzel::Vector3 position;
+    float padding[2];
+};
+
+static bool testTransformPoints()
+{
+    double error = 0.0;
+
+    for (size_t n = 0; n < TEST_COUNT / BATCH_SIZE; ++n)
+    {
+        ouzel::Matrix4 matrix = getRandomMatrix();
+
+        ouzel::Vector3 points[BATCH_SIZE];
+        ouzel::Vector3 expected[BATCH_SIZE];
+        ouzel::Vector3 results[BATCH_SIZE];
+        StridedPoint stridedPoints[BATCH_SIZE];
+        float x[BATCH_SIZE], y[BATCH_SIZE], z[BATCH_SIZE];
+        float resultX[BATCH_SIZE], resultY[BATCH_SIZE], resultZ[BATCH_SIZE];
+
+        for (size_t i = 0; i < BATCH_SIZE; ++i)
+        {
+            points[i] = ouzel::Vector3(getRandom(), getRandom(), getRandom());
+            matrix.transformPoint(points[i], expected[i]);
+
+            stridedPoints[i].position = points[i];
+            x[i] = points[i].v[0];
+            y[i] = points[i].v[1];
+            z[i] = points[i].v[2];
+        }
+
+        matrix.transformPoints(points, results, BATCH_SIZE);
+        matrix.transformPoints(&stridedPoints[0].position, &stridedPoints[0].position, BATCH_SIZE,
+                               sizeof(StridedPoint), sizeof(StridedPoint));
+        matrix.transformPoints(x, y, z, resultX, resultY, resultZ, BATCH_SIZE);
+
+        for (size_t i = 0; i < BATCH_SIZE; ++i)
+        {
+            for (size_t j = 0; j < 3; ++j)
+            {
+                error = std::max(error, fabs(results[i].v[j] - expected[i].v[j]));
+                error = std::max(error, fabs(stridedPoints[i].position.v[j] - expected[i].v[j]));
+            }
+
+            error = std::max(error, fabs(resultX[i] - expected[i].v[0]));
+            error = std::max(error, fabs(resultY[i] - expected[i].v[1]));
+            error = std::max(error, fabs(resultZ[i] - expected[i].v[2]));
+        }
+    }
+
+    return check("transformPoints", error);
+}
+
+static bool testTransformAABBs()
+{
+    double error = 0.0;
+
+    for (size_t n = 0; n < TEST_COUNT / BATCH_SIZE; ++n)
+    {
+        ouzel::Matrix4 matrix = getRandomMatrix();
+
+        ouzel::AABB3 boxes[BATCH_SIZE];
+        ouzel::AABB3 results[BATCH_SIZE];
+
+        for (size_t i = 1; i < BATCH_SIZE; ++i)
+        {
+            ouzel::Vector3 a(getRandom(), getRandom(), getRandom());
+            ouzel::Vector3 b(getRandom(), getRandom(), getRandom());
+
+            boxes[i] = ouzel::AABB3(ouzel::Vector3(std::min(a.v[0], b.v[0]), std::min(a.v[1], b.v[1]), std::min(a.v[2], b.v[2])),
+                                    ouzel::Vector3(std::max(a.v[0], b.v[0]), std::max(a.v[1], b.v[1]), std::max(a.v[2], b.v[2])));
+        }
+
+        matrix.transformAABBs(boxes, results, BATCH_SIZE);
+
+        // the first box is empty
+        if (!results[0].isEmpty())
+        {
+            printf("%s: transformAABBs changed an empty box\n", BUILD_NAME);
+            return false;
+        }
+
+        for (size_t i = 1; i < BATCH_SIZE; ++i)
+        {
+            // the box that encloses the transformed corners, AABB3::getCorners is not used, so that the test doesn't depend on it
+            ouzel::AABB3 expected;
+
+            for (size_t corner = 0; corner < 8; ++corner)
+            {
+                ouzel::Vector3 point((corner & 1) ? boxes[i].max.v[0] : boxes[i].min.v[0],
+                                     (corner & 2) ? boxes[i].max.v[1] : boxes[i].min.v[1],
+                                     (corner & 4) ? boxes[i].max.v[2] : boxes[i].min.v[2]);
+                matrix.transformPoint(point);
+                expected.insertPoint(point);
+            }
+
+            for (size_t j = 0; j < 3; ++j)
+            {
+                error = std::max(error, fabs(results[i].min.v[j] - expected.min.v[j]));
+                error = std::max(error, fabs(results[i].max.v[j] - expected.max.v[j]));
+            }
+        }
+    }
+
+    return check("transformAABBs", error);
+}
+
+static bool testQuaternion()
+{
+    double error = 0.0;
+
+    for (size_t n = 0; n < TEST_COUNT; ++n)
+    {
+        ouzel::Quaternion q1(getRandom(), getRandom(), getRandom(), getRandom());
+        ouzel::Quaternion q2(getRandom(), getRandom(), getRandom(), getRandom());
+        ouzel::Quaternion result = q1 * q2;
+
+        double x1 = q1.x(), y1 = q1.y(), z1 = q1.z(), w1 = q1.w();
+        double x2 = q2.x(), y2 = q2.y(), z2 = q2.z(), w2 = q2.w();
+
+        double expected[] = {
+            w1 * x2 + x1 * w2 + y1 * z2 - z1 * y2,
+            w1 * y2 + y1 * w2 + z1 * x2 - x1 * z2,
+            w1 * z2 + z1 * w2 + x1 * y2 - y1 * x2,
+            w1 * w2 - x1 * x2 - y1 * y2 - z1 * z2
+        };
+
+        for (size_t i = 0; i < 4; ++i)
+        {
+            error = std::max(error, fabs(result.v[i] - expected[i]));
+        }
+    }
+
+    return check("quaternion multiply", error);
+}
+
+static bool testVector()
+{
+    double error = 0.0;
+
+    for (size_t n = 0; n < TEST_COUNT; ++n)
+    {
+        ouzel::Vector4 v1(getRandom(), getRandom(), getRandom(), getRandom());
+        ouzel::Vector4 v2(getRandom(), getRandom(), getRandom(), getRandom());
+        float scalar = getRandom();
+
+        ouzel::Vector4 sum = v1 + v2;
+        ouzel::Vector4 difference = v1 - v2;
+        ouzel::Vector4 scaled = v1 * scalar;
+
+        for (size_t i = 0; i < 4; ++i)
+        {
+            error = std::max(error, fabs(sum.v[i] - (static_cast<double>(v1.v[i]) + v2.v[i])));
+            error = std::max(error, fabs(difference.v[i] - (static_cast<double>(v1.v[i]) - v2.v[i])));
+            error = std::max(error, fabs(scaled.v[i] - static_cast<double>(v1.v[i]) * scalar));
+        }
+    }
+
+    return check("vector arithmetic", error);
+}
+
+static const size_t VALUE_COUNT = 1024;
+static const size_t MEASURE_BATCH_SIZE = 16;
+
+template<class F>
+static void measure(const char* name, F function)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    for (size_t n = 0; n < MEASURE_COUNT; ++n)
+    {
+        function(n % VALUE_COUNT);
+    }
+
+    double time = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+
+    printf("%s: %s %.1f ns\n", BUILD_NAME, name, time / MEASURE_COUNT);
+}
+
+static void measureAll()
+{
+    std::vector<ouzel::Matrix4> matrices(VALUE_COUNT);
+    std::vector<ouzel::Vector4> vectors(VALUE_COUNT);
+    std::vector<ouzel::Quaternion> quaternions(VALUE_COUNT);
+    std::vector<ouzel::Vector3> points(VALUE_COUNT + MEASURE_BATCH_SIZE);
+    std::vector<float> x(VALUE_COUNT + MEASURE_BATCH_SIZE), y(VALUE_COUNT + MEASURE_BATCH_SIZE), z(VALUE_COUNT + MEASURE_BATCH_SIZE);
+    std::vector<ouzel::AABB3> boxes(VALUE_COUNT + MEASURE_BATCH_SIZE);
+
+    for (size_t i = 0; i < VALUE_COUNT; ++i)
+    {
+        matrices[i] = getRandomMatrix();
+        vectors[i] = ouzel::Vector4(getRandom(), getRandom(), getRandom(), getRandom());
+        quaternions[i] = ouzel::Quaternion(getRandom(), getRandom(), getRandom(), getRandom());
+    }
+
+    for (size_t i = 0; i < VALUE_COUNT + MEASURE_BATCH_SIZE; ++i)
+    {
+        points[i] = ouzel::Vector3(getRandom(), getRandom(), getRandom());
+        x[i] = points[i].v[0];
+        y[i] = points[i].v[1];
+        z[i] = points[i].v[2];
+        boxes[i] = ouzel::AABB3(points[i] - ouzel::Vector3(0.5f, 0.5f, 0.5f), points[i] + ouzel::Vector3(0.5f, 0.5f, 0.5f));
+    }
+
+    // results go to separate arrays, so that the values don't grow and the calls can't be optimized away
+    std::vector<ouzel::Matrix4> matrixResults(VALUE_COUNT);
+    std::vector<ouzel::Vector4> vectorResults(VALUE_COUNT);
+    std::vector<ouzel::Quaternion> quaternionResults(VALUE_COUNT);
+    std::vector<ouzel::Vector3> pointResults(VALUE_COUNT + MEASURE_BATCH_SIZE);
+    std::vector<float> resultX(VALUE_COUNT + MEASURE_BATCH_SIZE), resultY(VALUE_COUNT + MEASURE_BATCH_SIZE), resultZ(VALUE_COUNT + MEASURE_BATCH_SIZE);
+    std::vector<ouzel::AABB3> boxResults(VALUE_COUNT + MEASURE_BATCH_SIZE);
+
+    measure("multiply", [&](size_t i) {
+        ouzel::Matrix4::multiply(matrices[i], matrices[(i + 1) % VALUE_COUNT], matrixResults[i]);
+    });
+    measure("invert", [&](size_t i) {
+        matrices[i].invert(matrixResults[i]);
+    });
+    measure("transformVector", [&](size_t i) {
+        matrices[i].transformVector(vectors[i], vectorResults[i]);
+    });
+    measure("quaternion multiply", [&](size_t i) {
+        quaternionResults[i] = quaternions[i] * quaternions[(i + 1) % VALUE_COUNT];
+    });
+    measure("transformPoints (16 points)", [&](size_t i) {
+        matrices[i].transformPoints(&points[i], &pointResults[i], MEASURE_BATCH_SIZE);
+    });
+    measure("transformPoints with coordinate arrays (16 points)", [&](size_t i) {
+        matrices[i].transformPoints(&x[i], &y[i], &z[i], &resultX[i], &resultY[i], &resultZ[i], MEASURE_BATCH_SIZE);
+    });
+    measure("transformAABBs (16 boxes)", [&](size_t i) {
+        matrices[i].transformAABBs(&boxes[i], &boxResults[i], MEASURE_BATCH_SIZE);
+    });
+}
+
+int main()
+{
+    if (!testMultiply() ||
+        !testInvert() ||
+        !testTransform() ||
+        !testTransformPoints() ||
+        !testTransformAABBs() ||
+        !testQuaternion() ||
+        !testVector())
+    {
+        return EXIT_FAILURE;
+    }
+
+    printf("%s: all tests passed\n", BUILD_NAME);
+
+    measureAll();
+
+    return EXIT_SUCCESS;
+}
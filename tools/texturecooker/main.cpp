@@ -0,0 +1,96 @@
+// Copyright (C) 2016 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "graphics/Image.h"
+#include "graphics/Texture.h"
+#include "utils/Log.h"
+
+static void printUsage()
+{
+    ouzel::Log(ouzel::Log::Level::INFO) << "Usage: texturecooker [-format rgba8|bc1|bc3] [-nomipmaps] input output";
+}
+
+int main(int argc, char* argv[])
+{
+    ouzel::graphics::PixelFormat pixelFormat = ouzel::graphics::PixelFormat::RGBA8_UNORM;
+    bool mipmaps = true;
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+
+        if (arg == "-format")
+        {
+            if (++i >= argc)
+            {
+                ouzel::Log(ouzel::Log::Level::ERR) << "No format specified";
+                return EXIT_FAILURE;
+            }
+
+            std::string format = argv[i];
+
+            if (format == "rgba8") pixelFormat = ouzel::graphics::PixelFormat::RGBA8_UNORM;
+            else if (format == "bc1") pixelFormat = ouzel::graphics::PixelFormat::BC1_UNORM;
+            else if (format == "bc3") pixelFormat = ouzel::graphics::PixelFormat::BC3_UNORM;
+            else
+            {
+                ouzel::Log(ouzel::Log::Level::ERR) << "Invalid format: " << format;
+                return EXIT_FAILURE;
+            }
+        }
+        else if (arg == "-nomipmaps")
+        {
+            mipmaps = false;
+        }
+        else
+        {
+            files.push_back(arg);
+        }
+    }
+
+    if (files.size() != 2)
+    {
+        printUsage();
+        return EXIT_FAILURE;
+    }
+
+    // the cooker runs without an engine, so the files are read directly instead of through the file system
+    std::ifstream inputFile(files[0], std::ios::binary);
+
+    if (!inputFile)
+    {
+        ouzel::Log(ouzel::Log::Level::ERR) << "Failed to open file " << files[0];
+        return EXIT_FAILURE;
+    }
+
+    std::vector<uint8_t> inputData((std::istreambuf_iterator<char>(inputFile)), std::istreambuf_iterator<char>());
+
+    ouzel::graphics::Image image;
+    if (!image.initFromBuffer(inputData))
+    {
+        ouzel::Log(ouzel::Log::Level::ERR) << "Failed to load image " << files[0];
+        return EXIT_FAILURE;
+    }
+
+    std::vector<uint8_t> outputData;
+    if (!ouzel::graphics::Texture::cook(image, pixelFormat, mipmaps, outputData))
+    {
+        return EXIT_FAILURE;
+    }
+
+    std::ofstream outputFile(files[1], std::ios::binary);
+
+    if (!outputFile.write(reinterpret_cast<const char*>(outputData.data()), static_cast<std::streamsize>(outputData.size())))
+    {
+        ouzel::Log(ouzel::Log::Level::ERR) << "Failed to write file " << files[1];
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}